@@ -5,16 +5,40 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 TARGET = CovidStrategyCalculator
 TEMPLATE = app
 
-CONFIG += c++17
+CONFIG += c++17 thread
 QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
 
 INCLUDEPATH += submodules/eigen
 
 HEADERS += \
+        include/cli/command_line.h \
+        include/cli/query_server.h \
+        include/core/agent_simulation.h \
         include/core/base_model.h \
+        include/core/calibration.h \
+        include/core/cohort_release.h \
+        include/core/ensemble.h \
+        include/core/exposure_mixture.h \
+        include/core/incidence_file.h \
+        include/core/mapped_file.h \
         include/core/model.h \
+        include/core/parallel.h \
+        include/core/parameter_index.h \
+        include/core/parameter_space.h \
+        include/core/parameters.h \
         include/core/prevalence_estimator.h \
+        include/core/query_service.h \
+        include/core/regional_prevalence.h \
+        include/core/result_cache.h \
+        include/core/result_store.h \
+        include/core/rolling_prevalence_estimator.h \
+        include/core/screening_programme.h \
+        include/core/sensitivity_analysis.h \
         include/core/simulation.h \
+        include/core/sobol_sequence.h \
+        include/core/timeline.h \
+        include/core/trajectory_archive.h \
+        include/core/traveller_policy.h \
         include/gui/efficacy_table.h \
         include/gui/main_window.h \
         include/gui/plot_area.h \
@@ -27,10 +51,33 @@ HEADERS += \
 
 SOURCES += \
         main.cpp \
+        src/cli/command_line.cpp \
+        src/cli/query_server.cpp \
+        src/core/agent_simulation.cpp \
         src/core/base_model.cpp \
+        src/core/calibration.cpp \
+        src/core/cohort_release.cpp \
+        src/core/ensemble.cpp \
+        src/core/exposure_mixture.cpp \
+        src/core/incidence_file.cpp \
+        src/core/mapped_file.cpp \
         src/core/model.cpp \
+        src/core/parameter_index.cpp \
+        src/core/parameter_space.cpp \
+        src/core/parameters.cpp \
         src/core/prevalence_estimator.cpp \
+        src/core/query_service.cpp \
+        src/core/regional_prevalence.cpp \
+        src/core/result_cache.cpp \
+        src/core/result_store.cpp \
+        src/core/rolling_prevalence_estimator.cpp \
+        src/core/screening_programme.cpp \
+        src/core/sensitivity_analysis.cpp \
         src/core/simulation.cpp \
+        src/core/sobol_sequence.cpp \
+        src/core/timeline.cpp \
+        src/core/trajectory_archive.cpp \
+        src/core/traveller_policy.cpp \
         src/gui/efficacy_table.cpp \
         src/gui/main_window.cpp \
         src/gui/plot_area.cpp \
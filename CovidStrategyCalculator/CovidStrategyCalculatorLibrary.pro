@@ -0,0 +1,29 @@
+# The covidstrategycalculator library: the model behind a C interface, without Qt.
+
+TARGET = covidstrategycalculator
+TEMPLATE = lib
+
+CONFIG += c++17 thread shared
+CONFIG -= qt
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+unix: QMAKE_CXXFLAGS += -fvisibility=hidden -fvisibility-inlines-hidden
+
+INCLUDEPATH += submodules/eigen
+DEFINES += CSC_BUILD_LIBRARY
+
+HEADERS += \
+        include/capi/covid_strategy_calculator.h \
+        include/core/base_model.h \
+        include/core/model.h \
+        include/core/parallel.h \
+        include/core/parameters.h \
+        include/core/simulation.h
+
+SOURCES += \
+        src/capi/covid_strategy_calculator.cpp \
+        src/core/base_model.cpp \
+        src/core/model.cpp \
+        src/core/parameters.cpp \
+        src/core/simulation.cpp
+
+VERSION = 1.0.0
@@ -0,0 +1,138 @@
+/* covid_strategy_calculator.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the C interface of the covidstrategycalculator library, which embeds the model in other programs
+ * without Qt or C++ types. An engine holds the disease parameters and the outputs of its last evaluation; the outputs
+ * are written into buffers of the caller, row by row with the typical, best and worst case in each row.
+ *
+ * Thread safety: an engine may be used by one thread at a time; different engines may be used concurrently. Calls
+ * on one engine from several threads must be serialised by the caller. csc_evaluate_batch distributes its scenarios
+ * over threads of its own. The functions without an engine are safe to call from any thread.
+ *
+ * Errors: functions return a csc_status and never throw; csc_last_error describes the last failure of an engine.
+ * The layout of the structs and the meaning of the functions stay fixed for an ABI version.
+ */
+
+#ifndef COVID_STRATEGY_CALCULATOR_H
+#define COVID_STRATEGY_CALCULATOR_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(CSC_BUILD_LIBRARY)
+#define CSC_API __declspec(dllexport)
+#else
+#define CSC_API __declspec(dllimport)
+#endif
+#else
+#define CSC_API __attribute__((visibility("default")))
+#endif
+
+#define CSC_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum csc_status {
+    CSC_OK = 0,
+    CSC_INVALID_ARGUMENT = 1, // e.g. a null pointer, or parameters or a strategy out of range
+    CSC_BUFFER_TOO_SMALL = 2, // the buffer holds fewer values than the output; nothing is written
+    CSC_NOT_EVALUATED = 3,    // the engine has no outputs, or not the requested ones
+    CSC_FAILURE = 4           // the evaluation failed, e.g. out of memory
+} csc_status;
+
+// the disease parameters in the units of the ParametersTab: durations in days, percentages in percent
+typedef struct csc_disease_parameters {
+    float duration_incubation_lower;
+    float duration_incubation_mean;
+    float duration_incubation_upper;
+    float percentage_of_incubation_predetection;
+    float duration_symptomatic_lower;
+    float duration_symptomatic_mean;
+    float duration_symptomatic_upper;
+    float percentage_asymptomatic;
+    float duration_postinfectious_mean;
+    float pcr_sensitivity;
+    float pcr_specificity;
+    float relative_rdt_sensitivity;
+} csc_disease_parameters;
+
+// a strategy as in the StrategyTab; the arrays are read during the call only
+typedef struct csc_strategy {
+    int mode;                  // contact management=0, isolation=1; incoming travelers=2 is not supported
+    int time_delay;            // days between exposure / symptom onset and start of the strategy
+    int duration;              // days
+    const int *test_days;      // n_tests increasing days since the start of the strategy, within its duration
+    const int *test_types;     // type per test day, or NULL when all tests are of test_type
+    int n_tests;
+    int test_type;             // PCR=0, RDT=1
+    float adherence;           // fraction of individuals that adheres to the strategy
+    float p_infectious;        // the initial probability of infection
+    int symptomatic_screening; // 0 or 1
+} csc_strategy;
+
+typedef struct csc_engine csc_engine; // opaque
+
+CSC_API int csc_abi_version(void); // CSC_ABI_VERSION of the library, to compare with that of the header
+CSC_API void csc_default_parameters(csc_disease_parameters *parameters);
+CSC_API void csc_default_strategy(csc_strategy *strategy); // contact management of 10 days without tests
+
+// creates an engine for the parameters; returns NULL if they are out of range or memory is exhausted
+CSC_API csc_engine *csc_engine_create(const csc_disease_parameters *parameters);
+CSC_API void csc_engine_destroy(csc_engine *engine); // accepts NULL
+// replaces the parameters of later evaluations; the outputs of the last evaluation remain
+CSC_API csc_status csc_engine_set_parameters(csc_engine *engine, const csc_disease_parameters *parameters);
+// the last failure of the engine, valid until the next call on it; "" if there was none
+CSC_API const char *csc_last_error(const csc_engine *engine);
+
+/* Evaluates the strategy with all evaluation points, as the graphical user interface does, and keeps the outputs
+ * until the next evaluation. The sizes below are in rows of three values, except the evaluation points; the capacity
+ * of a buffer is the number of floats it holds. Incoming travelers need prevalence states, which a strategy does not
+ * hold, and return CSC_INVALID_ARGUMENT.
+ */
+CSC_API csc_status csc_evaluate(csc_engine *engine, const csc_strategy *strategy);
+CSC_API size_t csc_n_evaluation_points(const csc_engine *engine); // rows of the relative risk, 0 if not evaluated
+CSC_API size_t csc_n_days(const csc_engine *engine); // rows of the assay sensitivity and efficacy, from exposure
+
+/* the day of each evaluation point since the start of the strategy, from minus the time delay; test days appear
+ * twice, before and after the test
+ */
+CSC_API csc_status csc_evaluation_points(const csc_engine *engine, float *days, size_t capacity);
+CSC_API csc_status csc_relative_risk(const csc_engine *engine, float *relative_risk, size_t capacity);
+// the assay sensitivity and test efficacy of a test on each day without intervention, for PCR (0) or RDT (1)
+CSC_API csc_status csc_assay_sensitivity(const csc_engine *engine, int test_type, float *sensitivity,
+                                         size_t capacity);
+CSC_API csc_status csc_test_efficacy(const csc_engine *engine, int test_type, float *efficacy, size_t capacity);
+// the probability to be, or yet to become infectious at the end of the strategy; three values
+CSC_API csc_status csc_p_infectious_tend(const csc_engine *engine, float *p_infectious_tend);
+
+/* Evaluates n strategies at the end of the strategy only, over all threads, and writes three values per strategy to
+ * relative_risk and p_infectious_tend (n rows each; either may be NULL). statuses, if not NULL, receives the status
+ * of every strategy; the rows of a failed strategy are NaN. Returns CSC_OK if all strategies succeeded, otherwise the
+ * status of the first failure. If the batch itself fails, e.g. as no thread can be started, returns CSC_FAILURE and
+ * the strategies it did not evaluate read as failed. Does not change the outputs of csc_evaluate.
+ */
+CSC_API csc_status csc_evaluate_batch(csc_engine *engine, const csc_strategy *strategies, size_t n,
+                                      float *relative_risk, float *p_infectious_tend, csc_status *statuses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COVID_STRATEGY_CALCULATOR_H
@@ -0,0 +1,59 @@
+/* command_line.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the namespace CommandLine, which runs the headless modes of COVIDStrategycalculator.
+ * A headless mode is selected by the first argument, e.g. `CovidStrategyCalculator --ensemble --tests 3,7`, and
+ * writes its results as CSV to the standard output.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace CommandLine {
+
+// the options following the command, `--key value` or `--flag`
+class Arguments {
+    std::map<std::string, std::string> options_{};
+
+  public:
+    Arguments(int argc, char *argv[]); // constructor
+
+    bool has(const std::string &key) const { return options_.count(key); }
+    std::string value(const std::string &key, const std::string &fallback) const;
+    float value(const std::string &key, float fallback) const;
+    int value(const std::string &key, int fallback) const;
+    std::vector<int> values(const std::string &key) const; // comma separated list
+
+    /* the strategy as entered in the StrategyTab; durations in days, adherence in percent. Throws a
+     * std::invalid_argument if it is out of range, see StrategyParameters::check.
+     */
+    StrategyParameters strategy() const;
+    // one strategy per test schedule, when alternative schedules are separated by ';', e.g. `--tests "3,7;5;"`
+    std::vector<StrategyParameters> strategies() const;
+    // the parameters as entered in the ParametersTab, keyed as in Parameters::default_values
+    std::map<std::string, float> parameter_values() const;
+};
+
+bool is_command(const std::string &argument); // whether the argument selects a headless mode
+int run(int argc, char *argv[]);               // runs the headless mode, returns the exit code
+} // namespace CommandLine
@@ -0,0 +1,107 @@
+/* query_server.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the QueryServer class.
+ * The objective of the QueryServer class is to make a QueryService available to other programs on the same machine,
+ * on a TCP port of the loopback interface or on a Unix socket. Clients send one query per line and receive one answer
+ * per line; the answers of a connection may arrive in another order than its queries and carry their id. A single
+ * thread serves all connections, the queries are evaluated by the QueryService. The QueryClient is a blocking
+ * connection to a server, as used by the benchmark. Not available on Windows.
+ */
+
+#pragma once
+
+#include "include/core/query_service.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class QueryServer {
+
+  public:
+    // constructors; listen on 127.0.0.1:port or on a Unix socket, throw a std::runtime_error if they cannot
+    QueryServer(QueryService &service, int port);
+    QueryServer(QueryService &service, const std::string &socket_path);
+    ~QueryServer(); // destructor; closes the connections and removes the Unix socket
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    void run();  // serves the connections until stop() is called
+    void stop(); // safe to call from any thread, e.g. a signal handler thread
+
+    int port() const { return port_; } // the port listened on, e.g. when constructed with port 0
+
+  private:
+    struct Connection {
+        int socket;
+        std::string input{};  // received, up to the last complete line
+        std::string output{}; // answers not yet sent
+        int pending{};        // queries not yet answered
+        bool finished{};      // whether the client has finished sending; closed once all queries are answered
+    };
+
+    // the answers of the service by connection; shared with the pending queries, which may outlive the server
+    struct Outbox {
+        std::mutex mutex{};
+        std::vector<std::pair<uint64_t, std::string>> answers{};
+        int wake{-1}; // write end of the pipe that interrupts the wait of run(), -1 once the server is destroyed
+    };
+
+    void listen_on(int socket, const void *address, unsigned address_size, const std::string &name);
+    void accept_connections();
+    bool receive(uint64_t id, Connection &connection); // false when the connection fails
+    bool send(Connection &connection);                 // false when the connection fails
+
+    QueryService &service_;
+    int listener_{-1};
+    int wake_pipe_[2]{-1, -1};
+    int port_{};
+    std::string socket_path_{};
+    std::atomic<bool> stopping_{false};
+    std::map<uint64_t, Connection> connections_{}; // by id, which unlike the socket is not reused
+    uint64_t next_id_{};
+    std::shared_ptr<Outbox> outbox_;
+};
+
+class QueryClient {
+
+  public:
+    // constructors; connect to 127.0.0.1:port or to a Unix socket, throw a std::runtime_error if they cannot
+    explicit QueryClient(int port);
+    explicit QueryClient(const std::string &socket_path);
+    ~QueryClient(); // destructor; closes the connection
+    QueryClient(const QueryClient &) = delete;
+    QueryClient &operator=(const QueryClient &) = delete;
+
+    /* Sending and receiving may happen on two threads, e.g. to keep queries in flight. Sending throws a
+     * std::runtime_error if the connection fails; receiving returns false when the server closed it.
+     */
+    void send(const std::string &query); // a query, without the newline
+    bool receive(std::string &answer);  // the next answer, without the newline
+    void finish();                       // tells the server that no more queries follow
+
+  private:
+    int socket_{-1};
+    std::string input_{};
+};
@@ -0,0 +1,52 @@
+/* agent_simulation.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the AgentSimulation class, which derives from, and extends the Simulation class.
+ * The objective of the AgentSimulation class is to validate the deterministic model against the stochastic process
+ * it describes the mean of: individuals pass through the same compartments with exponential residence times, are
+ * tested on the same days with the same false omission rates, and are removed by a positive test or symptomatic
+ * screening. The empirical states replace those of the Model, such that the functions of the Simulation class,
+ * except relative_risk_jacobian, give the empirical results.
+ */
+
+#pragma once
+
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+#include <cstdint>
+
+class AgentSimulation : public Simulation {
+
+  public:
+    AgentSimulation() = default; // constructor
+    /* constructor; simulates n_agents infected individuals, whose initial compartments follow the initial states of
+     * the Simulation class. The random numbers are counter based, so the results only depend on the seed.
+     */
+    AgentSimulation(const DiseaseParameters &parameters, const StrategyParameters &strategy, int n_agents,
+                    uint32_t seed = 1, Eigen::VectorXf prevalence_states = Eigen::VectorXf());
+    ~AgentSimulation() = default; // destructor
+
+    // standard error of the relative risk, per evaluation point (rows) and scenario (columns)
+    Eigen::MatrixXf relative_risk_standard_error() const { return relative_risk_standard_error_; }
+    int n_agents() const { return n_agents_; }
+
+  private:
+    int n_agents_{};
+    Eigen::MatrixXf relative_risk_standard_error_{};
+};
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <array>
 #include <vector>
 
 class BaseModel {
@@ -32,22 +33,53 @@ class BaseModel {
     static const int n_compartments;                // 3+3+13+1+1 = 21
 
     BaseModel() = default; // constructor
-    BaseModel(std::vector<float> residence_times, float risk_posing_fraction_symptomatic_phase,
-              Eigen::Vector<float, 21> initial_states); // constructor
-    ~BaseModel() = default;                             // destructor
+    BaseModel(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+              const Eigen::Vector<float, 21> &initial_states); // constructor
+    ~BaseModel() = default;                                    // destructor
 
-    Eigen::Vector<float, 21> X0;                 // initial states
-    Eigen::Vector<float, 21> run_base(int time); // calculate states at time
-    // calculate states at time, for given initial states
-    Eigen::Vector<float, 21> run_base(int time, Eigen::Vector<float, 21> initial_states);
+    /* replaces the residence times and the risk posing fraction, such that a model can be reused for another
+     * parameter set without allocating; drops the cached propagators. Throws std::invalid_argument unless there are
+     * four residence times.
+     */
+    void set_parameters(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase);
+
+    Eigen::Vector<float, 21> X0;                       // initial states
+    Eigen::Vector<float, 21> run_base(int time) const; // calculate states at time
+    /* calculate states at time, for given initial states. The evaluations of the model are const and keep no state
+     * between calls, such that a single model can be shared by several threads.
+     */
+    Eigen::Vector<float, 21> run_base(int time, const Eigen::Vector<float, 21> &initial_states) const;
+    /* keeps exp(A * time) for time = 0, ..., horizon, which run_base then applies instead of computing it again; to
+     * call before the model is shared, as it changes the model
+     */
+    void cache_propagators(int horizon);
+
+    Eigen::Matrix<double, 21, 21> propagator(int time) const; // exp(A * time) in double precision
+
+    // parameters of the generator, in the order of the derivatives below
+    enum Parameter {
+        tau_predetection = 0,
+        tau_presymptomatic,
+        tau_symptomatic,
+        tau_postinfectious,
+        risk_posing_fraction,
+        n_base_parameters
+    };
+    // derivatives of the generator A_ with respect to the parameters
+    std::vector<Eigen::Matrix<double, 21, 21>> generator_derivatives() const;
+    /* One-day propagator exp(A) and its derivatives with respect to the parameters, from the block-triangular identity
+     * exp([A, dA; 0, A]) = [exp(A), d exp(A); 0, exp(A)], which differentiates the exponential exactly.
+     */
+    Eigen::Matrix<double, 21, 21> daily_propagator(std::vector<Eigen::Matrix<double, 21, 21>> &derivatives) const;
 
   private:
     float risk_posing_symptomatic_{}; // fraction of asymptomatic cases
-    std::vector<float> tau_{};        // vector of residence times per compartment
+    std::array<float, 4> tau_{};      // residence times per phase
 
     Eigen::Vector<float, 21> rates_;
     Eigen::Matrix<float, 21, 21 - 1> S_; // stoichiometric matrix
     Eigen::Matrix<float, 21, 21> A_;
+    std::vector<Eigen::Matrix<float, 21, 21>> propagators_{}; // exp(A * time) per day, see cache_propagators
 
     void set_rates();
     void set_S();
@@ -0,0 +1,113 @@
+/* calibration.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the Calibration class.
+ * The objective of the Calibration class is to fit the disease parameters to line-list data of a testing programme:
+ * test results by day since exposure and the day of symptom onset. The parameters are estimated by maximum likelihood,
+ * with a Levenberg-Marquardt optimiser on the exact model derivatives, from several starting points in parallel.
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+class Calibration {
+
+  public:
+    // line-list data, aggregated by day since exposure
+    struct Observations {
+        Eigen::VectorXd positive[2]{}; // number of positive tests per day, per test type (PCR=0, RDT=1)
+        Eigen::VectorXd negative[2]{}; // number of negative tests per day, per test type (PCR=0, RDT=1)
+        Eigen::VectorXd onset{};       // number of cases with symptom onset per day
+        double asymptomatic{};         // number of cases that did not develop symptoms
+
+        int n_days() const; // days since exposure covered by the data
+        double n_observations() const;
+
+        /* Reads a line list in CSV format with the header `event,day,result`, one observation per line:
+         * `pcr,<day>,positive|negative`, `rdt,<day>,positive|negative`, `onset,<day>,` or `asymptomatic,,`. Days are
+         * whole days since exposure; an onset on day d happened in [d, d + 1). Throws a std::runtime_error on
+         * malformed lines.
+         */
+        static Observations from_csv(std::istream &stream);
+    };
+
+    // the fitted parameters, in the units of the ParametersTab but as fractions instead of percentages
+    enum FitParameter {
+        incubation_mean = 0,
+        fraction_predetection,
+        symptomatic_mean,
+        pcr_sensitivity,
+        rdt_relative_sensitivity,
+        fraction_asymptomatic,
+        n_fit_parameters
+    };
+
+    struct Fit {
+        Eigen::VectorXd parameters; // per FitParameter
+        double log_likelihood;
+        int iterations;
+        bool converged;
+    };
+
+    Calibration() = default; // constructor
+    /* constructor; the parameters that are not fitted (specificity, postinfectious period) and the starting point of
+     * the first start are taken from the initial values, keyed as in Parameters::default_values.
+     */
+    Calibration(Observations observations, std::map<std::string, float> initial_values);
+    ~Calibration() = default; // destructor
+
+    /* Maximises the likelihood from n_starts starting points, the initial values and scrambled Sobol points in a
+     * plausible box. Parameters without informative data are kept at their initial value: the PCR or RDT
+     * sensitivity without results of that test, and the fraction asymptomatic without onsets.
+     */
+    void run(int n_starts = 8, uint32_t seed = 1);
+
+    // getter functions
+    const std::vector<Fit> &fits() const { return fits_; } // per start
+    const Fit &best_fit() const { return fits_[best_]; }
+    std::vector<bool> fitted() const; // per FitParameter, whether it is estimated
+    /* The initial values with the best fit applied. The lower and upper extreme values of the incubation and
+     * symptomatic period are shifted along with their mean, such that the file can be loaded into the ParametersTab.
+     */
+    std::map<std::string, float> values() const;
+
+    // log-likelihood of the observations and its gradient with respect to the parameters
+    double log_likelihood(const Eigen::VectorXd &parameters, Eigen::VectorXd *gradient = nullptr) const;
+
+    /* Least-squares form of the negative log-likelihood: sum(residuals^2) = -log_likelihood. One residual per
+     * outcome and day, sqrt(-count * log(p)), with its Jacobian with respect to the parameters.
+     */
+    Eigen::VectorXd residuals(const Eigen::VectorXd &parameters, Eigen::MatrixXd *jacobian = nullptr) const;
+    int n_residuals() const;
+
+  private:
+    Observations observations_{};
+    std::map<std::string, float> initial_values_{};
+    Eigen::VectorXd initial_parameters_{};
+
+    std::vector<Fit> fits_{};
+    int best_{};
+
+    Fit fit(const Eigen::VectorXd &start) const;
+};
@@ -0,0 +1,65 @@
+/* cohort_release.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the CohortRelease class.
+ * The objective of the CohortRelease class is to turn the probability per traveller of the Simulation into the
+ * distribution of the number of infectious people released from a finite cohort, e.g. a flight, whose travellers
+ * come from origins with different probabilities. The count is Poisson-binomial distributed; its distribution is the
+ * convolution of the binomial distributions of the origins.
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <istream>
+#include <vector>
+
+class CohortRelease {
+
+  public:
+    struct Origin {
+        double probability; // per traveller
+        int travellers;
+    };
+
+    /* Reads origins in CSV format with the header `origin,travellers,probability`, one origin per line. Throws a
+     * std::runtime_error on malformed lines, including a probability that is not a number within [0, 1].
+     */
+    static std::vector<Origin> read_csv(std::istream &stream);
+
+    CohortRelease() = default; // constructor
+    /* constructor; probabilities below 1e-20, or below the round-off of the FFT (1e-15 times the largest
+     * probability), are dropped from the tails of the distribution
+     */
+    explicit CohortRelease(const std::vector<Origin> &origins);
+    ~CohortRelease() = default; // destructor
+
+    // getter functions
+    int min_released() const { return offset_; } // smallest count with a non-negligible probability
+    int max_released() const { return offset_ + distribution_.size() - 1; }
+    double probability(int released) const; // P(X = released)
+    double tail_probability(int released) const; // P(X >= released)
+    double mean() const;
+    int quantile(double q) const; // smallest count k with P(X <= k) >= q
+    int n_travellers() const { return n_travellers_; }
+
+  private:
+    int n_travellers_{};
+    int offset_{};                   // count of the first entry of the distribution
+    Eigen::VectorXd distribution_{}; // P(X = offset + k)
+};
@@ -0,0 +1,118 @@
+/* ensemble.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the Ensemble class.
+ * The objective of the Ensemble class is to propagate the uncertainty in the disease parameters to the relative risk of
+ * an NPI strategy. The typical case of the strategy is evaluated for parameter sets sampled from a ParameterSpace,
+ * either pseudo-randomly or by scrambled Sobol points, until the quantile bands of the relative risk stop moving.
+ */
+
+#pragma once
+
+#include "include/core/model.h"
+#include "include/core/parameter_space.h"
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <vector>
+
+class Ensemble {
+
+  public:
+    enum Sampling { pseudo_random = 0, sobol = 1 };
+
+    struct ConvergenceStep {
+        int n_samples;     // number of samples after this step
+        float band_change; // largest change of the quantile bands with respect to the previous step
+    };
+
+    struct BenchmarkRow {
+        int n_samples;
+        float error_pseudo_random; // largest deviation of the bands from the reference, mean over replicates
+        float error_sobol;
+    };
+
+    /* the models and buffers of risks() for one strategy, to reuse for the parameter sets that one thread evaluates;
+     * the evaluations in a workspace do not allocate once its buffers have their size
+     */
+    struct Workspace {
+        Model model_no_intervention;
+        Model model_NPI;
+        std::vector<float> test_sensitivity{}; // per test type
+        Eigen::VectorXf initial_states_NPI{};
+        Eigen::MatrixXf initial_states{}; // as a row
+        Eigen::MatrixXf strategy_states{};
+        Eigen::MatrixXf risk{};
+    };
+
+    Ensemble() = default; // constructor
+    /* constructor; the prevalence states are the initial states in incoming travelers mode, as estimated by the
+     * PrevalenceEstimator. Leave empty when no prevalence estimation is used.
+     */
+    Ensemble(ParameterSpace space, StrategyParameters strategy, Eigen::VectorXf prevalence_states = Eigen::VectorXf());
+    ~Ensemble() = default; // destructor
+
+    /* Sample in batches that double the sample size, until the quantile bands of the relative risk change less than
+     * `tolerance` (on the 0-1 scale) between two batches, or until `max_samples` is reached.
+     */
+    void run(Sampling sampling = sobol, float tolerance = 1e-3, int max_samples = 1 << 14, uint32_t seed = 1);
+
+    // getter functions
+    Eigen::MatrixXf relative_risk_bands() const { return bands_; } // per evaluation point: median, lower, upper
+    bool converged() const { return converged_; }
+    int n_samples() const { return samples_.cols(); }
+    const std::vector<ConvergenceStep> &convergence() const { return convergence_; }
+
+    /* Residual risk per evaluation point of the typical case for one parameter set; column 0 with full adherence to
+     * the strategy, column 1 without intervention. The expected adherence only mixes these two columns. With
+     * end_of_strategy_only, the single row of the end of the strategy is calculated without the daily states.
+     */
+    Eigen::MatrixXf risks(const DiseaseParameters &parameters, bool end_of_strategy_only = false) const;
+    // a workspace for the strategy of this ensemble, and risks() evaluated in it; the result stays until its next use
+    Workspace workspace() const;
+    const Eigen::MatrixXf &risks(const DiseaseParameters &parameters, Workspace &workspace,
+                                 bool end_of_strategy_only = false) const;
+    Eigen::VectorXf relative_risk(const DiseaseParameters &parameters) const; // typical case for one parameter set
+    static Eigen::VectorXf relative_risk(const Eigen::MatrixXf &risks, float expected_adherence);
+    // relative risk per evaluation point (rows) for the sample points with index [first, first + n) (columns)
+    Eigen::MatrixXf sample_relative_risk(Sampling sampling, int first, int n, uint32_t seed) const;
+
+    /* Samples-to-accuracy of pseudo-random and Sobol sampling. The error of the bands with respect to a reference
+     * (Sobol sampling with 4 * max_samples points) is reported for sample sizes 64, 128, ..., max_samples.
+     */
+    std::vector<BenchmarkRow> benchmark(int max_samples = 1 << 12, int replicates = 8, uint32_t seed = 1) const;
+
+    // median and the central `coverage` interval per row of samples
+    static Eigen::MatrixXf quantile_bands(const Eigen::MatrixXf &samples, float coverage = .95);
+
+    const ParameterSpace &space() const { return space_; }
+    const StrategyParameters &strategy() const { return strategy_; }
+
+  private:
+    ParameterSpace space_;
+    StrategyParameters strategy_;
+    int t_end_{};
+    Eigen::VectorXf initial_states_{};
+    bool use_prevalence_states_{false};
+
+    Eigen::MatrixXf samples_{}; // relative risk per evaluation point (rows) per sample (columns)
+    Eigen::MatrixXf bands_{};
+    bool converged_{false};
+    std::vector<ConvergenceStep> convergence_{};
+};
@@ -0,0 +1,53 @@
+/* exposure_mixture.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ExposureMixture class, which derives from, and extends the Simulation class.
+ * The objective of the ExposureMixture class is to evaluate a contact management strategy for contacts whose day of
+ * exposure is uncertain: the time delay follows a discrete distribution instead of being a single number. The
+ * results are those of the Simulation class, averaged over the distribution, at about the cost of one Simulation.
+ */
+
+#pragma once
+
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+#include <vector>
+
+class ExposureMixture : public Simulation {
+
+  public:
+    ExposureMixture() = default; // constructor
+    /* constructor; offset_weights[d] is the (unnormalised) probability that the exposure happened d days before the
+     * start of the strategy. The strategy is in contact management mode; its time delay is replaced by the
+     * distribution, its test moments are taken relative to the time delay, i.e. to the start of the strategy.
+     */
+    ExposureMixture(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                    std::vector<float> offset_weights);
+    ~ExposureMixture() = default; // destructor
+
+    /* The functions of the Simulation class give the mixture over the exposure days, during the strategy only: the
+     * evaluation points run from the start (0) to the end of the strategy, and the temporal assay sensitivity is per
+     * day since the start of the strategy.
+     */
+    const Eigen::VectorXf &offset_weights() const { return offset_weights_; } // normalised
+    int max_offset() const { return offset_weights_.size() - 1; }
+
+  private:
+    Eigen::VectorXf offset_weights_{};
+};
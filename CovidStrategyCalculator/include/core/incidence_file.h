@@ -0,0 +1,75 @@
+/* incidence_file.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the IncidenceFile class.
+ * The objective of the IncidenceFile class is to read incidence time series of many regions (see
+ * RegionalPrevalence::read_csv) from files of several gigabytes. The file is memory-mapped and parsed in place, one
+ * region at a time, such that the memory use does not depend on the size of the file.
+ */
+
+#pragma once
+
+#include "include/core/mapped_file.h"
+#include "include/core/regional_prevalence.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class IncidenceFile {
+
+  public:
+    // the fields of one line `region,date,cases,population,detection_rate`; name and date point into the line
+    struct Line {
+        const char *name;
+        size_t name_length;
+        const char *date; // YYYY-MM-DD
+        int day;          // days since 1970-01-01
+        float incidence;  // cases per individual, corrected for the detection rate
+    };
+    // parses one line (without line break) in place, without allocations; returns false if the line is malformed
+    static bool parse_line(const char *begin, const char *end, Line &line);
+
+    // constructor; maps the file, throws a std::runtime_error if it cannot be read
+    explicit IncidenceFile(const std::string &path);
+    ~IncidenceFile() = default; // destructor
+
+    /* Reads the lines of the next region into region, reusing its memory. The lines of a region are contiguous, as
+     * in files sorted by region; a region that reappears later or a malformed line throws a std::runtime_error.
+     * Returns false at the end of the file.
+     */
+    bool next(RegionalPrevalence::Region &region);
+
+    // getter functions
+    size_t size() const { return file_.size(); } // in bytes
+    size_t position() const { return position_; }
+
+  private:
+    struct Report {
+        int day;
+        float incidence;
+    };
+
+    MappedFile file_;
+    size_t position_{};             // start of the next line
+    size_t released_{};             // pages before this offset are released from memory
+    int line_number_{};             // lines read so far
+    std::vector<Report> reports_{}; // of the current region
+    std::unordered_set<std::string> regions_{};
+};
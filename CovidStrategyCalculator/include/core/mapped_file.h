@@ -0,0 +1,56 @@
+/* mapped_file.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the MappedFile class.
+ * The objective of the MappedFile class is to map a file read-only into memory, such that it is read in place and only
+ * the pages that are accessed are loaded, as for the ResultStore, the ParameterIndex and the IncidenceFile.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+
+  public:
+    /* How the file is read: at random, through a mapping that is shared with writers of the file, or once from the
+     * start to the end, through a private mapping that the system reads ahead.
+     */
+    enum Access { random_access = 0, sequential_access };
+
+    MappedFile() = default; // constructor
+    // constructor; maps the file, throws a std::runtime_error if it cannot be read
+    explicit MappedFile(const std::string &path, Access access = random_access);
+    ~MappedFile(); // destructor
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // getter functions
+    const char *data() const { return data_; }
+    size_t size() const { return size_; } // in bytes
+
+    /* releases the whole pages within [begin, end) from memory, which are read from the file again when accessed;
+     * returns the end of the last page released, or begin. Does nothing on Windows.
+     */
+    size_t release(size_t begin, size_t end) const;
+
+  private:
+    const char *data_{};
+    size_t size_{};
+};
@@ -27,36 +27,107 @@
 #include "include/core/base_model.h"
 
 #include <Eigen/Dense>
+#include <array>
 #include <vector>
 
 class Model : public BaseModel {
 
-    int t_end{};               // time point marking end of NPI
-    std::vector<int> t_test{}; // time points at which to perform a diagnostic test
+    int t_end{};                   // time point marking end of NPI
+    std::vector<int> t_test{};     // time points at which to perform a diagnostic test
+    std::vector<int> test_types{}; // type of the test at each time point, PCR=0, RDT=1
 
-    int test_type;                       // PCR=0, RDT=1
-    float specificity{};                 // specificity of diagnostic test
-    float sensitivity{};                 // sensitivity of diagnostic test
-    Eigen::VectorXf false_ommision_rate; // compartment dependent false ommision rates
+    float specificity{};                                            // specificity of diagnostic test
+    std::array<float, 2> sensitivity{};                             // sensitivity of diagnostic test, per test type
+    std::array<Eigen::Vector<float, 21>, 2> false_ommision_rates{}; // compartment dependent, per test type
     void set_false_ommision_rate();
     void set_false_ommision_rate_PCR();
     void set_false_ommision_rate_RDT();
 
-    Eigen::MatrixXf run_no_test(int time); // run the model without tests
+    // run the model without tests, from the given initial states, into states (time + 1 rows)
+    void run_no_test(int time, const Eigen::Vector<float, 21> &initial_states,
+                     Eigen::Ref<Eigen::MatrixXf> states) const;
+
+    // derivative of the false ommision rates of a test type with respect to a test parameter (see TestParameter)
+    Eigen::VectorXd false_ommision_rate_derivative(int type, int parameter) const;
 
   public:
     Model() = default; // constructor
-    Model(std::vector<float> residence_times, float risk_posing_fraction_symptomatic_phase,
-          Eigen::VectorXf initial_states, int time, std::vector<int> test_indices, int test_type,
+    Model(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+          const Eigen::VectorXf &initial_states, int time, const std::vector<int> &test_indices, int test_type,
           float test_sensitivity,
           float test_specificity); // constructor
-    ~Model() = default;            // destructor
+    // constructor for schedules that mix test types; the sensitivities are given per test type
+    Model(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+          const Eigen::VectorXf &initial_states, int time, const std::vector<int> &test_indices,
+          const std::vector<int> &types_of_tests, const std::vector<float> &test_sensitivities, float test_specificity);
+    ~Model() = default; // destructor
 
     // no test or symptomatic screening
-    Model(std::vector<float> residence_times, Eigen::VectorXf initial_states, int time);
+    Model(const std::vector<float> &residence_times, const Eigen::VectorXf &initial_states, int time);
+
+    /* replaces the sensitivities per test type (PCR, RDT) and the specificity, without allocating (see
+     * set_parameters); throws std::invalid_argument unless there are two sensitivities
+     */
+    void set_test_parameters(const std::vector<float> &test_sensitivities, float test_specificity);
+    /* replaces the end of the strategy and its tests (time points and type per time point); does not allocate when
+     * the model held at least as many tests before
+     */
+    void set_strategy(int time, const std::vector<int> &test_indices, const std::vector<int> &types_of_tests);
 
-    Eigen::MatrixXf run();
-    Eigen::MatrixXf run_no_test();
-    Eigen::VectorXf integrate(Eigen::MatrixXf X); // calculation of the residual transmission risk
+    /* The evaluations start from X0, or from the given initial states, and return the states they reach; they leave
+     * the model unchanged and may run concurrently on one model (see BaseModel::run_base). The overloads with an
+     * output write into a buffer of the caller instead, e.g. a column of a larger matrix, and do not allocate.
+     */
+    Eigen::MatrixXf run() const;
+    Eigen::MatrixXf run(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const;
+    // states per evaluation point (n_evaluation_points() rows)
+    void run(const Eigen::Ref<const Eigen::VectorXf> &initial_states, Eigen::Ref<Eigen::MatrixXf> states) const;
+    Eigen::MatrixXf run_no_test() const;
+    Eigen::MatrixXf run_no_test(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const;
+    /* the states at the end of the strategy, as the last row of run(), jumping from one test to the next instead of
+     * evaluating every day
+     */
+    Eigen::MatrixXf run_end_of_strategy() const;
+    Eigen::MatrixXf run_end_of_strategy(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const;
+    void run_end_of_strategy(const Eigen::Ref<const Eigen::VectorXf> &initial_states,
+                             Eigen::Ref<Eigen::VectorXf> end_states) const;
+    int n_evaluation_points() const { return t_end + t_test.size() + 1; } // +1 because strategy is 0-indexed
+    /* calculation of the residual transmission risk per state (row of X); first_row is the index of the first row of
+     * X among the evaluation points of run(), which sets the integration horizon
+     */
+    Eigen::VectorXf integrate(const Eigen::Ref<const Eigen::MatrixXf> &X, int first_row = 0) const;
+    void integrate(const Eigen::Ref<const Eigen::MatrixXf> &X, int first_row, Eigen::Ref<Eigen::VectorXf> risk) const;
     void set_t_end(int new_t_end) { t_end = new_t_end; }
+
+    // parameters of the model: those of the generator (see BaseModel), followed by those of the test
+    enum TestParameter {
+        sensitivity_PCR_parameter = n_base_parameters,
+        sensitivity_RDT_parameter,
+        specificity_parameter,
+        n_parameters
+    };
+
+    /* Forward-mode derivatives. run_with_derivatives returns the states as run() does, computed in double precision
+     * in the same pass as derivatives[p], the derivative of the states with respect to parameter p. The optional
+     * initial derivatives (n_compartments x n_parameters) give the dependence of X0 on the parameters.
+     */
+    Eigen::MatrixXd run_with_derivatives(std::vector<Eigen::MatrixXd> &derivatives,
+                                         const Eigen::MatrixXd &initial_derivatives = Eigen::MatrixXd()) const;
+    /* integrate() with the derivatives of the residual risk per state (rows) with respect to the parameters
+     * (columns), given the derivatives of the states (empty if X is constant). Of the generator of this model, only
+     * the residence times are differentiated, as the residual risk is integrated without symptomatic screening.
+     */
+    Eigen::VectorXd integrate_with_derivatives(const Eigen::MatrixXd &X, const std::vector<Eigen::MatrixXd> &dX,
+                                               Eigen::MatrixXd &derivatives) const;
+
+    // compartment dependent false ommision rates of a test type
+    Eigen::VectorXd false_ommision_rate(int type) const { return false_ommision_rates[type].cast<double>(); }
+    // probability of a positive test of a type per compartment (1 - false ommision rate), and its derivative with
+    // respect to a test parameter
+    Eigen::VectorXd positive_test_probability(int type) const {
+        return (1 - false_ommision_rates[type].cast<double>().array()).matrix();
+    }
+    Eigen::VectorXd positive_test_probability_derivative(int type, int parameter) const {
+        return -false_ommision_rate_derivative(type, parameter);
+    }
 };
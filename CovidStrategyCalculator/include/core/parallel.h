@@ -0,0 +1,85 @@
+/* parallel.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the namespace Parallel with helpers to distribute independent evaluations over threads.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+inline int n_threads() {
+    int n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/* calls function(i, state) for i in [0, n), distributing the indices dynamically over the available threads, with a
+ * state per thread, made by make_state when the thread starts; e.g. a workspace that the evaluations of one thread
+ * reuse. If a call throws, no further indices are handed out and the first exception is rethrown once all threads
+ * have finished.
+ */
+template <typename MakeState, typename Function> void for_each(int n, MakeState make_state, Function function) {
+    int n_workers = std::min(n, n_threads());
+    if (n_workers <= 1) {
+        auto state = make_state();
+        for (int i = 0; i < n; ++i) {
+            function(i, state);
+        }
+        return;
+    }
+
+    std::atomic<int> next{0};
+    std::mutex failure_mutex;
+    std::exception_ptr failure{};
+    std::vector<std::thread> workers;
+    for (int w = 0; w < n_workers; ++w) {
+        workers.emplace_back([&]() {
+            try {
+                auto state = make_state();
+                for (int i = next++; i < n; i = next++) {
+                    function(i, state);
+                }
+            } catch (...) {
+                next = n; // no further indices are handed out
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+// as for_each with a state per thread, calling function(i)
+template <typename Function> void for_each(int n, Function function) {
+    for_each(
+        n, []() { return 0; }, [&function](int i, int &) { function(i); });
+}
+} // namespace Parallel
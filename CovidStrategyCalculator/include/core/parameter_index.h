@@ -0,0 +1,90 @@
+/* parameter_index.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ParameterIndex class.
+ * The objective of the ParameterIndex class is to answer point questions about a strategy sweep, e.g. "10 days of
+ * quarantine, PCR tests on day 5 and 8, 80% adherence", from a ResultStore without simulating. The index holds the
+ * strategy of every row of the store, sorted, in a file next to the store that is memory-mapped; exact lookups are a
+ * binary search.
+ */
+
+#pragma once
+
+#include "include/core/mapped_file.h"
+#include "include/core/parameters.h"
+#include "include/core/result_store.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ParameterIndex {
+
+  public:
+    /* The strategy of a row, in the order of the index. The test days are a bit mask of the days since the start of
+     * the strategy, the RDT days that of the days with an RDT, such that schedules that mix test types on the same
+     * days differ; the test type is -1 for schedules that mix test types and 0 without tests.
+     */
+    struct Key {
+        int32_t mode;
+        int32_t symptomatic_screening;
+        int32_t time_delay;
+        int32_t end_of_strategy;
+        uint64_t test_days;
+        uint64_t rdt_days;
+        int32_t test_type;
+        float adherence;
+    };
+    static const std::vector<std::string> columns; // the columns of the store that make up the key, as in Key
+
+    // key of a strategy, with the adherence rounded to 0.01%; throws a std::invalid_argument for tests after day 63
+    static Key key(const StrategyParameters &strategy);
+    static std::string path(const std::string &store_path) { return store_path + ".index"; }
+    // writes the index of the rows of the store; throws a std::invalid_argument if the store lacks a key column
+    static void build(const ResultStore &store, const std::string &path);
+
+    // constructor; maps the index, throws a std::runtime_error if it cannot be read or is not an index
+    explicit ParameterIndex(const std::string &path);
+    ~ParameterIndex() = default; // destructor
+
+    // getter functions
+    int64_t size() const { return size_; }             // number of rows indexed
+    int64_t n_store_rows() const { return store_rows_; } // rows of the store when the index was built
+
+    int64_t find(const Key &key) const; // row with this strategy, -1 if there is none
+    /* Rows whose strategies lie within the bounds in every component of the key, in the order of the index. The test
+     * days and the RDT days compare as numbers: equal bounds select one schedule, 0 and ~0 any schedule.
+     */
+    std::vector<int64_t> range(const Key &lower, const Key &upper) const;
+    /* Row of the closest strategy of the same mode, screening and test type (strategies without tests match any test
+     * type), -1 if there is none. The distance is the sum of the differences in time delay and duration (days), the
+     * number of test days that differ in day or type, and the difference in adherence in steps of 10%.
+     */
+    int64_t nearest(const Key &key, float *distance = nullptr) const;
+
+  private:
+    struct Entry {
+        Key key;
+        int64_t row;
+    };
+
+    MappedFile file_;
+    const Entry *entries_{};
+    int64_t size_{};
+    int64_t store_rows_{};
+};
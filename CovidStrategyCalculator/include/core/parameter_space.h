@@ -0,0 +1,58 @@
+/* parameter_space.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ParameterSpace class. The ParameterSpace describes the uncertainty in the disease parameters
+ * as a box of independent, uniformly distributed parameters, and maps points of the unit hypercube to parameter values.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <map>
+#include <string>
+#include <vector>
+
+struct ParameterRange {
+    std::string key; // key as in Parameters::default_values
+    float lower;
+    float upper;
+};
+
+class ParameterSpace {
+
+    std::map<std::string, float> values_{}; // values of the parameters that are not sampled
+    std::vector<ParameterRange> ranges_{};  // ranges of the sampled parameters, one per dimension
+
+  public:
+    ParameterSpace() = default; // constructor
+    /* The typical durations are sampled between the lower and upper extreme values of the ParametersTab, the remaining
+     * parameters that define the typical case are sampled within +/- relative_spread of their value.
+     */
+    explicit ParameterSpace(std::map<std::string, float> values, float relative_spread = .1);
+    ~ParameterSpace() = default; // destructor
+
+    int dimensions() const { return ranges_.size(); }
+    const std::vector<ParameterRange> &ranges() const { return ranges_; }
+    void set_range(const std::string &key, float lower, float upper); // adds the dimension if not yet sampled
+
+    // parameter values at a point of the unit hypercube, keyed as in Parameters::default_values
+    std::map<std::string, float> values_at(const Eigen::VectorXd &unit_point) const;
+    DiseaseParameters parameters_at(const Eigen::VectorXd &unit_point) const;
+};
@@ -0,0 +1,82 @@
+/* parameters.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the plain value types that carry the user input into the core. DiseaseParameters mirrors the
+ * ParametersTab and StrategyParameters mirrors the StrategyTab, such that the core can be run without the gui.
+ */
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Parameters {
+// default values of the user input fields in the ParametersTab, in the units displayed to the user
+extern const std::map<std::string, float> default_values;
+
+/* Parameter files hold one `key = value` per line, keyed as in default_values; '#' starts a comment. Reading throws a
+ * std::runtime_error on unknown keys and malformed lines; keys that are not provided are absent from the result.
+ */
+std::map<std::string, float> read_values(std::istream &stream);
+void write_values(std::ostream &stream, const std::map<std::string, float> &values);
+/* Throws a std::invalid_argument for values that the model cannot use: durations that are not positive, percentages
+ * outside [0, 100] and bounds of a duration that do not enclose its mean.
+ */
+void check_values(const std::map<std::string, float> &values);
+} // namespace Parameters
+
+struct DiseaseParameters {
+    std::vector<float> tau_mean_case{};  // residence times in typical case
+    std::vector<float> tau_best_case{};  // residence times in extreme case
+    std::vector<float> tau_worst_case{}; // residence times in extreme case
+    float fraction_asymptomatic{};       // probability of an asymptomatic disease course
+    float pcr_sens{};                    // maximal clinical sensitivity of PCR test
+    float rdt_relative_sens{};           // sensitivity of RDT relative to PCR test
+    float test_specificity{};            // test specificity of PCR and RDT are assumed to be similar.
+
+    /* Deduce the parameters from values keyed as in Parameters::default_values. Percentual values are scaled to
+     * probabilities and the incubation period is split in a predetection and presymptomatic phase, as in the getter
+     * functions of the ParametersTab.
+     */
+    static DiseaseParameters from_values(const std::map<std::string, float> &values);
+};
+
+struct StrategyParameters {
+    int mode{};                       // contact management=0, isolation=1, incoming travelers=2
+    int time_delay{};                 // days between exposure / symptom onset and start of the strategy
+    int end_of_strategy{10};          // duration of the strategy
+    std::vector<int> test_moments{};  // indices of placed tests; 0-indexed, also in case of non-zero time delay
+    int test_type{};                  // PCR=0, RDT=1
+    std::vector<int> test_types{};    // type per test moment; when empty, all tests are of test_type
+    float expected_adherence{1.};     // fraction of individuals that adheres to the strategy
+    float p_infectious_t0{1.};        // the initial probability of infection
+    bool symptomatic_screening{true}; // indicator variable whether symptom screening is to be used
+
+    // type of the test at each test moment
+    std::vector<int> types_of_tests() const {
+        return test_types.empty() ? std::vector<int>(test_moments.size(), test_type) : test_types;
+    }
+    /* Throws a std::invalid_argument for a strategy that the StrategyTab cannot express, e.g. test moments that do not
+     * increase or lie outside the strategy, an adherence outside [0, 1] or an initial probability of infection outside
+     * (0, 1].
+     */
+    void check() const;
+};
@@ -31,18 +31,31 @@
 
 class PrevalenceEstimator : public Simulation {
 
+  public:
+    enum Resolution { daily = 0, weekly };
+
   private:
-    // runs prevalence estimation based on incidence reports
-    void estimate_prevalence(std::vector<float> weekly_incidence);
+    // runs prevalence estimation based on incidence reports; daily incidence: [day 0, day -1, day -2, ...]
+    void estimate_prevalence(std::vector<float> daily_incidence);
 
     Eigen::MatrixXf compartment_states_;  // probability per compartment
     Eigen::MatrixXf phase_probabilities_; // probability per phase
 
   public:
     PrevalenceEstimator() = default; // constructor
-    explicit PrevalenceEstimator(ParametersTab *parameters_tab,
-                                 PrevalenceTab *prevalence_tab); // pre-simulation for prevalence estimator
-    ~PrevalenceEstimator() = default;                            // destructor
+    /* pre-simulation for prevalence estimator; incidence of any length, most recent first: [week 0, week -1, ...] or
+     * [day 0, day -1, ...]. Weekly reports are spread evenly over the days of their week.
+     */
+    explicit PrevalenceEstimator(const DiseaseParameters &parameters, std::vector<float> incidence,
+                                 Resolution resolution = weekly);
+    ~PrevalenceEstimator() = default; // destructor
+
+    /* states per compartment (rows) d days after the report of one infection (column d < n_days), for the residence
+     * times of a scenario; reported infections are distributed over the phases by the typical residence times. The
+     * responses are cached per parameter set.
+     */
+    static Eigen::MatrixXd impulse_response(const std::vector<float> &residence_times,
+                                            const std::vector<float> &typical_residence_times, int n_days);
 
     // getter functions
     Eigen::MatrixXf compartment_states() { return compartment_states_; }
@@ -0,0 +1,144 @@
+/* query_service.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the QueryService class.
+ * The objective of the QueryService class is to answer strategy queries of other programs: a query is a JSON object
+ * with the fields of the StrategyTab and the ParametersTab, e.g.
+ *
+ *     {"id": 7, "mode": 0, "delay": 2, "duration": 10, "tests": [5], "test_type": "rdt", "adherence": 90}
+ *
+ * and its answer is a JSON object with the quantities of the ResultLog at the end of the strategy, e.g.
+ *
+ *     {"id": 7, "relative_risk": [0.2, 0.18, 0.25], "risk_reduction": [...], "fold_risk_reduction": [...],
+ *      "p_infectious_tend": [...]}
+ *
+ * with the typical, best and worst case, or {"id": 7, "error": "..."}. Omitted fields take the defaults of the headless
+ * modes. Incoming travelers (mode 2) are not answered, as a query has no prevalence states. Queries that arrive within
+ * a short window are evaluated together, as a batch spread over worker threads that live as long as the service, and
+ * answered as they finish. A query that is identical to one that is queued or being evaluated, up to its id, is not
+ * evaluated again but answered with the result of the other (single flight).
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class QueryService {
+
+  public:
+    struct Query {
+        std::string id{"null"}; // JSON text of the id, returned with the answer
+        DiseaseParameters parameters;
+        StrategyParameters strategy;
+    };
+
+    // the quantities of the ResultLog, typical, best and worst case
+    struct Answer {
+        Eigen::Vector3f relative_risk;
+        Eigen::Vector3f risk_reduction;
+        Eigen::Vector3f fold_risk_reduction;
+        Eigen::Vector3f p_infectious_tend;
+    };
+
+    struct Statistics {
+        uint64_t queries{};
+        uint64_t errors{};      // malformed queries and failed evaluations
+        uint64_t evaluations{}; // simulations run
+        uint64_t coalesced{};   // queries answered with the evaluation of an identical query in flight
+        uint64_t batches{};     // evaluated batches; evaluations / batches is the mean batch size
+    };
+
+    // called with the answer as a line of JSON, without the newline; from the thread that evaluated the query
+    using Respond = std::function<void(const std::string &answer)>;
+
+    /* Reads the request into the query; throws a std::invalid_argument if it is malformed. The id is set as soon as
+     * it is read, such that an error can be answered with it.
+     */
+    static void parse(const std::string &request, Query &query);
+    static Answer evaluate(const Query &query);
+    // evaluate() in a workspace, which a thread reuses for the queries it evaluates
+    static Answer evaluate(const Query &query, Simulation::Workspace &workspace);
+    /* the answer as JSON; an error answer if a value is not finite, e.g. the fold risk reduction of a strategy without
+     * residual risk
+     */
+    static std::string format(const std::string &id, const Answer &answer);
+    static std::string format_error(const std::string &id, const std::string &message);
+
+    /* constructor; starts the thread that forms the batches and a worker per available thread, each with its own
+     * workspace. A batch is evaluated when its first query has waited for the window or when it holds max_batch
+     * queries.
+     */
+    explicit QueryService(std::chrono::microseconds window = std::chrono::microseconds(500), int max_batch = 256);
+    ~QueryService(); // destructor; answers the queries that were submitted and stops the threads
+    QueryService(const QueryService &) = delete;
+    QueryService &operator=(const QueryService &) = delete;
+
+    // queues the request, a JSON object; malformed requests are answered at once. Safe to call from any thread.
+    void submit(const std::string &request, Respond respond);
+    Statistics statistics() const;
+
+  private:
+    struct Pending {
+        Query query;
+        std::string inputs; // of the simulation, as identified by the ResultCache
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    // a query waiting for the evaluation of its inputs
+    struct Waiter {
+        std::string id;
+        Respond respond;
+    };
+
+    void run();  // forms the batches and hands them to the workers until the service is destroyed
+    void work(); // evaluates queries of the batches in a workspace of its own until the batcher stops
+    // evaluates the query and answers its waiters; does not throw, such that every waiter is answered
+    void answer(const Pending &pending, Simulation::Workspace &workspace);
+    void stop(); // stops and joins the threads that were started
+
+    std::chrono::microseconds window_;
+    int max_batch_;
+    mutable std::mutex mutex_{};
+    std::condition_variable queued_{};
+    std::condition_variable batch_ready_{};
+    std::condition_variable batch_done_{};
+    std::deque<Pending> queue_{};
+    std::unordered_map<std::string, std::vector<Waiter>> in_flight_{}; // by inputs, until the evaluation finishes
+    std::vector<Pending> batch_{}; // being evaluated; unchanged until all its queries are answered
+    size_t next_{};                // the next query of the batch to hand out
+    size_t unfinished_{};          // queries of the batch not answered yet
+    Statistics statistics_{};
+    bool stopping_{false};
+    bool batcher_stopped_{false};
+    std::thread batcher_{};
+    std::vector<std::thread> workers_{};
+};
@@ -0,0 +1,71 @@
+/* regional_prevalence.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the RegionalPrevalence class.
+ * The objective of the RegionalPrevalence class is to estimate the prevalence of many regions with their own incidence
+ * history at once, e.g. all countries and sub-national regions covered by a traveller policy. The regions share the
+ * impulse responses of the PrevalenceEstimator, such that a block of regions is a single matrix product.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class RegionalPrevalence {
+
+  public:
+    struct Region {
+        std::string name;
+        std::string date;                   // date of the most recent report, day 0
+        std::vector<float> daily_incidence; // [day 0, day -1, ...], per individual and corrected for detection
+    };
+
+    /* Reads a long-format time series in CSV format with the header `region,date,cases,population,detection_rate`,
+     * one report per line, e.g. `NL-ZH,2021-11-30,4512,3726000,0.4`. Dates are ISO dates (YYYY-MM-DD), the detection
+     * rate is the fraction of cases that is reported. Days without a report count as no cases. Throws a
+     * std::runtime_error on malformed lines. Large files sorted by region are read with the IncidenceFile.
+     */
+    static std::vector<Region> read_csv(std::istream &stream);
+    static int n_days(const std::vector<Region> &regions); // longest incidence history
+
+    RegionalPrevalence() = default; // constructor
+    // constructor; incidence histories up to n_days
+    RegionalPrevalence(const DiseaseParameters &parameters, int n_days);
+    ~RegionalPrevalence() = default; // destructor
+
+    // states per compartment (rows) of regions (columns) with incidence (n_days x regions); typical=0, best=1, worst=2
+    Eigen::MatrixXf compartment_states(const Eigen::MatrixXf &incidence, int scenario) const;
+    static Eigen::MatrixXf phase_probabilities(const Eigen::MatrixXf &compartment_states); // per phase (rows)
+
+    /* Estimates the regions in parallel and writes one CSV row per region and scenario, in the order of the regions.
+     * The rows are written block by block, so the output is streamed while the estimation continues. Successive
+     * batches of regions can be appended without header.
+     */
+    void write_csv(const std::vector<Region> &regions, std::ostream &output, bool compartments = false,
+                   bool header = true) const;
+
+  private:
+    int n_days_{};
+    std::vector<Eigen::MatrixXf> responses_{}; // per scenario, impulse response (compartments x days)
+};
@@ -0,0 +1,83 @@
+/* result_cache.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ResultCache class.
+ * The objective of the ResultCache class is to keep the results of simulations on disk, across sessions, such that a
+ * strategy that was simulated before with the same parameters is restored instead of simulated again. An entry is
+ * addressed by a hash of all inputs of the simulation: the disease parameters, the strategy and the prevalence
+ * states. Entries are written to a temporary file and renamed into place, so a lookup never sees a partial entry and
+ * needs no lock; threads and processes can share a cache directory. The least recently used entries are removed when
+ * the cache grows beyond its size.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class ResultCache {
+
+  public:
+    static constexpr uint32_t version = 2; // of the entries; raise when the model changes its results
+
+    /* The inputs of a simulation as little-endian bytes, which identify its cache entry on any machine. The prevalence
+     * states are only part of the inputs in incoming travelers mode, as in the Simulation, and the test type only
+     * through the type of each test day, such that equal schedules share an entry.
+     */
+    static std::string inputs(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                              const Eigen::VectorXf &prevalence_states = Eigen::VectorXf());
+    static uint64_t hash(const std::string &inputs); // 64-bit FNV-1a
+
+    // constructor; creates the directory if needed, throws a std::runtime_error if it cannot
+    explicit ResultCache(const std::string &directory, uint64_t max_size = uint64_t(256) << 20);
+    ~ResultCache() = default; // destructor
+
+    // getter functions
+    const std::string &directory() const { return directory_; }
+    uint64_t max_size() const { return max_size_; } // in bytes
+    uint64_t size() const { return size_; }         // in bytes, as far as known to this cache
+
+    // the results of the entry with these inputs, false if there is none; safe to call from any thread
+    bool find(const std::string &inputs, Simulation::Results &results) const;
+    // stores the results, replacing an entry with the same inputs; throws a std::runtime_error if it cannot write
+    void insert(const std::string &inputs, const Simulation::Results &results);
+    // removes the least recently used entries until the cache takes at most three quarters of its size
+    void evict();
+
+    /* The simulation of the strategy, restored from the cache or simulated and stored. Failing to store the results
+     * does not fail the simulation.
+     */
+    std::unique_ptr<Simulation> simulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                                           const Eigen::VectorXf &prevalence_states = Eigen::VectorXf());
+
+  private:
+    std::string path(const std::string &inputs) const; // of the entry
+
+    std::string directory_;
+    uint64_t max_size_;
+    std::atomic<uint64_t> size_{0};
+    std::mutex eviction_mutex_; // one eviction at a time; lookups do not take it
+};
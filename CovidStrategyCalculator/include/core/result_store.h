@@ -0,0 +1,135 @@
+/* result_store.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ResultStore class.
+ * The objective of the ResultStore class is to keep the results of large parameter sweeps on disk, one row per
+ * scenario, in a binary columnar file: the parameters and outputs are typed columns, each contiguous over all rows,
+ * described by a header at the start of the file. The file is written in batches by the ResultStore::Writer and
+ * memory-mapped by the ResultStore, which reads the columns in place, such that a sweep of many millions of scenarios
+ * is queried without loading it into memory.
+ *
+ * Layout (native byte order, which must be little-endian, as the columns are read in place): the magic `CSCSTORE`, the
+ * version, the number of columns, the capacity and the number of rows, followed by one descriptor per column (type,
+ * role, offset and name). Column c holds `capacity` values of its type from its offset on, aligned to 64 bytes.
+ */
+
+#pragma once
+
+#include "include/core/mapped_file.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class ResultStore {
+
+  public:
+    enum Type { int32 = 0, int64, float32, float64, n_types };
+    enum Role { parameter = 0, output };
+
+    struct Column {
+        std::string name; // at most 47 characters
+        Type type;
+        Role role;
+    };
+
+    class Writer {
+
+      public:
+        /* constructor; creates the file with room for `capacity` rows, throws a std::runtime_error if it cannot be
+         * written and a std::invalid_argument if the columns are invalid.
+         */
+        Writer(const std::string &path, const std::vector<Column> &columns, int64_t capacity);
+        ~Writer(); // destructor; closes the file
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        /* Writes the rows (one column per column of the store, converted to its type) from first_row on. Batches may
+         * be written from several threads and in any order. While the store is written, the number of rows in the
+         * header ends at the first row that is not written yet, such that readers only see written rows; after
+         * close() it ends at the last row written, and rows that are never written read as zero.
+         */
+        void write(int64_t first_row, const Eigen::MatrixXd &rows);
+        // writes after the rows written or reserved so far, returns the first row written
+        int64_t append(const Eigen::MatrixXd &rows);
+        // writes the number of rows into the header and closes the file; called by the destructor
+        void close();
+
+      private:
+        std::fstream file_{};
+        std::mutex mutex_{};
+        std::vector<Column> columns_{};
+        std::vector<uint64_t> offsets_{};
+        int64_t capacity_{};
+        int64_t n_rows_{};                    // end of the rows written without a gap, as in the header
+        int64_t written_{};                   // end of the last row written
+        int64_t reserved_{};                  // end of the rows written or reserved by append
+        std::map<int64_t, int64_t> blocks_{}; // the first and end row of the blocks written after a gap
+        uint64_t size_{};                     // of the file
+    };
+
+    static const char magic[8];
+    static const uint32_t version = 1;
+    static size_t type_size(Type type);
+    static const char *type_name(Type type); // int32, int64, float32 or float64
+
+    // constructor; maps the file, throws a std::runtime_error if it cannot be read or is not a result store
+    explicit ResultStore(const std::string &path);
+    ~ResultStore() = default; // destructor
+    ResultStore(const ResultStore &) = delete;
+    ResultStore &operator=(const ResultStore &) = delete;
+
+    // getter functions
+    int64_t n_rows() const { return n_rows_; }
+    int64_t capacity() const { return capacity_; }
+    size_t size() const { return file_.size(); } // in bytes
+    const std::vector<Column> &columns() const { return columns_; }
+    int column_index(const std::string &name) const; // throws a std::invalid_argument if there is no such column
+
+    /* The values of a column in place, n_rows() of them. T is int32_t, int64_t, float or double, matching the type
+     * of the column; otherwise a std::invalid_argument is thrown.
+     */
+    template <typename T> const T *data(int column) const;
+    double value(int64_t row, int column) const; // converted to double, for columns of any type
+
+  private:
+    MappedFile file_;
+    int64_t capacity_{};
+    int64_t n_rows_{};
+    std::vector<Column> columns_{};
+    std::vector<uint64_t> offsets_{};
+
+    const void *column_data(int column, Type type) const;
+};
+
+template <typename T> const T *ResultStore::data(int column) const {
+    static_assert(std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value ||
+                      std::is_same<T, float>::value || std::is_same<T, double>::value,
+                  "the columns hold int32_t, int64_t, float or double");
+    Type type = std::is_same<T, int32_t>::value   ? int32
+                : std::is_same<T, int64_t>::value ? int64
+                : std::is_same<T, float>::value   ? float32
+                                                  : float64;
+    return static_cast<const T *>(column_data(column, type));
+}
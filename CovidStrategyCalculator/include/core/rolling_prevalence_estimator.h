@@ -0,0 +1,63 @@
+/* rolling_prevalence_estimator.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the RollingPrevalenceEstimator class, which derives from, and extends the Simulation class.
+ * The objective of the RollingPrevalenceEstimator class is to keep the prevalence estimate of the
+ * PrevalenceEstimator up to date as daily incidence reports arrive, at a constant cost per day.
+ */
+
+#pragma once
+
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+#include <deque>
+#include <vector>
+
+class RollingPrevalenceEstimator : public Simulation {
+
+  public:
+    RollingPrevalenceEstimator() = default; // constructor
+    /* constructor; daily incidence history: [day 0, day -1, day -2, ...]. Reports of the last `window` days can be
+     * corrected afterwards.
+     */
+    explicit RollingPrevalenceEstimator(const DiseaseParameters &parameters, std::vector<float> daily_incidence = {},
+                                        int window = 14);
+    ~RollingPrevalenceEstimator() = default; // destructor
+
+    // a new day: one day of disease progression of the current states, and the infections reported today
+    void advance(float incidence);
+    /* late correction of the incidence reported `days_ago` days ago (0 is today); throws a std::out_of_range outside
+     * the correction window
+     */
+    void correct(int days_ago, float incidence);
+
+    // getter functions, as in the PrevalenceEstimator
+    Eigen::MatrixXf compartment_states();
+    Eigen::MatrixXf phase_probabilities();
+    int window() const { return window_; }
+
+  private:
+    int window_{};
+    std::deque<float> recent_incidence_{}; // [day 0, day -1, ...], at most window days
+
+    // per scenario: typical, best, worst case
+    std::vector<Eigen::Matrix<double, 21, 21>> propagators_{}; // one day
+    std::vector<Eigen::MatrixXd> responses_{};                 // impulse response over the correction window
+    std::vector<Eigen::Matrix<double, 21, 1>> states_{};        // today
+};
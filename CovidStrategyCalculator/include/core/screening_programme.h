@@ -0,0 +1,66 @@
+/* screening_programme.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the ScreeningProgramme class.
+ * The objective of the ScreeningProgramme class is to evaluate periodic screening, e.g. testing a workplace or school
+ * three times a week for months. Participants are not isolated, but a positive test removes them. The schedule of
+ * one period is composed into a single operator, which is raised to the number of periods by repeated squaring, such
+ * that the cost barely depends on the duration of the programme.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <vector>
+
+class ScreeningProgramme {
+
+  public:
+    typedef Eigen::Matrix<double, 21, 21> Operator; // acts on the compartment states, including the risk node
+
+    ScreeningProgramme() = default; // constructor
+    /* constructor; the tests of the strategy (as in the StrategyTab: 0-indexed since exposure, within the first
+     * period after the time delay) repeat every `period` days for the duration of the strategy. Symptomatic
+     * screening and the expected adherence apply as in the Simulation class.
+     */
+    ScreeningProgramme(const DiseaseParameters &parameters, const StrategyParameters &strategy, int period);
+    ~ScreeningProgramme() = default; // destructor
+
+    /* Relative risk (typical case, lower and upper extreme) posed during the programme by an individual that was
+     * exposed at day 0, with respect to no intervention.
+     */
+    Eigen::VectorXf relative_risk() const { return relative_risk_; }
+    /* Long-run relative risk under indefinite screening of a population with a constant incidence; the infections
+     * are spread evenly over the days of the period.
+     */
+    Eigen::VectorXf steady_state_relative_risk() const { return steady_state_relative_risk_; }
+
+    // one period of the programme: on each day the scheduled test, followed by one day of disease progression
+    const Operator &period_operator(int scenario) const { return period_operators_[scenario]; }
+    static Operator power(const Operator &M, int n); // M^n by repeated squaring
+
+  private:
+    int period_{};
+    std::vector<int> test_types_{}; // type of the test on each day of the period, -1 if there is none
+
+    std::vector<Operator> period_operators_{}; // per scenario: typical, best, worst case
+    Eigen::VectorXf relative_risk_{};
+    Eigen::VectorXf steady_state_relative_risk_{};
+};
@@ -0,0 +1,75 @@
+/* sensitivity_analysis.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the SensitivityAnalysis class.
+ * The objective of the SensitivityAnalysis class is to attribute the variance of the relative risk at the end of an
+ * NPI strategy to the uncertain inputs: the sampled disease parameters of a ParameterSpace and the expected adherence.
+ * First-order and total Sobol indices are estimated from a Saltelli design on scrambled Sobol points.
+ */
+
+#pragma once
+
+#include "include/core/parameter_space.h"
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SensitivityAnalysis {
+
+  public:
+    struct Indices {
+        Eigen::VectorXf first_order; // per input
+        Eigen::VectorXf total;       // per input
+        float mean_relative_risk;    // at the end of the strategy
+        float variance;              // of the relative risk at the end of the strategy
+    };
+
+    SensitivityAnalysis() = default; // constructor
+    /* constructor; the expected adherence of each strategy is sampled within +/- adherence_spread of its value. The
+     * prevalence states are the initial states in incoming travelers mode, leave empty when not used.
+     */
+    SensitivityAnalysis(ParameterSpace space, std::vector<StrategyParameters> strategies,
+                        float adherence_spread = .1, Eigen::VectorXf prevalence_states = Eigen::VectorXf());
+    ~SensitivityAnalysis() = default; // destructor
+
+    /* Evaluates the model for n_base_samples * (k + 2) parameter sets per strategy for k sampled disease parameters;
+     * the design matrix that only differs in adherence shares the model evaluations of the base matrix.
+     */
+    void run(int n_base_samples = 512, uint32_t seed = 1);
+
+    // getter functions
+    std::vector<std::string> inputs() const; // keys of the inputs, in the order of the indices
+    const std::vector<StrategyParameters> &strategies() const { return strategies_; }
+    /* Indices per strategy. Risk reduction = 1 - relative risk, so its variance and Sobol indices are equal to those
+     * of the relative risk.
+     */
+    const std::vector<Indices> &indices() const { return indices_; }
+    int n_evaluations() const { return n_evaluations_; }
+
+  private:
+    ParameterSpace space_;
+    std::vector<StrategyParameters> strategies_{};
+    float adherence_spread_{};
+    Eigen::VectorXf prevalence_states_{};
+
+    std::vector<Indices> indices_{};
+    int n_evaluations_{};
+};
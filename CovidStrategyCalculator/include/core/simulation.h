@@ -25,33 +25,121 @@
 #pragma once
 
 #include "include/core/model.h"
-#include "include/gui/user_input/parameters_tab.h"
-#include "include/gui/user_input/prevalence_tab.h"
-#include "include/gui/user_input/strategy_tab.h"
+#include "include/core/parameters.h"
 
 #include <Eigen/Dense>
 
 class Simulation {
 
   public:
-    Simulation() = default;                             // constructor
-    explicit Simulation(ParametersTab *parameters_tab); // constructor
-    explicit Simulation(ParametersTab *parameters_tab, StrategyTab *strategy,
-                        PrevalenceTab *prevalence_tab); // constructor
-    ~Simulation() = default;                            // destructor
+    /* The outputs that are calculated: all evaluation points, or only the end of the strategy. With
+     * end_of_strategy_outputs the models jump from one test to the next instead of evaluating every day; the risk
+     * matrices then hold a single row, equal to the last row with all_outputs, and the states without intervention
+     * are not calculated; the outputs that need them (temporal_assay_sensitivity, test_efficacy, results) throw a
+     * std::logic_error.
+     */
+    enum Outputs { all_outputs = 0, end_of_strategy_outputs };
+
+    /* The finished outputs of a simulation with all_outputs, as kept by the ResultCache: the risk matrices from which
+     * the relative risk and the risk reductions follow, the assay sensitivity and test efficacy per test type (PCR,
+     * RDT), and the probability to be, or yet to become infectious at the end of the strategy.
+     */
+    struct Results {
+        Eigen::MatrixXf risk_no_intervention;
+        Eigen::MatrixXf risk_NPI;
+        Eigen::MatrixXf temporal_assay_sensitivity[2];
+        Eigen::MatrixXf test_efficacy[2];
+        Eigen::VectorXf p_infectious_tend;
+    };
+
+    // the quantities of the ResultLog at the end of the strategy, typical, best and worst case
+    struct EndOfStrategy {
+        Eigen::Vector3f relative_risk;
+        Eigen::Vector3f risk_reduction;
+        Eigen::Vector3f fold_risk_reduction;
+        Eigen::Vector3f p_infectious_tend;
+    };
+
+    /* the models and buffers of end_of_strategy() and evaluate(), to reuse for the strategies and parameter sets that
+     * one thread evaluates; the evaluations in a workspace do not allocate once its vectors have their size. The
+     * buffers of evaluate() only grow and hold the current strategy in their top rows.
+     */
+    struct Workspace {
+        Model models_no_intervention[3]; // typical, best and worst case
+        Model models_NPI[3];
+        std::vector<int> test_moments{};       // of the strategy
+        std::vector<int> test_types{};         // per test moment
+        std::vector<float> test_sensitivity{}; // per test type
+        int t_offset{};
+        int t_end{};
+        float expected_adherence{};
+        float test_specificity{};
+        Eigen::VectorXf initial_states{};
+        Eigen::MatrixXf strategy_states[3]{};        // per evaluation point, or at the end of the strategy as a row
+        Eigen::MatrixXf states_no_intervention[3]{}; // per day; by evaluate() only
+        Eigen::Vector3f risk_no_intervention;
+        Eigen::Vector3f risk_NPI;
+        Eigen::MatrixXf risks_no_intervention{}; // per evaluation point (rows) and scenario; by evaluate() only
+        Eigen::MatrixXf risks_NPI{};
+        Eigen::VectorXf phases{}; // states grouped per phase, for the outputs of evaluate()
+        EndOfStrategy outputs;
+    };
+
+    /* Evaluates the strategy as a simulation with end_of_strategy_outputs does, without prevalence states, in the
+     * workspace; the result equals that of the simulation and stays until the next use of the workspace.
+     */
+    static const EndOfStrategy &end_of_strategy(const DiseaseParameters &parameters,
+                                                const StrategyParameters &strategy, Workspace &workspace);
+
+    /* Evaluates the strategy as a simulation with all_outputs does, without prevalence states, in the workspace, which
+     * then also holds the outputs at the end of the strategy. The functions below write the outputs of the simulation
+     * into a matrix of the caller of their size, e.g. a row-major buffer mapped with strides, until the next use of
+     * the workspace. Incoming travelers (mode 2) need prevalence states and throw a std::invalid_argument.
+     */
+    static void evaluate(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                         Workspace &workspace);
+    using Output = Eigen::Ref<Eigen::MatrixXf, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+    static void relative_risk(const Workspace &workspace, Output relative_risk); // per evaluation point
+    static void temporal_assay_sensitivity(Workspace &workspace, int type, Output sensitivity); // per day
+    static void test_efficacy(Workspace &workspace, int type, Output efficacy);                 // per day
+    static void evaluation_points_with_tests(const Workspace &workspace, Eigen::Ref<Eigen::VectorXf> points);
+
+    Simulation() = default;                                    // constructor
+    explicit Simulation(const DiseaseParameters &parameters); // constructor
+    /* constructor; the prevalence states are the initial states of the main simulation in incoming travelers mode,
+     * as estimated by the PrevalenceEstimator. Leave empty when no prevalence estimation is used.
+     */
+    explicit Simulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                        Eigen::VectorXf prevalence_states = Eigen::VectorXf(), Outputs outputs = all_outputs);
+    /* constructor; restores a simulation from its results without running the models. All outputs are available
+     * except the Jacobian of the relative risk.
+     */
+    explicit Simulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                        const Results &results);
+    virtual ~Simulation(); // destructor; deletes the models
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
 
     // calculate efficacy of current strategy
     Eigen::MatrixXf relative_risk();
     Eigen::MatrixXf risk_reduction();
     Eigen::MatrixXf fold_risk_reduction();
+    /* Jacobian of the relative risk in the typical case, per evaluation point (rows) with respect to the disease
+     * parameters (columns): the residence times of the four phases, the fraction of asymptomatic cases, the PCR
+     * sensitivity, the relative RDT sensitivity and the test specificity. Costs a small multiple of one model run.
+     */
+    Eigen::MatrixXf relative_risk_jacobian();
+    Results results(); // throws a std::logic_error with end_of_strategy_outputs
 
     Eigen::VectorXf evaluation_points_with_tests();    // time course with the defined tests
     Eigen::VectorXf evaluation_points_without_tests(); // time course without conducting defined tests
 
     Eigen::MatrixXf temporal_assay_sensitivity(); // for plot
+    Eigen::MatrixXf temporal_assay_sensitivity(int type);
     Eigen::MatrixXf temporal_assay_sensitivity_PCR();
     Eigen::MatrixXf temporal_assay_sensitivity_RDT(); // for plot
     Eigen::MatrixXf test_efficacy();                  // for efficacy table
+    Eigen::MatrixXf test_efficacy(int type);
     Eigen::MatrixXf test_efficacy_PCR();
     Eigen::MatrixXf test_efficacy_RDT();
 
@@ -63,14 +151,21 @@ class Simulation {
     int get_t_offset() { return t_offset; }
     int get_last_t() { return t_end - t_offset; } // time between last test and end of NPI
     int get_test_type() { return test_type; }
+    std::vector<int> get_test_types() { return test_types; } // per test moment
     float get_p_infectious_t0() { return p_infectious_t0; }
     Eigen::VectorXf get_p_infectious_tend();
     std::vector<int> get_t_test() { return t_test; };
+    Outputs get_outputs() { return outputs; }
+    /* compartment states per evaluation point of the strategy and per day without intervention, of the typical (0),
+     * best (1) or worst (2) case; empty when they are not calculated or the simulation is restored
+     */
+    Eigen::MatrixXf get_strategy_states(int scenario);
+    Eigen::MatrixXf get_states_no_intervention(int scenario);
 
   protected:
     // initialization
-    void collect_parameters(ParametersTab *parameters_tab);
-    void collect_strategy(StrategyTab *strategy_tab);
+    void collect_parameters(const DiseaseParameters &parameters);
+    void collect_strategy(const StrategyParameters &strategy);
     void deduce_combined_parameters();
     Eigen::VectorXf initial_states_no_intervention;
     Eigen::VectorXf initial_states_NPI;
@@ -79,13 +174,13 @@ class Simulation {
 
     // the different models that are needed to calculate relative and extreme values
     void create_different_scenario_models();
-    Model *model_mean_case_no_intervention;
-    Model *model_best_case_no_intervention;
-    Model *model_worst_case_no_intervention;
+    Model *model_mean_case_no_intervention{};
+    Model *model_best_case_no_intervention{};
+    Model *model_worst_case_no_intervention{};
 
-    Model *model_mean_case_NPI;
-    Model *model_best_case_NPI;
-    Model *model_worst_case_NPI;
+    Model *model_mean_case_NPI{};
+    Model *model_best_case_NPI{};
+    Model *model_worst_case_NPI{};
 
     // the compartment states of the different models
     Eigen::MatrixXf strategy_states_mean;
@@ -95,16 +190,23 @@ class Simulation {
     Eigen::MatrixXf states_mean_no_intervention;
     Eigen::MatrixXf states_best_no_intervention;
     Eigen::MatrixXf states_worst_no_intervention;
+    // throws a std::logic_error when the states without intervention are not calculated (end_of_strategy_outputs)
+    void require_states_no_intervention();
 
     // parameters from strategy_tab
     std::vector<int> t_test{};
-    int t_offset; // time delay
-    int t_end;    // time delay + duration of strategy
+    std::vector<int> test_types{}; // type of the test at each test moment
+    int t_offset;                  // time delay
+    int t_end;                     // time delay + duration of strategy
     int mode;
-    int test_type;
+    int test_type; // default test type, used when the schedule does not mix test types
     float expected_adherence;
-    float p_infectious_t0;      // the initial probability of infection
-    bool symptomatic_screening; // indicator variable whether symptom screening is to be used
+    float p_infectious_t0;               // the initial probability of infection
+    bool symptomatic_screening;          // indicator variable whether symptom screening is to be used
+    bool initial_states_screened{false}; // whether symptomatic screening was applied to the prevalence states
+    Outputs outputs{all_outputs};
+    bool restored{false}; // whether the outputs are taken from restored_results instead of the models
+    Results restored_results;
 
     // parameters from parameters_tab
     std::vector<float> tau_mean_case{};  // residence times in typical case
@@ -117,7 +219,7 @@ class Simulation {
 
     // parameters from strategy_tab + parameters_tab
     float risk_posing_fraction_symptomatic_phase;
-    float test_sensitivity;
+    std::vector<float> test_sensitivity{}; // per test type
 
     // risk calculations
     void run_risk_calculation();
@@ -127,6 +229,13 @@ class Simulation {
     Eigen::MatrixXf risk_matrix_NPI;
 
     // matrices grouped by phase are used in the prevalence estimator and daily probabilities
-    Eigen::MatrixXf group_by_phase(Eigen::MatrixXf states);
-    Eigen::MatrixXf group_by_phase_RDT(Eigen::MatrixXf states);
+    Eigen::MatrixXf group_by_phase(const Eigen::Ref<const Eigen::MatrixXf> &states);
+    Eigen::MatrixXf group_by_phase_RDT(const Eigen::Ref<const Eigen::MatrixXf> &states);
+    // into a matrix of the caller, of the size of the grouped states
+    static void group_by_phase(const Eigen::Ref<const Eigen::MatrixXf> &states, Eigen::Ref<Eigen::MatrixXf> grouped);
+    static void group_by_phase_RDT(const Eigen::Ref<const Eigen::MatrixXf> &states,
+                                   Eigen::Ref<Eigen::MatrixXf> grouped);
+
+    // the models and initial states of a workspace for the strategy; see end_of_strategy() and evaluate()
+    static void prepare(const DiseaseParameters &parameters, const StrategyParameters &strategy, Workspace &workspace);
 };
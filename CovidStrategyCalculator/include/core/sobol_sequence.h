@@ -0,0 +1,53 @@
+/* sobol_sequence.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the SobolSequence class, a generator of (scrambled) Sobol low-discrepancy points in the unit
+ * hypercube, and a counter-based pseudo-random generator with the same interface to compare against.
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class SobolSequence {
+
+    int dimensions_;
+    uint32_t seed_;                                  // seed of the Owen scrambling; 0 means unscrambled
+    std::vector<std::array<uint32_t, 32>> directions_; // direction numbers per dimension
+
+    void set_directions();
+
+  public:
+    static const int max_dimensions; // number of dimensions for which direction numbers are tabulated
+
+    explicit SobolSequence(int dimensions, uint32_t seed = 0); // constructor
+    ~SobolSequence() = default;                                // destructor
+
+    // the points with index [first, first + n), one point per column
+    Eigen::MatrixXd points(int first, int n) const;
+    Eigen::VectorXd point(uint32_t index) const;
+};
+
+namespace PseudoRandom {
+// independent uniform points with index [first, first + n), one point per column; counter based, so any range of
+// indices can be generated independently of the others
+Eigen::MatrixXd points(int dimensions, int first, int n, uint32_t seed);
+} // namespace PseudoRandom
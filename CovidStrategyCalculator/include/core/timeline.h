@@ -0,0 +1,103 @@
+/* timeline.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the Timeline class.
+ * The objective of the Timeline class is to evaluate composite strategies, given as a list of events: tests,
+ * periods of symptom checks, release from and re-entry into quarantine. The events are processed in one forward sweep
+ * that jumps from one event to the next with cached propagators, such that the cost depends on the number of events
+ * and not on the number of days between them.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+#include <array>
+#include <string>
+#include <vector>
+
+class Timeline {
+
+  public:
+    typedef Eigen::Matrix<double, 21, 21> Operator; // acts on the compartment states, including the risk node
+
+    enum EventType {
+        pcr_test = 0,  // the test types as in the StrategyTab: PCR=0, RDT=1
+        rdt_test,      //
+        symptom_check, // the cases that are symptomatic are isolated; for the first day, e.g. on arrival
+        checks_start,  // start of daily symptom checks: symptomatic cases are isolated at symptom onset
+        checks_end,    // end of the symptom checks
+        release,       // release from quarantine
+        quarantine,    // (re-)entry into quarantine
+        n_event_types
+    };
+    struct Event {
+        int day;
+        EventType type;
+    };
+    static const std::array<std::string, n_event_types> event_names; // as in parse()
+
+    Timeline() = default; // constructor
+    /* constructor; the individual is in quarantine from day 0 on, until it is released. Events on the same day are
+     * processed in the given order. The risk posed outside quarantine is compared to the risk of no intervention, as
+     * in the Simulation class; after the last event the disease course continues with the symptom checks in effect.
+     */
+    Timeline(const DiseaseParameters &parameters, std::vector<Event> events, Eigen::VectorXf initial_states,
+             float expected_adherence = 1.);
+    // constructor; the events and initial states of a strategy as in the Simulation class
+    Timeline(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+             Eigen::VectorXf prevalence_states = Eigen::VectorXf());
+    ~Timeline() = default; // destructor
+
+    /* Events of a strategy: symptom checks during the strategy if symptomatic screening is used, the tests, and
+     * release at the end of the strategy.
+     */
+    static std::vector<Event> events(const StrategyParameters &strategy);
+    static Eigen::VectorXf initial_states(const StrategyParameters &strategy); // as in the Simulation class
+    /* Reads events written as `<name>@<day>`, separated by commas, e.g. `checks@0,pcr@5,release@5`. The names are
+     * pcr, rdt, symptoms, checks, no-checks, release and quarantine, in the order of EventType. Throws a
+     * std::invalid_argument on unknown names.
+     */
+    static std::vector<Event> parse(const std::string &text);
+
+    // relative risk (typical case, lower and upper extreme) with respect to no intervention
+    Eigen::VectorXf relative_risk() const { return relative_risk_; }
+    /* Compartment states per requested day (rows), after the events of that day, of a scenario (typical=0, best=1,
+     * worst=2). The sweep only stops at the requested days in addition to the events.
+     */
+    Eigen::MatrixXf states(const std::vector<int> &days, int scenario = 0) const; // days in ascending order
+
+  private:
+    static const int n_powers = 8; // cached powers P^(2^k) of the daily propagators
+
+    std::vector<Event> events_{};
+    Eigen::VectorXd initial_states_{};
+    float expected_adherence_{};
+
+    // per scenario and screening (without=0, with symptom checks=1)
+    std::vector<std::array<std::array<Operator, n_powers>, 2>> powers_{};
+    std::vector<std::array<Eigen::Matrix<double, 1, 21>, 2>> residual_risk_{}; // risk from a state on, per state
+    std::vector<std::array<Eigen::VectorXd, 2>> false_ommision_rates_{};        // per test type
+    Eigen::VectorXd symptom_check_{};                                            // fraction remaining per state
+    Eigen::VectorXf relative_risk_{};
+
+    void jump(Eigen::Matrix<double, 21, 1> &x, int days, int scenario, bool screening) const;
+    // risk posed outside quarantine; the states of the requested days are written to the rows of states
+    double sweep(int scenario, const std::vector<int> &days = {}, Eigen::MatrixXf *states = nullptr) const;
+};
@@ -0,0 +1,116 @@
+/* trajectory_archive.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the TrajectoryArchive class.
+ * The objective of the TrajectoryArchive class is to keep the compartment states of many scenarios, one matrix (time
+ * points by compartments) per trajectory, in a compact file. The states are smooth in time and many compartments are
+ * empty or change monotonically, so every compartment is coded as the residuals of a prediction from its previous
+ * values, bit-packed in blocks of 16 time points. With quantised coding the states are first rounded to multiples of
+ * twice the tolerance, which bounds the error; lossless coding keeps the bits of the floats. Every trajectory is a
+ * chunk of its own, such that a single scenario is decoded without the others; identical trajectories, such as the
+ * states without intervention that the strategies of a sweep share, share their chunk.
+ *
+ * Layout (native byte order, which must be little-endian, as the packed residuals are read in words and the table of
+ * chunks in place): the magic `CSCTRAJ`, the version, the coding and the step, followed by the chunks, the offset and
+ * size of the chunk of every trajectory and a footer with the number of trajectories and the offset of this table. The
+ * footer is written when the archive is closed.
+ */
+
+#pragma once
+
+#include "include/core/mapped_file.h"
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TrajectoryArchive {
+
+  public:
+    enum Coding { lossless = 0, quantised };
+
+    class Writer {
+
+      public:
+        /* constructor; creates the file, throws a std::runtime_error if it cannot be written. With quantised coding
+         * the decoded states differ by at most the tolerance from the states appended (plus the rounding to float).
+         */
+        explicit Writer(const std::string &path, Coding coding = quantised, double tolerance = 1e-7);
+        ~Writer(); // destructor; closes the file
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        /* Appends a trajectory and returns its index in the archive. The trajectories may be appended from several
+         * threads; they are encoded outside the lock. With quantised coding, throws a std::invalid_argument for states
+         * that are not finite or exceed 2^52 times the step.
+         */
+        int64_t append(const Eigen::MatrixXf &trajectory);
+        // appends trajectories with consecutive indices, e.g. those of one scenario; returns the index of the first
+        int64_t append(const std::vector<Eigen::MatrixXf> &trajectories);
+        // writes the table of the chunks and the footer and closes the file; called by the destructor
+        void close();
+
+      private:
+        // whether the chunk of the trajectory that was written holds the bytes; reads it back from the file
+        bool holds(int64_t trajectory, const std::string &bytes);
+
+        std::fstream file_{}; // read as well, to compare a chunk with an identical hash
+        std::mutex mutex_{};
+        Coding coding_;
+        double step_;
+        uint64_t size_{};                 // of the file
+        std::vector<uint64_t> chunks_{}; // offset and size per trajectory
+        std::map<std::pair<uint64_t, uint64_t>, int64_t> written_{}; // trajectory by the hashes of its chunk
+    };
+
+    // encodes a trajectory into a chunk and decodes it; step is twice the tolerance, unused with lossless coding
+    static std::string encode(const Eigen::MatrixXf &trajectory, Coding coding, double step);
+    static void decode(const char *chunk, size_t size, Coding coding, double step, Eigen::MatrixXf &trajectory);
+
+    // constructor; maps the file, throws a std::runtime_error if it cannot be read or is not a closed archive
+    explicit TrajectoryArchive(const std::string &path);
+    ~TrajectoryArchive() = default; // destructor
+    TrajectoryArchive(const TrajectoryArchive &) = delete;
+    TrajectoryArchive &operator=(const TrajectoryArchive &) = delete;
+
+    // getter functions
+    int64_t n_trajectories() const { return n_chunks_; }
+    Coding coding() const { return coding_; }
+    double tolerance() const { return step_ / 2; }
+    size_t size() const { return file_.size(); }    // in bytes
+    uint64_t chunk_size(int64_t trajectory) const; // in bytes
+    int rows(int64_t trajectory) const;            // time points
+    int cols(int64_t trajectory) const;            // compartments
+
+    Eigen::MatrixXf trajectory(int64_t trajectory) const;
+    void trajectory(int64_t trajectory, Eigen::MatrixXf &states) const; // reuses the memory of states if it can
+
+  private:
+    MappedFile file_;
+    Coding coding_{lossless};
+    double step_{};
+    int64_t n_chunks_{};
+    const uint64_t *chunks_{}; // offset and size per trajectory, in place
+
+    const char *chunk(int64_t trajectory) const; // throws a std::invalid_argument if out of range
+};
@@ -0,0 +1,76 @@
+/* traveller_policy.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the TravellerPolicy class.
+ * The objective of the TravellerPolicy class is to chain the prevalence estimation of a region, the incoming
+ * travelers mode of the Simulation and the choice of a strategy: for every region it selects the shortest quarantine
+ * and test plan that releases at most a target number of (pre-)infectious travellers per 100,000 arrivals.
+ */
+
+#pragma once
+
+#include "include/core/incidence_file.h"
+#include "include/core/parameters.h"
+#include "include/core/regional_prevalence.h"
+
+#include <Eigen/Dense>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class TravellerPolicy {
+
+  public:
+    struct Decision {
+        int plan;                 // index in plans(), -1 if no plan meets the target
+        Eigen::Vector3f released; // per 100,000 arrivals under the plan (or the last plan): typical, best, worst case
+    };
+
+    TravellerPolicy() = default; // constructor
+    /* constructor; the candidate plans are quarantines of 0 to max_duration days, ending without test, with an RDT,
+     * with a PCR test or with a PCR test both on arrival and at the end, in this order of preference for the same
+     * duration. The initial states are the prevalence of the use case (typical=0, best=1, worst=2), as in the
+     * PrevalenceTab. A conservative policy requires the worst of the three scenarios to meet the target.
+     */
+    TravellerPolicy(const DiseaseParameters &parameters, float target, int max_duration = 14,
+                    bool symptomatic_screening = true, int use_case = 0, bool conservative = false);
+    ~TravellerPolicy() = default; // destructor
+
+    const std::vector<StrategyParameters> &plans() const { return plans_; }
+    static std::string description(const StrategyParameters &plan); // e.g. `7 days with PCR on day 0 and 7`
+
+    /* (Pre-)infectious travellers per 100,000 arrivals released by each plan (rows) in each scenario (columns), as
+     * get_p_infectious_tend of the Simulation in incoming travelers mode; linear in the initial states.
+     */
+    Eigen::MatrixXf released(const Eigen::VectorXf &initial_states) const;
+    Decision decide(const Eigen::VectorXf &initial_states) const;
+
+    /* Runs the pipeline over the regions of the file: batch prevalence estimation, initial states and decision, one
+     * CSV row per region. Reading the next batch and writing the previous one overlap with the evaluation.
+     */
+    void run(IncidenceFile &file, std::ostream &output) const;
+
+  private:
+    DiseaseParameters parameters_{};
+    float target_{};
+    int use_case_{};
+    bool conservative_{};
+
+    std::vector<StrategyParameters> plans_{};
+    Eigen::MatrixXf weights_{}; // released per arrival, per plan and scenario (rows) and compartment (columns)
+};
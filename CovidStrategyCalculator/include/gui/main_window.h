@@ -44,6 +44,9 @@ class MainWindow : public QMainWindow {
     explicit MainWindow(QWidget *parent = 0); // constructor
     ~MainWindow() = default;                  // destructor
 
+    // a stored strategy sweep, see `--strategy-sweep`
+    void load_results(const std::string &path) { input_container->load_results(path); }
+
   private slots:
     void update_plot(Simulation *simulation);
     void update_result_log(Simulation *simulation);
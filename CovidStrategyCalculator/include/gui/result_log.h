@@ -35,5 +35,16 @@ class ResultLog : public QTableWidget {
     ~ResultLog() = default;                        // destructor
 
     void write_row_result_log(Simulation *simulation);
+    /* row of a result that was looked up in a stored strategy sweep; the relative risk and the probability of being
+     * infectious at the end of the strategy for the typical, best and worst case
+     */
+    void write_row_result_log(const StrategyParameters &strategy, float fraction_asymptomatic,
+                              const Eigen::VectorXf &relative_risk, const Eigen::VectorXf &p_infectious_tend);
     bool event(QEvent *event);
+
+  private:
+    // the results are sorted by Utils::mid_min_max, relative risk and risk reduction in percent
+    void write_row(const StrategyParameters &strategy, float fraction_asymptomatic,
+                   const Eigen::VectorXf &p_infectious_tend, const Eigen::VectorXf &relative_risk,
+                   const Eigen::VectorXf &risk_reduction, bool stored);
 };
@@ -24,12 +24,17 @@
 
 #pragma once
 
+#include "include/core/parameter_index.h"
+#include "include/core/result_cache.h"
+#include "include/core/result_store.h"
 #include "include/core/simulation.h"
 #include "include/gui/user_input/parameters_tab.h"
 #include "include/gui/user_input/prevalence_tab.h"
 #include "include/gui/user_input/strategy_tab.h"
 
 #include <QTabWidget>
+#include <memory>
+#include <string>
 
 class InputContainer : public QTabWidget {
     Q_OBJECT
@@ -43,12 +48,26 @@ class InputContainer : public QTabWidget {
     void run_prevalence_estimator();
     void run_simulation();
 
+    // results of earlier simulations, kept across sessions in the cache directory of the user; null if unavailable
+    std::unique_ptr<ResultCache> result_cache;
+
+    // a stored strategy sweep (see `--strategy-sweep`), which answers the strategies it holds without simulating
+    std::unique_ptr<ResultStore> result_store;
+    std::unique_ptr<ParameterIndex> parameter_index;
+    // emits the stored results if the sweep holds the strategy with the current parameters
+    bool look_up_stored_results();
+
   public:
     explicit InputContainer(QWidget *parent = nullptr); // constructor
 
+    void load_results(const std::string &path); // loads a stored strategy sweep and its index
+
   signals:
     /* signal to emit after running the simulation, used to pass the simulation object to
      *  the plotting and reporting functions
      */
     void output_results(Simulation *simulation);
+    // signal to emit instead when the results are looked up in the stored sweep
+    void output_stored_results(const StrategyParameters &strategy, float fraction_asymptomatic,
+                               const Eigen::VectorXf &relative_risk, const Eigen::VectorXf &p_infectious_tend);
 };
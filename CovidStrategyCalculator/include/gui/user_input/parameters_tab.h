@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include "include/core/parameters.h"
+
 #include <QDoubleSpinBox>
 #include <QPushButton>
 #include <QWidget>
@@ -46,26 +48,19 @@ class ParametersTab : public QWidget {
     QDoubleSpinBox *pcr_spec_;
     QDoubleSpinBox *relative_rdt_sens_;
     QPushButton *reset_button_;
+    QPushButton *load_button_;
 
     // default values for the parameters, used to initialize and reset the fields to their default values
-    std::map<std::string, float> default_values{{"duration_incubation_lower", 5.60},
-                                                {"duration_incubation_mean", 6.77},
-                                                {"duration_incubation_upper", 7.99},
-                                                {"percentage_of_incubation_predetection", 42.2},
-                                                {"duration_symptomatic_lower", 2.79},
-                                                {"duration_symptomatic_mean", 7.50},
-                                                {"duration_symptomatic_upper", 11.47},
-                                                {"percentage_asymptomatic", 20},
-                                                {"duration_postinfectious_mean", 8},
-                                                {"PCR_sensitivity", 80},
-                                                {"PCR_specificity", 99.99},
-                                                {"relative_RDT_sensitivity", 85}};
+    std::map<std::string, float> default_values{Parameters::default_values};
 
     // functions to initialize the widget
     void initialize_member_variables();
     void set_layout();
     // resets all input fields to their default values; to be executed when the 'reset defaults' button is clicked
     void reset_defaults();
+    // sets the input fields to the values of a parameter file, e.g. as written by `--calibrate`; to be executed when
+    // the 'load parameters' button is clicked
+    void load_parameters();
 
   public:
     explicit ParametersTab(QWidget *parent = nullptr);
@@ -99,4 +94,9 @@ class ParametersTab : public QWidget {
     float pcr_sensitivity() const { return pcr_sens_->value() / 100.; }                      // percent to probability
     float pcr_specificity() const { return pcr_spec_->value() / 100.; }                      // percent to probability
     float relative_rdt_sensitivity() const { return relative_rdt_sens_->value() / 100.; }    // percent to probability
+
+    // current values of the input fields, keyed as in Parameters::default_values
+    std::map<std::string, float> values() const;
+    void set_values(const std::map<std::string, float> &values); // fields of keys that are not provided are unchanged
+    DiseaseParameters disease_parameters() const { return DiseaseParameters::from_values(values()); }
 };
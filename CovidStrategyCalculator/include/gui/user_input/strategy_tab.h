@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include "include/core/parameters.h"
+
 #include <QCheckBox>
 #include <QComboBox>
 #include <QDoubleSpinBox>
@@ -49,6 +51,8 @@ class StrategyTab : public QWidget {
     // variables and functions for the placements of diagnostic test
     std::vector<QCheckBox *> test_days_boxes{};
     std::vector<bool> test_days_boxes_states{};
+    std::vector<QComboBox *> test_days_types{}; // type of the test per day, defaults to the selected type of test
+    std::vector<int> test_days_types_states{};
     void set_layout_test_days_box();
     void update_test_days_box();
 
@@ -72,6 +76,8 @@ class StrategyTab : public QWidget {
     int test_type() const { return test_type_->currentIndex(); }
     QString test_type_string() const { return test_type_->currentText(); }
     std::vector<int> test_moments() const; // indices of placed tests; 0-indexed, also in case of non-zero time delay
+    std::vector<int> test_types() const;   // type of the test at each test moment
+    StrategyParameters strategy_parameters() const; // all of the above, to pass to the core
 
     // setter function
     void set_p_infectious_t0(float risk) { p_infectious_t0_->setValue(risk); }
@@ -1,10 +1,19 @@
+#include "include/cli/command_line.h"
 #include "include/gui/main_window.h"
 
 #include <QApplication>
+#include <string>
 
 int main(int argc, char *argv[]) {
+    if (argc > 1 && CommandLine::is_command(argv[1])) {
+        return CommandLine::run(argc, argv); // headless mode, no gui
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
+    if (argc > 2 && std::string(argv[1]) == "--results") {
+        w.load_results(argv[2]); // a stored strategy sweep answers the strategies it holds
+    }
     w.show();
 
     return a.exec();
@@ -0,0 +1,352 @@
+/* covid_strategy_calculator.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the C interface of the covidstrategycalculator library on top of the Simulation. Exceptions of
+ * the core are turned into a csc_status and kept as the last error of the engine; the outputs are written through an
+ * Eigen::Map of the buffer of the caller.
+ */
+
+#include "include/capi/covid_strategy_calculator.h"
+
+#include "include/core/parallel.h"
+#include "include/core/parameters.h"
+#include "include/core/simulation.h"
+
+#include <Eigen/Dense>
+
+#include <climits>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+struct csc_engine {
+    DiseaseParameters parameters;
+    StrategyParameters strategy{}; // of the last csc_evaluate
+    // holds the last evaluation; mutable because the outputs group the states in its buffers
+    mutable Simulation::Workspace workspace{};
+    bool evaluated{false};
+    mutable std::string error{};
+};
+
+namespace {
+// a row-major buffer of the caller with three columns, as the matrix the Simulation writes its outputs into
+using Rows = Eigen::Map<Eigen::MatrixXf, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+
+DiseaseParameters disease_parameters(const csc_disease_parameters *parameters) {
+    if (!parameters) {
+        throw std::invalid_argument("no parameters");
+    }
+    std::map<std::string, float> values{{"duration_incubation_lower", parameters->duration_incubation_lower},
+                                        {"duration_incubation_mean", parameters->duration_incubation_mean},
+                                        {"duration_incubation_upper", parameters->duration_incubation_upper},
+                                        {"percentage_of_incubation_predetection",
+                                         parameters->percentage_of_incubation_predetection},
+                                        {"duration_symptomatic_lower", parameters->duration_symptomatic_lower},
+                                        {"duration_symptomatic_mean", parameters->duration_symptomatic_mean},
+                                        {"duration_symptomatic_upper", parameters->duration_symptomatic_upper},
+                                        {"percentage_asymptomatic", parameters->percentage_asymptomatic},
+                                        {"duration_postinfectious_mean", parameters->duration_postinfectious_mean},
+                                        {"PCR_sensitivity", parameters->pcr_sensitivity},
+                                        {"PCR_specificity", parameters->pcr_specificity},
+                                        {"relative_RDT_sensitivity", parameters->relative_rdt_sensitivity}};
+    Parameters::check_values(values);
+    return DiseaseParameters::from_values(values);
+}
+
+// fills the parameters, reusing their vectors
+void strategy_parameters(const csc_strategy *strategy, StrategyParameters &parameters) {
+    if (!strategy || strategy->n_tests < 0 || (strategy->n_tests > 0 && !strategy->test_days)) {
+        throw std::invalid_argument("no strategy, or no test days");
+    }
+    parameters.mode = strategy->mode;
+    parameters.time_delay = strategy->time_delay;
+    parameters.end_of_strategy = strategy->duration;
+    parameters.test_type = strategy->test_type;
+    parameters.expected_adherence = strategy->adherence;
+    parameters.p_infectious_t0 = strategy->p_infectious;
+    parameters.symptomatic_screening = strategy->symptomatic_screening != 0;
+    parameters.test_moments.clear();
+    parameters.test_types.clear();
+    // test days are given relative to the start of the strategy, the core expects them 0-indexed from the exposure
+    for (int i = 0; i < strategy->n_tests; ++i) {
+        parameters.test_moments.push_back(strategy->test_days[i] + strategy->time_delay);
+        if (strategy->test_types) {
+            parameters.test_types.push_back(strategy->test_types[i]);
+        }
+    }
+    parameters.check();
+}
+
+// what a thread of csc_evaluate_batch reuses for the strategies it evaluates
+struct BatchWorkspace {
+    StrategyParameters strategy;
+    Simulation::Workspace simulation;
+};
+
+// runs the function and turns its exceptions into a status, keeping their message as the last error of the engine
+template <typename Function> csc_status guarded(const csc_engine *engine, Function function) {
+    try {
+        engine->error.clear();
+        return function();
+    } catch (const std::invalid_argument &e) {
+        engine->error = e.what();
+        return CSC_INVALID_ARGUMENT;
+    } catch (const std::exception &e) {
+        engine->error = e.what();
+        return CSC_FAILURE;
+    } catch (...) {
+        engine->error = "unknown exception";
+        return CSC_FAILURE;
+    }
+}
+
+csc_status not_evaluated(const csc_engine *engine) {
+    engine->error = "no strategy has been evaluated";
+    return CSC_NOT_EVALUATED;
+}
+
+// an output of the last evaluation with a row per evaluation point or day, written by the Simulation into the buffer
+template <typename Output>
+csc_status write_output(const csc_engine *engine, size_t rows, Output output, float *buffer, size_t capacity) {
+    if (!engine) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    if (!engine->evaluated) {
+        return not_evaluated(engine);
+    }
+    return guarded(engine, [&]() {
+        if (!buffer) {
+            throw std::invalid_argument("no buffer");
+        }
+        if (capacity < 3 * rows) {
+            return CSC_BUFFER_TOO_SMALL;
+        }
+        output(engine->workspace, Rows(buffer, rows, 3, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(1, 3)));
+        return CSC_OK;
+    });
+}
+} // namespace
+
+int csc_abi_version(void) { return CSC_ABI_VERSION; }
+
+void csc_default_parameters(csc_disease_parameters *parameters) {
+    if (!parameters) {
+        return;
+    }
+    const std::map<std::string, float> &values = Parameters::default_values;
+    parameters->duration_incubation_lower = values.at("duration_incubation_lower");
+    parameters->duration_incubation_mean = values.at("duration_incubation_mean");
+    parameters->duration_incubation_upper = values.at("duration_incubation_upper");
+    parameters->percentage_of_incubation_predetection = values.at("percentage_of_incubation_predetection");
+    parameters->duration_symptomatic_lower = values.at("duration_symptomatic_lower");
+    parameters->duration_symptomatic_mean = values.at("duration_symptomatic_mean");
+    parameters->duration_symptomatic_upper = values.at("duration_symptomatic_upper");
+    parameters->percentage_asymptomatic = values.at("percentage_asymptomatic");
+    parameters->duration_postinfectious_mean = values.at("duration_postinfectious_mean");
+    parameters->pcr_sensitivity = values.at("PCR_sensitivity");
+    parameters->pcr_specificity = values.at("PCR_specificity");
+    parameters->relative_rdt_sensitivity = values.at("relative_RDT_sensitivity");
+}
+
+void csc_default_strategy(csc_strategy *strategy) {
+    if (!strategy) {
+        return;
+    }
+    StrategyParameters defaults;
+    *strategy = csc_strategy{defaults.mode,
+                             defaults.time_delay,
+                             defaults.end_of_strategy,
+                             nullptr,
+                             nullptr,
+                             0,
+                             defaults.test_type,
+                             defaults.expected_adherence,
+                             defaults.p_infectious_t0,
+                             defaults.symptomatic_screening};
+}
+
+csc_engine *csc_engine_create(const csc_disease_parameters *parameters) {
+    try {
+        std::unique_ptr<csc_engine> engine = std::make_unique<csc_engine>();
+        engine->parameters = disease_parameters(parameters);
+        return engine.release();
+    } catch (const std::exception &) {
+        return nullptr;
+    }
+}
+
+void csc_engine_destroy(csc_engine *engine) { delete engine; }
+
+csc_status csc_engine_set_parameters(csc_engine *engine, const csc_disease_parameters *parameters) {
+    if (!engine) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    return guarded(engine, [&]() {
+        engine->parameters = disease_parameters(parameters);
+        return CSC_OK;
+    });
+}
+
+const char *csc_last_error(const csc_engine *engine) { return engine ? engine->error.c_str() : "no engine"; }
+
+csc_status csc_evaluate(csc_engine *engine, const csc_strategy *strategy) {
+    if (!engine) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    engine->evaluated = false; // no outputs if the evaluation fails
+    return guarded(engine, [&]() {
+        strategy_parameters(strategy, engine->strategy);
+        Simulation::evaluate(engine->parameters, engine->strategy, engine->workspace);
+        engine->evaluated = true;
+        return CSC_OK;
+    });
+}
+
+size_t csc_n_evaluation_points(const csc_engine *engine) {
+    return csc_n_days(engine) ? csc_n_days(engine) + engine->workspace.test_moments.size() : 0;
+}
+
+size_t csc_n_days(const csc_engine *engine) {
+    if (!engine || !engine->evaluated) {
+        return 0;
+    }
+    return engine->workspace.t_end + 1; // +1 because of 0-indexed time
+}
+
+csc_status csc_evaluation_points(const csc_engine *engine, float *days, size_t capacity) {
+    if (!engine) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    if (!engine->evaluated) {
+        return not_evaluated(engine);
+    }
+    return guarded(engine, [&]() {
+        if (!days) {
+            throw std::invalid_argument("no buffer");
+        }
+        size_t n = csc_n_evaluation_points(engine);
+        if (capacity < n) {
+            return CSC_BUFFER_TOO_SMALL;
+        }
+        Simulation::evaluation_points_with_tests(engine->workspace, Eigen::Map<Eigen::VectorXf>(days, n));
+        return CSC_OK;
+    });
+}
+
+csc_status csc_relative_risk(const csc_engine *engine, float *relative_risk, size_t capacity) {
+    return write_output(
+        engine, csc_n_evaluation_points(engine),
+        [](Simulation::Workspace &workspace, Rows rows) { Simulation::relative_risk(workspace, rows); },
+        relative_risk, capacity);
+}
+
+csc_status csc_assay_sensitivity(const csc_engine *engine, int test_type, float *sensitivity, size_t capacity) {
+    if (test_type < 0 || test_type > 1) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    return write_output(
+        engine, csc_n_days(engine),
+        [&](Simulation::Workspace &workspace, Rows rows) {
+            Simulation::temporal_assay_sensitivity(workspace, test_type, rows);
+        },
+        sensitivity, capacity);
+}
+
+csc_status csc_test_efficacy(const csc_engine *engine, int test_type, float *efficacy, size_t capacity) {
+    if (test_type < 0 || test_type > 1) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    return write_output(
+        engine, csc_n_days(engine),
+        [&](Simulation::Workspace &workspace, Rows rows) { Simulation::test_efficacy(workspace, test_type, rows); },
+        efficacy, capacity);
+}
+
+csc_status csc_p_infectious_tend(const csc_engine *engine, float *p_infectious_tend) {
+    auto output = [](Simulation::Workspace &workspace, Rows rows) {
+        rows = workspace.outputs.p_infectious_tend.transpose(); // one row
+    };
+    return write_output(engine, 1, output, p_infectious_tend, 3);
+}
+
+csc_status csc_evaluate_batch(csc_engine *engine, const csc_strategy *strategies, size_t n, float *relative_risk,
+                              float *p_infectious_tend, csc_status *statuses) {
+    if (!engine || (n > 0 && !strategies) || n > size_t(INT_MAX)) {
+        return CSC_INVALID_ARGUMENT;
+    }
+    return guarded(engine, [&]() {
+        // a strategy that is not reached, when the batch itself fails, reads as failed
+        for (size_t i = 0; i < n; ++i) {
+            if (relative_risk) {
+                Eigen::Map<Eigen::RowVector3f>(relative_risk + 3 * i).setConstant(NAN);
+            }
+            if (p_infectious_tend) {
+                Eigen::Map<Eigen::RowVector3f>(p_infectious_tend + 3 * i).setConstant(NAN);
+            }
+            if (statuses) {
+                statuses[i] = CSC_FAILURE;
+            }
+        }
+        std::mutex failure_mutex;
+        size_t first_failure = n;
+        csc_status status = CSC_OK;
+
+        Parallel::for_each(
+            int(n), []() { return BatchWorkspace(); },
+            [&](int i, BatchWorkspace &workspace) {
+                csc_status strategy_status = CSC_OK;
+                std::string error{};
+                Eigen::RowVector3f risk = Eigen::RowVector3f::Constant(NAN), p_infectious = risk;
+                try {
+                    strategy_parameters(&strategies[i], workspace.strategy);
+                    const Simulation::EndOfStrategy &outputs =
+                        Simulation::end_of_strategy(engine->parameters, workspace.strategy, workspace.simulation);
+                    risk = outputs.relative_risk.transpose();
+                    p_infectious = outputs.p_infectious_tend.transpose();
+                } catch (const std::invalid_argument &e) {
+                    strategy_status = CSC_INVALID_ARGUMENT;
+                    error = e.what();
+                } catch (const std::exception &e) {
+                    strategy_status = CSC_FAILURE;
+                    error = e.what();
+                }
+
+                if (relative_risk) {
+                    Eigen::Map<Eigen::RowVector3f>(relative_risk + 3 * i) = risk;
+                }
+                if (p_infectious_tend) {
+                    Eigen::Map<Eigen::RowVector3f>(p_infectious_tend + 3 * i) = p_infectious;
+                }
+                if (statuses) {
+                    statuses[i] = strategy_status;
+                }
+                if (strategy_status != CSC_OK) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (size_t(i) < first_failure) {
+                        first_failure = i;
+                        status = strategy_status;
+                        engine->error = "strategy " + std::to_string(i) + ": " + error;
+                    }
+                }
+            });
+        return status;
+    });
+}
@@ -0,0 +1,1283 @@
+/* command_line.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the namespace CommandLine, which runs the headless modes of COVIDStrategycalculator.
+ */
+
+#include "include/cli/command_line.h"
+#include "include/cli/query_server.h"
+#include "include/core/agent_simulation.h"
+#include "include/core/calibration.h"
+#include "include/core/cohort_release.h"
+#include "include/core/ensemble.h"
+#include "include/core/exposure_mixture.h"
+#include "include/core/incidence_file.h"
+#include "include/core/parallel.h"
+#include "include/core/parameter_index.h"
+#include "include/core/prevalence_estimator.h"
+#include "include/core/query_service.h"
+#include "include/core/regional_prevalence.h"
+#include "include/core/result_cache.h"
+#include "include/core/result_store.h"
+#include "include/core/rolling_prevalence_estimator.h"
+#include "include/core/screening_programme.h"
+#include "include/core/sensitivity_analysis.h"
+#include "include/core/simulation.h"
+#include "include/core/sobol_sequence.h"
+#include "include/core/timeline.h"
+#include "include/core/trajectory_archive.h"
+#include "include/core/traveller_policy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+CommandLine::Arguments::Arguments(int argc, char *argv[]) {
+    for (int i = 2; i < argc; ++i) { // argv[1] is the command
+        std::string key = argv[i];
+        if (key.rfind("--", 0) != 0) {
+            continue;
+        }
+        key = key.substr(2);
+        if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+            options_[key] = argv[++i];
+        } else {
+            options_[key] = ""; // flag
+        }
+    }
+}
+
+std::string CommandLine::Arguments::value(const std::string &key, const std::string &fallback) const {
+    auto it = options_.find(key);
+    return it != options_.end() ? it->second : fallback;
+}
+
+float CommandLine::Arguments::value(const std::string &key, float fallback) const {
+    auto it = options_.find(key);
+    return it != options_.end() ? std::stof(it->second) : fallback;
+}
+
+int CommandLine::Arguments::value(const std::string &key, int fallback) const {
+    auto it = options_.find(key);
+    return it != options_.end() ? std::stoi(it->second) : fallback;
+}
+
+std::vector<int> CommandLine::Arguments::values(const std::string &key) const {
+    std::vector<int> v{};
+    std::stringstream stream(value(key, std::string()));
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            v.push_back(std::stoi(item));
+        }
+    }
+    return v;
+}
+
+StrategyParameters CommandLine::Arguments::strategy() const {
+    StrategyParameters strategy;
+    strategy.mode = value("mode", 0);
+    strategy.time_delay = value("delay", 0);
+    strategy.end_of_strategy = value("duration", 10);
+    strategy.test_type = value("test-type", std::string("pcr")) == "rdt" ? 1 : 0;
+    strategy.expected_adherence = value("adherence", float(100.)) / 100.; // percent to fraction
+    strategy.p_infectious_t0 = value("p-infectious", float(1.));
+    strategy.symptomatic_screening = !has("no-screening");
+
+    /* test days are given relative to the start of the strategy, the core expects them 0-indexed from the exposure. A
+     * day may carry its own test type, e.g. `--tests 3:rdt,7:pcr`; other days use --test-type.
+     */
+    std::stringstream stream(value("tests", std::string()));
+    std::string item;
+    bool mixed = false;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t separator = item.find(':');
+        strategy.test_moments.push_back(std::stoi(item.substr(0, separator)) + strategy.time_delay);
+        int type = strategy.test_type;
+        if (separator != std::string::npos) {
+            std::string name = item.substr(separator + 1);
+            if (name != "pcr" && name != "rdt") {
+                throw std::invalid_argument("unknown test type " + name);
+            }
+            type = name == "rdt" ? 1 : 0;
+            mixed = true;
+        }
+        strategy.test_types.push_back(type);
+    }
+    if (!mixed) {
+        strategy.test_types.clear();
+    }
+    strategy.check();
+    return strategy;
+}
+
+std::vector<StrategyParameters> CommandLine::Arguments::strategies() const {
+    std::vector<StrategyParameters> strategies{};
+    std::string schedules = value("tests", std::string());
+    std::stringstream stream(schedules);
+    std::string schedule;
+    while (std::getline(stream, schedule, ';')) {
+        Arguments arguments = *this;
+        arguments.options_["tests"] = schedule;
+        strategies.push_back(arguments.strategy());
+    }
+    if (strategies.empty() || schedules.back() == ';') { // trailing ';' adds the strategy without tests
+        Arguments arguments = *this;
+        arguments.options_["tests"] = "";
+        strategies.push_back(arguments.strategy());
+    }
+    return strategies;
+}
+
+std::map<std::string, float> CommandLine::Arguments::parameter_values() const {
+    std::map<std::string, float> values = Parameters::default_values;
+    for (auto &[key, value] : values) {
+        value = this->value(key, value);
+    }
+    return values;
+}
+
+namespace {
+// scenario selected by --use-case: typical=0, best=1, worst=2
+int use_case(const CommandLine::Arguments &arguments) {
+    std::string name = arguments.value("use-case", std::string("typical"));
+    if (name != "typical" && name != "best" && name != "worst") {
+        throw std::invalid_argument("unknown use case " + name);
+    }
+    return name == "typical" ? 0 : name == "best" ? 1 : 2;
+}
+
+void print_bands(const Eigen::MatrixXf &bands) {
+    std::printf("evaluation_point,relative_risk_median,relative_risk_lower,relative_risk_upper\n");
+    for (int i = 0; i < bands.rows(); ++i) {
+        std::printf("%d,%g,%g,%g\n", i, bands(i, 0), bands(i, 1), bands(i, 2));
+    }
+}
+
+// uncertainty bands of the relative risk of a strategy
+int ensemble(const CommandLine::Arguments &arguments) {
+    Ensemble ensemble(ParameterSpace(arguments.parameter_values(), arguments.value("spread", float(.1))),
+                      arguments.strategy());
+    Ensemble::Sampling sampling =
+        arguments.value("sampling", std::string("sobol")) == "random" ? Ensemble::pseudo_random : Ensemble::sobol;
+    ensemble.run(sampling, arguments.value("tolerance", float(1e-3)), arguments.value("max-samples", 1 << 14),
+                 arguments.value("seed", 1));
+
+    for (const Ensemble::ConvergenceStep &step : ensemble.convergence()) {
+        std::fprintf(stderr, "samples: %d, band change: %g\n", step.n_samples, step.band_change);
+    }
+    std::fprintf(stderr, ensemble.converged() ? "converged\n" : "not converged\n");
+    print_bands(ensemble.relative_risk_bands());
+    return ensemble.converged() ? 0 : 1;
+}
+
+// samples-to-accuracy of pseudo-random and Sobol sampling
+int benchmark_sampling(const CommandLine::Arguments &arguments) {
+    Ensemble ensemble(ParameterSpace(arguments.parameter_values(), arguments.value("spread", float(.1))),
+                      arguments.strategy());
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Ensemble::BenchmarkRow> rows = ensemble.benchmark(
+        arguments.value("max-samples", 1 << 12), arguments.value("replicates", 8), arguments.value("seed", 1));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("n_samples,error_pseudo_random,error_sobol\n");
+    for (const Ensemble::BenchmarkRow &row : rows) {
+        std::printf("%d,%g,%g\n", row.n_samples, row.error_pseudo_random, row.error_sobol);
+    }
+
+    // smallest sample size at which each sampling reaches the accuracy of pseudo-random sampling at max_samples
+    float target = rows.back().error_pseudo_random;
+    for (const Ensemble::BenchmarkRow &row : rows) {
+        if (row.error_sobol <= target) {
+            std::fprintf(stderr, "sobol reaches the error of %d pseudo-random samples with %d samples (%.1fx)\n",
+                         rows.back().n_samples, row.n_samples, float(rows.back().n_samples) / row.n_samples);
+            break;
+        }
+    }
+    std::fprintf(stderr, "elapsed: %.2f s\n", elapsed.count());
+    return 0;
+}
+
+// first-order and total Sobol indices of the relative risk at the end of each strategy
+int sensitivity(const CommandLine::Arguments &arguments) {
+    SensitivityAnalysis analysis(ParameterSpace(arguments.parameter_values(), arguments.value("spread", float(.1))),
+                                 arguments.strategies(), arguments.value("spread", float(.1)));
+
+    auto start = std::chrono::steady_clock::now();
+    analysis.run(arguments.value("samples", 512), arguments.value("seed", 1));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::vector<std::string> inputs = analysis.inputs();
+    for (int s = 0; s < (int)analysis.strategies().size(); ++s) {
+        const StrategyParameters &strategy = analysis.strategies()[s];
+        const SensitivityAnalysis::Indices &indices = analysis.indices()[s];
+
+        std::string days{};
+        std::vector<int> types = strategy.types_of_tests();
+        for (int i = 0; i < (int)strategy.test_moments.size(); ++i) {
+            days += std::to_string(strategy.test_moments[i] - strategy.time_delay) + (types[i] ? ":RDT " : ":PCR ");
+        }
+        std::printf("# strategy %d: mode %d, delay %d, duration %d, tests [%s], adherence %g%%\n", s, strategy.mode,
+                    strategy.time_delay, strategy.end_of_strategy, days.c_str(), strategy.expected_adherence * 100);
+        std::printf("# relative risk: mean %g, variance %g; risk reduction: mean %g, variance %g\n",
+                    indices.mean_relative_risk, indices.variance, 1 - indices.mean_relative_risk, indices.variance);
+        std::printf("input,first_order,total\n");
+        for (int i = 0; i < (int)inputs.size(); ++i) {
+            std::printf("%s,%g,%g\n", inputs[i].c_str(), indices.first_order(i), indices.total(i));
+        }
+    }
+    std::fprintf(stderr, "%d model evaluations in %.2f s\n", analysis.n_evaluations(), elapsed.count());
+    return 0;
+}
+
+// relative risk of the typical case and its derivatives with respect to the disease parameters
+int jacobian(const CommandLine::Arguments &arguments) {
+    Simulation simulation(DiseaseParameters::from_values(arguments.parameter_values()), arguments.strategy());
+    Eigen::VectorXf relative_risk = simulation.relative_risk().col(0);
+    Eigen::MatrixXf jacobian = simulation.relative_risk_jacobian();
+
+    std::printf("evaluation_point,relative_risk,d_tau_predetection,d_tau_presymptomatic,d_tau_symptomatic,"
+                "d_tau_postinfectious,d_fraction_asymptomatic,d_pcr_sensitivity,d_rdt_relative_sensitivity,"
+                "d_specificity\n");
+    for (int i = 0; i < jacobian.rows(); ++i) {
+        std::printf("%d,%g", i, relative_risk(i));
+        for (int j = 0; j < jacobian.cols(); ++j) {
+            std::printf(",%g", jacobian(i, j));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+// relative risk per evaluation point of one or more strategies, restored from the result cache when given by --cache
+int simulate(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    std::vector<StrategyParameters> strategies = arguments.strategies();
+    std::unique_ptr<ResultCache> cache{};
+    if (arguments.has("cache")) {
+        uint64_t max_size = uint64_t(arguments.value("cache-size", 256)) << 20; // MB
+        cache = std::make_unique<ResultCache>(arguments.value("cache", std::string()), max_size);
+    }
+
+    std::vector<std::unique_ptr<Simulation>> simulations(strategies.size());
+    std::vector<double> seconds(strategies.size());
+    auto start = std::chrono::steady_clock::now();
+    Parallel::for_each(strategies.size(), [&](int s) {
+        auto strategy_start = std::chrono::steady_clock::now();
+        simulations[s] = cache ? cache->simulation(parameters, strategies[s])
+                               : std::make_unique<Simulation>(parameters, strategies[s]);
+        seconds[s] = std::chrono::duration<double>(std::chrono::steady_clock::now() - strategy_start).count();
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("strategy,evaluation_point,day,relative_risk_typical,relative_risk_best,relative_risk_worst\n");
+    for (int s = 0; s < (int)strategies.size(); ++s) {
+        Eigen::MatrixXf relative_risk = simulations[s]->relative_risk();
+        Eigen::VectorXf days = simulations[s]->evaluation_points_with_tests();
+        for (int i = 0; i < relative_risk.rows(); ++i) {
+            std::printf("%d,%d,%g,%g,%g,%g\n", s, i, days(i), relative_risk(i, 0), relative_risk(i, 1),
+                        relative_risk(i, 2));
+        }
+        std::fprintf(stderr, "strategy %d: %.1f us\n", s, seconds[s] * 1e6);
+    }
+    std::fprintf(stderr, "%d strategies in %.2f ms", (int)strategies.size(), elapsed.count() * 1e3);
+    if (cache) {
+        std::fprintf(stderr, "; cache %s: %.1f of %.0f MB", cache->directory().c_str(), cache->size() / 1048576.,
+                     cache->max_size() / 1048576.);
+    }
+    std::fprintf(stderr, "\n");
+    return 0;
+}
+
+// maximum likelihood fit of the disease parameters to a line list, written as a parameter file
+int calibrate(const CommandLine::Arguments &arguments) {
+    std::ifstream data(arguments.value("data", std::string()));
+    if (!data) {
+        throw std::runtime_error("cannot read the line list given by --data");
+    }
+    Calibration calibration(Calibration::Observations::from_csv(data), arguments.parameter_values());
+
+    auto start = std::chrono::steady_clock::now();
+    calibration.run(arguments.value("starts", 8), arguments.value("seed", 1));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (int s = 0; s < (int)calibration.fits().size(); ++s) {
+        const Calibration::Fit &fit = calibration.fits()[s];
+        std::fprintf(stderr, "start %d: log-likelihood %.6g, %d iterations%s\n", s, fit.log_likelihood, fit.iterations,
+                     fit.converged ? "" : ", not converged");
+    }
+    std::fprintf(stderr, "%d starts in %.2f s\n", (int)calibration.fits().size(), elapsed.count());
+
+    if (arguments.has("output")) {
+        std::ofstream output(arguments.value("output", std::string()));
+        Parameters::write_values(output, calibration.values());
+    } else {
+        Parameters::write_values(std::cout, calibration.values());
+    }
+    return calibration.best_fit().converged ? 0 : 1;
+}
+
+// relative risk during a periodic screening programme and under indefinite screening
+int screening(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+
+    auto start = std::chrono::steady_clock::now();
+    ScreeningProgramme programme(parameters, arguments.strategy(), arguments.value("period", 7));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("scenario,relative_risk,steady_state_relative_risk\n");
+    const char *scenarios[] = {"typical", "best", "worst"};
+    for (int i = 0; i < 3; ++i) {
+        std::printf("%s,%g,%g\n", scenarios[i], programme.relative_risk()(i),
+                    programme.steady_state_relative_risk()(i));
+    }
+
+    // reference: a single 14-day quarantine without tests
+    StrategyParameters quarantine;
+    quarantine.end_of_strategy = 14;
+    start = std::chrono::steady_clock::now();
+    Simulation simulation(parameters, quarantine);
+    std::chrono::duration<double> elapsed_quarantine = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "programme: %.3f ms, 14-day quarantine: %.3f ms\n", elapsed.count() * 1e3,
+                 elapsed_quarantine.count() * 1e3);
+    return 0;
+}
+
+// prevalence per region from a long-format incidence time series, sorted by region
+int prevalence_batch(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    IncidenceFile file(arguments.value("data", std::string()));
+    std::ofstream output_file;
+    if (arguments.has("output")) {
+        output_file.open(arguments.value("output", std::string()));
+    }
+    std::ostream &output = arguments.has("output") ? output_file : std::cout;
+
+    // batches of regions, such that the memory use does not depend on the number of regions
+    auto start = std::chrono::steady_clock::now();
+    int batch_size = 4096 * Parallel::n_threads();
+    int n_regions = 0;
+    std::vector<RegionalPrevalence::Region> batch(batch_size);
+    for (bool first = true, end = false; !end; first = false) {
+        int n = 0;
+        while (n < batch_size && file.next(batch[n])) {
+            ++n;
+        }
+        end = n < batch_size;
+        batch.resize(n); // only the last batch is incomplete, the others reuse the memory of the regions
+        RegionalPrevalence(parameters, RegionalPrevalence::n_days(batch))
+            .write_csv(batch, output, arguments.has("compartments"), first);
+        n_regions += n;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%d regions, %.2f GB in %.2f s\n", n_regions, file.size() * 1e-9, elapsed.count());
+    return 0;
+}
+
+// throughput of reading an incidence time series, memory-mapped and as a stream
+int benchmark_ingestion(const CommandLine::Arguments &arguments) {
+    std::string path = arguments.value("data", std::string());
+    std::printf("reader,regions,seconds,gigabytes_per_second\n");
+
+    auto start = std::chrono::steady_clock::now();
+    IncidenceFile file(path);
+    RegionalPrevalence::Region region;
+    int n_regions = 0;
+    double checksum = 0; // keeps the parsing from being optimised away
+    while (file.next(region)) {
+        ++n_regions;
+        checksum += region.daily_incidence[0];
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("mapped,%d,%g,%g\n", n_regions, elapsed.count(), file.size() * 1e-9 / elapsed.count());
+
+    if (!arguments.has("mapped-only")) {
+        start = std::chrono::steady_clock::now();
+        std::ifstream stream(path);
+        std::vector<RegionalPrevalence::Region> regions = RegionalPrevalence::read_csv(stream);
+        elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("stream,%d,%g,%g\n", (int)regions.size(), elapsed.count(), file.size() * 1e-9 / elapsed.count());
+    }
+    std::fprintf(stderr, "checksum: %g\n", checksum);
+    return 0;
+}
+
+/* the rolling prevalence estimation of the first region of a time series, day by day with preliminary reports that are
+ * corrected later, against the full estimation from the same reports every day
+ */
+int rolling_prevalence(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    IncidenceFile file(arguments.value("data", std::string()));
+    RegionalPrevalence::Region region;
+    if (!file.next(region)) {
+        throw std::runtime_error("the time series holds no region");
+    }
+    int window = arguments.value("window", 14);
+    int n_corrections = arguments.value("corrections", 1); // per day, besides the final report
+    float tolerance = arguments.value("tolerance", float(1e-5));
+    std::mt19937_64 generator(arguments.value("seed", 1));
+    std::uniform_real_distribution<float> completeness(.5, 1.); // of a preliminary report
+
+    /* a day is first reported incompletely and revised by random corrections while it lies in the correction window;
+     * its final report, from the time series, arrives on the last day of the window
+     */
+    RollingPrevalenceEstimator rolling(parameters, {}, window);
+    std::vector<float> reports{}; // [day 0, day -1, ...]
+    std::chrono::duration<double> elapsed_rolling{}, elapsed_full{};
+    float max_difference = 0;
+    std::printf("day,incidence,prevalence,max_relative_difference\n");
+    int n_days = region.daily_incidence.size();
+    for (int day = 0; day < n_days; ++day) {
+        // final report of the day `days_ago` days before today
+        auto final_report = [&](int days_ago) { return region.daily_incidence[n_days - 1 - day + days_ago]; };
+        reports.insert(reports.begin(), final_report(0) * completeness(generator));
+        std::vector<std::pair<int, float>> corrections{}; // days ago, report
+        int n_open = std::min<int>(window, reports.size());
+        for (int c = 0; c < n_corrections && n_open > 1; ++c) {
+            int days_ago = std::uniform_int_distribution<int>(1, n_open - 1)(generator);
+            corrections.emplace_back(days_ago, final_report(days_ago) * completeness(generator));
+        }
+        if ((int)reports.size() >= window) {
+            corrections.emplace_back(window - 1, final_report(window - 1));
+        }
+        for (const auto &[days_ago, report] : corrections) {
+            reports[days_ago] = report;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        rolling.advance(reports[0]);
+        for (const auto &[days_ago, report] : corrections) {
+            rolling.correct(days_ago, report);
+        }
+        Eigen::MatrixXf rolling_phases = rolling.phase_probabilities();
+        elapsed_rolling += std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        Eigen::MatrixXf full_phases =
+            PrevalenceEstimator(parameters, reports, PrevalenceEstimator::daily).phase_probabilities();
+        elapsed_full += std::chrono::steady_clock::now() - start;
+
+        float scale = full_phases.cwiseAbs().maxCoeff();
+        float difference = scale > 0 ? (rolling_phases - full_phases).cwiseAbs().maxCoeff() / scale : 0;
+        max_difference = std::max(max_difference, difference);
+        // prevalence of the typical case: all phases but the last, recovered
+        std::printf("%d,%g,%g,%g\n", day, reports[0], rolling_phases.col(0).head(4).sum(), difference);
+    }
+
+    std::fprintf(stderr, "%s: %d days, rolling: %.3f ms (%.2f us per day), full estimation: %.3f ms\n",
+                 region.name.c_str(), n_days, elapsed_rolling.count() * 1e3,
+                 elapsed_rolling.count() * 1e6 / std::max(n_days, 1), elapsed_full.count() * 1e3);
+    std::fprintf(stderr, "largest relative difference: %g (tolerance %g)\n", max_difference, tolerance);
+    return max_difference <= tolerance ? 0 : 1;
+}
+
+// shortest quarantine and test plan per region that meets a target of released infectious travellers
+int traveller_policy(const CommandLine::Arguments &arguments) {
+    TravellerPolicy policy(DiseaseParameters::from_values(arguments.parameter_values()),
+                           arguments.value("target", float(10.)), arguments.value("max-duration", 14),
+                           !arguments.has("no-screening"), use_case(arguments), arguments.has("conservative"));
+    IncidenceFile file(arguments.value("data", std::string()));
+
+    auto start = std::chrono::steady_clock::now();
+    if (arguments.has("output")) {
+        std::ofstream output(arguments.value("output", std::string()));
+        policy.run(file, output);
+    } else {
+        policy.run(file, std::cout);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%d candidate plans, %.2f GB in %.2f s\n", (int)policy.plans().size(), file.size() * 1e-9,
+                 elapsed.count());
+    return 0;
+}
+
+// distribution of the number of infectious people released from a cohort of travellers from several origins
+int cohort(const CommandLine::Arguments &arguments) {
+    std::ifstream data(arguments.value("origins", std::string()));
+    if (!data) {
+        throw std::runtime_error("cannot read the origins given by --origins");
+    }
+    std::vector<CohortRelease::Origin> origins = CohortRelease::read_csv(data);
+
+    // the released fraction is linear in the initial probability of infection, so one simulation serves all origins
+    StrategyParameters strategy = arguments.strategy();
+    if (strategy.mode == 2) {
+        throw std::invalid_argument("incoming travelers (mode 2) need prevalence states, which --cohort does not take");
+    }
+    strategy.p_infectious_t0 = 1;
+    Simulation simulation(DiseaseParameters::from_values(arguments.parameter_values()), strategy, Eigen::VectorXf(),
+                          Simulation::end_of_strategy_outputs);
+    float released = simulation.get_p_infectious_tend()(use_case(arguments));
+    for (CohortRelease::Origin &origin : origins) {
+        origin.probability *= released;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CohortRelease cohort(origins);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("released,probability,cumulative\n");
+    double cumulative = 0;
+    for (int k = cohort.min_released(); k <= cohort.max_released(); ++k) {
+        cumulative += cohort.probability(k);
+        std::printf("%d,%g,%g\n", k, cohort.probability(k), cumulative);
+    }
+    std::fprintf(stderr,
+                 "%d travellers from %d origins: mean %g released; quantiles 50%%: %d, 90%%: %d, 99%%: %d, "
+                 "99.9%%: %d; %.2f ms\n",
+                 cohort.n_travellers(), (int)origins.size(), cohort.mean(), cohort.quantile(.5), cohort.quantile(.9),
+                 cohort.quantile(.99), cohort.quantile(.999), elapsed.count() * 1e3);
+    return 0;
+}
+
+// relative risk and assay sensitivity during a contact management strategy, for an uncertain day of exposure
+int exposure_mixture(const CommandLine::Arguments &arguments) {
+    std::vector<float> weights{};
+    std::stringstream stream(arguments.value("exposure", std::string()));
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        weights.push_back(std::stof(item));
+    }
+    StrategyParameters strategy = arguments.strategy();
+    strategy.mode = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    ExposureMixture mixture(DiseaseParameters::from_values(arguments.parameter_values()), strategy, weights);
+    Eigen::MatrixXf relative_risk = mixture.relative_risk();
+    Eigen::MatrixXf sensitivity = mixture.temporal_assay_sensitivity();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // the days of the tests appear twice in the relative risk: before and after the test
+    Eigen::VectorXf days = mixture.evaluation_points_with_tests();
+    std::printf("day,relative_risk,relative_risk_best,relative_risk_worst,assay_sensitivity,assay_sensitivity_best,"
+                "assay_sensitivity_worst\n");
+    for (int i = 0; i < relative_risk.rows(); ++i) {
+        int day = days(i);
+        std::printf("%d,%g,%g,%g,%g,%g,%g\n", day, relative_risk(i, 0), relative_risk(i, 1), relative_risk(i, 2),
+                    sensitivity(day, 0), sensitivity(day, 1), sensitivity(day, 2));
+    }
+    std::fprintf(stderr, "exposure 0 to %d days before the start: %.2f ms\n", mixture.max_offset(),
+                 elapsed.count() * 1e3);
+    return 0;
+}
+
+// the relative risk of the deterministic model next to that of an agent-based simulation; fails on a deviation
+int agents(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    StrategyParameters strategy = arguments.strategy();
+    int scenario = use_case(arguments);
+    int n_agents = arguments.value("n-agents", 1000000);
+
+    Simulation simulation(parameters, strategy);
+    auto start = std::chrono::steady_clock::now();
+    AgentSimulation agent_simulation(parameters, strategy, n_agents, arguments.value("seed", 1));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    Eigen::MatrixXf relative_risk = simulation.relative_risk();
+    Eigen::MatrixXf relative_risk_agents = agent_simulation.relative_risk();
+    Eigen::MatrixXf standard_error = agent_simulation.relative_risk_standard_error();
+    float max_deviation = 0; // in standard errors
+    std::printf("evaluation_point,relative_risk,relative_risk_agents,standard_error\n");
+    for (int i = 0; i < relative_risk.rows(); ++i) {
+        std::printf("%d,%g,%g,%g\n", i, relative_risk(i, scenario), relative_risk_agents(i, scenario),
+                    standard_error(i, scenario));
+        for (int s = 0; s < 3; ++s) {
+            float deviation = std::abs(relative_risk_agents(i, s) - relative_risk(i, s));
+            if (standard_error(i, s) > 0) {
+                max_deviation = std::max(max_deviation, deviation / standard_error(i, s));
+            }
+        }
+    }
+
+    float assay_deviation = 0;
+    for (int type = 0; type < 2; ++type) {
+        Eigen::MatrixXf deviation =
+            agent_simulation.temporal_assay_sensitivity(type) - simulation.temporal_assay_sensitivity(type);
+        assay_deviation = std::max(assay_deviation, deviation.cwiseAbs().maxCoeff());
+    }
+    std::fprintf(stderr,
+                 "%d agents in %.2f s (%.3g agents/s); largest deviation of the relative risk: %.2f standard errors, "
+                 "of the assay sensitivity: %.2g; infectious at the end: %g, agents %g\n",
+                 n_agents, elapsed.count(), n_agents / elapsed.count(), max_deviation, assay_deviation,
+                 simulation.get_p_infectious_tend()(scenario), agent_simulation.get_p_infectious_tend()(scenario));
+    return max_deviation > 5 ? 1 : 0;
+}
+
+// relative risk of a composite strategy, given as a timeline of events, or of the strategy options
+int timeline(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    StrategyParameters strategy = arguments.strategy();
+    std::vector<Timeline::Event> events = Timeline::events(strategy);
+    if (arguments.has("events")) {
+        events = Timeline::parse(arguments.value("events", std::string()));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Timeline timeline(parameters, events, Timeline::initial_states(strategy), strategy.expected_adherence);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("scenario,relative_risk\n");
+    const char *scenarios[] = {"typical", "best", "worst"};
+    for (int i = 0; i < 3; ++i) {
+        std::printf("%s,%g\n", scenarios[i], timeline.relative_risk()(i));
+    }
+    std::fprintf(stderr, "%d events: %.3f ms\n", (int)events.size(), elapsed.count() * 1e3);
+    return 0;
+}
+
+// residual risk at the end of the strategy over a sample of the parameter space, written to a result store
+int sweep(const CommandLine::Arguments &arguments) {
+    std::string path = arguments.value("store", std::string());
+    if (path.empty()) {
+        throw std::invalid_argument("the result store is given by --store");
+    }
+    ParameterSpace space(arguments.parameter_values(), arguments.value("spread", float(.1)));
+    StrategyParameters strategy = arguments.strategy();
+    Ensemble ensemble(space, strategy);
+    bool sobol = arguments.value("sampling", std::string("sobol")) != "random";
+    int n_samples = arguments.value("samples", 1 << 16);
+    int batch_size = std::max(1, arguments.value("batch", 4096));
+    uint32_t seed = arguments.value("seed", 1);
+
+    std::vector<ResultStore::Column> columns{{"sample", ResultStore::int64, ResultStore::parameter}};
+    for (const ParameterRange &range : space.ranges()) {
+        columns.push_back({range.key, ResultStore::float32, ResultStore::parameter});
+    }
+    columns.push_back({"risk_strategy", ResultStore::float64, ResultStore::output});
+    columns.push_back({"risk_no_intervention", ResultStore::float64, ResultStore::output});
+    columns.push_back({"relative_risk", ResultStore::float32, ResultStore::output});
+    ResultStore::Writer writer(path, columns, n_samples);
+
+    auto start = std::chrono::steady_clock::now();
+    int n_batches = (n_samples + batch_size - 1) / batch_size;
+    Parallel::for_each(n_batches, [&](int batch) {
+        int first = batch * batch_size;
+        int n = std::min(batch_size, n_samples - first);
+        Eigen::MatrixXd unit_points = sobol ? SobolSequence(space.dimensions(), seed).points(first, n)
+                                            : PseudoRandom::points(space.dimensions(), first, n, seed);
+
+        Eigen::MatrixXd rows(n, columns.size());
+        for (int i = 0; i < n; ++i) {
+            std::map<std::string, float> values = space.values_at(unit_points.col(i));
+            Eigen::MatrixXf risks = ensemble.risks(DiseaseParameters::from_values(values), true);
+
+            int c = 0;
+            rows(i, c++) = first + i;
+            for (const ParameterRange &range : space.ranges()) {
+                rows(i, c++) = values[range.key];
+            }
+            rows(i, c++) = risks(0, 0);
+            rows(i, c++) = risks(0, 1);
+            rows(i, c++) = Ensemble::relative_risk(risks, strategy.expected_adherence)(0);
+        }
+        writer.write(first, rows);
+    });
+    writer.close();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%d scenarios in %.2f s (%.0f per s)\n", n_samples, elapsed.count(),
+                 n_samples / elapsed.count());
+    return 0;
+}
+
+// the names of the selected columns of a result store, as a CSV line
+std::string csv_header(const ResultStore &store, const std::vector<int> &selection) {
+    std::string line{};
+    for (int i = 0; i < (int)selection.size(); ++i) {
+        line += (i ? "," : "") + store.columns()[selection[i]].name;
+    }
+    return line + '\n';
+}
+
+// the selected columns of a row of a result store, as a CSV line
+std::string csv_row(const ResultStore &store, int64_t row, const std::vector<int> &selection) {
+    char buffer[32];
+    std::string line{};
+    for (int i = 0; i < (int)selection.size(); ++i) {
+        ResultStore::Type type = store.columns()[selection[i]].type;
+        // enough digits to read the floating point values back exactly
+        const char *format = type == ResultStore::float32   ? "%.9g"
+                             : type == ResultStore::float64 ? "%.17g"
+                                                            : "%.0f";
+        std::snprintf(buffer, sizeof(buffer), format, store.value(row, selection[i]));
+        line += i ? "," : "";
+        line += buffer;
+    }
+    return line + '\n';
+}
+
+// columns of a result store with their minimum, mean and maximum
+int store_info(const CommandLine::Arguments &arguments) {
+    ResultStore store(arguments.value("store", std::string()));
+
+    auto start = std::chrono::steady_clock::now();
+    std::printf("column,type,role,min,mean,max\n");
+    for (int c = 0; c < (int)store.columns().size(); ++c) {
+        const ResultStore::Column &column = store.columns()[c];
+        double min = INFINITY, max = -INFINITY, sum = 0;
+        auto summarize = [&](const auto *values) {
+            for (int64_t row = 0; row < store.n_rows(); ++row) {
+                double value = values[row];
+                min = std::min(min, value);
+                max = std::max(max, value);
+                sum += value;
+            }
+        };
+        switch (column.type) {
+        case ResultStore::int32:
+            summarize(store.data<int32_t>(c));
+            break;
+        case ResultStore::int64:
+            summarize(store.data<int64_t>(c));
+            break;
+        case ResultStore::float32:
+            summarize(store.data<float>(c));
+            break;
+        default:
+            summarize(store.data<double>(c));
+            break;
+        }
+        std::printf("%s,%s,%s,%g,%g,%g\n", column.name.c_str(), ResultStore::type_name(column.type),
+                    column.role == ResultStore::parameter ? "parameter" : "output", min, sum / store.n_rows(), max);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%lld of %lld rows, %.1f MB, scanned in %.3f s\n", (long long)store.n_rows(),
+                 (long long)store.capacity(), store.size() / 1e6, elapsed.count());
+    return 0;
+}
+
+// a result store as CSV, optionally restricted to the columns given by --columns
+int store_csv(const CommandLine::Arguments &arguments) {
+    ResultStore store(arguments.value("store", std::string()));
+    std::ofstream output_file;
+    if (arguments.has("output")) {
+        output_file.open(arguments.value("output", std::string()));
+    }
+    std::ostream &output = arguments.has("output") ? output_file : std::cout;
+
+    std::vector<int> selection{};
+    std::stringstream stream(arguments.value("columns", std::string()));
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        selection.push_back(store.column_index(name));
+    }
+    if (selection.empty()) {
+        for (int c = 0; c < (int)store.columns().size(); ++c) {
+            selection.push_back(c);
+        }
+    }
+
+    output << csv_header(store, selection);
+    for (int64_t row = 0; row < store.n_rows(); ++row) {
+        output << csv_row(store, row, selection);
+    }
+    if (!output) {
+        throw std::runtime_error("cannot write the CSV file");
+    }
+    return 0;
+}
+
+// the strategies of the grid given by --modes, --delays, --max-duration and --max-tests, with full adherence
+std::vector<StrategyParameters> strategy_grid(const CommandLine::Arguments &arguments, int default_max_tests) {
+    std::vector<int> modes = arguments.has("modes") ? arguments.values("modes") : std::vector<int>{0, 1};
+    std::vector<int> delays = arguments.has("delays") ? arguments.values("delays") : std::vector<int>{0, 1, 2, 3, 4, 5};
+    int max_duration = arguments.value("max-duration", 14);
+    int max_tests = arguments.value("max-tests", default_max_tests);
+
+    std::vector<StrategyParameters> strategies{};
+    std::vector<int> days{};
+    std::function<void(StrategyParameters &, int)> add_schedules = [&](StrategyParameters &strategy, int first_day) {
+        for (int test_type : days.empty() ? std::vector<int>{0} : std::vector<int>{0, 1}) {
+            strategy.test_type = test_type;
+            strategy.test_moments.clear();
+            for (int day : days) {
+                strategy.test_moments.push_back(strategy.time_delay + day);
+            }
+            strategies.push_back(strategy);
+        }
+        for (int day = first_day; day <= strategy.end_of_strategy && (int)days.size() < max_tests; ++day) {
+            days.push_back(day);
+            add_schedules(strategy, day + 1);
+            days.pop_back();
+        }
+    };
+    for (int mode : modes) {
+        for (bool symptomatic_screening : {true, false}) {
+            for (int delay : delays) {
+                for (int duration = 0; duration <= max_duration; ++duration) {
+                    StrategyParameters strategy;
+                    strategy.mode = mode;
+                    strategy.symptomatic_screening = symptomatic_screening;
+                    strategy.time_delay = delay;
+                    strategy.end_of_strategy = duration;
+                    add_schedules(strategy, 0);
+                }
+            }
+        }
+    }
+    return strategies;
+}
+
+// relative risk and released fraction at the end of every strategy of a grid, written to a result store and indexed
+int strategy_sweep(const CommandLine::Arguments &arguments) {
+    std::string path = arguments.value("store", std::string());
+    if (path.empty()) {
+        throw std::invalid_argument("the result store is given by --store");
+    }
+    std::map<std::string, float> values = arguments.parameter_values();
+    DiseaseParameters parameters = DiseaseParameters::from_values(values);
+    std::vector<int> adherences =
+        arguments.has("adherences") ? arguments.values("adherences") : std::vector<int>{100, 90, 80, 70, 60, 50};
+    std::unique_ptr<TrajectoryArchive::Writer> trajectories{};
+    if (arguments.has("trajectories")) {
+        TrajectoryArchive::Coding coding = arguments.has("lossless") ? TrajectoryArchive::lossless
+                                                                     : TrajectoryArchive::quantised;
+        trajectories = std::make_unique<TrajectoryArchive::Writer>(arguments.value("trajectories", std::string()),
+                                                                   coding, arguments.value("tolerance", 1e-6f));
+    }
+
+    // the strategies with full adherence; the adherence only enters the relative risk, see below
+    std::vector<StrategyParameters> strategies = strategy_grid(arguments, 2);
+
+    std::vector<ResultStore::Column> columns{};
+    for (const std::string &name : ParameterIndex::columns) {
+        ResultStore::Type type = name == "test_days" || name == "rdt_days" ? ResultStore::int64
+                                 : name == "adherence" ? ResultStore::float32
+                                                       : ResultStore::int32;
+        columns.push_back({name, type, ResultStore::parameter});
+    }
+    for (const auto &[name, value] : values) {
+        columns.push_back({name, ResultStore::float32, ResultStore::parameter});
+    }
+    for (std::string output : {"relative_risk", "released"}) {
+        for (std::string scenario : {"_typical", "_best", "_worst"}) {
+            columns.push_back({output + scenario, ResultStore::float32, ResultStore::output});
+        }
+    }
+    if (trajectories) { // the first of the six trajectories of the strategy in the archive
+        columns.push_back({"trajectory", ResultStore::int64, ResultStore::output});
+    }
+    int n_adherences = adherences.size();
+    ResultStore::Writer writer(path, columns, int64_t(strategies.size()) * n_adherences);
+
+    auto start = std::chrono::steady_clock::now();
+    const int batch_size = 256; // strategies
+    int n_batches = (strategies.size() + batch_size - 1) / batch_size;
+    Parallel::for_each(n_batches, [&](int batch) {
+        int first = batch * batch_size;
+        int n = std::min<int>(batch_size, strategies.size() - first);
+        Eigen::MatrixXd rows(n * n_adherences, columns.size());
+        for (int i = 0; i < n; ++i) {
+            StrategyParameters strategy = strategies[first + i];
+            Simulation simulation(parameters, strategy, Eigen::VectorXf(),
+                                  trajectories ? Simulation::all_outputs : Simulation::end_of_strategy_outputs);
+            Eigen::MatrixXf relative_risks = simulation.relative_risk();
+            Eigen::VectorXf relative_risk = relative_risks.row(relative_risks.rows() - 1);
+            Eigen::VectorXf released = simulation.get_p_infectious_tend();
+            int64_t trajectory = -1;
+            if (trajectories) { // the states with the strategy, then without intervention, per scenario
+                std::vector<Eigen::MatrixXf> states{};
+                for (int scenario = 0; scenario < 3; ++scenario) {
+                    states.push_back(simulation.get_strategy_states(scenario));
+                }
+                for (int scenario = 0; scenario < 3; ++scenario) {
+                    states.push_back(simulation.get_states_no_intervention(scenario));
+                }
+                trajectory = trajectories->append(states);
+            }
+
+            for (int a = 0; a < n_adherences; ++a) {
+                strategy.expected_adherence = adherences[a] / 100.;
+                ParameterIndex::Key key = ParameterIndex::key(strategy);
+                int r = i * n_adherences + a;
+                int c = 0;
+                for (double value : {double(key.mode), double(key.symptomatic_screening), double(key.time_delay),
+                                     double(key.end_of_strategy), double(key.test_days), double(key.rdt_days),
+                                     double(key.test_type), double(key.adherence)}) {
+                    rows(r, c++) = value;
+                }
+                for (const auto &[name, value] : values) {
+                    rows(r, c++) = value;
+                }
+                // relative risk = a^2 * relative risk with full adherence + 1 - a^2, see Simulation::relative_risk
+                float a2 = key.adherence * key.adherence;
+                for (int scenario = 0; scenario < 3; ++scenario) {
+                    rows(r, c++) = a2 * relative_risk(scenario) + 1 - a2;
+                }
+                for (int scenario = 0; scenario < 3; ++scenario) {
+                    rows(r, c++) = released(scenario);
+                }
+                if (trajectories) {
+                    rows(r, c++) = trajectory;
+                }
+            }
+        }
+        writer.write(int64_t(first) * n_adherences, rows);
+    });
+    writer.close();
+    if (trajectories) {
+        trajectories->close();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    ParameterIndex::build(ResultStore(path), ParameterIndex::path(path));
+    std::chrono::duration<double> elapsed_index = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%d strategies, %lld rows in %.2f s; index in %.3f s\n", (int)strategies.size(),
+                 (long long)strategies.size() * n_adherences, elapsed.count(), elapsed_index.count());
+    return 0;
+}
+
+// (re)builds the parameter index of a result store of a strategy sweep
+int store_index(const CommandLine::Arguments &arguments) {
+    std::string path = arguments.value("store", std::string());
+    ResultStore store(path);
+
+    auto start = std::chrono::steady_clock::now();
+    ParameterIndex::build(store, ParameterIndex::path(path));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr, "%lld rows indexed in %.3f s\n", (long long)store.n_rows(), elapsed.count());
+    return 0;
+}
+
+/* the stored results of the strategy, or of the closest stored strategy; with --range-duration and
+ * --range-adherence (in %) all stored results within these ranges
+ */
+int store_lookup(const CommandLine::Arguments &arguments) {
+    std::string path = arguments.value("store", std::string());
+    ResultStore store(path);
+    ParameterIndex index(ParameterIndex::path(path));
+    if (index.n_store_rows() != store.n_rows()) {
+        throw std::runtime_error("the index is out of date, rebuild it with --store-index");
+    }
+    std::vector<int> selection(store.columns().size());
+    for (int c = 0; c < (int)selection.size(); ++c) {
+        selection[c] = c;
+    }
+
+    ParameterIndex::Key key = ParameterIndex::key(arguments.strategy());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int64_t> rows{};
+    float distance = 0;
+    if (arguments.has("range-duration") || arguments.has("range-adherence")) {
+        ParameterIndex::Key lower = key, upper = key;
+        std::vector<int> durations = arguments.values("range-duration");
+        std::vector<int> adherences = arguments.values("range-adherence");
+        if (durations.size() == 2) {
+            lower.end_of_strategy = durations[0];
+            upper.end_of_strategy = durations[1];
+        }
+        if (adherences.size() == 2) {
+            lower.adherence = adherences[0] / 100.f - 5e-5f;
+            upper.adherence = adherences[1] / 100.f + 5e-5f;
+        }
+        rows = index.range(lower, upper);
+    } else {
+        int64_t row = index.find(key);
+        if (row < 0) {
+            row = index.nearest(key, &distance);
+        }
+        if (row >= 0) {
+            rows.push_back(row);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%s", csv_header(store, selection).c_str());
+    for (int64_t row : rows) {
+        std::printf("%s", csv_row(store, row, selection).c_str());
+    }
+    std::fprintf(stderr, "%d of %lld rows%s in %.1f us\n", (int)rows.size(), (long long)store.n_rows(),
+                 distance > 0 ? (", nearest strategy at distance " + std::to_string(distance)).c_str() : "",
+                 elapsed.count() * 1e6);
+    return rows.empty() ? 1 : 0;
+}
+
+// the states of a trajectory of an archive as CSV, one row per time point
+int trajectory_csv(const CommandLine::Arguments &arguments) {
+    TrajectoryArchive archive(arguments.value("trajectories", std::string()));
+    int64_t trajectory = arguments.value("trajectory", 0);
+    Eigen::MatrixXf states = archive.trajectory(trajectory);
+
+    std::printf("row");
+    for (int c = 0; c < states.cols(); ++c) {
+        std::printf(",compartment_%d", c);
+    }
+    std::printf("\n");
+    for (int t = 0; t < states.rows(); ++t) {
+        std::printf("%d", t);
+        for (int c = 0; c < states.cols(); ++c) {
+            std::printf(",%.9g", states(t, c));
+        }
+        std::printf("\n");
+    }
+    std::fprintf(stderr, "trajectory %lld of %lld: %d x %d states in %llu bytes\n", (long long)trajectory,
+                 (long long)archive.n_trajectories(), (int)states.rows(), (int)states.cols(),
+                 (unsigned long long)archive.chunk_size(trajectory));
+    return 0;
+}
+
+// compression ratio and throughput of trajectory archives of the states of a grid of strategies
+int benchmark_trajectories(const CommandLine::Arguments &arguments) {
+    DiseaseParameters parameters = DiseaseParameters::from_values(arguments.parameter_values());
+    std::vector<StrategyParameters> strategies = strategy_grid(arguments, 1);
+    std::string path = arguments.value("trajectories", std::string("trajectories.benchmark"));
+
+    // the six trajectories of every strategy, as written by --strategy-sweep
+    std::vector<Eigen::MatrixXf> states(6 * strategies.size());
+    Parallel::for_each(strategies.size(), [&](int s) {
+        Simulation simulation(parameters, strategies[s]);
+        for (int scenario = 0; scenario < 3; ++scenario) {
+            states[6 * s + scenario] = simulation.get_strategy_states(scenario);
+            states[6 * s + 3 + scenario] = simulation.get_states_no_intervention(scenario);
+        }
+    });
+    double raw_size = 0;
+    for (const Eigen::MatrixXf &trajectory : states) {
+        raw_size += sizeof(float) * trajectory.size();
+    }
+
+    std::printf("coding,tolerance,raw_MB,archive_MB,ratio,ratio_unshared,encode_GB_per_s,decode_GB_per_s,max_error\n");
+    for (double tolerance : {0., 1e-4, 1e-6, 1e-8}) {
+        TrajectoryArchive::Coding coding = tolerance > 0 ? TrajectoryArchive::quantised : TrajectoryArchive::lossless;
+        auto start = std::chrono::steady_clock::now();
+        {
+            TrajectoryArchive::Writer writer(path, coding, tolerance);
+            for (size_t s = 0; s < strategies.size(); ++s) {
+                writer.append(std::vector<Eigen::MatrixXf>(states.begin() + 6 * s, states.begin() + 6 * s + 6));
+            }
+        }
+        std::chrono::duration<double> encoding = std::chrono::steady_clock::now() - start;
+
+        TrajectoryArchive archive(path);
+        double unshared_size = 0;
+        float max_error = 0;
+        Eigen::MatrixXf decoded;
+        for (int64_t i = 0; i < archive.n_trajectories(); ++i) {
+            unshared_size += archive.chunk_size(i);
+            archive.trajectory(i, decoded);
+            max_error = std::max(max_error, (decoded - states[i]).cwiseAbs().maxCoeff());
+        }
+
+        // decodes every trajectory, repeatedly for at least half a second
+        int repetitions = 0;
+        std::chrono::duration<double> decoding{0};
+        start = std::chrono::steady_clock::now();
+        while (decoding.count() < .5) {
+            for (int64_t i = 0; i < archive.n_trajectories(); ++i) {
+                archive.trajectory(i, decoded);
+            }
+            ++repetitions;
+            decoding = std::chrono::steady_clock::now() - start;
+        }
+        std::printf("%s,%g,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%g\n", tolerance > 0 ? "quantised" : "lossless", tolerance,
+                    raw_size / 1e6, archive.size() / 1e6, raw_size / archive.size(), raw_size / unshared_size,
+                    raw_size / encoding.count() / 1e9, repetitions * raw_size / decoding.count() / 1e9, max_error);
+    }
+    std::remove(path.c_str());
+    std::fprintf(stderr, "%d strategies, %d trajectories\n", (int)strategies.size(), (int)states.size());
+    return 0;
+}
+
+// the server that SIGINT and SIGTERM stop
+QueryServer *serving = nullptr;
+
+void stop_serving(int) {
+    if (serving) {
+        serving->stop();
+    }
+}
+
+// answers JSON strategy queries on a local socket until interrupted
+int serve(const CommandLine::Arguments &arguments) {
+    QueryService service(std::chrono::microseconds(arguments.value("window", 500)), arguments.value("max-batch", 256));
+    std::unique_ptr<QueryServer> server =
+        arguments.has("socket") ? std::make_unique<QueryServer>(service, arguments.value("socket", std::string()))
+                                : std::make_unique<QueryServer>(service, arguments.value("port", 7878));
+    std::fprintf(stderr, "serving on %s\n",
+                 arguments.has("socket") ? arguments.value("socket", std::string()).c_str()
+                                         : ("127.0.0.1:" + std::to_string(server->port())).c_str());
+    serving = server.get();
+    std::signal(SIGINT, stop_serving);
+    std::signal(SIGTERM, stop_serving);
+    server->run();
+    serving = nullptr;
+
+    QueryService::Statistics statistics = service.statistics();
+    std::fprintf(stderr, "%llu queries (%llu errors, %llu coalesced), %llu evaluations in %llu batches\n",
+                 (unsigned long long)statistics.queries, (unsigned long long)statistics.errors,
+                 (unsigned long long)statistics.coalesced, (unsigned long long)statistics.evaluations,
+                 (unsigned long long)statistics.batches);
+    return 0;
+}
+
+// a query for the strategy, in the fields of the QueryService
+std::string query(const StrategyParameters &strategy, int64_t id) {
+    std::string text = "{\"id\": " + std::to_string(id) + ", \"mode\": " + std::to_string(strategy.mode) +
+                       ", \"delay\": " + std::to_string(strategy.time_delay) +
+                       ", \"duration\": " + std::to_string(strategy.end_of_strategy) + ", \"tests\": [";
+    for (size_t i = 0; i < strategy.test_moments.size(); ++i) {
+        text += (i ? ", " : "") + std::to_string(strategy.test_moments[i] - strategy.time_delay);
+    }
+    return text + "], \"test_type\": \"" + (strategy.test_type ? "rdt" : "pcr") +
+           "\", \"screening\": " + (strategy.symptomatic_screening ? "true" : "false") + "}";
+}
+
+/* latency of the query server under a constant rate of queries: a server on a local socket and --connections clients
+ * that send the strategies of the grid in random order, without waiting for the answers. With --burst all clients send
+ * the same strategy at about the same time, as dashboards that refresh together.
+ */
+int benchmark_serve(const CommandLine::Arguments &arguments) {
+    std::vector<StrategyParameters> strategies = strategy_grid(arguments, 1);
+    std::mt19937_64 generator(arguments.value("seed", 1));
+    std::shuffle(strategies.begin(), strategies.end(), generator);
+    strategies.resize(std::min<size_t>(strategies.size(), arguments.value("distinct", 1000)));
+    int n_connections = arguments.value("connections", 8);
+    double rate = arguments.value("rate", float(1000.)) / n_connections; // per connection, per second
+    int n_queries = int(rate * arguments.value("seconds", float(5.)));
+
+    QueryService service(std::chrono::microseconds(arguments.value("window", 500)), arguments.value("max-batch", 256));
+    std::string socket_path = arguments.value("socket", std::string("/tmp/CovidStrategyCalculator.benchmark"));
+    std::unique_ptr<QueryServer> server = arguments.has("port")
+                                              ? std::make_unique<QueryServer>(service, arguments.value("port", 0))
+                                              : std::make_unique<QueryServer>(service, socket_path);
+    std::thread server_thread([&]() { server->run(); });
+
+    // microseconds from sending a query to receiving its answer, per connection and query
+    std::vector<std::vector<double>> latencies(n_connections, std::vector<double>(n_queries, -1));
+    std::atomic<int> errors{0};        // answers to no query that was sent
+    std::atomic<int> error_answers{0}; // e.g. of strategies whose fold risk reduction is not finite
+    std::clock_t cpu_start = std::clock(); // of the process, server and clients
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients{};
+    for (int c = 0; c < n_connections; ++c) {
+        clients.emplace_back([&, c]() {
+            std::unique_ptr<QueryClient> client = arguments.has("port")
+                                                      ? std::make_unique<QueryClient>(server->port())
+                                                      : std::make_unique<QueryClient>(socket_path);
+            std::vector<std::atomic<int64_t>> sent(n_queries); // nanoseconds since start
+            std::thread receiver([&]() {
+                std::string answer;
+                while (client->receive(answer)) {
+                    int64_t id = std::strtoll(answer.c_str() + answer.find(':') + 1, nullptr, 10);
+                    if (id < 0 || id >= n_queries) {
+                        ++errors;
+                        continue;
+                    }
+                    error_answers += answer.find("\"error\"") != std::string::npos;
+                    auto now = std::chrono::steady_clock::now() - start;
+                    latencies[c][id] = (std::chrono::nanoseconds(now).count() - sent[id]) / 1e3;
+                }
+            });
+            // the queries of the connections are interleaved, at evenly spaced times, unless they come in bursts
+            double offset = arguments.has("burst") ? 0 : double(c) / n_connections;
+            for (int i = 0; i < n_queries; ++i) {
+                auto time = start + std::chrono::duration<double>((i + offset) / rate);
+                std::this_thread::sleep_until(time);
+                sent[i] = std::chrono::nanoseconds(std::chrono::steady_clock::now() - start).count();
+                int strategy = arguments.has("burst") ? i : i * n_connections + c;
+                client->send(query(strategies[strategy % strategies.size()], i));
+            }
+            client->finish();
+            receiver.join();
+        });
+    }
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    server->stop();
+    server_thread.join();
+    double cpu_seconds = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    std::vector<double> answered{};
+    for (const std::vector<double> &connection : latencies) {
+        std::copy_if(connection.begin(), connection.end(), std::back_inserter(answered),
+                     [](double latency) { return latency >= 0; });
+    }
+    std::sort(answered.begin(), answered.end());
+    auto percentile = [&](double p) { return answered.empty() ? NAN : answered[size_t(p * (answered.size() - 1))]; };
+    QueryService::Statistics statistics = service.statistics();
+    std::printf("connections,rate,queries,answered,error_answers,errors,evaluations,coalesced,throughput,mean_batch,"
+                "cpu_s,p50_ms,p90_ms,p99_ms,max_ms\n");
+    std::printf("%d,%g,%d,%d,%d,%d,%llu,%llu,%.0f,%.1f,%.2f,%.3f,%.3f,%.3f,%.3f\n", n_connections,
+                rate * n_connections, n_queries * n_connections, (int)answered.size(), error_answers.load(),
+                errors.load(), (unsigned long long)statistics.evaluations, (unsigned long long)statistics.coalesced,
+                answered.size() / elapsed.count(),
+                double(statistics.evaluations) / std::max<uint64_t>(statistics.batches, 1), cpu_seconds,
+                percentile(.5) / 1e3, percentile(.9) / 1e3, percentile(.99) / 1e3, percentile(1) / 1e3);
+    std::fprintf(stderr, "%d distinct strategies, %d threads\n", (int)strategies.size(), Parallel::n_threads());
+    return 0;
+}
+
+const std::map<std::string, std::function<int(const CommandLine::Arguments &)>> commands{
+    {"--ensemble", ensemble},
+    {"--benchmark-sampling", benchmark_sampling},
+    {"--sensitivity", sensitivity},
+    {"--jacobian", jacobian},
+    {"--simulate", simulate},
+    {"--calibrate", calibrate},
+    {"--screening", screening},
+    {"--prevalence-batch", prevalence_batch},
+    {"--benchmark-ingestion", benchmark_ingestion},
+    {"--rolling-prevalence", rolling_prevalence},
+    {"--traveller-policy", traveller_policy},
+    {"--cohort", cohort},
+    {"--exposure-mixture", exposure_mixture},
+    {"--agents", agents},
+    {"--timeline", timeline},
+    {"--sweep", sweep},
+    {"--store-info", store_info},
+    {"--store-csv", store_csv},
+    {"--strategy-sweep", strategy_sweep},
+    {"--store-index", store_index},
+    {"--store-lookup", store_lookup},
+    {"--trajectory-csv", trajectory_csv},
+    {"--benchmark-trajectories", benchmark_trajectories},
+    {"--serve", serve},
+    {"--benchmark-serve", benchmark_serve},
+};
+} // namespace
+
+bool CommandLine::is_command(const std::string &argument) { return commands.count(argument); }
+
+int CommandLine::run(int argc, char *argv[]) {
+    try {
+        return commands.at(argv[1])(Arguments(argc, argv));
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], e.what());
+        return 2;
+    }
+}
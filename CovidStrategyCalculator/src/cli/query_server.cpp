@@ -0,0 +1,344 @@
+/* query_server.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the QueryServer class with non-blocking sockets and poll(). The threads of the QueryService
+ * post their answers to the outbox and wake the server through a pipe; only the server thread touches the sockets.
+ */
+
+#include "include/cli/query_server.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+QueryServer::QueryServer(QueryService &service, int) : service_(service) {
+    throw std::runtime_error("the query server is not available on Windows");
+}
+QueryServer::QueryServer(QueryService &service, const std::string &) : service_(service) {
+    throw std::runtime_error("the query server is not available on Windows");
+}
+QueryServer::~QueryServer() = default;
+void QueryServer::run() {}
+void QueryServer::stop() {}
+
+QueryClient::QueryClient(int) { throw std::runtime_error("the query client is not available on Windows"); }
+QueryClient::QueryClient(const std::string &) {
+    throw std::runtime_error("the query client is not available on Windows");
+}
+QueryClient::~QueryClient() = default;
+void QueryClient::send(const std::string &) {}
+bool QueryClient::receive(std::string &) { return false; }
+void QueryClient::finish() {}
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+#ifdef MSG_NOSIGNAL
+const int send_flags = MSG_NOSIGNAL; // a closed connection fails the send instead of raising SIGPIPE
+#else
+const int send_flags = 0;
+#endif
+const size_t max_line = 1 << 20; // a connection that sends a longer line is closed
+
+void set_non_blocking(int descriptor) { fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK); }
+} // namespace
+
+QueryServer::QueryServer(QueryService &service, int port) : service_(service), outbox_(std::make_shared<Outbox>()) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    if (listener >= 0) {
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    listen_on(listener, &address, sizeof(address), "port " + std::to_string(port));
+
+    socklen_t size = sizeof(address);
+    getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &size);
+    port_ = ntohs(address.sin_port);
+}
+
+QueryServer::QueryServer(QueryService &service, const std::string &socket_path)
+    : service_(service), outbox_(std::make_shared<Outbox>()) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("invalid socket path " + socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    struct stat status;
+    if (stat(socket_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(socket_path.c_str()); // left by a server that did not shut down
+    }
+    listen_on(socket(AF_UNIX, SOCK_STREAM, 0), &address, sizeof(address), socket_path);
+    socket_path_ = socket_path;
+}
+
+void QueryServer::listen_on(int socket, const void *address, unsigned address_size, const std::string &name) {
+    listener_ = socket;
+    if (listener_ < 0 || bind(listener_, static_cast<const sockaddr *>(address), address_size) != 0 ||
+        listen(listener_, SOMAXCONN) != 0 || pipe(wake_pipe_) != 0) {
+        std::string error = std::strerror(errno);
+        if (listener_ >= 0) {
+            close(listener_);
+        }
+        throw std::runtime_error("cannot listen on " + name + ": " + error);
+    }
+    set_non_blocking(listener_);
+    set_non_blocking(wake_pipe_[0]);
+    set_non_blocking(wake_pipe_[1]);
+    outbox_->wake = wake_pipe_[1];
+}
+
+QueryServer::~QueryServer() {
+    {
+        std::lock_guard<std::mutex> lock(outbox_->mutex);
+        outbox_->wake = -1; // answers that arrive later are dropped
+    }
+    for (auto &[id, connection] : connections_) {
+        close(connection.socket);
+    }
+    close(listener_);
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+    if (!socket_path_.empty()) {
+        unlink(socket_path_.c_str());
+    }
+}
+
+void QueryServer::stop() {
+    stopping_ = true;
+    char byte = 0;
+    [[maybe_unused]] ssize_t written = write(wake_pipe_[1], &byte, 1); // async-signal-safe
+}
+
+void QueryServer::run() {
+    std::vector<pollfd> descriptors{};
+    std::vector<uint64_t> ids{};
+    std::vector<std::pair<uint64_t, std::string>> answers{};
+    while (!stopping_) {
+        descriptors.assign({{wake_pipe_[0], POLLIN, 0}, {listener_, POLLIN, 0}});
+        ids.clear();
+        for (const auto &[id, connection] : connections_) {
+            short events = (connection.finished ? 0 : POLLIN) | (connection.output.empty() ? 0 : POLLOUT);
+            if (events) { // a finished connection waits for its answers without being polled
+                descriptors.push_back({connection.socket, events, 0});
+                ids.push_back(id);
+            }
+        }
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+        }
+
+        if (descriptors[0].revents) {
+            char buffer[256];
+            while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(outbox_->mutex);
+            answers.swap(outbox_->answers);
+        }
+        for (auto &[id, answer] : answers) {
+            auto connection = connections_.find(id);
+            if (connection != connections_.end()) { // otherwise closed meanwhile
+                connection->second.output += answer;
+                connection->second.output += '\n';
+                --connection->second.pending;
+            }
+        }
+        answers.clear();
+
+        for (size_t i = 0; i < ids.size(); ++i) {
+            Connection &connection = connections_.at(ids[i]);
+            bool open = !(descriptors[i + 2].revents & (POLLERR | POLLNVAL));
+            if (open && descriptors[i + 2].revents & (POLLIN | POLLHUP)) {
+                open = receive(ids[i], connection);
+            }
+            if (!open) {
+                close(connection.socket);
+                connections_.erase(ids[i]);
+            }
+        }
+        for (auto connection = connections_.begin(); connection != connections_.end();) {
+            const Connection &state = connection->second;
+            bool failed = !state.output.empty() && !send(connection->second);
+            if (failed || (state.finished && !state.pending && state.output.empty())) {
+                close(state.socket);
+                connection = connections_.erase(connection);
+            } else {
+                ++connection;
+            }
+        }
+        if (descriptors[1].revents & POLLIN) {
+            accept_connections();
+        }
+    }
+}
+
+void QueryServer::accept_connections() {
+    int socket;
+    while ((socket = accept(listener_, nullptr, nullptr)) >= 0) {
+        set_non_blocking(socket);
+        int no_delay = 1; // answers are short and latency matters; fails harmlessly on Unix sockets
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+#ifdef SO_NOSIGPIPE
+        int no_sigpipe = 1;
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+        connections_.emplace(next_id_++, Connection{socket});
+    }
+}
+
+bool QueryServer::receive(uint64_t id, Connection &connection) {
+    char buffer[1 << 16];
+    ssize_t size;
+    while ((size = recv(connection.socket, buffer, sizeof(buffer), 0)) > 0) {
+        connection.input.append(buffer, size);
+    }
+    if (size == 0) {
+        connection.finished = true; // the answers of its queries are still sent
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        return false;
+    }
+
+    size_t begin = 0, end;
+    while ((end = connection.input.find('\n', begin)) != std::string::npos) {
+        std::string line = connection.input.substr(begin, end - begin);
+        begin = end + 1;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        ++connection.pending;
+        std::shared_ptr<Outbox> outbox = outbox_;
+        service_.submit(line, [outbox, id](const std::string &answer) {
+            std::lock_guard<std::mutex> lock(outbox->mutex);
+            if (outbox->wake < 0) {
+                return;
+            }
+            if (outbox->answers.empty()) { // otherwise the server is woken already
+                char byte = 0;
+                [[maybe_unused]] ssize_t written = write(outbox->wake, &byte, 1);
+            }
+            outbox->answers.emplace_back(id, answer);
+        });
+    }
+    connection.input.erase(0, begin);
+    return connection.input.size() <= max_line;
+}
+
+bool QueryServer::send(Connection &connection) {
+    size_t sent = 0;
+    while (sent < connection.output.size()) {
+        ssize_t size = ::send(connection.socket, connection.output.data() + sent, connection.output.size() - sent,
+                              send_flags);
+        if (size < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break; // continued when the socket is writable
+            }
+            return false;
+        }
+        sent += size;
+    }
+    connection.output.erase(0, sent);
+    return true;
+}
+
+QueryClient::QueryClient(int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_ < 0 || connect(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        std::string error = std::strerror(errno);
+        if (socket_ >= 0) {
+            close(socket_);
+        }
+        throw std::runtime_error("cannot connect to port " + std::to_string(port) + ": " + error);
+    }
+    int no_delay = 1;
+    setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+}
+
+QueryClient::QueryClient(const std::string &socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("invalid socket path " + socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_ < 0 || connect(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        std::string error = std::strerror(errno);
+        if (socket_ >= 0) {
+            close(socket_);
+        }
+        throw std::runtime_error("cannot connect to " + socket_path + ": " + error);
+    }
+}
+
+QueryClient::~QueryClient() { close(socket_); }
+
+void QueryClient::send(const std::string &query) {
+    std::string line = query + '\n';
+    for (size_t sent = 0; sent < line.size();) {
+        ssize_t size = ::send(socket_, line.data() + sent, line.size() - sent, send_flags);
+        if (size < 0 && errno != EINTR) {
+            throw std::runtime_error(std::string("cannot send the query: ") + std::strerror(errno));
+        }
+        sent += std::max<ssize_t>(size, 0);
+    }
+}
+
+bool QueryClient::receive(std::string &answer) {
+    size_t end;
+    while ((end = input_.find('\n')) == std::string::npos) {
+        char buffer[1 << 16];
+        ssize_t size = recv(socket_, buffer, sizeof(buffer), 0);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        input_.append(buffer, size);
+    }
+    answer.assign(input_, 0, end);
+    input_.erase(0, end + 1);
+    return true;
+}
+
+void QueryClient::finish() { shutdown(socket_, SHUT_WR); }
+#endif
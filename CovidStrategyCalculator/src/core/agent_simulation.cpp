@@ -0,0 +1,269 @@
+/* agent_simulation.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the AgentSimulation class. The path of an individual is given by the times at which it enters
+ * each compartment, drawn at once for a block of individuals: the residence times are exponential, so a rate one
+ * exponential per compartment serves all three scenarios. Removal by a test or by symptomatic screening ends the
+ * presence of the individual, and the risk it poses is the time it spends in the infectious compartments. As in the
+ * Simulation class, the residual risk from an evaluation point on is that of the disease course without intervention.
+ */
+
+#include "include/core/agent_simulation.h"
+#include "include/core/parallel.h"
+#include "include/core/sobol_sequence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// sums over the individuals of a range of blocks, per scenario
+struct Sums {
+    Eigen::MatrixXd states_NPI;             // per evaluation point and compartment, see below
+    Eigen::MatrixXd states_no_intervention; // per day and compartment, see below
+    Eigen::VectorXd residual;               // residual risk x per evaluation point
+    Eigen::VectorXd residual_squared;       // x^2
+    Eigen::VectorXd residual_total;         // x * y
+    double total{};                         // risk without intervention y
+    double total_squared{};                 // y^2
+
+    Sums(int n_rows, int n_days)
+        : states_NPI(Eigen::MatrixXd::Zero(n_rows + 1, 21)),
+          states_no_intervention(Eigen::MatrixXd::Zero(n_days + 2, 21)), residual(Eigen::VectorXd::Zero(n_rows)),
+          residual_squared(Eigen::VectorXd::Zero(n_rows)), residual_total(Eigen::VectorXd::Zero(n_rows)) {}
+
+    void add(const Sums &other) {
+        states_NPI += other.states_NPI;
+        states_no_intervention += other.states_no_intervention;
+        residual += other.residual;
+        residual_squared += other.residual_squared;
+        residual_total += other.residual_total;
+        total += other.total;
+        total_squared += other.total_squared;
+    }
+};
+
+// length of the overlap of [a, b) and [c, d)
+inline double overlap(double a, double b, double c, double d) { return std::max(0., std::min(b, d) - std::max(a, c)); }
+} // namespace
+
+AgentSimulation::AgentSimulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                                 int n_agents, uint32_t seed, Eigen::VectorXf prevalence_states)
+    : Simulation(parameters), n_agents_(n_agents) {
+    if (n_agents < 1) {
+        throw std::invalid_argument("an agent-based simulation has at least one agent");
+    }
+    collect_strategy(strategy);
+    deduce_combined_parameters();
+    if ((mode == 2) && prevalence_states.size()) {
+        initial_states_no_intervention = prevalence_states;
+        initial_states_NPI = prevalence_states;
+        if (symptomatic_screening) {
+            apply_symptomatic_screening_to_initial_states();
+            initial_states_screened = true;
+        }
+    } else {
+        set_initial_states();
+    }
+
+    const int n_states = Model::n_compartments - 1; // without the risk node
+    const int first_infectious = Model::sub_compartments[0];
+    const int first_symptomatic = Model::sub_compartments[0] + Model::sub_compartments[1];
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // evaluation points as in Model::run: the day of a test appears before and after the test
+    std::vector<int> row_day{}, test_row{}; // per test, the evaluation point after the test
+    int day = 0;
+    for (int i = 0; i <= (int)t_test.size(); ++i) {
+        int last_day = i < (int)t_test.size() ? t_test[i] : t_end;
+        for (; day <= last_day; ++day) {
+            row_day.push_back(day);
+        }
+        day = last_day;
+        test_row.push_back(row_day.size());
+    }
+    int n_rows = row_day.size();
+    std::vector<int> first_row(t_end + 2, n_rows); // first evaluation point at or after each day
+    for (int r = n_rows - 1; r >= 0; --r) {
+        first_row[row_day[r]] = r;
+    }
+
+    // initial compartments, and the probability to be present in the strategy (symptomatic screening of prevalence)
+    double mass = initial_states_no_intervention.head(n_states).sum();
+    if (mass <= 0) {
+        throw std::invalid_argument("the initial states hold no infected individuals");
+    }
+    Eigen::VectorXd cumulative(n_states), kept(n_states);
+    double share = 0;
+    for (int c = 0; c < n_states; ++c) {
+        share += initial_states_no_intervention(c) / mass;
+        cumulative(c) = share;
+        kept(c) = initial_states_no_intervention(c) > 0 ? initial_states_NPI(c) / initial_states_no_intervention(c) : 0;
+    }
+
+    // inverse rates and false omission rates per scenario
+    std::vector<Eigen::VectorXd> inverse_rates{};
+    std::vector<std::vector<Eigen::VectorXd>> false_ommision_rates{};
+    for (const std::vector<float> &tau : {tau_mean_case, tau_best_case, tau_worst_case}) {
+        Eigen::VectorXd inverse_rate(n_states);
+        for (int phase = 0, c = 0; phase < 4; ++phase) {
+            for (int j = 0; j < Model::sub_compartments[phase]; ++j, ++c) {
+                inverse_rate(c) = tau[phase] / Model::sub_compartments[phase];
+            }
+        }
+        inverse_rates.push_back(inverse_rate);
+        Model model(tau, risk_posing_fraction_symptomatic_phase, initial_states_NPI, t_end, t_test, test_types,
+                    test_sensitivity, test_specificity);
+        false_ommision_rates.push_back({model.false_ommision_rate(0), model.false_ommision_rate(1)});
+    }
+
+    /* random numbers per individual: the initial compartment, the residence times, presence at the start, symptomatic
+     * screening and one per test
+     */
+    const int block_size = 4096;
+    const int n_dimensions = 1 + n_states + 2 + t_test.size();
+    int n_blocks = (n_agents + block_size - 1) / block_size;
+    int n_chunks = std::min(n_blocks, 256); // fixed, such that the sums do not depend on the number of threads
+    std::vector<std::vector<Sums>> chunk_sums(n_chunks, std::vector<Sums>(3, Sums(n_rows, t_end)));
+
+    /* The compartment of an individual changes at random times, so walking through the days branches unpredictably.
+     * The occupancy is therefore recorded as the first day (or evaluation point) in and out of each compartment, and
+     * accumulated over the days after the run.
+     */
+    Parallel::for_each(n_chunks, [&](int chunk) {
+        std::vector<Sums> &sums = chunk_sums[chunk];
+        double entry[21]; // time of entering each compartment; entering the risk node is leaving the disease course
+        int entry_day[21];
+        for (int block = chunk * n_blocks / n_chunks; block < (chunk + 1) * n_blocks / n_chunks; ++block) {
+            int first = block * block_size;
+            int n = std::min(block_size, n_agents - first);
+            Eigen::MatrixXd uniforms = PseudoRandom::points(n_dimensions, first, n, seed);
+            Eigen::ArrayXXd exponentials = -uniforms.middleRows(1, n_states).array().log();
+
+            for (int i = 0; i < n; ++i) {
+                int c0 = std::lower_bound(cumulative.data(), cumulative.data() + n_states, uniforms(0, i)) -
+                         cumulative.data();
+                c0 = std::min(c0, n_states - 1);
+                bool present_at_start = uniforms(n_states + 1, i) < kept(c0);
+                bool screened =
+                    c0 < first_symptomatic && uniforms(n_states + 2, i) >= risk_posing_fraction_symptomatic_phase;
+
+                for (int s = 0; s < 3; ++s) {
+                    Sums &sum = sums[s];
+                    entry[c0] = 0;
+                    entry_day[c0] = 0;
+                    for (int c = c0; c < n_states; ++c) {
+                        entry[c + 1] = entry[c] + exponentials(c, i) * inverse_rates[s](c);
+                        entry_day[c + 1] = std::min(double(t_end + 1), std::ceil(entry[c + 1]));
+                    }
+                    double infectious_begin = c0 <= first_infectious ? entry[first_infectious] : 0;
+                    double infectious_end = c0 < n_states - 1 ? entry[n_states - 1] : 0;
+                    double total = std::max(0., infectious_end - infectious_begin);
+                    sum.total += total;
+                    sum.total_squared += total * total;
+
+                    // without intervention
+                    for (int c = c0; c < n_states; ++c) {
+                        sum.states_no_intervention(entry_day[c], c) += 1;
+                        sum.states_no_intervention(entry_day[c + 1], c) -= 1;
+                    }
+                    for (int t = 0; t <= t_end; ++t) {
+                        sum.states_no_intervention(t, n_states) += overlap(infectious_begin, infectious_end, 0, t);
+                    }
+
+                    // with intervention: present at the evaluation points before the removal row
+                    double removal = present_at_start ? infinity : 0;
+                    int removal_row = present_at_start ? n_rows : 0;
+                    if (screened && entry[first_symptomatic] < removal) {
+                        removal = entry[first_symptomatic];
+                        removal_row = first_row[entry_day[first_symptomatic]];
+                    }
+                    for (int k = 0; k < (int)t_test.size(); ++k) {
+                        if (removal_row < test_row[k]) {
+                            break;
+                        }
+                        int c = c0;
+                        while (c < n_states && entry[c + 1] <= t_test[k]) {
+                            ++c;
+                        }
+                        if (uniforms(n_states + 3 + k, i) >= false_ommision_rates[s][test_types[k]](c)) {
+                            removal = t_test[k];
+                            removal_row = test_row[k];
+                        }
+                    }
+                    for (int c = c0; c < n_states; ++c) {
+                        sum.states_NPI(std::min(first_row[entry_day[c]], removal_row), c) += 1;
+                        sum.states_NPI(std::min(first_row[entry_day[c + 1]], removal_row), c) -= 1;
+                    }
+                    for (int r = 0; r < n_rows; ++r) {
+                        double t = row_day[r];
+                        double residual = r < removal_row ? overlap(infectious_begin, infectious_end, t, infinity) : 0;
+                        sum.states_NPI(r, n_states) +=
+                            overlap(infectious_begin, infectious_end, 0, std::min(t, removal));
+                        sum.residual(r) += residual;
+                        sum.residual_squared(r) += residual * residual;
+                        sum.residual_total(r) += residual * total;
+                    }
+                }
+            }
+        }
+    });
+
+    // the sums of the chunks in a fixed order, scaled from individuals to the initial states
+    double weight = mass / n_agents;
+    float adherence = expected_adherence;
+    Eigen::MatrixXf *states_no_intervention[] = {&states_mean_no_intervention, &states_best_no_intervention,
+                                                 &states_worst_no_intervention};
+    Eigen::MatrixXf *strategy_states[] = {&strategy_states_mean, &strategy_states_best, &strategy_states_worst};
+    risk_matrix_no_intervention.resize(n_rows, 3);
+    risk_matrix_NPI.resize(n_rows, 3);
+    relative_risk_standard_error_.resize(n_rows, 3);
+    for (int s = 0; s < 3; ++s) {
+        Sums sum(n_rows, t_end);
+        for (const std::vector<Sums> &sums : chunk_sums) {
+            sum.add(sums[s]);
+        }
+        for (Eigen::MatrixXd *states : {&sum.states_no_intervention, &sum.states_NPI}) {
+            for (int r = 1; r < states->rows(); ++r) { // from the changes in occupancy to the occupancy
+                states->row(r).head(n_states) += states->row(r - 1).head(n_states);
+            }
+        }
+        sum.states_no_intervention.col(n_states).array() += initial_states_no_intervention(n_states) / weight;
+        sum.states_NPI.col(n_states).array() += initial_states_NPI(n_states) / weight;
+        *states_no_intervention[s] = (weight * sum.states_no_intervention.topRows(t_end + 1)).cast<float>();
+        *strategy_states[s] = (weight * sum.states_NPI.topRows(n_rows)).cast<float>();
+
+        // see Simulation::risk_NPI
+        Eigen::VectorXd risk_NPI = weight * sum.residual;
+        double risk_no_intervention = weight * sum.total;
+        risk_matrix_no_intervention.col(s).fill(risk_no_intervention);
+        risk_matrix_NPI.col(s) =
+            (adherence * risk_NPI.array() + (1 - adherence) * risk_no_intervention).cast<float>().matrix();
+
+        /* the relative risk is a^2 x / y + 1 - a^2 for the means x and y of the residual risk and the risk without
+         * intervention; the variance of the ratio by the delta method
+         */
+        Eigen::ArrayXd ratio = sum.residual.array() / sum.total;
+        Eigen::ArrayXd variance = (sum.residual_squared.array() - 2 * ratio * sum.residual_total.array() +
+                                   ratio.square() * sum.total_squared) /
+                                  (sum.total * sum.total);
+        relative_risk_standard_error_.col(s) =
+            (adherence * adherence * variance.max(0).sqrt()).cast<float>().matrix();
+    }
+}
@@ -23,16 +23,27 @@
 #include "include/core/base_model.h"
 #include <unsupported/Eigen/MatrixFunctions>
 
+#include <algorithm>
+#include <stdexcept>
+
 const std::vector<int> BaseModel::sub_compartments = {3, 3, 13, 1, 1}; // number of sub compartments per phase
 const int BaseModel::n_compartments = 21;                              // sum of sub compartments
 
 // constructor
-BaseModel::BaseModel(std::vector<float> residence_times, float risk_posing_fraction_symptomatic_phase,
-                     Eigen::Vector<float, BaseModel::n_compartments> initial_states) {
+BaseModel::BaseModel(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+                     const Eigen::Vector<float, BaseModel::n_compartments> &initial_states) {
+    X0 = initial_states;
+    set_parameters(residence_times, risk_posing_fraction_symptomatic_phase);
+}
 
-    tau_ = residence_times;
+void BaseModel::set_parameters(const std::vector<float> &residence_times,
+                               float risk_posing_fraction_symptomatic_phase) {
+    if (residence_times.size() != tau_.size()) {
+        throw std::invalid_argument("expected a residence time per phase");
+    }
+    std::copy_n(residence_times.begin(), tau_.size(), tau_.begin());
     risk_posing_symptomatic_ = risk_posing_fraction_symptomatic_phase;
-    X0 = initial_states;
+    propagators_.clear();
 
     set_rates();
     set_S();
@@ -97,10 +108,64 @@ void BaseModel::set_A() {
     this->A_ = A_augmented;
 }
 
-Eigen::Vector<float, BaseModel::n_compartments> BaseModel::run_base(int time) { return (A_ * (float)time).exp() * X0; }
+Eigen::Vector<float, BaseModel::n_compartments> BaseModel::run_base(int time) const { return run_base(time, X0); }
 
 Eigen::Vector<float, BaseModel::n_compartments>
-BaseModel::run_base(int time, Eigen::Vector<float, BaseModel::n_compartments> initial_states) {
-    X0 = initial_states;
-    return run_base(time);
+BaseModel::run_base(int time, const Eigen::Vector<float, BaseModel::n_compartments> &initial_states) const {
+    if (time >= 0 && time < (int)propagators_.size()) {
+        return propagators_[time] * initial_states;
+    }
+    return (A_ * (float)time).exp() * initial_states;
+}
+
+void BaseModel::cache_propagators(int horizon) {
+    propagators_.resize(horizon + 1);
+    for (int time = 0; time <= horizon; ++time) {
+        propagators_[time] = (A_ * (float)time).exp();
+    }
+}
+
+Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments> BaseModel::propagator(int time) const {
+    return (A_.cast<double>() * time).exp();
+}
+
+std::vector<Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments>>
+BaseModel::generator_derivatives() const {
+    Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments> A = A_.cast<double>();
+    std::vector<Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments>> dA(n_base_parameters);
+
+    // rates = n / tau, so the transitions out of the compartments of phase i scale with -1 / tau_i
+    int first_compartment = 0;
+    for (int i = 0; i < 4; ++i) {
+        dA[i].setZero();
+        dA[i](Eigen::seq(0, Eigen::last - 1), Eigen::seqN(first_compartment, sub_compartments[i])) =
+            -A(Eigen::seq(0, Eigen::last - 1), Eigen::seqN(first_compartment, sub_compartments[i])) / tau_[i];
+        first_compartment += sub_compartments[i];
+    }
+
+    int first_symptomatic_compartment = sub_compartments[0] + sub_compartments[1];
+    dA[risk_posing_fraction].setZero();
+    dA[risk_posing_fraction](first_symptomatic_compartment, first_symptomatic_compartment - 1) =
+        rates_[first_symptomatic_compartment - 1];
+    return dA;
+}
+
+Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments>
+BaseModel::daily_propagator(std::vector<Eigen::Matrix<double, 21, 21>> &derivatives) const {
+    std::vector<Eigen::Matrix<double, BaseModel::n_compartments, BaseModel::n_compartments>> dA =
+        generator_derivatives();
+    derivatives.resize(n_base_parameters);
+
+    Eigen::Matrix<double, 2 * BaseModel::n_compartments, 2 * BaseModel::n_compartments> block;
+    Eigen::Matrix<double, 2 * BaseModel::n_compartments, 2 * BaseModel::n_compartments> block_exp;
+    block.setZero();
+    block.topLeftCorner<BaseModel::n_compartments, BaseModel::n_compartments>() = A_.cast<double>();
+    block.bottomRightCorner<BaseModel::n_compartments, BaseModel::n_compartments>() = A_.cast<double>();
+
+    for (int p = 0; p < n_base_parameters; ++p) {
+        block.topRightCorner<BaseModel::n_compartments, BaseModel::n_compartments>() = dA[p];
+        block_exp = block.exp();
+        derivatives[p] = block_exp.topRightCorner<BaseModel::n_compartments, BaseModel::n_compartments>();
+    }
+    return block_exp.topLeftCorner<BaseModel::n_compartments, BaseModel::n_compartments>();
 }
@@ -0,0 +1,380 @@
+/* calibration.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the Calibration class. The likelihood treats every observation as an independent draw from
+ * the natural course of an infection that started at exposure: a test result on day d is positive with probability
+ * sum_c P(compartment c at d) * (1 - false ommision rate of c), a symptom onset on day d has probability
+ * (1 - fraction asymptomatic) * P(symptomatic phase is entered in [d, d + 1)).
+ */
+
+#include "include/core/calibration.h"
+#include "include/core/model.h"
+#include "include/core/parallel.h"
+#include "include/core/parameters.h"
+#include "include/core/sobol_sequence.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <unsupported/Eigen/LevenbergMarquardt>
+
+int Calibration::Observations::n_days() const { return onset.size(); }
+
+double Calibration::Observations::n_observations() const {
+    return positive[0].sum() + negative[0].sum() + positive[1].sum() + negative[1].sum() + onset.sum() + asymptomatic;
+}
+
+Calibration::Observations Calibration::Observations::from_csv(std::istream &stream) {
+    struct Row {
+        std::string event;
+        int day;
+        bool positive;
+    };
+    std::vector<Row> rows{};
+    int n_days = 1;
+
+    std::string line;
+    for (int line_number = 1; std::getline(stream, line); ++line_number) {
+        line.erase(std::remove_if(line.begin(), line.end(), [](char c) { return std::isspace(c); }), line.end());
+        if (line.empty() || (line_number == 1 && line.rfind("event", 0) == 0)) { // header
+            continue;
+        }
+        std::vector<std::string> fields{};
+        std::stringstream fields_stream(line);
+        std::string field;
+        while (std::getline(fields_stream, field, ',')) {
+            fields.push_back(field);
+        }
+        fields.resize(3);
+
+        Row row{fields[0], 0, fields[2] == "positive" || fields[2] == "1"};
+        bool is_test = row.event == "pcr" || row.event == "rdt";
+        bool valid = is_test || row.event == "onset" || row.event == "asymptomatic";
+        if (is_test) {
+            valid = valid && (row.positive || fields[2] == "negative" || fields[2] == "0");
+        }
+        if (row.event != "asymptomatic") {
+            try {
+                row.day = std::stoi(fields[1]);
+            } catch (const std::logic_error &) {
+                valid = false;
+            }
+            valid = valid && row.day >= 0;
+        }
+        if (!valid) {
+            throw std::runtime_error("line " + std::to_string(line_number) +
+                                     ": expected `pcr|rdt,<day>,positive|negative`, `onset,<day>,` or "
+                                     "`asymptomatic,,`");
+        }
+        rows.push_back(row);
+        n_days = std::max(n_days, row.day + 1);
+    }
+
+    Observations observations;
+    for (int type = 0; type < 2; ++type) {
+        observations.positive[type].setZero(n_days);
+        observations.negative[type].setZero(n_days);
+    }
+    observations.onset.setZero(n_days);
+    for (const Row &row : rows) {
+        if (row.event == "onset") {
+            observations.onset(row.day) += 1;
+        } else if (row.event == "asymptomatic") {
+            observations.asymptomatic += 1;
+        } else {
+            int type = row.event == "pcr" ? 0 : 1;
+            (row.positive ? observations.positive[type] : observations.negative[type])(row.day) += 1;
+        }
+    }
+    return observations;
+}
+
+Calibration::Calibration(Observations observations, std::map<std::string, float> initial_values)
+    : observations_(observations), initial_values_(initial_values) {
+    auto value = [&](const std::string &key) {
+        auto it = initial_values_.find(key);
+        return it != initial_values_.end() ? it->second : Parameters::default_values.at(key);
+    };
+    initial_parameters_.resize(n_fit_parameters);
+    initial_parameters_ << value("duration_incubation_mean"), value("percentage_of_incubation_predetection") / 100,
+        value("duration_symptomatic_mean"), value("PCR_sensitivity") / 100, value("relative_RDT_sensitivity") / 100,
+        value("percentage_asymptomatic") / 100;
+}
+
+std::vector<bool> Calibration::fitted() const {
+    bool pcr = observations_.positive[0].sum() + observations_.negative[0].sum() > 0;
+    bool rdt = observations_.positive[1].sum() + observations_.negative[1].sum() > 0;
+    bool onset = observations_.onset.sum() > 0;
+
+    std::vector<bool> fitted(n_fit_parameters);
+    fitted[incubation_mean] = pcr || rdt || onset;
+    fitted[fraction_predetection] = pcr || rdt;
+    fitted[symptomatic_mean] = pcr || rdt;
+    fitted[pcr_sensitivity] = pcr || rdt;
+    fitted[rdt_relative_sensitivity] = rdt;
+    fitted[fraction_asymptomatic] = onset && observations_.asymptomatic > 0; // the MLE is on the boundary otherwise
+    return fitted;
+}
+
+int Calibration::n_residuals() const {
+    int n = (observations_.asymptomatic > 0);
+    for (int type = 0; type < 2; ++type) {
+        n += (observations_.positive[type].array() > 0).count() + (observations_.negative[type].array() > 0).count();
+    }
+    return n + (observations_.onset.array() > 0).count();
+}
+
+Eigen::VectorXd Calibration::residuals(const Eigen::VectorXd &parameters, Eigen::MatrixXd *jacobian) const {
+    double incubation = parameters(incubation_mean);
+    double predetection = parameters(fraction_predetection);
+    double pcr = parameters(pcr_sensitivity);
+    double rdt = parameters(rdt_relative_sensitivity);
+    double asymptomatic = parameters(fraction_asymptomatic);
+
+    auto value = [&](const std::string &key) {
+        auto it = initial_values_.find(key);
+        return it != initial_values_.end() ? it->second : Parameters::default_values.at(key);
+    };
+    float specificity = value("PCR_specificity") / 100;
+    std::vector<float> tau{float(predetection * incubation), float((1 - predetection) * incubation),
+                           float(parameters(symptomatic_mean)), value("duration_postinfectious_mean")};
+
+    // natural course of an infection from exposure onwards, without symptomatic screening
+    int n_days = observations_.n_days();
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    X0(0) = 1;
+    Model model(tau, 1, X0, n_days, {}, {}, {float(pcr), float(1.3 * rdt * pcr)}, specificity); // see Simulation
+    std::vector<Eigen::MatrixXd> dX_tau;
+    Eigen::MatrixXd X = model.run_with_derivatives(dX_tau);
+
+    // derivatives of the states with respect to the fit parameters; only the residence times affect the states
+    std::vector<Eigen::MatrixXd> dX(n_fit_parameters, Eigen::MatrixXd::Zero(X.rows(), X.cols()));
+    dX[incubation_mean] = predetection * dX_tau[Model::tau_predetection] +
+                          (1 - predetection) * dX_tau[Model::tau_presymptomatic];
+    dX[fraction_predetection] =
+        incubation * (dX_tau[Model::tau_predetection] - dX_tau[Model::tau_presymptomatic]);
+    dX[symptomatic_mean] = dX_tau[Model::tau_symptomatic];
+
+    Eigen::VectorXd r(n_residuals());
+    Eigen::MatrixXd J(n_residuals(), n_fit_parameters);
+    int row = 0;
+    auto add_residual = [&](double count, double p, Eigen::RowVectorXd dp) {
+        const double epsilon = 1e-12;
+        if (p < epsilon || p > 1 - epsilon) { // e.g. an effective RDT sensitivity above 1
+            p = std::clamp(p, epsilon, 1 - epsilon);
+            dp.setZero();
+        }
+        r(row) = std::sqrt(-count * std::log(p));
+        J.row(row).setZero();
+        if (r(row) > 0) {
+            J.row(row) = -count / (2 * p * r(row)) * dp;
+        }
+        ++row;
+    };
+
+    int first_symptomatic_compartment = Model::sub_compartments[0] + Model::sub_compartments[1];
+    for (int type = 0; type < 2; ++type) {
+        Eigen::RowVectorXd positive = model.positive_test_probability(type).transpose();
+        Eigen::RowVectorXd d_positive =
+            model.positive_test_probability_derivative(type, Model::sensitivity_PCR_parameter + type).transpose();
+        double d_sensitivity_d_pcr = type == 0 ? 1 : 1.3 * rdt;
+        double d_sensitivity_d_rdt = type == 0 ? 0 : 1.3 * pcr;
+
+        for (int day = 0; day < n_days; ++day) {
+            double p = positive.dot(X.row(day));
+            Eigen::RowVectorXd dp(n_fit_parameters);
+            for (int k = 0; k < n_fit_parameters; ++k) {
+                dp(k) = positive.dot(dX[k].row(day));
+            }
+            dp(pcr_sensitivity) += d_positive.dot(X.row(day)) * d_sensitivity_d_pcr;
+            dp(rdt_relative_sensitivity) += d_positive.dot(X.row(day)) * d_sensitivity_d_rdt;
+
+            if (observations_.positive[type](day) > 0) {
+                add_residual(observations_.positive[type](day), p, dp);
+            }
+            if (observations_.negative[type](day) > 0) {
+                add_residual(observations_.negative[type](day), 1 - p, -dp);
+            }
+        }
+    }
+
+    for (int day = 0; day < n_days; ++day) {
+        if (observations_.onset(day) > 0) {
+            // probability to enter the symptomatic phase in [day, day + 1)
+            double p = X.row(day).head(first_symptomatic_compartment).sum() -
+                       X.row(day + 1).head(first_symptomatic_compartment).sum();
+            Eigen::RowVectorXd dp(n_fit_parameters);
+            for (int k = 0; k < n_fit_parameters; ++k) {
+                dp(k) = (1 - asymptomatic) * (dX[k].row(day).head(first_symptomatic_compartment).sum() -
+                                              dX[k].row(day + 1).head(first_symptomatic_compartment).sum());
+            }
+            dp(fraction_asymptomatic) = -p;
+            add_residual(observations_.onset(day), (1 - asymptomatic) * p, dp);
+        }
+    }
+    if (observations_.asymptomatic > 0) {
+        add_residual(observations_.asymptomatic, asymptomatic,
+                     Eigen::RowVectorXd::Unit(n_fit_parameters, fraction_asymptomatic));
+    }
+
+    if (jacobian) {
+        *jacobian = J;
+    }
+    return r;
+}
+
+double Calibration::log_likelihood(const Eigen::VectorXd &parameters, Eigen::VectorXd *gradient) const {
+    Eigen::MatrixXd J;
+    Eigen::VectorXd r = residuals(parameters, gradient ? &J : nullptr);
+    if (gradient) {
+        *gradient = -2 * J.transpose() * r;
+    }
+    return -r.squaredNorm();
+}
+
+namespace {
+/* The optimiser works on unconstrained coordinates of the fitted parameters: the log of the durations and the logit
+ * of the fractions.
+ */
+struct LikelihoodFunctor : Eigen::DenseFunctor<double> {
+    const Calibration &calibration;
+    Eigen::VectorXd fixed_parameters;
+    std::vector<int> active;
+
+    LikelihoodFunctor(const Calibration &calibration, const Eigen::VectorXd &fixed_parameters,
+                      const std::vector<int> &active)
+        : Eigen::DenseFunctor<double>(active.size(), calibration.n_residuals()), calibration(calibration),
+          fixed_parameters(fixed_parameters), active(active) {}
+
+    static bool is_duration(int k) { return k == Calibration::incubation_mean || k == Calibration::symptomatic_mean; }
+
+    Eigen::VectorXd coordinates(const Eigen::VectorXd &parameters) const {
+        Eigen::VectorXd z(active.size());
+        for (int i = 0; i < (int)active.size(); ++i) {
+            double p = parameters(active[i]);
+            z(i) = is_duration(active[i]) ? std::log(p) : std::log(p / (1 - p));
+        }
+        return z;
+    }
+
+    Eigen::VectorXd parameters(const Eigen::VectorXd &z) const {
+        Eigen::VectorXd parameters = fixed_parameters;
+        for (int i = 0; i < (int)active.size(); ++i) {
+            parameters(active[i]) = is_duration(active[i]) ? std::exp(z(i)) : 1 / (1 + std::exp(-z(i)));
+        }
+        return parameters;
+    }
+
+    int operator()(const Eigen::VectorXd &z, Eigen::VectorXd &fvec) const {
+        fvec = calibration.residuals(parameters(z));
+        return 0;
+    }
+
+    int df(const Eigen::VectorXd &z, Eigen::MatrixXd &fjac) const {
+        Eigen::VectorXd p = parameters(z);
+        Eigen::MatrixXd J;
+        calibration.residuals(p, &J);
+        fjac.resize(J.rows(), active.size());
+        for (int i = 0; i < (int)active.size(); ++i) {
+            double d_parameter = is_duration(active[i]) ? p(active[i]) : p(active[i]) * (1 - p(active[i]));
+            fjac.col(i) = J.col(active[i]) * d_parameter;
+        }
+        return 0;
+    }
+};
+} // namespace
+
+Calibration::Fit Calibration::fit(const Eigen::VectorXd &start) const {
+    std::vector<int> active{};
+    std::vector<bool> is_fitted = fitted();
+    for (int k = 0; k < n_fit_parameters; ++k) {
+        if (is_fitted[k]) {
+            active.push_back(k);
+        }
+    }
+
+    LikelihoodFunctor functor(*this, start, active);
+    Eigen::VectorXd z = functor.coordinates(start);
+    Eigen::LevenbergMarquardt<LikelihoodFunctor> optimiser(functor);
+    optimiser.setXtol(1e-8);
+    optimiser.setFtol(1e-10);
+    optimiser.setMaxfev(200 * (active.size() + 1));
+    Eigen::LevenbergMarquardtSpace::Status status = optimiser.minimize(z);
+
+    Fit fit;
+    fit.parameters = functor.parameters(z);
+    fit.log_likelihood = log_likelihood(fit.parameters);
+    fit.iterations = optimiser.iterations();
+    fit.converged = status >= Eigen::LevenbergMarquardtSpace::RelativeReductionTooSmall &&
+                    status <= Eigen::LevenbergMarquardtSpace::CosinusTooSmall;
+    return fit;
+}
+
+void Calibration::run(int n_starts, uint32_t seed) {
+    // the first start is the initial values, the others are spread over a plausible box
+    Eigen::VectorXd lower(n_fit_parameters), upper(n_fit_parameters);
+    lower << 3, .1, 3, .5, .5, .05;
+    upper << 12, .9, 14, .99, .99, .6;
+    Eigen::MatrixXd unit_points = SobolSequence(n_fit_parameters, seed).points(0, std::max(n_starts - 1, 0));
+
+    std::vector<bool> is_fitted = fitted();
+    std::vector<Eigen::VectorXd> starts(n_starts, initial_parameters_);
+    for (int s = 1; s < n_starts; ++s) {
+        for (int k = 0; k < n_fit_parameters; ++k) {
+            if (is_fitted[k]) {
+                starts[s](k) = lower(k) + unit_points(k, s - 1) * (upper(k) - lower(k));
+            }
+        }
+    }
+
+    fits_.assign(n_starts, Fit{});
+    Parallel::for_each(n_starts, [&](int s) { fits_[s] = fit(starts[s]); });
+
+    best_ = 0;
+    for (int s = 1; s < n_starts; ++s) {
+        if (fits_[s].log_likelihood > fits_[best_].log_likelihood) {
+            best_ = s;
+        }
+    }
+}
+
+std::map<std::string, float> Calibration::values() const {
+    std::map<std::string, float> values = Parameters::default_values;
+    for (const auto &[key, value] : initial_values_) {
+        values[key] = value;
+    }
+    const Eigen::VectorXd &parameters = best_fit().parameters;
+
+    // shift the extreme values along with the mean
+    auto set_mean = [&](const std::string &period, double mean) {
+        float shift = mean - values["duration_" + period + "_mean"];
+        values["duration_" + period + "_mean"] = mean;
+        values["duration_" + period + "_lower"] = std::max(float(.01), values["duration_" + period + "_lower"] + shift);
+        values["duration_" + period + "_upper"] += shift;
+    };
+    set_mean("incubation", parameters(incubation_mean));
+    set_mean("symptomatic", parameters(symptomatic_mean));
+
+    values["percentage_of_incubation_predetection"] = parameters(fraction_predetection) * 100; // fraction to percent
+    values["PCR_sensitivity"] = parameters(pcr_sensitivity) * 100;
+    values["relative_RDT_sensitivity"] = parameters(rdt_relative_sensitivity) * 100;
+    values["percentage_asymptomatic"] = parameters(fraction_asymptomatic) * 100;
+    return values;
+}
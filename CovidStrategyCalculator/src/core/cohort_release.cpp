@@ -0,0 +1,205 @@
+/* cohort_release.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the CohortRelease class. The binomial distributions of the origins are convolved pairwise in
+ * a balanced tree, directly for short distributions and by FFT otherwise, such that N travellers with different
+ * probabilities cost O(N log^2 N). The negligible tails are trimmed after every convolution; after an FFT, this
+ * includes the tails below its round-off.
+ */
+
+#include "include/core/cohort_release.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unsupported/Eigen/FFT>
+
+namespace {
+const double negligible = 1e-20;
+const double fft_round_off = 1e-15; // relative to the largest probability
+const int direct_convolution_length = 64; // shorter distributions are convolved directly
+
+struct Distribution {
+    int offset;
+    Eigen::VectorXd probabilities; // P(X = offset + k)
+};
+
+// removes the tails below the threshold, and the round-off of the FFT below them
+void trim(Distribution &d, double threshold = negligible) {
+    int first = 0, last = d.probabilities.size() - 1;
+    while (first < last && d.probabilities(first) < threshold) {
+        ++first;
+    }
+    while (last > first && d.probabilities(last) < threshold) {
+        --last;
+    }
+    d.offset += first;
+    d.probabilities = d.probabilities.segment(first, last - first + 1).cwiseMax(0.).eval();
+}
+
+Distribution binomial(int n, double p) {
+    if (p <= 0 || n == 0) {
+        return {0, Eigen::VectorXd::Ones(1)};
+    }
+    if (p >= 1) {
+        return {n, Eigen::VectorXd::Ones(1)};
+    }
+    Distribution d{0, Eigen::VectorXd(n + 1)};
+    double log_p = std::log(p), log_q = std::log1p(-p), log_n = std::lgamma(n + 1.);
+    for (int k = 0; k <= n; ++k) {
+        double log_binomial_coefficient = log_n - std::lgamma(k + 1.) - std::lgamma(n - k + 1.);
+        d.probabilities(k) = std::exp(log_binomial_coefficient + k * log_p + (n - k) * log_q);
+    }
+    trim(d);
+    return d;
+}
+
+Distribution convolve(const Distribution &a, const Distribution &b) {
+    int n = a.probabilities.size() + b.probabilities.size() - 1;
+    Distribution c{a.offset + b.offset, Eigen::VectorXd::Zero(n)};
+    if (std::min(a.probabilities.size(), b.probabilities.size()) <= direct_convolution_length) {
+        for (int i = 0; i < a.probabilities.size(); ++i) {
+            c.probabilities.segment(i, b.probabilities.size()) += a.probabilities(i) * b.probabilities;
+        }
+    } else {
+        int size = 1;
+        while (size < n) {
+            size <<= 1;
+        }
+        std::vector<double> x(size, 0.), y(size, 0.), z;
+        std::copy(a.probabilities.data(), a.probabilities.data() + a.probabilities.size(), x.begin());
+        std::copy(b.probabilities.data(), b.probabilities.data() + b.probabilities.size(), y.begin());
+
+        Eigen::FFT<double> fft;
+        std::vector<std::complex<double>> X, Y;
+        fft.fwd(X, x);
+        fft.fwd(Y, y);
+        for (int k = 0; k < (int)X.size(); ++k) {
+            X[k] *= Y[k];
+        }
+        fft.inv(z, X);
+        c.probabilities = Eigen::Map<Eigen::VectorXd>(z.data(), n);
+        trim(c, std::max(negligible, fft_round_off * c.probabilities.maxCoeff()));
+        return c;
+    }
+    trim(c);
+    return c;
+}
+} // namespace
+
+std::vector<CohortRelease::Origin> CohortRelease::read_csv(std::istream &stream) {
+    std::vector<Origin> origins{};
+    std::string line;
+    for (int line_number = 1; std::getline(stream, line); ++line_number) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || (line_number == 1 && line.rfind("origin", 0) == 0)) { // header
+            continue;
+        }
+        std::stringstream fields(line);
+        std::string name, travellers, probability;
+        std::getline(fields, name, ',');
+        std::getline(fields, travellers, ',');
+        std::getline(fields, probability, ',');
+        Origin origin{-1, -1};
+        try {
+            origin = {std::stod(probability), std::stoi(travellers)};
+        } catch (const std::logic_error &) {
+        }
+        if (origin.travellers < 0 || !std::isfinite(origin.probability) || origin.probability < 0 ||
+            origin.probability > 1) {
+            throw std::runtime_error("line " + std::to_string(line_number) +
+                                     ": expected `<origin>,<travellers>,<probability>`");
+        }
+        origins.push_back(origin);
+    }
+    return origins;
+}
+
+CohortRelease::CohortRelease(const std::vector<Origin> &origins) {
+    // origins are first combined directly into distributions of about the direct convolution length
+    std::vector<Distribution> distributions{};
+    Distribution combined{0, Eigen::VectorXd::Ones(1)};
+    for (const Origin &origin : origins) {
+        n_travellers_ += origin.travellers;
+        if (origin.travellers == 1 && origin.probability > 0 && origin.probability < 1) {
+            // a single traveller, in place
+            Eigen::VectorXd &v = combined.probabilities;
+            int n = v.size();
+            v.conservativeResize(n + 1);
+            v(n) = origin.probability * v(n - 1);
+            for (int k = n - 1; k > 0; --k) {
+                v(k) = (1 - origin.probability) * v(k) + origin.probability * v(k - 1);
+            }
+            v(0) *= 1 - origin.probability;
+            if (v.size() >= direct_convolution_length) {
+                trim(combined);
+            }
+        } else {
+            combined = convolve(combined, binomial(origin.travellers, origin.probability));
+        }
+        if (combined.probabilities.size() >= direct_convolution_length) {
+            distributions.push_back(combined);
+            combined = {0, Eigen::VectorXd::Ones(1)};
+        }
+    }
+    distributions.push_back(combined);
+
+    // balanced tree of pairwise convolutions
+    while (distributions.size() > 1) {
+        std::vector<Distribution> next{};
+        for (int i = 0; i + 1 < (int)distributions.size(); i += 2) {
+            next.push_back(convolve(distributions[i], distributions[i + 1]));
+        }
+        if (distributions.size() % 2) {
+            next.push_back(distributions.back());
+        }
+        distributions.swap(next);
+    }
+    offset_ = distributions[0].offset;
+    distribution_ = distributions[0].probabilities / distributions[0].probabilities.sum();
+}
+
+double CohortRelease::probability(int released) const {
+    int k = released - offset_;
+    return k >= 0 && k < distribution_.size() ? distribution_(k) : 0.;
+}
+
+double CohortRelease::tail_probability(int released) const {
+    int k = std::max(released - offset_, 0);
+    return k < distribution_.size() ? distribution_.tail(distribution_.size() - k).sum() : 0.;
+}
+
+double CohortRelease::mean() const {
+    return offset_ + Eigen::VectorXd::LinSpaced(distribution_.size(), 0, distribution_.size() - 1).dot(distribution_);
+}
+
+int CohortRelease::quantile(double q) const {
+    double cumulative = 0;
+    for (int k = 0; k < distribution_.size(); ++k) {
+        cumulative += distribution_(k);
+        if (cumulative >= q) {
+            return offset_ + k;
+        }
+    }
+    return max_released();
+}
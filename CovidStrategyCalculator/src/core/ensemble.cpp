@@ -0,0 +1,199 @@
+/* ensemble.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the Ensemble class, which propagates the uncertainty in the disease parameters to the relative
+ * risk of an NPI strategy.
+ */
+
+#include "include/core/ensemble.h"
+#include "include/core/parallel.h"
+#include "include/core/sobol_sequence.h"
+
+#include <algorithm>
+#include <cmath>
+
+Ensemble::Ensemble(ParameterSpace space, StrategyParameters strategy, Eigen::VectorXf prevalence_states)
+    : space_(space), strategy_(strategy) {
+    t_end_ = strategy.time_delay + strategy.end_of_strategy;
+
+    // initial states as in Simulation::set_initial_states
+    initial_states_.setZero(Model::n_compartments);
+    if ((strategy.mode == 2) && prevalence_states.size()) {
+        initial_states_ = prevalence_states;
+        use_prevalence_states_ = true;
+    } else if (strategy.mode == 0) {
+        initial_states_(0) = strategy.p_infectious_t0;
+    } else if (strategy.mode == 1) {
+        initial_states_(Model::sub_compartments[0] + Model::sub_compartments[1]) = strategy.p_infectious_t0;
+    }
+}
+
+Eigen::MatrixXf Ensemble::risks(const DiseaseParameters &parameters, bool end_of_strategy_only) const {
+    Workspace workspace = this->workspace();
+    return risks(parameters, workspace, end_of_strategy_only);
+}
+
+// the models are set up for the centre of the parameter space, risks() sets the parameters of each evaluation
+Ensemble::Workspace Ensemble::workspace() const {
+    DiseaseParameters centre = space_.parameters_at(Eigen::VectorXd::Constant(space_.dimensions(), .5));
+    Workspace workspace{Model(centre.tau_mean_case, initial_states_, t_end_),
+                        Model(centre.tau_mean_case, 1, initial_states_, t_end_, strategy_.test_moments,
+                              strategy_.types_of_tests(), {centre.pcr_sens, centre.pcr_sens},
+                              centre.test_specificity)};
+    workspace.initial_states = initial_states_.transpose();
+    return workspace;
+}
+
+// mirrors the typical case of the Simulation class
+const Eigen::MatrixXf &Ensemble::risks(const DiseaseParameters &parameters, Workspace &workspace,
+                                       bool end_of_strategy_only) const {
+    float risk_posing_fraction_symptomatic_phase =
+        strategy_.symptomatic_screening ? parameters.fraction_asymptomatic : 1;
+    // per test type, see Simulation
+    workspace.test_sensitivity = {parameters.pcr_sens,
+                                  float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+
+    Eigen::VectorXf &initial_states_NPI = workspace.initial_states_NPI;
+    initial_states_NPI = initial_states_;
+    if (use_prevalence_states_ && strategy_.symptomatic_screening) {
+        int first_symptomatic_compartment = Model::sub_compartments[0] + Model::sub_compartments[1];
+        initial_states_NPI.segment(first_symptomatic_compartment, Model::sub_compartments[2]) *=
+            risk_posing_fraction_symptomatic_phase;
+    }
+
+    Model &model_no_intervention = workspace.model_no_intervention;
+    Model &model_NPI = workspace.model_NPI;
+    model_no_intervention.set_parameters(parameters.tau_mean_case, 1);
+    model_NPI.set_parameters(parameters.tau_mean_case, risk_posing_fraction_symptomatic_phase);
+    model_NPI.set_test_parameters(workspace.test_sensitivity, parameters.test_specificity);
+
+    Eigen::MatrixXf &strategy_states = workspace.strategy_states;
+    if (end_of_strategy_only) {
+        strategy_states.resize(1, Model::n_compartments);
+        model_NPI.run_end_of_strategy(initial_states_NPI,
+                                      Eigen::Map<Eigen::VectorXf>(strategy_states.data(), Model::n_compartments));
+    } else {
+        strategy_states.resize(model_NPI.n_evaluation_points(), Model::n_compartments);
+        model_NPI.run(initial_states_NPI, strategy_states);
+    }
+    const Eigen::MatrixXf &X0_proxy = workspace.initial_states;
+    int first_row = t_end_ + strategy_.test_moments.size() + 1 - strategy_states.rows();
+
+    Eigen::MatrixXf &risk = workspace.risk;
+    risk.resize(strategy_states.rows(), 2);
+    model_no_intervention.integrate(strategy_states, first_row, risk.col(0));
+    risk.col(0) -= strategy_states(Eigen::all, Eigen::last);
+    model_no_intervention.integrate(X0_proxy, 0, risk.col(1).head(1));
+    risk.col(1).fill(risk(0, 1) - X0_proxy(0, Eigen::last));
+    return risk;
+}
+
+Eigen::VectorXf Ensemble::relative_risk(const DiseaseParameters &parameters) const {
+    return relative_risk(risks(parameters), strategy_.expected_adherence);
+}
+
+// adherence is applied as in Simulation::risk_NPI and Simulation::relative_risk
+Eigen::VectorXf Ensemble::relative_risk(const Eigen::MatrixXf &risks, float expected_adherence) {
+    Eigen::ArrayXf risk_no_intervention = risks.col(1).array();
+    Eigen::ArrayXf risk_NPI =
+        expected_adherence * risks.col(0).array() + (1 - expected_adherence) * risk_no_intervention;
+    return (expected_adherence * risk_NPI + (1 - expected_adherence) * risk_no_intervention) / risk_no_intervention;
+}
+
+Eigen::MatrixXf Ensemble::sample_relative_risk(Sampling sampling, int first, int n, uint32_t seed) const {
+    Eigen::MatrixXd unit_points = sampling == sobol ? SobolSequence(space_.dimensions(), seed).points(first, n)
+                                                    : PseudoRandom::points(space_.dimensions(), first, n, seed);
+
+    int n_eval = t_end_ + strategy_.test_moments.size() + 1; // +1 because of 0-indexed time
+    Eigen::MatrixXf relative_risks(n_eval, n);
+    Parallel::for_each(
+        n, [this]() { return workspace(); },
+        [&](int i, Workspace &workspace) {
+            const Eigen::MatrixXf &risk = risks(space_.parameters_at(unit_points.col(i)), workspace);
+            relative_risks.col(i) = relative_risk(risk, strategy_.expected_adherence);
+        });
+    return relative_risks;
+}
+
+void Ensemble::run(Sampling sampling, float tolerance, int max_samples, uint32_t seed) {
+    samples_ = sample_relative_risk(sampling, 0, std::min(64, max_samples), seed);
+    bands_ = quantile_bands(samples_);
+    converged_ = false;
+    convergence_.clear();
+
+    while (!converged_ && samples_.cols() < max_samples) {
+        int n_new = std::min<int>(samples_.cols(), max_samples - samples_.cols()); // doubles the sample size
+        Eigen::MatrixXf new_samples = sample_relative_risk(sampling, samples_.cols(), n_new, seed);
+
+        Eigen::MatrixXf samples(samples_.rows(), samples_.cols() + n_new);
+        samples << samples_, new_samples;
+        samples_ = samples;
+
+        Eigen::MatrixXf bands = quantile_bands(samples_);
+        float band_change = (bands - bands_).cwiseAbs().maxCoeff();
+        bands_ = bands;
+
+        convergence_.push_back({(int)samples_.cols(), band_change});
+        converged_ = band_change < tolerance;
+    }
+}
+
+std::vector<Ensemble::BenchmarkRow> Ensemble::benchmark(int max_samples, int replicates, uint32_t seed) const {
+    Eigen::MatrixXf reference = quantile_bands(sample_relative_risk(sobol, 0, 4 * max_samples, seed + replicates));
+
+    std::vector<BenchmarkRow> rows;
+    for (int n = 64; n <= max_samples; n *= 2) {
+        rows.push_back({n, 0, 0});
+    }
+
+    // the sequences are extensible, so the prefixes of one run of max_samples give all smaller sample sizes
+    for (int r = 0; r < replicates; ++r) {
+        Eigen::MatrixXf samples_pseudo_random = sample_relative_risk(pseudo_random, 0, max_samples, seed + r);
+        Eigen::MatrixXf samples_sobol = sample_relative_risk(sobol, 0, max_samples, seed + r);
+
+        for (BenchmarkRow &row : rows) {
+            row.error_pseudo_random +=
+                (quantile_bands(samples_pseudo_random.leftCols(row.n_samples)) - reference).cwiseAbs().maxCoeff() /
+                replicates;
+            row.error_sobol +=
+                (quantile_bands(samples_sobol.leftCols(row.n_samples)) - reference).cwiseAbs().maxCoeff() /
+                replicates;
+        }
+    }
+    return rows;
+}
+
+Eigen::MatrixXf Ensemble::quantile_bands(const Eigen::MatrixXf &samples, float coverage) {
+    std::vector<float> probabilities{.5, (1 - coverage) / 2, (1 + coverage) / 2};
+
+    Eigen::MatrixXf bands(samples.rows(), 3);
+    std::vector<float> row(samples.cols());
+    for (int i = 0; i < samples.rows(); ++i) {
+        Eigen::VectorXf::Map(row.data(), row.size()) = samples.row(i);
+        std::sort(row.begin(), row.end());
+
+        // linear interpolation between the order statistics
+        for (int j = 0; j < 3; ++j) {
+            float position = probabilities[j] * (row.size() - 1);
+            int lower = std::floor(position);
+            int upper = std::min<int>(lower + 1, row.size() - 1);
+            bands(i, j) = row[lower] + (position - lower) * (row[upper] - row[lower]);
+        }
+    }
+    return bands;
+}
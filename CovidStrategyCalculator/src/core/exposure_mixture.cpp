@@ -0,0 +1,89 @@
+/* exposure_mixture.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ExposureMixture class. The model is linear and, before the strategy starts, the same for
+ * every exposure day. The states without intervention during the strategy are therefore shifted windows of a single
+ * trajectory since exposure, and the strategy is run once from the mixture of the states at its start. The risk of
+ * no intervention does not depend on the exposure day, so the relative risk of the mixture is the mixture of the
+ * relative risks.
+ */
+
+#include "include/core/exposure_mixture.h"
+
+#include <stdexcept>
+
+ExposureMixture::ExposureMixture(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                                 std::vector<float> offset_weights)
+    : Simulation(parameters) {
+    if (strategy.mode != 0) {
+        throw std::invalid_argument("a distribution of exposure days applies to contact management");
+    }
+    offset_weights_ = Eigen::Map<Eigen::VectorXf>(offset_weights.data(), offset_weights.size());
+    if (!offset_weights_.size() || (offset_weights_.array() < 0).any() || offset_weights_.sum() <= 0) {
+        throw std::invalid_argument("the weights of the exposure days are non-negative and not all zero");
+    }
+    offset_weights_ /= offset_weights_.sum();
+
+    collect_strategy(strategy);
+    deduce_combined_parameters();
+
+    // time since the start of the strategy
+    for (int &t : t_test) {
+        t -= t_offset;
+        if (t < 0) {
+            throw std::invalid_argument("the tests lie within the strategy");
+        }
+    }
+    t_end -= t_offset;
+    t_offset = 0;
+    set_initial_states();
+
+    int n_days = max_offset() + t_end;
+    Model **models_no_intervention[] = {&model_mean_case_no_intervention, &model_best_case_no_intervention,
+                                        &model_worst_case_no_intervention};
+    Model **models_NPI[] = {&model_mean_case_NPI, &model_best_case_NPI, &model_worst_case_NPI};
+    Eigen::MatrixXf *states_no_intervention[] = {&states_mean_no_intervention, &states_best_no_intervention,
+                                                 &states_worst_no_intervention};
+    Eigen::MatrixXf *strategy_states[] = {&strategy_states_mean, &strategy_states_best, &strategy_states_worst};
+    const std::vector<float> *taus[] = {&tau_mean_case, &tau_best_case, &tau_worst_case};
+
+    for (int s = 0; s < 3; ++s) {
+        const std::vector<float> &tau = *taus[s];
+
+        // without intervention: windows of the trajectory since exposure, starting at each exposure day
+        Eigen::MatrixXf trajectory = Model(tau, initial_states_no_intervention, n_days).run_no_test();
+        Eigen::MatrixXf window = Eigen::MatrixXf::Zero(t_end + 1, Model::n_compartments);
+        for (int d = 0; d <= max_offset(); ++d) {
+            if (offset_weights_(d) > 0) {
+                window += offset_weights_(d) * trajectory.middleRows(d, t_end + 1);
+            }
+        }
+        *states_no_intervention[s] = window;
+
+        // with intervention: symptomatic screening until the start, then the strategy from the mixed states
+        Model screened(tau, risk_posing_fraction_symptomatic_phase, initial_states_NPI, max_offset(), {}, {},
+                       test_sensitivity, test_specificity);
+        Eigen::VectorXf start_states = screened.run_no_test().transpose() * offset_weights_;
+
+        *models_no_intervention[s] = new Model(tau, initial_states_no_intervention, t_end);
+        *models_NPI[s] = new Model(tau, risk_posing_fraction_symptomatic_phase, start_states, t_end, t_test,
+                                   test_types, test_sensitivity, test_specificity);
+        *strategy_states[s] = (*models_NPI[s])->run();
+    }
+    run_risk_calculation();
+}
@@ -0,0 +1,207 @@
+/* incidence_file.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the IncidenceFile class. The file is mapped for sequential access, and the pages that have
+ * been parsed are released as the reading proceeds.
+ */
+
+#include "include/core/incidence_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+// days since 1970-01-01 of an ISO date (YYYY-MM-DD) of the given length, -1 if it is malformed or not in the calendar
+int parse_date(const char *date, size_t length) {
+    if (length != 10 || date[4] != '-' || date[7] != '-') {
+        return -1;
+    }
+    int digits[8];
+    const int positions[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i = 0; i < 8; ++i) {
+        digits[i] = date[positions[i]] - '0';
+        if (digits[i] < 0 || digits[i] > 9) {
+            return -1;
+        }
+    }
+    int year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    int month = digits[4] * 10 + digits[5];
+    int day = digits[6] * 10 + digits[7];
+    if (month < 1 || month > 12 || day < 1) {
+        return -1;
+    }
+    static const int days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap_year = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    if (day > days_in_month[month - 1] + (month == 2 && leap_year)) {
+        return -1;
+    }
+
+    // days from civil, H. Hinnant
+    year -= month <= 2;
+    int era = year / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// non-negative decimal number `digits[.digits][e[+-]digits]` spanning [begin, end); false if it is malformed
+bool parse_number(const char *begin, const char *end, double &value) {
+    static const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int n_digits = 0;
+    const char *p = begin;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++n_digits) {
+        if (mantissa < UINT64_C(100000000000000000)) {
+            mantissa = 10 * mantissa + (*p - '0');
+        } else {
+            ++exponent; // digits beyond the precision of a double
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++n_digits) {
+            if (mantissa < UINT64_C(100000000000000000)) {
+                mantissa = 10 * mantissa + (*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (n_digits == 0) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negative = p < end && *p == '-';
+        p += p < end && (*p == '-' || *p == '+');
+        int e = 0;
+        const char *first = p;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            e = std::min(10 * e + (*p - '0'), 10000);
+        }
+        if (p == first) {
+            return false;
+        }
+        exponent += negative ? -e : e;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    value = mantissa;
+    if (exponent >= 0) {
+        value *= exponent <= 22 ? powers_of_ten[exponent] : std::pow(10., exponent);
+    } else {
+        value /= exponent >= -22 ? powers_of_ten[-exponent] : std::pow(10., -exponent);
+    }
+    return true;
+}
+
+const size_t release_size = size_t(64) << 20; // parsed pages are released in steps of 64 MiB
+} // namespace
+
+bool IncidenceFile::parse_line(const char *begin, const char *end, Line &line) {
+    const char *separators[4];
+    const char *p = begin;
+    for (int i = 0; i < 4; ++i) {
+        p = static_cast<const char *>(std::memchr(p, ',', end - p));
+        if (!p) {
+            return false;
+        }
+        separators[i] = p++;
+    }
+
+    double cases, population, detection_rate;
+    line.name = begin;
+    line.name_length = separators[0] - begin;
+    line.date = separators[0] + 1;
+    line.day = parse_date(line.date, separators[1] - line.date);
+    if (line.name_length == 0 || line.day < 0 || !parse_number(separators[1] + 1, separators[2], cases) ||
+        !parse_number(separators[2] + 1, separators[3], population) ||
+        !parse_number(separators[3] + 1, end, detection_rate) || population <= 0 || detection_rate <= 0 ||
+        detection_rate > 1) {
+        return false;
+    }
+    line.incidence = cases / (population * detection_rate);
+    return true;
+}
+
+IncidenceFile::IncidenceFile(const std::string &path) : file_(path, MappedFile::sequential_access) {}
+
+bool IncidenceFile::next(RegionalPrevalence::Region &region) {
+    const char *data = file_.data();
+    size_t size = file_.size();
+    reports_.clear();
+    int last_day = -1;
+    while (position_ < size) {
+        const char *begin = data + position_;
+        const char *line_end = static_cast<const char *>(std::memchr(begin, '\n', size - position_));
+        if (!line_end) {
+            line_end = data + size;
+        }
+        const char *end = line_end > begin && line_end[-1] == '\r' ? line_end - 1 : line_end;
+        bool header = line_number_ == 0 && end - begin >= 6 && std::memcmp(begin, "region", 6) == 0;
+
+        Line line;
+        if (begin != end && !header) {
+            if (!parse_line(begin, end, line)) {
+                throw std::runtime_error("line " + std::to_string(line_number_ + 1) +
+                                         ": expected `<region>,<YYYY-MM-DD>,<cases>,<population>,<detection rate>`");
+            }
+            if (reports_.empty()) {
+                region.name.assign(line.name, line.name_length);
+                if (!regions_.insert(region.name).second) {
+                    throw std::runtime_error("line " + std::to_string(line_number_ + 1) + ": the lines of region " +
+                                             region.name + " are not contiguous; sort the file by region");
+                }
+            } else if (region.name.compare(0, std::string::npos, line.name, line.name_length) != 0) {
+                break; // the next region starts
+            }
+            reports_.push_back({line.day, line.incidence});
+            if (line.day > last_day) {
+                last_day = line.day;
+                region.date.assign(line.date, 10);
+            }
+        }
+        ++line_number_;
+        position_ = line_end - data + 1;
+    }
+    position_ = std::min(position_, size);
+
+    // release the parsed pages, they are read from the file again if needed
+    if (position_ - released_ >= release_size) {
+        released_ = file_.release(released_, position_);
+    }
+
+    if (reports_.empty()) {
+        return false;
+    }
+    int first_day = last_day;
+    for (const Report &report : reports_) {
+        first_day = std::min(first_day, report.day);
+    }
+    region.daily_incidence.assign(last_day - first_day + 1, 0);
+    for (const Report &report : reports_) {
+        region.daily_incidence[last_day - report.day] += report.incidence;
+    }
+    return true;
+}
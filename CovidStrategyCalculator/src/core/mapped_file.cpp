@@ -0,0 +1,106 @@
+/* mapped_file.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the MappedFile class. With random access the mapping is shared, so a reader sees the rows that
+ * a writer adds to a file of fixed size, e.g. a ResultStore that is being written. The mappings are backed by the
+ * file, so pages that are not needed anymore can be released at any time.
+ */
+
+#include "include/core/mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &path, Access access) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              access == sequential_access ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        throw std::runtime_error("cannot read " + path);
+    }
+    size_ = size.QuadPart;
+    if (size_ > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data_ = mapping ? static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (mapping) {
+            CloseHandle(mapping); // the view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+#else
+    int descriptor = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        throw std::runtime_error("cannot read " + path);
+    }
+    size_ = status.st_size;
+    if (size_ > 0) {
+        void *data = mmap(nullptr, size_, PROT_READ, access == sequential_access ? MAP_PRIVATE : MAP_SHARED,
+                          descriptor, 0);
+        data_ = data != MAP_FAILED ? static_cast<const char *>(data) : nullptr;
+        if (data_ && access == sequential_access) {
+            madvise(data, size_, MADV_SEQUENTIAL);
+        }
+    }
+    close(descriptor); // the mapping keeps the file open
+#endif
+    if (size_ > 0 && !data_) {
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<char *>(data_), size_);
+#endif
+    }
+}
+
+size_t MappedFile::release(size_t begin, size_t end) const {
+#ifdef _WIN32
+    return begin;
+#else
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t first = (begin + page_size - 1) / page_size * page_size;
+    size_t last = std::min(end, size_) / page_size * page_size;
+    if (!data_ || last <= first) {
+        return begin;
+    }
+    madvise(const_cast<char *>(data_) + first, last - first, MADV_DONTNEED);
+    return last;
+#endif
+}
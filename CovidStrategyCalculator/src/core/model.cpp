@@ -24,30 +24,51 @@
 
 #include "include/core/model.h"
 
-Model::Model(std::vector<float> residence_times, float risk_posing_fraction_symptomatic_phase,
-             Eigen::VectorXf initial_states, int time, std::vector<int> test_indices, int type_of_test,
+#include <algorithm>
+#include <stdexcept>
+
+Model::Model(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+             const Eigen::VectorXf &initial_states, int time, const std::vector<int> &test_indices, int type_of_test,
              float test_sensitivity, float test_specificity)
+    : Model(residence_times, risk_posing_fraction_symptomatic_phase, initial_states, time, test_indices,
+            std::vector<int>(test_indices.size(), type_of_test), {test_sensitivity, test_sensitivity},
+            test_specificity) {}
+
+Model::Model(const std::vector<float> &residence_times, float risk_posing_fraction_symptomatic_phase,
+             const Eigen::VectorXf &initial_states, int time, const std::vector<int> &test_indices,
+             const std::vector<int> &types_of_tests, const std::vector<float> &test_sensitivities,
+             float test_specificity)
     : BaseModel(residence_times, risk_posing_fraction_symptomatic_phase, initial_states) {
-    t_end = time;
-    t_test = test_indices;
-    test_type = type_of_test;
-    sensitivity = test_sensitivity;
+    set_strategy(time, test_indices, types_of_tests);
+    set_test_parameters(test_sensitivities, test_specificity);
+}
+
+Model::Model(const std::vector<float> &residence_times, const Eigen::VectorXf &initial_states, int time)
+    : Model(residence_times, 1, initial_states, time, {}, 0, .8, .999){};
+
+void Model::set_test_parameters(const std::vector<float> &test_sensitivities, float test_specificity) {
+    if (test_sensitivities.size() != sensitivity.size()) {
+        throw std::invalid_argument("expected a sensitivity per test type");
+    }
+    std::copy_n(test_sensitivities.begin(), sensitivity.size(), sensitivity.begin());
     specificity = test_specificity;
     set_false_ommision_rate();
 }
 
-Model::Model(std::vector<float> residence_times, Eigen::VectorXf initial_states, int time)
-    : Model(residence_times, 1, initial_states, time, {}, 0, .8, .999){};
+void Model::set_strategy(int time, const std::vector<int> &test_indices, const std::vector<int> &types_of_tests) {
+    t_end = time;
+    t_test = test_indices;
+    test_types = types_of_tests;
+}
 
+// the false ommision rates of both test types are precomputed, such that a schedule can mix them
 void Model::set_false_ommision_rate() {
-    if (this->test_type == 0) {
-        set_false_ommision_rate_PCR();
-    } else
-        set_false_ommision_rate_RDT();
+    set_false_ommision_rate_PCR();
+    set_false_ommision_rate_RDT();
 }
 
 void Model::set_false_ommision_rate_PCR() {
-    Eigen::VectorXf FOR(Model::n_compartments);
+    Eigen::Vector<float, 21> FOR;
     FOR.fill(1.);
 
     int counter = 0;
@@ -56,15 +77,15 @@ void Model::set_false_ommision_rate_PCR() {
         counter++;
     }
     for (int j = 0; j < sub_compartments[1] + sub_compartments[2]; ++j) {
-        FOR[counter] = 1 - sensitivity;
+        FOR[counter] = 1 - sensitivity[0];
         counter++;
     }
 
-    false_ommision_rate = FOR;
+    false_ommision_rates[0] = FOR;
 }
 
 void Model::set_false_ommision_rate_RDT() {
-    Eigen::VectorXf FOR(Model::n_compartments);
+    Eigen::Vector<float, 21> FOR;
     FOR.fill(1.);
 
     int counter = 0;
@@ -73,7 +94,7 @@ void Model::set_false_ommision_rate_RDT() {
         counter++;
     }
     for (int j = 0; j < sub_compartments[1] - 2 + sub_compartments[2] - 5; ++j) {
-        FOR[counter] = 1 - sensitivity;
+        FOR[counter] = 1 - sensitivity[1];
         counter++;
     }
     for (int j = 0; j < 5; ++j) {
@@ -81,29 +102,35 @@ void Model::set_false_ommision_rate_RDT() {
         counter++;
     }
 
-    false_ommision_rate = FOR;
+    false_ommision_rates[1] = FOR;
 }
 
-Eigen::MatrixXf Model::run_no_test(int time) {
-    Eigen::MatrixXf states(Model::n_compartments, time + 1); // +1 because of start at day=0
-
-    for (int i = 0; i < time + 1; ++i) {
-        states.col(i) = this->run_base(i);
+void Model::run_no_test(int time, const Eigen::Vector<float, 21> &initial_states,
+                        Eigen::Ref<Eigen::MatrixXf> states) const {
+    for (int i = 0; i < time + 1; ++i) { // +1 because of start at day=0
+        states.row(i) = this->run_base(i, initial_states).transpose();
     }
+}
+
+Eigen::MatrixXf Model::run_no_test() const { return run_no_test(X0); }
+
+Eigen::MatrixXf Model::run_no_test(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const {
+    Eigen::MatrixXf states(t_end + 1, Model::n_compartments);
+    run_no_test(t_end, initial_states, states);
     return states;
 }
 
-Eigen::MatrixXf Model::run_no_test() {
-    int time = t_end;
-    Eigen::MatrixXf X_transposed = run_no_test(time);
-    X_transposed.transposeInPlace();
-    return X_transposed;
+Eigen::MatrixXf Model::run() const { return run(X0); }
+
+Eigen::MatrixXf Model::run(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const {
+    Eigen::MatrixXf states(n_evaluation_points(), Model::n_compartments);
+    run(initial_states, states);
+    return states;
 }
 
 // The model is executed in 1-day steps to obtain all the points required for plotting
-Eigen::MatrixXf Model::run() {
-    int n_eval_states = t_end + t_test.size() + 1; // +1 because strategy is 0-indexed
-    Eigen::MatrixXf states(Model::n_compartments, n_eval_states);
+void Model::run(const Eigen::Ref<const Eigen::VectorXf> &initial_states, Eigen::Ref<Eigen::MatrixXf> states) const {
+    Eigen::Vector<float, 21> x = initial_states; // the states after the last test
 
     int day_counter = 0;
     int next_idx = 0;
@@ -111,24 +138,155 @@ Eigen::MatrixXf Model::run() {
 
     for (int i = 0; i < (int)t_test.size(); ++i) {
         t_diff = t_test[i] - day_counter;
-        states(Eigen::all, Eigen::seq(next_idx, next_idx + t_diff)).array() = run_no_test(t_diff).array();
-        X0.array() = false_ommision_rate.array() * states(Eigen::all, next_idx + t_diff).array();
+        run_no_test(t_diff, x, states.middleRows(next_idx, t_diff + 1));
+        x.array() = false_ommision_rates[test_types[i]].array() * states.row(next_idx + t_diff).transpose().array();
         day_counter += t_diff;
         next_idx = next_idx + t_diff + 1;
     }
     t_diff = t_end - day_counter;
-    states(Eigen::all, Eigen::seq(next_idx, Eigen::last)).array() = run_no_test(t_diff).array();
+    run_no_test(t_diff, x, states.middleRows(next_idx, t_diff + 1));
+}
+
+Eigen::MatrixXf Model::run_end_of_strategy() const { return run_end_of_strategy(X0); }
+
+Eigen::MatrixXf Model::run_end_of_strategy(const Eigen::Ref<const Eigen::VectorXf> &initial_states) const {
+    Eigen::VectorXf end_states(Model::n_compartments);
+    run_end_of_strategy(initial_states, end_states);
+    return end_states.transpose();
+}
+
+void Model::run_end_of_strategy(const Eigen::Ref<const Eigen::VectorXf> &initial_states,
+                                Eigen::Ref<Eigen::VectorXf> end_states) const {
+    Eigen::Vector<float, 21> x = initial_states;
+    int day_counter = 0;
+    for (int i = 0; i < (int)t_test.size(); ++i) {
+        x.array() = false_ommision_rates[test_types[i]].array() * run_base(t_test[i] - day_counter, x).array();
+        day_counter = t_test[i];
+    }
+    end_states = run_base(t_end - day_counter, x);
+}
+
+Eigen::VectorXf Model::integrate(const Eigen::Ref<const Eigen::MatrixXf> &X, int first_row) const {
+    Eigen::VectorXf risk_at_t_inf(X.rows());
+    integrate(X, first_row, risk_at_t_inf);
+    return risk_at_t_inf;
+}
+
+// calculates the residual risk
+void Model::integrate(const Eigen::Ref<const Eigen::MatrixXf> &X, int first_row,
+                      Eigen::Ref<Eigen::VectorXf> risk_at_t_inf) const {
+    for (int i = 0; i < X.rows(); ++i) {
+        risk_at_t_inf[i] = this->run_base(100 - first_row - i, X.row(i).transpose())(Eigen::last); // t_inf=100
+    }
+}
+
+// the false ommision rates are affine in the sensitivity and specificity, so a unit step gives the exact derivative
+Eigen::VectorXd Model::false_ommision_rate_derivative(int type, int parameter) const {
+    Model shifted = *this;
+    if (parameter == specificity_parameter) {
+        shifted.specificity += 1;
+    } else {
+        shifted.sensitivity[parameter - sensitivity_PCR_parameter] += 1;
+    }
+    shifted.set_false_ommision_rate();
+    return (shifted.false_ommision_rates[type] - false_ommision_rates[type]).cast<double>();
+}
+
+// The model is executed in 1-day steps of the propagator, such that the derivatives follow by the chain rule
+Eigen::MatrixXd Model::run_with_derivatives(std::vector<Eigen::MatrixXd> &derivatives,
+                                            const Eigen::MatrixXd &initial_derivatives) const {
+    std::vector<Eigen::Matrix<double, 21, 21>> dP;
+    Eigen::Matrix<double, 21, 21> P = daily_propagator(dP);
+
+    // false ommision rates per test type and their derivatives with respect to the test parameters
+    std::vector<Eigen::VectorXd> FOR(2);
+    std::vector<std::vector<Eigen::VectorXd>> dFOR(2);
+    for (int type = 0; type < 2; ++type) {
+        FOR[type] = false_ommision_rates[type].cast<double>();
+        for (int p = sensitivity_PCR_parameter; p < n_parameters; ++p) {
+            dFOR[type].push_back(false_ommision_rate_derivative(type, p));
+        }
+    }
+
+    int n_eval_states = t_end + t_test.size() + 1; // +1 because strategy is 0-indexed
+    Eigen::MatrixXd states(Model::n_compartments, n_eval_states);
+    derivatives.assign(n_parameters, Eigen::MatrixXd(Model::n_compartments, n_eval_states));
+
+    Eigen::VectorXd x = X0.cast<double>();
+    Eigen::MatrixXd dx = Eigen::MatrixXd::Zero(Model::n_compartments, n_parameters);
+    if (initial_derivatives.size()) {
+        dx = initial_derivatives;
+    }
+
+    int column = 0;
+    auto store = [&]() {
+        states.col(column) = x;
+        for (int p = 0; p < n_parameters; ++p) {
+            derivatives[p].col(column) = dx.col(p);
+        }
+        ++column;
+    };
+
+    int next_test = 0;
+    for (int day = 0;; ++day) {
+        store();
+        while (next_test < (int)t_test.size() && t_test[next_test] == day) {
+            int type = test_types[next_test];
+            dx = FOR[type].asDiagonal() * dx;
+            for (int p = sensitivity_PCR_parameter; p < n_parameters; ++p) {
+                dx.col(p) += dFOR[type][p - sensitivity_PCR_parameter].cwiseProduct(x);
+            }
+            x = FOR[type].cwiseProduct(x);
+            store();
+            ++next_test;
+        }
+        if (day == t_end) {
+            break;
+        }
+        dx = P * dx;
+        for (int p = 0; p < n_base_parameters; ++p) {
+            dx.col(p) += dP[p] * x;
+        }
+        x = P * x;
+    }
+
     states.transposeInPlace();
+    for (Eigen::MatrixXd &derivative : derivatives) {
+        derivative.transposeInPlace();
+    }
     return states;
 }
 
-// calculates the residual risk
-Eigen::VectorXf Model::integrate(Eigen::MatrixXf X) {
-    Eigen::VectorXf risk_at_t_inf(X.rows());
-    X.transposeInPlace();
+Eigen::VectorXd Model::integrate_with_derivatives(const Eigen::MatrixXd &X, const std::vector<Eigen::MatrixXd> &dX,
+                                                  Eigen::MatrixXd &derivatives) const {
+    const int t_inf = 100;
+    std::vector<Eigen::Matrix<double, 21, 21>> dP;
+    Eigen::Matrix<double, 21, 21> P = daily_propagator(dP);
+
+    /* risk node of exp(A * m) applied to a state, and its derivatives, for m = 0, ..., t_inf:
+     * w_m = e_risk' * P^m, so that w_{m+1} = w_m * P and dw_{m+1} = dw_m * P + w_m * dP
+     */
+    std::vector<Eigen::RowVectorXd> w(t_inf + 1);
+    std::vector<Eigen::MatrixXd> dw(t_inf + 1); // rows: residence times
+    w[0] = Eigen::RowVectorXd::Unit(Model::n_compartments, Model::n_compartments - 1);
+    dw[0] = Eigen::MatrixXd::Zero(tau_postinfectious + 1, Model::n_compartments);
+    for (int m = 0; m < t_inf; ++m) {
+        w[m + 1] = w[m] * P;
+        dw[m + 1] = dw[m] * P;
+        for (int p = 0; p <= tau_postinfectious; ++p) {
+            dw[m + 1].row(p) += w[m] * dP[p];
+        }
+    }
 
-    for (int i = 0; i < X.cols(); ++i) {
-        risk_at_t_inf[i] = this->run_base(100 - i, X.col(i))(Eigen::last); // t_inf=100
+    Eigen::VectorXd risk_at_t_inf(X.rows());
+    derivatives.setZero(X.rows(), n_parameters);
+    for (int i = 0; i < X.rows(); ++i) {
+        int m = std::max(t_inf - i, 0);
+        risk_at_t_inf(i) = w[m].dot(X.row(i));
+        for (int p = 0; p < (int)dX.size(); ++p) {
+            derivatives(i, p) = w[m].dot(dX[p].row(i));
+        }
+        derivatives.row(i).head(tau_postinfectious + 1) += (dw[m] * X.row(i).transpose()).transpose();
     }
     return risk_at_t_inf;
 }
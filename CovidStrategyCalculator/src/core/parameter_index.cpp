@@ -0,0 +1,191 @@
+/* parameter_index.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ParameterIndex class. The index file starts with a 32-byte header: the magic `CSCINDEX`,
+ * the version, 4 bytes reserved, the number of entries and the number of rows of the store, followed by the entries
+ * (key and row, 48 bytes each) in lexicographic order of the keys.
+ */
+
+#include "include/core/parameter_index.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+const char magic[8] = {'C', 'S', 'C', 'I', 'N', 'D', 'E', 'X'};
+const uint32_t version = 2; // 2: the RDT days
+const size_t header_size = 32;
+
+auto tied(const ParameterIndex::Key &key) {
+    return std::tie(key.mode, key.symptomatic_screening, key.time_delay, key.end_of_strategy, key.test_days,
+                    key.rdt_days, key.test_type, key.adherence);
+}
+bool operator<(const ParameterIndex::Key &a, const ParameterIndex::Key &b) { return tied(a) < tied(b); }
+bool operator==(const ParameterIndex::Key &a, const ParameterIndex::Key &b) { return tied(a) == tied(b); }
+} // namespace
+
+const std::vector<std::string> ParameterIndex::columns = {
+    "mode", "symptomatic_screening", "time_delay", "end_of_strategy", "test_days", "rdt_days", "test_type",
+    "adherence"};
+
+ParameterIndex::Key ParameterIndex::key(const StrategyParameters &strategy) {
+    // the adherence is rounded to 0.01%, such that adherences entered in percent compare equal
+    Key key{strategy.mode, strategy.symptomatic_screening, strategy.time_delay, strategy.end_of_strategy, 0, 0, 0,
+            std::round(strategy.expected_adherence * 1e4f) / 1e4f};
+    std::vector<int> types = strategy.types_of_tests();
+    for (size_t i = 0; i < strategy.test_moments.size(); ++i) {
+        int day = strategy.test_moments[i] - strategy.time_delay;
+        if (day < 0 || day > 63) {
+            throw std::invalid_argument("the index holds tests on the days 0 to 63 of the strategy");
+        }
+        key.test_days |= uint64_t(1) << day;
+        if (types[i] == 1) {
+            key.rdt_days |= uint64_t(1) << day;
+        }
+    }
+    if (!types.empty()) {
+        bool mixed = !std::equal(types.begin() + 1, types.end(), types.begin());
+        key.test_type = mixed ? -1 : types[0];
+    }
+    return key;
+}
+
+void ParameterIndex::build(const ResultStore &store, const std::string &path) {
+    std::vector<int> c;
+    for (const std::string &name : columns) {
+        c.push_back(store.column_index(name));
+    }
+    const int32_t *mode = store.data<int32_t>(c[0]);
+    const int32_t *symptomatic_screening = store.data<int32_t>(c[1]);
+    const int32_t *time_delay = store.data<int32_t>(c[2]);
+    const int32_t *end_of_strategy = store.data<int32_t>(c[3]);
+    const int64_t *test_days = store.data<int64_t>(c[4]);
+    const int64_t *rdt_days = store.data<int64_t>(c[5]);
+    const int32_t *test_type = store.data<int32_t>(c[6]);
+    const float *adherence = store.data<float>(c[7]);
+
+    std::vector<Entry> entries(store.n_rows());
+    for (int64_t row = 0; row < store.n_rows(); ++row) {
+        entries[row] = {{mode[row], symptomatic_screening[row], time_delay[row], end_of_strategy[row],
+                         uint64_t(test_days[row]), uint64_t(rdt_days[row]), test_type[row], adherence[row]},
+                        row};
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.key < b.key; });
+
+    char header[header_size] = {};
+    uint64_t sizes[2] = {entries.size(), uint64_t(store.n_rows())};
+    std::memcpy(header, magic, sizeof(magic));
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 16, sizes, 16);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(header, header_size);
+    file.write(reinterpret_cast<const char *>(entries.data()), sizeof(Entry) * entries.size());
+    if (!file) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+ParameterIndex::ParameterIndex(const std::string &path) : file_(path) {
+    static_assert(sizeof(Entry) == 48, "the entries are stored as they are laid out in memory");
+    uint32_t file_version;
+    uint64_t sizes[2];
+    if (file_.size() < header_size || std::memcmp(file_.data(), magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " is not a parameter index");
+    }
+    std::memcpy(&file_version, file_.data() + 8, 4);
+    std::memcpy(sizes, file_.data() + 16, 16);
+    if (file_version != version || sizes[0] != (file_.size() - header_size) / sizeof(Entry)) {
+        throw std::runtime_error(path + " is not a parameter index of version " + std::to_string(version));
+    }
+    entries_ = reinterpret_cast<const Entry *>(file_.data() + header_size);
+    size_ = sizes[0];
+    store_rows_ = sizes[1];
+}
+
+int64_t ParameterIndex::find(const Key &key) const {
+    const Entry *end = entries_ + size_;
+    const Entry *entry =
+        std::lower_bound(entries_, end, key, [](const Entry &entry, const Key &key) { return entry.key < key; });
+    return entry != end && entry->key == key ? entry->row : -1;
+}
+
+std::vector<int64_t> ParameterIndex::range(const Key &lower, const Key &upper) const {
+    const Entry *end = entries_ + size_;
+    const Entry *first =
+        std::lower_bound(entries_, end, lower, [](const Entry &entry, const Key &key) { return entry.key < key; });
+    const Entry *last =
+        std::upper_bound(first, end, upper, [](const Key &key, const Entry &entry) { return key < entry.key; });
+
+    std::vector<int64_t> rows{};
+    for (const Entry *entry = first; entry < last; ++entry) {
+        const Key &k = entry->key;
+        bool within = k.mode >= lower.mode && k.mode <= upper.mode &&
+                      k.symptomatic_screening >= lower.symptomatic_screening &&
+                      k.symptomatic_screening <= upper.symptomatic_screening && k.time_delay >= lower.time_delay &&
+                      k.time_delay <= upper.time_delay && k.end_of_strategy >= lower.end_of_strategy &&
+                      k.end_of_strategy <= upper.end_of_strategy && k.test_days >= lower.test_days &&
+                      k.test_days <= upper.test_days && k.rdt_days >= lower.rdt_days &&
+                      k.rdt_days <= upper.rdt_days && k.test_type >= lower.test_type &&
+                      k.test_type <= upper.test_type && k.adherence >= lower.adherence &&
+                      k.adherence <= upper.adherence;
+        if (within) {
+            rows.push_back(entry->row);
+        }
+    }
+    return rows;
+}
+
+int64_t ParameterIndex::nearest(const Key &key, float *distance) const {
+    // the entries of the same mode and screening are contiguous
+    const int32_t lowest = std::numeric_limits<int32_t>::min(), highest = std::numeric_limits<int32_t>::max();
+    Key lower{key.mode, key.symptomatic_screening, lowest, lowest, 0, 0, lowest, -INFINITY};
+    Key upper{key.mode, key.symptomatic_screening, highest, highest, ~uint64_t(0), ~uint64_t(0), highest, INFINITY};
+    const Entry *end = entries_ + size_;
+    const Entry *first =
+        std::lower_bound(entries_, end, lower, [](const Entry &entry, const Key &key) { return entry.key < key; });
+    const Entry *last =
+        std::upper_bound(first, end, upper, [](const Key &key, const Entry &entry) { return key < entry.key; });
+
+    int64_t row = -1;
+    float best = INFINITY;
+    for (const Entry *entry = first; entry < last; ++entry) {
+        const Key &k = entry->key;
+        if (k.test_days && key.test_days && k.test_type != key.test_type) {
+            continue;
+        }
+        // a day with a test in only one of the schedules, or with tests of different types
+        uint64_t different_days = (k.test_days ^ key.test_days) | (k.rdt_days ^ key.rdt_days);
+        float d = std::abs(k.time_delay - key.time_delay) + std::abs(k.end_of_strategy - key.end_of_strategy) +
+                  std::bitset<64>(different_days).count() + std::abs(k.adherence - key.adherence) / .1f;
+        if (d < best) {
+            best = d;
+            row = entry->row;
+        }
+    }
+    if (distance) {
+        *distance = best;
+    }
+    return row;
+}
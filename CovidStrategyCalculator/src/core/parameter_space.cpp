@@ -0,0 +1,70 @@
+/* parameter_space.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ParameterSpace class, which maps points of the unit hypercube to parameter values.
+ */
+
+#include "include/core/parameter_space.h"
+
+#include <algorithm>
+
+ParameterSpace::ParameterSpace(std::map<std::string, float> values, float relative_spread) {
+    values_ = Parameters::default_values;
+    for (const auto &[key, value] : values) {
+        values_[key] = value;
+    }
+
+    set_range("duration_incubation_mean", values_["duration_incubation_lower"], values_["duration_incubation_upper"]);
+    set_range("duration_symptomatic_mean", values_["duration_symptomatic_lower"],
+              values_["duration_symptomatic_upper"]);
+
+    // percentual values are capped at 100%
+    for (const std::string key : {"percentage_of_incubation_predetection", "duration_postinfectious_mean",
+                                  "percentage_asymptomatic", "PCR_sensitivity", "PCR_specificity",
+                                  "relative_RDT_sensitivity"}) {
+        float lower = (1 - relative_spread) * values_[key];
+        float upper = (1 + relative_spread) * values_[key];
+        if (key != "duration_postinfectious_mean") {
+            upper = std::min(upper, float(100.));
+        }
+        set_range(key, lower, upper);
+    }
+}
+
+void ParameterSpace::set_range(const std::string &key, float lower, float upper) {
+    for (ParameterRange &range : ranges_) {
+        if (range.key == key) {
+            range.lower = lower;
+            range.upper = upper;
+            return;
+        }
+    }
+    ranges_.push_back({key, lower, upper});
+}
+
+std::map<std::string, float> ParameterSpace::values_at(const Eigen::VectorXd &unit_point) const {
+    std::map<std::string, float> values = values_;
+    for (int i = 0; i < dimensions(); ++i) {
+        values[ranges_[i].key] = ranges_[i].lower + unit_point(i) * (ranges_[i].upper - ranges_[i].lower);
+    }
+    return values;
+}
+
+DiseaseParameters ParameterSpace::parameters_at(const Eigen::VectorXd &unit_point) const {
+    return DiseaseParameters::from_values(values_at(unit_point));
+}
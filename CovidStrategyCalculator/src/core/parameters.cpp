@@ -0,0 +1,149 @@
+/* parameters.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the plain value types that carry the user input into the core.
+ */
+
+#include "include/core/parameters.h"
+
+#include <stdexcept>
+
+const std::map<std::string, float> Parameters::default_values{{"duration_incubation_lower", 5.60},
+                                                              {"duration_incubation_mean", 6.77},
+                                                              {"duration_incubation_upper", 7.99},
+                                                              {"percentage_of_incubation_predetection", 42.2},
+                                                              {"duration_symptomatic_lower", 2.79},
+                                                              {"duration_symptomatic_mean", 7.50},
+                                                              {"duration_symptomatic_upper", 11.47},
+                                                              {"percentage_asymptomatic", 20},
+                                                              {"duration_postinfectious_mean", 8},
+                                                              {"PCR_sensitivity", 80},
+                                                              {"PCR_specificity", 99.99},
+                                                              {"relative_RDT_sensitivity", 85}};
+
+std::map<std::string, float> Parameters::read_values(std::istream &stream) {
+    auto trim = [](const std::string &text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        size_t last = text.find_last_not_of(" \t\r");
+        return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    };
+
+    std::map<std::string, float> values{};
+    std::string line;
+    for (int line_number = 1; std::getline(stream, line); ++line_number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t separator = line.find('=');
+        std::string key = trim(line.substr(0, separator));
+        if (separator == std::string::npos || !default_values.count(key)) {
+            throw std::runtime_error("line " + std::to_string(line_number) +
+                                     ": expected `key = value` with a known key");
+        }
+        try {
+            values[key] = std::stof(line.substr(separator + 1));
+        } catch (const std::logic_error &) {
+            throw std::runtime_error("line " + std::to_string(line_number) + ": invalid value for " + key);
+        }
+    }
+    return values;
+}
+
+void Parameters::write_values(std::ostream &stream, const std::map<std::string, float> &values) {
+    for (const auto &[key, value] : values) {
+        stream << key << " = " << value << "\n";
+    }
+}
+
+DiseaseParameters DiseaseParameters::from_values(const std::map<std::string, float> &values) {
+    // fall back to the default value for keys that are not provided
+    auto value = [&](const std::string &key) {
+        auto it = values.find(key);
+        return it != values.end() ? it->second : Parameters::default_values.at(key);
+    };
+
+    float fraction_predetection = value("percentage_of_incubation_predetection") / 100;
+    float incubation_mean = value("duration_incubation_mean");
+    float incubation_lower = value("duration_incubation_lower");
+    float incubation_upper = value("duration_incubation_upper");
+    float postinfectious = value("duration_postinfectious_mean");
+
+    DiseaseParameters parameters;
+    parameters.tau_mean_case = {fraction_predetection * incubation_mean, (1 - fraction_predetection) * incubation_mean,
+                                value("duration_symptomatic_mean"), postinfectious};
+    parameters.tau_best_case = {fraction_predetection * incubation_lower,
+                                (1 - fraction_predetection) * incubation_upper, value("duration_symptomatic_upper"),
+                                postinfectious};
+    parameters.tau_worst_case = {fraction_predetection * incubation_upper,
+                                 (1 - fraction_predetection) * incubation_lower, value("duration_symptomatic_lower"),
+                                 postinfectious};
+
+    parameters.fraction_asymptomatic = value("percentage_asymptomatic") / 100.; // percent to probability
+    parameters.pcr_sens = value("PCR_sensitivity") / 100.;                      // percent to probability
+    parameters.test_specificity = value("PCR_specificity") / 100.;              // percent to probability
+    parameters.rdt_relative_sens = value("relative_RDT_sensitivity") / 100.;    // percent to probability
+    return parameters;
+}
+
+void Parameters::check_values(const std::map<std::string, float> &values) {
+    auto value = [&](const std::string &key) {
+        auto it = values.find(key);
+        return it != values.end() ? it->second : default_values.at(key);
+    };
+    for (const auto &[key, default_value] : default_values) {
+        float v = value(key);
+        bool percentage = key.find("percentage") != std::string::npos || key.find("sensitivity") != std::string::npos ||
+                          key.find("specificity") != std::string::npos;
+        if (!(percentage ? v >= 0 && v <= 100 : v > 0)) { // also rejects NaN
+            throw std::invalid_argument(key + (percentage ? " must lie within [0, 100]" : " must be positive"));
+        }
+    }
+    for (std::string duration : {"duration_incubation", "duration_symptomatic"}) {
+        if (value(duration + "_lower") > value(duration + "_mean") ||
+            value(duration + "_mean") > value(duration + "_upper")) {
+            throw std::invalid_argument(duration + "_lower, _mean and _upper must not decrease");
+        }
+    }
+}
+
+void StrategyParameters::check() const {
+    if (mode < 0 || mode > 2 || time_delay < 0 || end_of_strategy < 0 || test_type < 0 || test_type > 1) {
+        throw std::invalid_argument("mode, time delay, duration or test type out of range");
+    }
+    if (!(expected_adherence >= 0 && expected_adherence <= 1)) { // also rejects NaN
+        throw std::invalid_argument("adherence must lie within [0, 1]");
+    }
+    if (!(p_infectious_t0 > 0 && p_infectious_t0 <= 1)) { // the relative risk divides by it
+        throw std::invalid_argument("initial probability of infection must lie within (0, 1]");
+    }
+    for (size_t i = 0; i < test_moments.size(); ++i) {
+        if (test_moments[i] < time_delay || test_moments[i] > time_delay + end_of_strategy ||
+            (i > 0 && test_moments[i] <= test_moments[i - 1])) {
+            throw std::invalid_argument("test days must increase and lie within the strategy");
+        }
+    }
+    if (!test_types.empty() && test_types.size() != test_moments.size()) {
+        throw std::invalid_argument("the test types need one type per test day");
+    }
+    for (int type : test_types) {
+        if (type < 0 || type > 1) {
+            throw std::invalid_argument("unknown test type " + std::to_string(type));
+        }
+    }
+}
@@ -20,96 +20,103 @@
  * This file implements the PrevalenceEstimator class, which derives from, and extends the Simulation class.
  * The objective of the PrevalenceEstimator class is to execute a single simulation to generate a population with
  * mixed ‘infection age’ for the analysis of NPI strategies.
+ * The states today are the convolution of the daily incidence with the impulse response of the model, i.e. the
+ * states d days after the report of one infection.
  */
 
 #include "include/core/prevalence_estimator.h"
 
-// pre-simulation for prevalence estimator
-PrevalenceEstimator::PrevalenceEstimator(ParametersTab *parameters_tab, PrevalenceTab *prevalence_tab)
-    : Simulation(parameters_tab) {
-    std::vector<float> incidence = prevalence_tab->incidence();
+#include <map>
+#include <mutex>
+#include <numeric>
+
+namespace {
+struct ImpulseResponse {
+    Eigen::Matrix<double, 21, 21> propagator; // one day
+    Eigen::MatrixXd states;                   // per day since the report
+};
+
+// impulse responses keyed by the residence times followed by the typical residence times
+std::map<std::vector<float>, ImpulseResponse> impulse_responses{};
+std::mutex impulse_responses_mutex{};
+const int max_cached_responses = 64;
+} // namespace
 
+// pre-simulation for prevalence estimator
+PrevalenceEstimator::PrevalenceEstimator(const DiseaseParameters &parameters, std::vector<float> incidence,
+                                         Resolution resolution)
+    : Simulation(parameters) {
     this->t_end = 0;                                   // placeholder, not used
     this->risk_posing_fraction_symptomatic_phase = 1.; // no symptom screening
     this->expected_adherence = 1.;                     // placeholder, not used
     this->t_test = {};                                 // placeholder, not used
 
+    if (resolution == weekly) {
+        std::vector<float> daily_incidence{};
+        for (float week_incidence : incidence) {
+            daily_incidence.insert(daily_incidence.end(), 7, week_incidence / 7);
+        }
+        incidence = daily_incidence;
+    }
     estimate_prevalence(incidence);
 }
 
-// weekly incidence: [week 0, week -1, week -2, week -3, ...]
-void PrevalenceEstimator::estimate_prevalence(std::vector<float> weekly_incidence) {
-
-    Eigen::MatrixXf X_mean;
-    Eigen::MatrixXf X_best;
-    Eigen::MatrixXf X_worst;
-
-    Eigen::VectorXf X0;
-    X0.setZero(Model::n_compartments);
-
-    model_mean_case_no_intervention = new Model(tau_mean_case, X0, t_end);   // without tests or symptomatic screening
-    model_best_case_no_intervention = new Model(tau_best_case, X0, t_end);   // without tests or symptomatic screening
-    model_worst_case_no_intervention = new Model(tau_worst_case, X0, t_end); // without tests or symptomatic screening
-
-    Eigen::VectorXf cumulative_states_today_mean;
-    Eigen::VectorXf cumulative_states_today_best;
-    Eigen::VectorXf cumulative_states_today_worst;
-
-    cumulative_states_today_mean.setZero(Model::n_compartments);
-    cumulative_states_today_best.setZero(Model::n_compartments);
-    cumulative_states_today_worst.setZero(Model::n_compartments);
-
-    float total_tau = std::accumulate(tau_mean_case.begin(), tau_mean_case.end(), 0);
-
-    for (int week = 0; week < 5; ++week) {
-        float day_incidence = weekly_incidence[week] / 7;
-        t_end = (week + 1) * 7 - 1; // -1 because days are 0-indexed
+Eigen::MatrixXd PrevalenceEstimator::impulse_response(const std::vector<float> &residence_times,
+                                                      const std::vector<float> &typical_residence_times,
+                                                      int n_days) {
+    std::vector<float> key = residence_times;
+    key.insert(key.end(), typical_residence_times.begin(), typical_residence_times.end());
+
+    std::lock_guard<std::mutex> lock(impulse_responses_mutex);
+    auto it = impulse_responses.find(key);
+    if (it == impulse_responses.end()) {
+        if ((int)impulse_responses.size() >= max_cached_responses) {
+            impulse_responses.clear();
+        }
 
-        // set intial states according to incidence report
+        // reported infections are distributed over the phases proportionally to the typical residence times
+        Eigen::VectorXd X0 = Eigen::VectorXd::Zero(Model::n_compartments);
+        float total_tau = std::accumulate(typical_residence_times.begin(), typical_residence_times.end(), 0);
         int counter = 0;
         for (int i = 0; i < 4; ++i) {
             for (int j = 0; j < Model::sub_compartments[i]; ++j) {
-                float probability = tau_mean_case[i] / total_tau * day_incidence / Model::sub_compartments[i];
-                X0(counter) = probability;
+                X0(counter) = typical_residence_times[i] / total_tau / Model::sub_compartments[i];
                 counter++;
             }
         }
 
-        model_mean_case_no_intervention->set_t_end(t_end);
-        model_best_case_no_intervention->set_t_end(t_end);
-        model_worst_case_no_intervention->set_t_end(t_end);
-
-        model_mean_case_no_intervention->X0 = X0;
-        model_best_case_no_intervention->X0 = X0;
-        model_worst_case_no_intervention->X0 = X0;
-
-        X_mean = model_mean_case_no_intervention->run_no_test();
-        X_best = model_best_case_no_intervention->run_no_test();
-        X_worst = model_worst_case_no_intervention->run_no_test();
-
-        cumulative_states_today_mean.array() +=
-            X_mean(Eigen::seq(Eigen::last - 6, Eigen::last), Eigen::all).colwise().sum().array();
-        cumulative_states_today_best.array() +=
-            X_best(Eigen::seq(Eigen::last - 6, Eigen::last), Eigen::all).colwise().sum().array();
-        cumulative_states_today_worst.array() +=
-            X_worst(Eigen::seq(Eigen::last - 6, Eigen::last), Eigen::all).colwise().sum().array();
+        ImpulseResponse response;
+        response.propagator = Model(residence_times, Eigen::VectorXf::Zero(Model::n_compartments), 0).propagator(1);
+        response.states = X0;
+        it = impulse_responses.emplace(key, response).first;
+    }
 
-        X0.fill(0.); // needed to set initial state of sink compartment back to zero
+    // extend the cached response to n_days, one propagator multiplication per day
+    Eigen::MatrixXd &states = it->second.states;
+    int n_cached = states.cols();
+    if (n_cached < n_days) {
+        states.conservativeResize(Eigen::NoChange, n_days);
+        for (int d = n_cached; d < n_days; ++d) {
+            states.col(d) = it->second.propagator * states.col(d - 1);
+        }
     }
+    return states.leftCols(n_days);
+}
 
-    Eigen::VectorXf probability_per_phase_today_mean = group_by_phase(cumulative_states_today_mean);
-    Eigen::VectorXf probability_per_phase_today_best = group_by_phase(cumulative_states_today_best);
-    Eigen::VectorXf probability_per_phase_today_worst = group_by_phase(cumulative_states_today_worst);
+// daily incidence: [day 0, day -1, day -2, ...]
+void PrevalenceEstimator::estimate_prevalence(std::vector<float> daily_incidence) {
+    int n_days = daily_incidence.size();
+    Eigen::VectorXd incidence = Eigen::Map<Eigen::VectorXf>(daily_incidence.data(), n_days).cast<double>();
 
     Eigen::MatrixXf states_mtrx(Model::n_compartments, 3);
-    states_mtrx.col(0) = cumulative_states_today_mean;
-    states_mtrx.col(1) = cumulative_states_today_best;
-    states_mtrx.col(2) = cumulative_states_today_worst;
+    states_mtrx.col(0) = (impulse_response(tau_mean_case, tau_mean_case, n_days) * incidence).cast<float>();
+    states_mtrx.col(1) = (impulse_response(tau_best_case, tau_mean_case, n_days) * incidence).cast<float>();
+    states_mtrx.col(2) = (impulse_response(tau_worst_case, tau_mean_case, n_days) * incidence).cast<float>();
 
     Eigen::MatrixXf probabilities_mtrx(5, 3);
-    probabilities_mtrx.col(0) = probability_per_phase_today_mean;
-    probabilities_mtrx.col(1) = probability_per_phase_today_best;
-    probabilities_mtrx.col(2) = probability_per_phase_today_worst;
+    probabilities_mtrx.col(0) = group_by_phase(states_mtrx.col(0));
+    probabilities_mtrx.col(1) = group_by_phase(states_mtrx.col(1));
+    probabilities_mtrx.col(2) = group_by_phase(states_mtrx.col(2));
 
     this->compartment_states_ = states_mtrx;
     this->phase_probabilities_ = probabilities_mtrx;
@@ -0,0 +1,437 @@
+/* query_service.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the QueryService class. A query is evaluated as by a Simulation with end_of_strategy_outputs,
+ * since the ResultLog only shows the end of the strategy, in the workspace of a worker. The models of different
+ * strategies differ in their test days, so a batch is not vectorised; its queries are handed out to the workers one by
+ * one, which keeps the workers busy when the queries arrive faster than a single query is evaluated. The workers and
+ * their workspaces live as long as the service, so a batch costs neither the start of threads nor allocations.
+ * Identical queries are recognised by the inputs of their simulation, as in the ResultCache, which do not depend on the
+ * order of the fields or on how the numbers are written.
+ */
+
+#include "include/core/query_service.h"
+
+#include "include/core/parallel.h"
+#include "include/core/result_cache.h"
+#include "include/core/simulation.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+// reads the flat JSON object of a query: scalars and arrays of scalars
+class JsonReader {
+    const std::string &text_;
+    size_t position_{};
+
+    [[noreturn]] void fail(const std::string &expected) const {
+        throw std::invalid_argument("expected " + expected + " at offset " + std::to_string(position_));
+    }
+
+  public:
+    explicit JsonReader(const std::string &text) : text_(text) {}
+
+    void skip_whitespace() {
+        while (position_ < text_.size() && (text_[position_] == ' ' || text_[position_] == '\t' ||
+                                            text_[position_] == '\r' || text_[position_] == '\n')) {
+            ++position_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (position_ < text_.size() && text_[position_] == c) {
+            ++position_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("'") + c + "'");
+        }
+    }
+
+    bool at_end() {
+        skip_whitespace();
+        return position_ == text_.size();
+    }
+
+    std::string string() {
+        expect('"');
+        std::string value{};
+        while (position_ < text_.size() && text_[position_] != '"') {
+            char c = text_[position_++];
+            if (c == '\\') {
+                if (position_ == text_.size()) {
+                    break;
+                }
+                // \uXXXX is not supported; the fields of a query are ASCII
+                size_t escape = std::string("nrtbf\"\\/").find(text_[position_++]);
+                if (escape == std::string::npos) {
+                    fail("a supported escape sequence");
+                }
+                c = "\n\r\t\b\f\"\\/"[escape];
+            }
+            value += c;
+        }
+        if (!consume('"')) {
+            fail("the end of the string");
+        }
+        return value;
+    }
+
+    double number() {
+        skip_whitespace();
+        const char *begin = text_.c_str() + position_;
+        char *end;
+        double value = std::strtod(begin, &end);
+        if (end == begin || !std::isfinite(value)) {
+            fail("a number");
+        }
+        position_ += end - begin;
+        return value;
+    }
+
+    int integer() {
+        double value = number();
+        if (value != std::floor(value) || std::abs(value) > 1e6) {
+            fail("an integer");
+        }
+        return int(value);
+    }
+
+    bool boolean() {
+        skip_whitespace();
+        for (bool value : {true, false}) {
+            std::string word = value ? "true" : "false";
+            if (text_.compare(position_, word.size(), word) == 0) {
+                position_ += word.size();
+                return value;
+            }
+        }
+        fail("true or false");
+    }
+
+    // the text of a number, string or null, as it appears in the request
+    std::string scalar() {
+        skip_whitespace();
+        size_t begin = position_;
+        if (position_ < text_.size() && text_[position_] == '"') {
+            string();
+        } else if (text_.compare(position_, 4, "null") == 0) {
+            position_ += 4;
+        } else {
+            number();
+        }
+        return text_.substr(begin, position_ - begin);
+    }
+
+    template <typename Element> std::vector<Element> array(Element (JsonReader::*element)()) {
+        std::vector<Element> values{};
+        expect('[');
+        if (consume(']')) {
+            return values;
+        }
+        do {
+            values.push_back((this->*element)());
+        } while (consume(','));
+        expect(']');
+        return values;
+    }
+};
+
+int test_type(const std::string &name) {
+    if (name != "pcr" && name != "rdt") {
+        throw std::invalid_argument("unknown test type " + name);
+    }
+    return name == "rdt" ? 1 : 0;
+}
+
+void append(std::string &text, const char *key, const Eigen::Vector3f &values) {
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), ", \"%s\": [%.9g, %.9g, %.9g]", key, values(0), values(1), values(2));
+    text += buffer;
+}
+
+// the key of the first value of the answer that is not finite, nullptr if all are; JSON has no NaN or infinity
+const char *non_finite(const QueryService::Answer &answer) {
+    const std::pair<const char *, const Eigen::Vector3f *> fields[] = {
+        {"relative_risk", &answer.relative_risk},
+        {"risk_reduction", &answer.risk_reduction},
+        {"fold_risk_reduction", &answer.fold_risk_reduction},
+        {"p_infectious_tend", &answer.p_infectious_tend}};
+    for (const auto &[key, values] : fields) {
+        if (!values->allFinite()) {
+            return key;
+        }
+    }
+    return nullptr;
+}
+
+// a JSON string with the characters of the message escaped
+std::string quote(const std::string &message) {
+    std::string text = "\"";
+    for (char c : message) {
+        if (c == '"' || c == '\\') {
+            text += '\\';
+        }
+        text += (unsigned char)c < 0x20 ? ' ' : c;
+    }
+    return text + "\"";
+}
+} // namespace
+
+void QueryService::parse(const std::string &request, Query &query) {
+    query = Query{};
+    std::map<std::string, float> values = Parameters::default_values;
+    std::vector<int> days{};
+    std::vector<std::string> types{};
+
+    JsonReader reader(request);
+    reader.expect('{');
+    if (!reader.consume('}')) {
+        do {
+            std::string key = reader.string();
+            reader.expect(':');
+            if (key == "id") {
+                query.id = reader.scalar();
+            } else if (key == "mode") {
+                query.strategy.mode = reader.integer();
+            } else if (key == "delay") {
+                query.strategy.time_delay = reader.integer();
+            } else if (key == "duration") {
+                query.strategy.end_of_strategy = reader.integer();
+            } else if (key == "tests") {
+                days = reader.array(&JsonReader::integer);
+            } else if (key == "test_types") {
+                types = reader.array(&JsonReader::string);
+            } else if (key == "test_type") {
+                query.strategy.test_type = test_type(reader.string());
+            } else if (key == "adherence") {
+                query.strategy.expected_adherence = reader.number() / 100.; // percent to fraction
+            } else if (key == "p_infectious") {
+                query.strategy.p_infectious_t0 = reader.number();
+            } else if (key == "screening") {
+                query.strategy.symptomatic_screening = reader.boolean();
+            } else if (values.count(key)) {
+                values[key] = reader.number();
+            } else {
+                throw std::invalid_argument("unknown field " + key);
+            }
+        } while (reader.consume(','));
+        reader.expect('}');
+    }
+    if (!reader.at_end()) {
+        throw std::invalid_argument("expected the end of the request after the object");
+    }
+
+    // test days are given relative to the start of the strategy, the core expects them 0-indexed from the exposure
+    for (int day : days) {
+        query.strategy.test_moments.push_back(day + query.strategy.time_delay);
+    }
+    for (const std::string &type : types) {
+        query.strategy.test_types.push_back(test_type(type));
+    }
+    query.strategy.check();
+    if (query.strategy.mode == 2) {
+        throw std::invalid_argument("incoming travelers (mode 2) need prevalence states, which a query cannot give");
+    }
+    Parameters::check_values(values);
+    query.parameters = DiseaseParameters::from_values(values);
+}
+
+QueryService::Answer QueryService::evaluate(const Query &query) {
+    Simulation::Workspace workspace;
+    return evaluate(query, workspace);
+}
+
+QueryService::Answer QueryService::evaluate(const Query &query, Simulation::Workspace &workspace) {
+    const Simulation::EndOfStrategy &outputs = Simulation::end_of_strategy(query.parameters, query.strategy, workspace);
+    Answer answer;
+    answer.relative_risk = outputs.relative_risk;
+    answer.risk_reduction = outputs.risk_reduction;
+    answer.fold_risk_reduction = outputs.fold_risk_reduction;
+    answer.p_infectious_tend = outputs.p_infectious_tend;
+    return answer;
+}
+
+std::string QueryService::format(const std::string &id, const Answer &answer) {
+    if (const char *key = non_finite(answer)) {
+        return format_error(id, std::string(key) + " is not finite");
+    }
+    std::string text = "{\"id\": " + id;
+    append(text, "relative_risk", answer.relative_risk);
+    append(text, "risk_reduction", answer.risk_reduction);
+    append(text, "fold_risk_reduction", answer.fold_risk_reduction);
+    append(text, "p_infectious_tend", answer.p_infectious_tend);
+    return text + "}";
+}
+
+std::string QueryService::format_error(const std::string &id, const std::string &message) {
+    return "{\"id\": " + id + ", \"error\": " + quote(message) + "}";
+}
+
+QueryService::QueryService(std::chrono::microseconds window, int max_batch)
+    : window_(window), max_batch_(std::max(max_batch, 1)) {
+    try {
+        for (int w = 0; w < Parallel::n_threads(); ++w) {
+            workers_.emplace_back([this]() { work(); });
+        }
+        batcher_ = std::thread([this]() { run(); });
+    } catch (...) {
+        stop(); // the threads that were started
+        throw;
+    }
+}
+
+QueryService::~QueryService() { stop(); }
+
+void QueryService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_all();
+    if (batcher_.joinable()) {
+        batcher_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batcher_stopped_ = true;
+    }
+    batch_ready_.notify_all();
+    for (std::thread &worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void QueryService::submit(const std::string &request, Respond respond) {
+    Pending pending{};
+    try {
+        parse(request, pending.query);
+    } catch (const std::invalid_argument &e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++statistics_.queries;
+            ++statistics_.errors;
+        }
+        respond(format_error(pending.query.id, e.what()));
+        return;
+    }
+    pending.inputs = ResultCache::inputs(pending.query.parameters, pending.query.strategy);
+    pending.arrival = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++statistics_.queries;
+        std::vector<Waiter> &waiters = in_flight_[pending.inputs];
+        waiters.push_back({pending.query.id, std::move(respond)});
+        if (waiters.size() > 1) { // attached to the identical query in flight
+            ++statistics_.coalesced;
+            return;
+        }
+        queue_.push_back(std::move(pending));
+    }
+    queued_.notify_one();
+}
+
+QueryService::Statistics QueryService::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+void QueryService::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queued_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return; // stopping
+        }
+        // the batch closes when its first query has waited for the window, or when it is full
+        std::chrono::steady_clock::time_point deadline = queue_.front().arrival + window_;
+        queued_.wait_until(lock, deadline, [this]() { return stopping_ || (int)queue_.size() >= max_batch_; });
+
+        size_t size = std::min(queue_.size(), size_t(max_batch_));
+        batch_.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + size));
+        queue_.erase(queue_.begin(), queue_.begin() + size);
+        ++statistics_.batches;
+        next_ = 0;
+        unfinished_ = size;
+        batch_ready_.notify_all();
+
+        // queries that arrive meanwhile form the next batch, or attach to a query of this batch
+        batch_done_.wait(lock, [this]() { return unfinished_ == 0; });
+        batch_.clear();
+    }
+}
+
+void QueryService::work() {
+    Simulation::Workspace workspace{};
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        batch_ready_.wait(lock, [this]() { return batcher_stopped_ || next_ < batch_.size(); });
+        if (next_ >= batch_.size()) {
+            return; // the batcher has stopped
+        }
+        const Pending &pending = batch_[next_++];
+        lock.unlock();
+        answer(pending, workspace);
+        lock.lock();
+        if (--unfinished_ == 0) {
+            batch_done_.notify_one();
+        }
+    }
+}
+
+void QueryService::answer(const Pending &pending, Simulation::Workspace &workspace) {
+    Answer answer;
+    std::string error{};
+    try {
+        answer = evaluate(pending.query, workspace);
+        if (const char *key = non_finite(answer)) { // answered with an error by format() as well
+            error = std::string(key) + " is not finite";
+        }
+    } catch (const std::exception &e) {
+        error = e.what();
+    }
+
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto flight = in_flight_.find(pending.inputs);
+        waiters = std::move(flight->second);
+        in_flight_.erase(flight);
+        ++statistics_.evaluations;
+        statistics_.errors += error.empty() ? 0 : waiters.size();
+    }
+    for (const Waiter &waiter : waiters) {
+        try {
+            waiter.respond(error.empty() ? format(waiter.id, answer) : format_error(waiter.id, error));
+        } catch (...) {
+            // e.g. out of memory, or a connection that closed; the other waiters are still answered
+        }
+    }
+}
@@ -0,0 +1,183 @@
+/* regional_prevalence.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the RegionalPrevalence class.
+ */
+
+#include "include/core/regional_prevalence.h"
+#include "include/core/incidence_file.h"
+#include "include/core/model.h"
+#include "include/core/parallel.h"
+#include "include/core/prevalence_estimator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+const int block_size = 256; // regions per matrix product
+} // namespace
+
+std::vector<RegionalPrevalence::Region> RegionalPrevalence::read_csv(std::istream &stream) {
+    struct Report {
+        int day;
+        float incidence;
+    };
+    std::vector<Region> regions{};
+    std::vector<std::vector<Report>> reports{}; // per region
+    std::vector<int> last_days{};               // per region
+    std::unordered_map<std::string, int> index{};
+    int last = -1; // reports of a region are usually consecutive
+
+    std::string text;
+    for (int line_number = 1; std::getline(stream, text); ++line_number) {
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+        if (text.empty() || (line_number == 1 && text.rfind("region", 0) == 0)) { // header
+            continue;
+        }
+        IncidenceFile::Line line;
+        if (!IncidenceFile::parse_line(text.data(), text.data() + text.size(), line)) {
+            throw std::runtime_error("line " + std::to_string(line_number) +
+                                     ": expected `<region>,<YYYY-MM-DD>,<cases>,<population>,<detection rate>`");
+        }
+
+        if (last < 0 || text.compare(0, line.name_length, regions[last].name) != 0) {
+            std::string name(line.name, line.name_length);
+            auto it = index.find(name);
+            if (it == index.end()) {
+                it = index.emplace(name, regions.size()).first;
+                regions.push_back({name, {}, {}});
+                reports.emplace_back();
+                last_days.push_back(-1);
+            }
+            last = it->second;
+        }
+        reports[last].push_back({line.day, line.incidence});
+        if (line.day > last_days[last]) {
+            last_days[last] = line.day;
+            regions[last].date.assign(line.date, 10);
+        }
+    }
+
+    for (int r = 0; r < (int)regions.size(); ++r) {
+        int first_day = last_days[r];
+        for (const Report &report : reports[r]) {
+            first_day = std::min(first_day, report.day);
+        }
+        regions[r].daily_incidence.assign(last_days[r] - first_day + 1, 0);
+        for (const Report &report : reports[r]) {
+            regions[r].daily_incidence[last_days[r] - report.day] += report.incidence;
+        }
+    }
+    return regions;
+}
+
+int RegionalPrevalence::n_days(const std::vector<Region> &regions) {
+    int n_days = 0;
+    for (const Region &region : regions) {
+        n_days = std::max(n_days, (int)region.daily_incidence.size());
+    }
+    return n_days;
+}
+
+RegionalPrevalence::RegionalPrevalence(const DiseaseParameters &parameters, int n_days) : n_days_(n_days) {
+    for (const std::vector<float> &tau :
+         {parameters.tau_mean_case, parameters.tau_best_case, parameters.tau_worst_case}) {
+        responses_.push_back(
+            PrevalenceEstimator::impulse_response(tau, parameters.tau_mean_case, n_days).cast<float>());
+    }
+}
+
+Eigen::MatrixXf RegionalPrevalence::compartment_states(const Eigen::MatrixXf &incidence, int scenario) const {
+    return responses_[scenario].leftCols(incidence.rows()) * incidence;
+}
+
+Eigen::MatrixXf RegionalPrevalence::phase_probabilities(const Eigen::MatrixXf &compartment_states) {
+    Eigen::MatrixXf grouped(5, compartment_states.cols());
+    int counter = 0;
+    for (int i = 0; i < 5; ++i) {
+        grouped.row(i) = compartment_states.middleRows(counter, Model::sub_compartments[i]).colwise().sum();
+        counter += Model::sub_compartments[i];
+    }
+    return grouped;
+}
+
+void RegionalPrevalence::write_csv(const std::vector<Region> &regions, std::ostream &output, bool compartments,
+                                   bool header) const {
+    if (n_days(regions) > n_days_) {
+        throw std::invalid_argument("the incidence histories exceed the days of the impulse responses");
+    }
+
+    if (header) {
+        output << "region,date,scenario,predetection,presymptomatic,symptomatic,postinfectious,prevalence_total,"
+                  "prevalence_infectious";
+        for (int c = 0; compartments && c < Model::n_compartments - 1; ++c) {
+            output << ",compartment_" << c;
+        }
+        output << "\n";
+    }
+
+    const char *scenarios[] = {"typical", "best", "worst"};
+    int n_blocks = (regions.size() + block_size - 1) / block_size;
+    int blocks_per_batch = 4 * Parallel::n_threads();
+    for (int first_block = 0; first_block < n_blocks; first_block += blocks_per_batch) {
+        int n = std::min(blocks_per_batch, n_blocks - first_block);
+        std::vector<std::string> text(n);
+        Parallel::for_each(n, [&](int b) {
+            int first = (first_block + b) * block_size;
+            int n_regions = std::min(block_size, (int)regions.size() - first);
+
+            Eigen::MatrixXf incidence = Eigen::MatrixXf::Zero(n_days_, n_regions);
+            for (int r = 0; r < n_regions; ++r) {
+                const std::vector<float> &daily_incidence = regions[first + r].daily_incidence;
+                incidence.col(r).head(daily_incidence.size()) =
+                    Eigen::Map<const Eigen::VectorXf>(daily_incidence.data(), daily_incidence.size());
+            }
+
+            Eigen::MatrixXf states[3], phases[3];
+            for (int s = 0; s < 3; ++s) {
+                states[s] = compartment_states(incidence, s);
+                phases[s] = phase_probabilities(states[s]);
+            }
+
+            char buffer[32];
+            for (int r = 0; r < n_regions; ++r) {
+                for (int s = 0; s < 3; ++s) {
+                    text[b] += regions[first + r].name + "," + regions[first + r].date + "," + scenarios[s];
+                    Eigen::VectorXf p = phases[s].col(r);
+                    float values[6] = {p(0), p(1), p(2), p(3), p(0) + p(1) + p(2) + p(3), p(0) + p(1) + p(2)};
+                    for (float value : values) {
+                        std::snprintf(buffer, sizeof(buffer), ",%g", value);
+                        text[b] += buffer;
+                    }
+                    for (int c = 0; compartments && c < Model::n_compartments - 1; ++c) {
+                        std::snprintf(buffer, sizeof(buffer), ",%g", states[s](c, r));
+                        text[b] += buffer;
+                    }
+                    text[b] += "\n";
+                }
+            }
+        });
+        for (const std::string &block : text) {
+            output << block;
+        }
+    }
+}
@@ -0,0 +1,423 @@
+/* result_cache.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ResultCache class. An entry is the file `<hash>.result` in the cache directory: the magic
+ * `CSCCACHE`, the version, the size of the inputs and the inputs themselves, followed by the matrices of the results
+ * (rows, columns and the values in column-major order). All values are little-endian, also in the inputs. The inputs
+ * are compared on lookup, such that a collision of the hash is a miss. A lookup sets the modification time of the
+ * entry, which orders the entries for eviction. The files are handled by the calls of the platform, as in MappedFile,
+ * since std::filesystem needs macOS 10.15.
+ */
+
+#include "include/core/result_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+const char magic[8] = {'C', 'S', 'C', 'C', 'A', 'C', 'H', 'E'};
+const char extension[] = ".result";
+
+struct FileStatus {
+    bool exists{false};
+    bool directory{false};
+    uint64_t size{};
+    int64_t time{}; // of the last modification, in nanoseconds since the Unix epoch
+};
+
+FileStatus status(const std::string &path) {
+    FileStatus status;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+        status.exists = true;
+        status.directory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+        status.size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        int64_t ticks = (int64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        status.time = (ticks - 116444736000000000) * 100; // 100 ns ticks since 1601
+    }
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+        status.exists = true;
+        status.directory = S_ISDIR(info.st_mode);
+        status.size = info.st_size;
+#ifdef __APPLE__
+        status.time = int64_t(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+        status.time = int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    }
+#endif
+    return status;
+}
+
+// creates the directory and its parents; existing directories are kept
+void create_directories(const std::string &path) {
+    for (size_t end = path.find_first_of("/\\", 1);; end = path.find_first_of("/\\", end + 1)) {
+        std::string directory = path.substr(0, end);
+#ifdef _WIN32
+        CreateDirectoryA(directory.c_str(), nullptr);
+#else
+        mkdir(directory.c_str(), 0777);
+#endif
+        if (end == std::string::npos) {
+            return;
+        }
+    }
+}
+
+// sets the modification time to now; fails harmlessly if the file was removed
+void touch(const std::string &path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), FILE_WRITE_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        SetFileTime(file, nullptr, nullptr, &now);
+        CloseHandle(file);
+    }
+#else
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+#endif
+}
+
+// renames the file, replacing the target if it exists
+bool replace(const std::string &from, const std::string &to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+std::vector<std::string> file_names(const std::string &directory) {
+    std::vector<std::string> names{};
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &data);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            names.push_back(data.cFileName);
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+#else
+    if (DIR *entries = opendir(directory.c_str())) {
+        while (dirent *entry = readdir(entries)) {
+            names.push_back(entry->d_name);
+        }
+        closedir(entries);
+    }
+#endif
+    return names;
+}
+
+bool ends_with(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// the values are written as little-endian bytes, such that machines of any byte order can share a cache directory
+void append(std::string &bytes, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        bytes += char(value >> shift);
+    }
+}
+
+void append(std::string &bytes, int32_t value) { append(bytes, uint32_t(value)); }
+
+void append(std::string &bytes, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    append(bytes, bits);
+}
+
+void append(std::string &bytes, bool value) { bytes += char(value); }
+
+template <typename T> void append(std::string &bytes, const std::vector<T> &values) {
+    append(bytes, uint32_t(values.size()));
+    for (T value : values) {
+        append(bytes, value);
+    }
+}
+
+void append(std::string &bytes, const Eigen::MatrixXf &matrix) {
+    append(bytes, int32_t(matrix.rows()));
+    append(bytes, int32_t(matrix.cols()));
+    for (Eigen::Index i = 0; i < matrix.size(); ++i) {
+        append(bytes, matrix.data()[i]);
+    }
+}
+
+// reads the values of an entry in the order in which they were appended; fails on reading beyond its end
+class Reader {
+    const std::string &bytes_;
+    size_t position_{};
+
+  public:
+    explicit Reader(const std::string &bytes) : bytes_(bytes) {}
+
+    bool read(void *destination, size_t size) {
+        if (size > bytes_.size() - position_) {
+            return false;
+        }
+        std::memcpy(destination, bytes_.data() + position_, size);
+        position_ += size;
+        return true;
+    }
+
+    bool read(uint32_t &value) {
+        unsigned char little_endian[4];
+        if (!read(little_endian, 4)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= uint32_t(little_endian[i]) << (8 * i);
+        }
+        return true;
+    }
+
+    template <typename Matrix> bool read(Matrix &matrix) {
+        uint32_t shape[2];
+        if (!read(shape[0]) || !read(shape[1]) || shape[0] > INT32_MAX || shape[1] > INT32_MAX ||
+            uint64_t(shape[0]) * uint64_t(shape[1]) > (bytes_.size() - position_) / sizeof(float)) {
+            return false;
+        }
+        matrix.resize(shape[0], shape[1]);
+        for (Eigen::Index i = 0; i < matrix.size(); ++i) {
+            uint32_t bits = 0;
+            if (!read(bits)) {
+                return false;
+            }
+            std::memcpy(matrix.data() + i, &bits, 4);
+        }
+        return true;
+    }
+
+    bool skip(size_t size) {
+        if (size > bytes_.size() - position_) {
+            return false;
+        }
+        position_ += size;
+        return true;
+    }
+
+    bool at_end() const { return position_ == bytes_.size(); }
+};
+} // namespace
+
+std::string ResultCache::inputs(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                                const Eigen::VectorXf &prevalence_states) {
+    std::string bytes{};
+    append(bytes, version);
+
+    append(bytes, parameters.tau_mean_case);
+    append(bytes, parameters.tau_best_case);
+    append(bytes, parameters.tau_worst_case);
+    append(bytes, parameters.fraction_asymptomatic);
+    append(bytes, parameters.pcr_sens);
+    append(bytes, parameters.rdt_relative_sens);
+    append(bytes, parameters.test_specificity);
+
+    append(bytes, strategy.mode);
+    append(bytes, strategy.time_delay);
+    append(bytes, strategy.end_of_strategy);
+    append(bytes, strategy.test_moments);
+    append(bytes, strategy.types_of_tests()); // the test type only matters through the type of each test
+    append(bytes, strategy.expected_adherence);
+    append(bytes, strategy.p_infectious_t0);
+    append(bytes, strategy.symptomatic_screening);
+
+    // the simulation uses the prevalence states in incoming travelers mode only
+    bool use_prevalence_states = strategy.mode == 2 && prevalence_states.size();
+    append(bytes, use_prevalence_states ? Eigen::MatrixXf(prevalence_states) : Eigen::MatrixXf());
+    return bytes;
+}
+
+uint64_t ResultCache::hash(const std::string &inputs) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : inputs) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+ResultCache::ResultCache(const std::string &directory, uint64_t max_size)
+    : directory_(directory), max_size_(max_size) {
+    create_directories(directory_);
+    if (!status(directory_).directory) {
+        throw std::runtime_error("cannot create the cache directory " + directory_);
+    }
+    evict(); // counts the size of the entries of earlier sessions
+}
+
+std::string ResultCache::path(const std::string &inputs) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash(inputs)));
+    return directory_ + "/" + name + extension;
+}
+
+bool ResultCache::find(const std::string &inputs, Simulation::Results &results) const {
+    std::string path = this->path(inputs);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::string bytes(size_t(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(bytes.data(), bytes.size());
+    if (!file) {
+        return false;
+    }
+
+    Reader reader(bytes);
+    char entry_magic[8];
+    uint32_t entry_version, inputs_size;
+    bool valid = reader.read(entry_magic, 8) && std::memcmp(entry_magic, magic, 8) == 0 &&
+                 reader.read(entry_version) && entry_version == version && reader.read(inputs_size) &&
+                 inputs_size == inputs.size() && bytes.compare(16, inputs.size(), inputs) == 0 &&
+                 reader.skip(inputs_size);
+
+    Simulation::Results entry;
+    valid = valid && reader.read(entry.risk_no_intervention) && reader.read(entry.risk_NPI);
+    for (int type = 0; type < 2; ++type) {
+        valid = valid && reader.read(entry.temporal_assay_sensitivity[type]) && reader.read(entry.test_efficacy[type]);
+    }
+    valid = valid && reader.read(entry.p_infectious_tend) && reader.at_end();
+    if (!valid) { // a collision of the hash or an entry of another version
+        return false;
+    }
+
+    touch(path); // the entry may have been evicted meanwhile, which is harmless
+    results = std::move(entry);
+    return true;
+}
+
+void ResultCache::insert(const std::string &inputs, const Simulation::Results &results) {
+    std::string bytes(magic, sizeof(magic));
+    append(bytes, version);
+    append(bytes, uint32_t(inputs.size()));
+    bytes += inputs;
+    append(bytes, results.risk_no_intervention);
+    append(bytes, results.risk_NPI);
+    for (int type = 0; type < 2; ++type) {
+        append(bytes, results.temporal_assay_sensitivity[type]);
+        append(bytes, results.test_efficacy[type]);
+    }
+    append(bytes, Eigen::MatrixXf(results.p_infectious_tend));
+
+    // a unique temporary file, renamed into place such that a lookup sees the complete entry or none
+    std::string path = this->path(inputs);
+    std::string temporary = path + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+        file.close();
+        if (!file) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("cannot write " + temporary);
+        }
+    }
+    uint64_t replaced = status(path).size; // of the entry that is replaced, if any
+    if (!replace(temporary, path)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("cannot write " + path);
+    }
+
+    size_ += bytes.size();
+    size_ -= replaced < size_ ? replaced : uint64_t(size_);
+    if (size_ > max_size_) {
+        evict();
+    }
+}
+
+void ResultCache::evict() {
+    std::lock_guard<std::mutex> lock(eviction_mutex_);
+    struct Entry {
+        int64_t time;
+        uint64_t size;
+        std::string path;
+    };
+    std::vector<Entry> entries{};
+    uint64_t size = 0;
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    for (const std::string &name : file_names(directory_)) {
+        std::string path = directory_ + "/" + name;
+        FileStatus file = status(path);
+        if (!file.exists || file.directory) {
+            continue; // removed meanwhile
+        }
+        if (ends_with(name, extension)) {
+            entries.push_back({file.time, file.size, path});
+            size += file.size;
+        } else if (name.find(std::string(extension) + ".tmp") != std::string::npos &&
+                   now - file.time > int64_t(3600) * 1000000000) {
+            std::remove(path.c_str()); // left by an interrupted insert
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.time < b.time; });
+    for (const Entry &entry : entries) {
+        if (size <= max_size_ / 4 * 3) {
+            break;
+        }
+        if (std::remove(entry.path.c_str()) == 0) {
+            size -= entry.size;
+        }
+    }
+    size_ = size;
+}
+
+std::unique_ptr<Simulation> ResultCache::simulation(const DiseaseParameters &parameters,
+                                                    const StrategyParameters &strategy,
+                                                    const Eigen::VectorXf &prevalence_states) {
+    std::string inputs = ResultCache::inputs(parameters, strategy, prevalence_states);
+    Simulation::Results results;
+    if (find(inputs, results)) {
+        return std::make_unique<Simulation>(parameters, strategy, results);
+    }
+
+    std::unique_ptr<Simulation> simulation = std::make_unique<Simulation>(parameters, strategy, prevalence_states);
+    try {
+        insert(inputs, simulation->results());
+    } catch (const std::runtime_error &) {
+        // e.g. a full disk; the cache only saves time
+    }
+    return simulation;
+}
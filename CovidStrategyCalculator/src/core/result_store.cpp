@@ -0,0 +1,282 @@
+/* result_store.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ResultStore class. The writer reserves the full size of the file when it is created (a
+ * sparse file on most file systems), such that the columns do not move while the sweep is written, and updates the
+ * number of rows in the header after every batch. The header is 64 bytes, followed by a 64-byte descriptor per column:
+ * type (1 byte), role (1 byte), 6 bytes reserved, offset (8 bytes) and the zero-terminated name (48 bytes).
+ */
+
+#include "include/core/result_store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// the header and the columns are written and read in the byte order of the host, in place
+#ifdef __BYTE_ORDER__
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "result stores are little-endian");
+#endif
+
+const char ResultStore::magic[8] = {'C', 'S', 'C', 'S', 'T', 'O', 'R', 'E'};
+
+namespace {
+const size_t header_size = 64;
+const size_t descriptor_size = 64;
+const size_t name_size = 48;
+const size_t alignment = 64;
+const size_t n_rows_offset = 24; // of the number of rows in the header
+
+uint64_t aligned(uint64_t offset) { return (offset + alignment - 1) / alignment * alignment; }
+} // namespace
+
+size_t ResultStore::type_size(Type type) {
+    switch (type) {
+    case int32:
+    case float32:
+        return 4;
+    case int64:
+    case float64:
+        return 8;
+    default:
+        throw std::invalid_argument("unknown column type");
+    }
+}
+
+const char *ResultStore::type_name(Type type) {
+    static const char *names[n_types] = {"int32", "int64", "float32", "float64"};
+    if (type < 0 || type >= n_types) {
+        throw std::invalid_argument("unknown column type");
+    }
+    return names[type];
+}
+
+ResultStore::Writer::Writer(const std::string &path, const std::vector<Column> &columns, int64_t capacity)
+    : columns_(columns), capacity_(capacity) {
+    if (columns_.empty() || capacity_ < 0) {
+        throw std::invalid_argument("a result store has at least one column and a non-negative capacity");
+    }
+
+    std::vector<char> header(header_size + descriptor_size * columns_.size(), 0);
+    uint32_t n_columns = columns_.size();
+    uint64_t rows[2] = {uint64_t(capacity_), 0};
+    std::memcpy(header.data(), magic, sizeof(magic));
+    std::memcpy(header.data() + 8, &version, 4);
+    std::memcpy(header.data() + 12, &n_columns, 4);
+    std::memcpy(header.data() + 16, rows, 16);
+
+    size_ = aligned(header.size());
+    for (int c = 0; c < (int)columns_.size(); ++c) {
+        const Column &column = columns_[c];
+        if (column.name.empty() || column.name.size() >= name_size) {
+            throw std::invalid_argument("the column names have 1 to 47 characters");
+        }
+        if (column.role != parameter && column.role != output) {
+            throw std::invalid_argument("unknown column role");
+        }
+        offsets_.push_back(size_);
+        size_ = aligned(size_ + type_size(column.type) * capacity_);
+
+        char *descriptor = header.data() + header_size + descriptor_size * c;
+        descriptor[0] = char(column.type);
+        descriptor[1] = char(column.role);
+        std::memcpy(descriptor + 8, &offsets_.back(), 8);
+        std::memcpy(descriptor + 16, column.name.data(), column.name.size());
+    }
+
+    file_.open(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    file_.write(header.data(), header.size());
+    if (size_ > header.size()) { // reserves the columns
+        file_.seekp(size_ - 1);
+        file_.put(0);
+    }
+    file_.flush();
+    if (!file_) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+ResultStore::Writer::~Writer() {
+    try {
+        close();
+    } catch (const std::exception &) {
+        // the rows written so far are in the header already
+    }
+}
+
+void ResultStore::Writer::write(int64_t first_row, const Eigen::MatrixXd &rows) {
+    if (rows.cols() != (int)columns_.size()) {
+        throw std::invalid_argument("the rows hold one value per column of the result store");
+    }
+    if (first_row < 0 || first_row + rows.rows() > capacity_) {
+        throw std::invalid_argument("the rows exceed the capacity of the result store");
+    }
+
+    // the conversion to the column types does not need the lock
+    std::vector<std::vector<char>> buffers(columns_.size());
+    for (int c = 0; c < (int)columns_.size(); ++c) {
+        buffers[c].resize(type_size(columns_[c].type) * rows.rows());
+        char *buffer = buffers[c].data();
+        for (int i = 0; i < rows.rows(); ++i) {
+            double value = rows(i, c);
+            switch (columns_[c].type) {
+            case int32:
+                reinterpret_cast<int32_t *>(buffer)[i] = int32_t(std::llround(value));
+                break;
+            case int64:
+                reinterpret_cast<int64_t *>(buffer)[i] = int64_t(std::llround(value));
+                break;
+            case float32:
+                reinterpret_cast<float *>(buffer)[i] = float(value);
+                break;
+            default:
+                reinterpret_cast<double *>(buffer)[i] = value;
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        throw std::runtime_error("the result store is closed");
+    }
+    for (int c = 0; c < (int)columns_.size(); ++c) {
+        file_.seekp(offsets_[c] + type_size(columns_[c].type) * first_row);
+        file_.write(buffers[c].data(), buffers[c].size());
+    }
+    int64_t end = first_row + rows.rows();
+    written_ = std::max(written_, end);
+    reserved_ = std::max(reserved_, end);
+
+    // the rows are published once the rows before them are written, appended rows may be written out of order
+    int64_t n_rows = n_rows_;
+    blocks_[first_row] = std::max(blocks_[first_row], end);
+    while (!blocks_.empty() && blocks_.begin()->first <= n_rows_) {
+        n_rows_ = std::max(n_rows_, blocks_.begin()->second);
+        blocks_.erase(blocks_.begin());
+    }
+    if (n_rows_ != n_rows) {
+        uint64_t header_rows = n_rows_;
+        file_.seekp(n_rows_offset);
+        file_.write(reinterpret_cast<const char *>(&header_rows), 8);
+    }
+    file_.flush();
+    if (!file_) {
+        throw std::runtime_error("cannot write the result store");
+    }
+}
+
+int64_t ResultStore::Writer::append(const Eigen::MatrixXd &rows) {
+    int64_t first_row;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first_row = reserved_;
+        if (first_row + rows.rows() > capacity_) {
+            throw std::invalid_argument("the rows exceed the capacity of the result store");
+        }
+        reserved_ += rows.rows(); // reserves the rows for this batch
+    }
+    write(first_row, rows);
+    return first_row;
+}
+
+void ResultStore::Writer::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.is_open()) {
+        uint64_t n_rows = written_;
+        file_.seekp(n_rows_offset);
+        file_.write(reinterpret_cast<const char *>(&n_rows), 8);
+        bool written = bool(file_.flush());
+        file_.close();
+        if (!written) {
+            throw std::runtime_error("cannot write the result store");
+        }
+    }
+}
+
+ResultStore::ResultStore(const std::string &path) : file_(path) {
+    const char *data = file_.data();
+    size_t size = file_.size();
+    if (size < header_size || std::memcmp(data, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " is not a result store");
+    }
+    uint32_t file_version, n_columns;
+    uint64_t rows[2];
+    std::memcpy(&file_version, data + 8, 4);
+    std::memcpy(&n_columns, data + 12, 4);
+    std::memcpy(rows, data + 16, 16);
+    if (file_version != version || n_columns == 0 || n_columns > (size - header_size) / descriptor_size ||
+        rows[1] > rows[0]) {
+        throw std::runtime_error(path + " is not a result store of version " + std::to_string(version));
+    }
+    capacity_ = rows[0];
+    n_rows_ = rows[1];
+
+    for (uint32_t c = 0; c < n_columns; ++c) {
+        const char *descriptor = data + header_size + descriptor_size * c;
+        uint64_t offset;
+        std::memcpy(&offset, descriptor + 8, 8);
+        Type type = Type(descriptor[0]);
+        Role role = Role(descriptor[1]);
+        bool valid = type >= 0 && type < n_types && (role == parameter || role == output) &&
+                     descriptor[16 + name_size - 1] == 0 && offset % alignment == 0 && offset <= size &&
+                     rows[0] <= (size - offset) / type_size(type);
+        if (!valid) {
+            throw std::runtime_error(path + " has an invalid column descriptor");
+        }
+        columns_.push_back({std::string(descriptor + 16), type, role});
+        offsets_.push_back(offset);
+    }
+}
+
+int ResultStore::column_index(const std::string &name) const {
+    for (int c = 0; c < (int)columns_.size(); ++c) {
+        if (columns_[c].name == name) {
+            return c;
+        }
+    }
+    throw std::invalid_argument("the result store has no column " + name);
+}
+
+const void *ResultStore::column_data(int column, Type type) const {
+    if (column < 0 || column >= (int)columns_.size()) {
+        throw std::invalid_argument("column index out of range");
+    }
+    if (columns_[column].type != type) {
+        throw std::invalid_argument("column " + columns_[column].name + " holds " + type_name(columns_[column].type));
+    }
+    return file_.data() + offsets_[column];
+}
+
+double ResultStore::value(int64_t row, int column) const {
+    if (row < 0 || row >= n_rows_ || column < 0 || column >= (int)columns_.size()) {
+        throw std::invalid_argument("row or column out of range");
+    }
+    const void *values = column_data(column, columns_[column].type);
+    switch (columns_[column].type) {
+    case int32:
+        return static_cast<const int32_t *>(values)[row];
+    case int64:
+        return static_cast<const int64_t *>(values)[row];
+    case float32:
+        return static_cast<const float *>(values)[row];
+    default:
+        return static_cast<const double *>(values)[row];
+    }
+}
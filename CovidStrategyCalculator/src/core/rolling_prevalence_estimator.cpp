@@ -0,0 +1,86 @@
+/* rolling_prevalence_estimator.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the RollingPrevalenceEstimator class. The states are linear in the incidence, so a correction
+ * of a recent day is replayed by adding the change in incidence times the impulse response at the age of that day.
+ */
+
+#include "include/core/rolling_prevalence_estimator.h"
+#include "include/core/prevalence_estimator.h"
+
+#include <stdexcept>
+
+RollingPrevalenceEstimator::RollingPrevalenceEstimator(const DiseaseParameters &parameters,
+                                                       std::vector<float> daily_incidence, int window)
+    : Simulation(parameters), window_(window) {
+    if (window < 1) {
+        throw std::invalid_argument("the correction window is at least one day");
+    }
+    this->t_end = 0;                                   // placeholder, not used
+    this->risk_posing_fraction_symptomatic_phase = 1.; // no symptom screening
+    this->expected_adherence = 1.;                     // placeholder, not used
+    this->t_test = {};                                 // placeholder, not used
+
+    for (const std::vector<float> &tau : {tau_mean_case, tau_best_case, tau_worst_case}) {
+        propagators_.push_back(Model(tau, Eigen::VectorXf::Zero(Model::n_compartments), 0).propagator(1));
+        responses_.push_back(PrevalenceEstimator::impulse_response(tau, tau_mean_case, window));
+        states_.push_back(Eigen::Matrix<double, 21, 1>::Zero());
+    }
+
+    for (auto it = daily_incidence.rbegin(); it != daily_incidence.rend(); ++it) { // oldest day first
+        advance(*it);
+    }
+}
+
+void RollingPrevalenceEstimator::advance(float incidence) {
+    for (int s = 0; s < 3; ++s) {
+        states_[s] = propagators_[s] * states_[s] + incidence * responses_[s].col(0);
+    }
+    recent_incidence_.push_front(incidence);
+    if ((int)recent_incidence_.size() > window_) {
+        recent_incidence_.pop_back();
+    }
+}
+
+void RollingPrevalenceEstimator::correct(int days_ago, float incidence) {
+    if (days_ago < 0 || days_ago >= (int)recent_incidence_.size()) {
+        throw std::out_of_range("the corrected day lies outside the correction window");
+    }
+    double change = incidence - recent_incidence_[days_ago];
+    for (int s = 0; s < 3; ++s) {
+        states_[s] += change * responses_[s].col(days_ago);
+    }
+    recent_incidence_[days_ago] = incidence;
+}
+
+Eigen::MatrixXf RollingPrevalenceEstimator::compartment_states() {
+    Eigen::MatrixXf states_mtrx(Model::n_compartments, 3);
+    for (int s = 0; s < 3; ++s) {
+        states_mtrx.col(s) = states_[s].cast<float>();
+    }
+    return states_mtrx;
+}
+
+Eigen::MatrixXf RollingPrevalenceEstimator::phase_probabilities() {
+    Eigen::MatrixXf states_mtrx = compartment_states();
+    Eigen::MatrixXf probabilities_mtrx(5, 3);
+    for (int s = 0; s < 3; ++s) {
+        probabilities_mtrx.col(s) = group_by_phase(states_mtrx.col(s));
+    }
+    return probabilities_mtrx;
+}
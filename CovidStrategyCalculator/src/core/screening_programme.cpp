@@ -0,0 +1,125 @@
+/* screening_programme.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the ScreeningProgramme class. The risk node accumulates the risk, so the risk posed in a time
+ * window is the increase of the last state. Under indefinite screening, the transient compartments of a population
+ * with constant incidence converge to the fixed point x = M x + b of the period operator M and the infections b of
+ * one period; the risk per period then follows from the risk row of M.
+ */
+
+#include "include/core/screening_programme.h"
+#include "include/core/model.h"
+
+#include <stdexcept>
+
+ScreeningProgramme::Operator ScreeningProgramme::power(const Operator &M, int n) {
+    Operator result = Operator::Identity();
+    Operator square = M;
+    for (; n > 0; n >>= 1) {
+        if (n & 1) {
+            result = square * result;
+        }
+        square = square * square;
+    }
+    return result;
+}
+
+ScreeningProgramme::ScreeningProgramme(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                                       int period)
+    : period_(period) {
+    if (period < 1) {
+        throw std::invalid_argument("the period of a screening programme is at least one day");
+    }
+    if (strategy.mode == 2) {
+        throw std::invalid_argument("a screening programme starts from an exposure or a symptom onset");
+    }
+    test_types_.assign(period, -1);
+    std::vector<int> types = strategy.types_of_tests();
+    for (int i = 0; i < (int)strategy.test_moments.size(); ++i) {
+        int day = strategy.test_moments[i] - strategy.time_delay;
+        if (day < 0 || day >= period) {
+            throw std::invalid_argument("the tests of a screening programme lie within its first period");
+        }
+        test_types_[day] = types[i];
+    }
+
+    float risk_posing_fraction_symptomatic_phase =
+        strategy.symptomatic_screening ? parameters.fraction_asymptomatic : 1;
+    std::vector<float> test_sensitivity{parameters.pcr_sens,
+                                        float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+
+    // initial states as in the Simulation class, and the states of one new infection
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    X0(strategy.mode == 1 ? Model::sub_compartments[0] + Model::sub_compartments[1] : 0) = strategy.p_infectious_t0;
+    Eigen::Matrix<double, 21, 1> exposure = Eigen::Matrix<double, 21, 1>::Unit(0);
+
+    int risk_node = Model::n_compartments - 1;
+    int n_periods = strategy.end_of_strategy / period;
+    int remaining_days = strategy.end_of_strategy % period;
+    float adherence_squared = strategy.expected_adherence * strategy.expected_adherence; // see Simulation::risk_NPI
+
+    relative_risk_.resize(3);
+    steady_state_relative_risk_.resize(3);
+    for (const std::vector<float> &tau :
+         {parameters.tau_mean_case, parameters.tau_best_case, parameters.tau_worst_case}) {
+        Model screened(tau, risk_posing_fraction_symptomatic_phase, X0, 0, {}, {}, test_sensitivity,
+                       parameters.test_specificity);
+        Model natural(tau, X0, 0); // without tests or symptomatic screening
+        Operator P = screened.propagator(1);
+        Operator P0 = natural.propagator(1);
+
+        /* one period, with and without the programme; b and b0 are the states at the end of the period of one
+         * infection at the start of each day
+         */
+        Operator M = Operator::Identity(), M_remaining = Operator::Identity(), M0 = Operator::Identity();
+        Eigen::Matrix<double, 21, 1> b = Eigen::Matrix<double, 21, 1>::Zero(), b0 = b;
+        for (int day = 0; day < period; ++day) {
+            Operator O = P;
+            if (test_types_[day] >= 0) {
+                O = P * screened.false_ommision_rate(test_types_[day]).asDiagonal();
+            }
+            M = O * M;
+            M0 = P0 * M0;
+            b = O * b + P * exposure;
+            b0 = P0 * b0 + P0 * exposure;
+            if (day == remaining_days - 1) {
+                M_remaining = M;
+            }
+        }
+        period_operators_.push_back(M);
+
+        // individual exposed at day 0; the programme starts after the time delay
+        Eigen::Matrix<double, 21, 1> x_start = power(P0, strategy.time_delay) * X0.cast<double>();
+        Eigen::Matrix<double, 21, 1> x_end = M_remaining * (power(M, n_periods) * x_start);
+        Eigen::Matrix<double, 21, 1> x0_end = power(P0, strategy.end_of_strategy) * x_start;
+        double risk = x_end(risk_node) - x_start(risk_node);
+        double risk_no_intervention = x0_end(risk_node) - x_start(risk_node);
+
+        // fixed point of the transient compartments, and the risk per period
+        auto risk_per_period = [&](const Operator &M, const Eigen::Matrix<double, 21, 1> &b) {
+            Eigen::MatrixXd I = Eigen::MatrixXd::Identity(risk_node, risk_node);
+            Eigen::VectorXd x = (I - M.topLeftCorner(risk_node, risk_node)).partialPivLu().solve(b.head(risk_node));
+            return M.row(risk_node).head(risk_node).dot(x) + b(risk_node);
+        };
+
+        int scenario = period_operators_.size() - 1;
+        relative_risk_(scenario) = adherence_squared * risk / risk_no_intervention + 1 - adherence_squared;
+        steady_state_relative_risk_(scenario) =
+            adherence_squared * risk_per_period(M, b) / risk_per_period(M0, b0) + 1 - adherence_squared;
+    }
+}
@@ -0,0 +1,126 @@
+/* sensitivity_analysis.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the SensitivityAnalysis class. The first-order indices use the estimator of Saltelli et al.
+ * (2010), the total indices the estimator of Jansen (1999).
+ */
+
+#include "include/core/sensitivity_analysis.h"
+#include "include/core/ensemble.h"
+#include "include/core/parallel.h"
+#include "include/core/sobol_sequence.h"
+
+#include <algorithm>
+
+SensitivityAnalysis::SensitivityAnalysis(ParameterSpace space, std::vector<StrategyParameters> strategies,
+                                         float adherence_spread, Eigen::VectorXf prevalence_states)
+    : space_(space), strategies_(strategies), adherence_spread_(adherence_spread),
+      prevalence_states_(prevalence_states) {}
+
+std::vector<std::string> SensitivityAnalysis::inputs() const {
+    std::vector<std::string> keys{};
+    for (const ParameterRange &range : space_.ranges()) {
+        keys.push_back(range.key);
+    }
+    keys.push_back("expected_adherence");
+    return keys;
+}
+
+void SensitivityAnalysis::run(int n_base_samples, uint32_t seed) {
+    int k = space_.dimensions(); // sampled disease parameters; input k is the expected adherence
+    int n = n_base_samples;
+
+    // the columns of A and B are the first and last k + 1 coordinates of a 2(k + 1) dimensional Sobol sequence
+    Eigen::MatrixXd points = SobolSequence(2 * (k + 1), seed).points(0, n);
+    Eigen::MatrixXd A = points.topRows(k + 1);
+    Eigen::MatrixXd B = points.bottomRows(k + 1);
+
+    // design matrices A, B and AB_i for i <= k; AB_k only differs from A in adherence, so it needs no model evaluation
+    int n_sets = n * (k + 3);
+    auto unit_point = [&](int set) -> Eigen::VectorXd {
+        int matrix = set / n; // 0: A, 1: B, 2 + i: AB_i
+        int sample = set % n;
+        if (matrix == 1) {
+            return B.col(sample);
+        }
+        Eigen::VectorXd x = A.col(sample);
+        if (matrix >= 2) {
+            x(matrix - 2) = B(matrix - 2, sample);
+        }
+        return x;
+    };
+
+    std::vector<Ensemble> ensembles;
+    for (const StrategyParameters &strategy : strategies_) {
+        ensembles.emplace_back(space_, strategy, prevalence_states_);
+    }
+
+    // residual risk at the end of the strategy, with full adherence (row 0) and without intervention (row 1)
+    int n_strategies = strategies_.size();
+    int n_model_sets = n * (k + 2);
+    std::vector<Eigen::MatrixXf> final_risks(n_strategies, Eigen::MatrixXf(2, n_model_sets));
+    auto workspaces = [&ensembles]() {
+        std::vector<Ensemble::Workspace> per_strategy;
+        for (const Ensemble &ensemble : ensembles) {
+            per_strategy.push_back(ensemble.workspace());
+        }
+        return per_strategy;
+    };
+    Parallel::for_each(
+        n_strategies * n_model_sets, workspaces, [&](int job, std::vector<Ensemble::Workspace> &workspace) {
+            int s = job / n_model_sets;
+            int set = job % n_model_sets;
+            DiseaseParameters parameters = space_.parameters_at(unit_point(set).head(k));
+            final_risks[s].col(set) = ensembles[s].risks(parameters, workspace[s], true).transpose();
+        });
+    n_evaluations_ = n_strategies * n_model_sets;
+
+    indices_.clear();
+    for (int s = 0; s < n_strategies; ++s) {
+        float adherence = strategies_[s].expected_adherence;
+        float adherence_lower = std::max(float(0.), (1 - adherence_spread_) * adherence);
+        float adherence_upper = std::min(float(1.), (1 + adherence_spread_) * adherence);
+
+        Eigen::VectorXd y(n_sets);
+        for (int set = 0; set < n_sets; ++set) {
+            int model_set = set < n_model_sets ? set : set % n; // AB_k uses the model evaluations of A
+            float a = adherence_lower + unit_point(set)(k) * (adherence_upper - adherence_lower);
+            y(set) = Ensemble::relative_risk(final_risks[s].col(model_set).transpose(), a)(0);
+        }
+
+        Eigen::ArrayXd y_A = y.segment(0, n).array();
+        Eigen::ArrayXd y_B = y.segment(n, n).array();
+        Eigen::ArrayXd y_A_B = y.segment(0, 2 * n).array();
+        double mean = y_A_B.mean();
+        double variance = (y_A_B - mean).square().mean();
+
+        Indices indices;
+        indices.first_order.setZero(k + 1);
+        indices.total.setZero(k + 1);
+        indices.mean_relative_risk = mean;
+        indices.variance = variance;
+        if (variance > 0) {
+            for (int i = 0; i < k + 1; ++i) {
+                Eigen::ArrayXd y_AB_i = y.segment((2 + i) * n, n).array();
+                indices.first_order(i) = (y_B * (y_AB_i - y_A)).mean() / variance;
+                indices.total(i) = .5 * (y_A - y_AB_i).square().mean() / variance;
+            }
+        }
+        indices_.push_back(indices);
+    }
+}
@@ -24,19 +24,69 @@
 
 #include "include/core/simulation.h"
 
-Simulation::Simulation(ParametersTab *parameters_tab) { collect_parameters(parameters_tab); }
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 
-Simulation::Simulation(ParametersTab *parameters_tab, StrategyTab *strategy_tab, PrevalenceTab *prevalence_tab) {
-    collect_parameters(parameters_tab);
-    collect_strategy(strategy_tab);
+namespace {
+
+// the days of the evaluation points relative to the start of the strategy, with the days of the tests twice
+void evaluation_points(int t_offset, int t_end, const std::vector<int> &t_test, Eigen::Ref<Eigen::VectorXf> points) {
+    int time_counter = -t_offset;
+    int index_counter = 0;
+    int t_diff = 0;
+    for (int i = 0; i < (int)t_test.size(); ++i) {
+        t_diff = (t_test[i] - t_offset) - time_counter;
+        for (int day = 0; day < t_diff + 1; ++day) {
+            points(index_counter) = time_counter + day;
+            ++index_counter;
+        }
+        time_counter += t_diff;
+    }
+
+    t_diff = (t_end - t_offset) - time_counter;
+    for (int day = 0; day < t_diff + 1; ++day) {
+        points(index_counter) = time_counter + day;
+        ++index_counter;
+    }
+}
+
+// the top rows of a buffer that only grows, such that a workspace stops allocating once it fits the longest strategy
+Eigen::Block<Eigen::MatrixXf> top_rows(Eigen::MatrixXf &buffer, int rows, int cols) {
+    if (buffer.rows() < rows || buffer.cols() != cols) {
+        buffer.resize(std::max(rows, int(buffer.rows())), cols);
+    }
+    return buffer.topRows(rows);
+}
+
+/* a matrix in a buffer that only grows, laid out as the matrix of Simulation::group_by_phase(): Eigen vectorises the
+ * sums per phase by the alignment of its columns, which then gives the same result
+ */
+Eigen::Map<Eigen::MatrixXf> grouped(Eigen::VectorXf &buffer, int rows, int cols) {
+    if (buffer.size() < rows * cols) {
+        buffer.resize(rows * cols);
+    }
+    return Eigen::Map<Eigen::MatrixXf>(buffer.data(), rows, cols);
+}
+
+} // namespace
+
+Simulation::Simulation(const DiseaseParameters &parameters) { collect_parameters(parameters); }
+
+Simulation::Simulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                       Eigen::VectorXf prevalence_states, Outputs outputs)
+    : outputs(outputs) {
+    collect_parameters(parameters);
+    collect_strategy(strategy);
     deduce_combined_parameters();
 
-    if ((mode == 2) && prevalence_tab->use_prevalence_estimation()) {
-        initial_states_no_intervention = prevalence_tab->initial_states(); // main simulation incoming travelers
-        initial_states_NPI = prevalence_tab->initial_states();             // main simulation incoming travelers
+    if ((mode == 2) && prevalence_states.size()) {
+        initial_states_no_intervention = prevalence_states; // main simulation incoming travelers
+        initial_states_NPI = prevalence_states;             // main simulation incoming travelers
 
         if (symptomatic_screening) {
             apply_symptomatic_screening_to_initial_states();
+            initial_states_screened = true;
         }
     } else {
         set_initial_states(); // main simulation contact management / isolation
@@ -46,37 +96,45 @@ Simulation::Simulation(ParametersTab *parameters_tab, StrategyTab *strategy_tab,
     run_risk_calculation();
 }
 
-void Simulation::collect_strategy(StrategyTab *strategy_tab) {
-    t_offset = strategy_tab->time_delay();
-    t_end = strategy_tab->time_delay() + strategy_tab->end_of_strategy();
-    t_test = strategy_tab->test_moments();
-    mode = strategy_tab->mode();
-    symptomatic_screening = strategy_tab->use_symptomatic_screening();
-    test_type = strategy_tab->test_type();
-    expected_adherence = strategy_tab->expected_adherence();
-    p_infectious_t0 = strategy_tab->p_infectious_t0();
+Simulation::Simulation(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                       const Results &results)
+    : restored(true), restored_results(results) {
+    collect_parameters(parameters);
+    collect_strategy(strategy);
+    deduce_combined_parameters();
+    risk_matrix_no_intervention = results.risk_no_intervention;
+    risk_matrix_NPI = results.risk_NPI;
 }
 
-void Simulation::collect_parameters(ParametersTab *parameters_tab) {
-    tau_mean_case.push_back(parameters_tab->predetection_mean());
-    tau_mean_case.push_back(parameters_tab->presymptomatic_mean());
-    tau_mean_case.push_back(parameters_tab->symptomatic_mean());
-    tau_mean_case.push_back(parameters_tab->postinfectious());
+Simulation::~Simulation() {
+    for (Model *model : {model_mean_case_no_intervention, model_best_case_no_intervention,
+                         model_worst_case_no_intervention, model_mean_case_NPI, model_best_case_NPI,
+                         model_worst_case_NPI}) {
+        delete model;
+    }
+}
 
-    tau_best_case.push_back(parameters_tab->predetection_lower());
-    tau_best_case.push_back(parameters_tab->presymptomatic_upper());
-    tau_best_case.push_back(parameters_tab->symptomatic_upper());
-    tau_best_case.push_back(parameters_tab->postinfectious());
+void Simulation::collect_strategy(const StrategyParameters &strategy) {
+    t_offset = strategy.time_delay;
+    t_end = strategy.time_delay + strategy.end_of_strategy;
+    t_test = strategy.test_moments;
+    test_types = strategy.types_of_tests();
+    mode = strategy.mode;
+    symptomatic_screening = strategy.symptomatic_screening;
+    test_type = strategy.test_type;
+    expected_adherence = strategy.expected_adherence;
+    p_infectious_t0 = strategy.p_infectious_t0;
+}
 
-    tau_worst_case.push_back(parameters_tab->predetection_upper());
-    tau_worst_case.push_back(parameters_tab->presymptomatic_lower());
-    tau_worst_case.push_back(parameters_tab->symptomatic_lower());
-    tau_worst_case.push_back(parameters_tab->postinfectious());
+void Simulation::collect_parameters(const DiseaseParameters &parameters) {
+    tau_mean_case = parameters.tau_mean_case;
+    tau_best_case = parameters.tau_best_case;
+    tau_worst_case = parameters.tau_worst_case;
 
-    fraction_asymptomatic = parameters_tab->fraction_asymptomatic();
-    pcr_sens = parameters_tab->pcr_sensitivity();
-    rdt_relative_sens = parameters_tab->relative_rdt_sensitivity();
-    test_specificity = parameters_tab->pcr_specificity();
+    fraction_asymptomatic = parameters.fraction_asymptomatic;
+    pcr_sens = parameters.pcr_sens;
+    rdt_relative_sens = parameters.rdt_relative_sens;
+    test_specificity = parameters.test_specificity;
 }
 
 void Simulation::deduce_combined_parameters() {
@@ -86,16 +144,8 @@ void Simulation::deduce_combined_parameters() {
         risk_posing_fraction_symptomatic_phase = 1;
     }
 
-    switch (test_type) {
-    case 0: // PCR
-        test_sensitivity = pcr_sens;
-        break;
-    case 1:                                                    // RDT
-        test_sensitivity = 1.3 * rdt_relative_sens * pcr_sens; // *1.3 to achieve 100% relative sensitivity at peak
-        break;
-    default:
-        break;
-    }
+    // PCR, RDT; *1.3 to achieve 100% relative sensitivity at peak
+    test_sensitivity = {pcr_sens, float(1.3 * rdt_relative_sens * pcr_sens)};
 }
 
 void Simulation::set_initial_states() {
@@ -141,11 +191,18 @@ void Simulation::create_different_scenario_models() {
         new Model(tau_worst_case, initial_states_no_intervention, t_end); // without tests or symptomatic screening
 
     model_mean_case_NPI = new Model(tau_mean_case, risk_posing_fraction_symptomatic_phase, initial_states_NPI, t_end,
-                                    t_test, test_type, test_sensitivity, test_specificity);
+                                    t_test, test_types, test_sensitivity, test_specificity);
     model_best_case_NPI = new Model(tau_best_case, risk_posing_fraction_symptomatic_phase, initial_states_NPI, t_end,
-                                    t_test, test_type, test_sensitivity, test_specificity);
+                                    t_test, test_types, test_sensitivity, test_specificity);
     model_worst_case_NPI = new Model(tau_worst_case, risk_posing_fraction_symptomatic_phase, initial_states_NPI, t_end,
-                                     t_test, test_type, test_sensitivity, test_specificity);
+                                     t_test, test_types, test_sensitivity, test_specificity);
+
+    if (outputs == end_of_strategy_outputs) {
+        strategy_states_mean = model_mean_case_NPI->run_end_of_strategy();
+        strategy_states_best = model_best_case_NPI->run_end_of_strategy();
+        strategy_states_worst = model_worst_case_NPI->run_end_of_strategy();
+        return;
+    }
 
     // states per evaluation point
     strategy_states_mean = model_mean_case_NPI->run();
@@ -158,8 +215,16 @@ void Simulation::create_different_scenario_models() {
     states_worst_no_intervention = model_worst_case_no_intervention->run();
 }
 
-Eigen::MatrixXf Simulation::temporal_assay_sensitivity() {
-    if (test_type == 0) {
+void Simulation::require_states_no_intervention() {
+    if (outputs == end_of_strategy_outputs) {
+        throw std::logic_error("the states without intervention are not calculated with end_of_strategy_outputs");
+    }
+}
+
+Eigen::MatrixXf Simulation::temporal_assay_sensitivity() { return temporal_assay_sensitivity(test_type); }
+
+Eigen::MatrixXf Simulation::temporal_assay_sensitivity(int type) {
+    if (type == 0) {
         return temporal_assay_sensitivity_PCR();
     } else {
         return temporal_assay_sensitivity_RDT();
@@ -167,23 +232,27 @@ Eigen::MatrixXf Simulation::temporal_assay_sensitivity() {
 }
 
 Eigen::MatrixXf Simulation::temporal_assay_sensitivity_PCR() {
+    if (restored) {
+        return restored_results.temporal_assay_sensitivity[0];
+    }
+    require_states_no_intervention();
     Eigen::MatrixXf daily_probability_per_phase_mean = group_by_phase(states_mean_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_best = group_by_phase(states_best_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_worst = group_by_phase(states_worst_no_intervention);
 
     // needed for scaling if initial population (probability) != 1.
-    float initial_population = daily_probability_per_phase_mean(0, Eigen::seq(0, 3)).sum();
+    float initial_population = group_by_phase(initial_states_no_intervention).topRows(4).sum();
 
     Eigen::VectorXf p_detectable_mean, p_detectable_best, p_detectable_worst;
     p_detectable_mean =
         (1 - test_specificity) * daily_probability_per_phase_mean(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_mean(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
+        test_sensitivity[0] * daily_probability_per_phase_mean(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
     p_detectable_best =
         (1 - test_specificity) * daily_probability_per_phase_best(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_best(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
+        test_sensitivity[0] * daily_probability_per_phase_best(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
     p_detectable_worst =
         (1 - test_specificity) * daily_probability_per_phase_worst(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_worst(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
+        test_sensitivity[0] * daily_probability_per_phase_worst(Eigen::all, Eigen::seq(1, 3)).rowwise().sum();
 
     Eigen::MatrixXf p_detectable(t_end + 1, 3); // +1 decause of 0-indexed time
     p_detectable.col(0) = p_detectable_mean.array() / initial_population;
@@ -194,22 +263,26 @@ Eigen::MatrixXf Simulation::temporal_assay_sensitivity_PCR() {
 }
 
 Eigen::MatrixXf Simulation::temporal_assay_sensitivity_RDT() {
+    if (restored) {
+        return restored_results.temporal_assay_sensitivity[1];
+    }
+    require_states_no_intervention();
     Eigen::MatrixXf daily_probability_per_phase_mean = group_by_phase_RDT(states_mean_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_best = group_by_phase_RDT(states_best_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_worst = group_by_phase_RDT(states_worst_no_intervention);
 
     // needed for scaling if initial population (probability) != 1.
-    float initial_population = group_by_phase(states_mean_no_intervention)(0, Eigen::seq(0, 3)).sum();
+    float initial_population = group_by_phase(initial_states_no_intervention).topRows(4).sum();
 
     Eigen::VectorXf p_detectable_mean, p_detectable_best, p_detectable_worst;
     p_detectable_mean = (1 - test_specificity) * daily_probability_per_phase_mean(Eigen::all, 0) +
-                        test_sensitivity * daily_probability_per_phase_mean(Eigen::all, 1) +
+                        test_sensitivity[1] * daily_probability_per_phase_mean(Eigen::all, 1) +
                         (1 - test_specificity) * daily_probability_per_phase_mean(Eigen::all, 2);
     p_detectable_best = (1 - test_specificity) * daily_probability_per_phase_best(Eigen::all, 0) +
-                        test_sensitivity * daily_probability_per_phase_best(Eigen::all, 1) +
+                        test_sensitivity[1] * daily_probability_per_phase_best(Eigen::all, 1) +
                         (1 - test_specificity) * daily_probability_per_phase_best(Eigen::all, 2);
     p_detectable_worst = (1 - test_specificity) * daily_probability_per_phase_worst(Eigen::all, 0) +
-                         test_sensitivity * daily_probability_per_phase_worst(Eigen::all, 1) +
+                         test_sensitivity[1] * daily_probability_per_phase_worst(Eigen::all, 1) +
                          (1 - test_specificity) * daily_probability_per_phase_worst(Eigen::all, 2);
 
     Eigen::MatrixXf p_detectable(t_end + 1, 3); // +1 decause of 0-indexed time
@@ -220,8 +293,10 @@ Eigen::MatrixXf Simulation::temporal_assay_sensitivity_RDT() {
     return p_detectable;
 }
 
-Eigen::MatrixXf Simulation::test_efficacy() {
-    if (test_type == 0) {
+Eigen::MatrixXf Simulation::test_efficacy() { return test_efficacy(test_type); }
+
+Eigen::MatrixXf Simulation::test_efficacy(int type) {
+    if (type == 0) {
         return test_efficacy_PCR();
     } else {
         return test_efficacy_RDT();
@@ -229,6 +304,10 @@ Eigen::MatrixXf Simulation::test_efficacy() {
 }
 
 Eigen::MatrixXf Simulation::test_efficacy_PCR() {
+    if (restored) {
+        return restored_results.test_efficacy[0];
+    }
+    require_states_no_intervention();
     Eigen::MatrixXf daily_probability_per_phase_mean = group_by_phase(states_mean_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_best = group_by_phase(states_best_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_worst = group_by_phase(states_worst_no_intervention);
@@ -242,29 +321,33 @@ Eigen::MatrixXf Simulation::test_efficacy_PCR() {
 
     Eigen::VectorXf p_positive_test_mean =
         (1. - test_specificity) * daily_probability_per_phase_mean(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_mean(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
+        test_sensitivity[0] * daily_probability_per_phase_mean(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_mean(Eigen::all, Eigen::seq(0, 3)).rowwise().sum());
     Eigen::VectorXf p_positive_test_best =
         (1. - test_specificity) * daily_probability_per_phase_best(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_best(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
+        test_sensitivity[0] * daily_probability_per_phase_best(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_best(Eigen::all, Eigen::seq(0, 3)).rowwise().sum());
     Eigen::VectorXf p_positive_test_worst =
         (1. - test_specificity) * daily_probability_per_phase_worst(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_worst(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
+        test_sensitivity[0] * daily_probability_per_phase_worst(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_worst(Eigen::all, Eigen::seq(0, 3)).rowwise().sum());
 
     Eigen::MatrixXf efficacy(t_end + 1, 3); // +1 decause of 0-indexed time
-    efficacy.col(0) = (infectious_mean * test_sensitivity).array() / p_positive_test_mean.array();
-    efficacy.col(1) = (infectious_best * test_sensitivity).array() / p_positive_test_best.array();
-    efficacy.col(2) = (infectious_worst * test_sensitivity).array() / p_positive_test_worst.array();
+    efficacy.col(0) = (infectious_mean * test_sensitivity[0]).array() / p_positive_test_mean.array();
+    efficacy.col(1) = (infectious_best * test_sensitivity[0]).array() / p_positive_test_best.array();
+    efficacy.col(2) = (infectious_worst * test_sensitivity[0]).array() / p_positive_test_worst.array();
 
     return efficacy;
 }
 
 Eigen::MatrixXf Simulation::test_efficacy_RDT() {
+    if (restored) {
+        return restored_results.test_efficacy[1];
+    }
+    require_states_no_intervention();
     Eigen::MatrixXf daily_probability_per_phase_mean = group_by_phase_RDT(states_mean_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_best = group_by_phase_RDT(states_best_no_intervention);
     Eigen::MatrixXf daily_probability_per_phase_worst = group_by_phase_RDT(states_worst_no_intervention);
@@ -279,24 +362,24 @@ Eigen::MatrixXf Simulation::test_efficacy_RDT() {
 
     Eigen::VectorXf p_positive_test_mean =
         (1. - test_specificity) * daily_probability_per_phase_mean(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_mean(Eigen::all, 1) +
+        test_sensitivity[1] * daily_probability_per_phase_mean(Eigen::all, 1) +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_mean(Eigen::all, Eigen::seq(0, 1)).rowwise().sum());
     Eigen::VectorXf p_positive_test_best =
         (1. - test_specificity) * daily_probability_per_phase_best(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_best(Eigen::all, 1) +
+        test_sensitivity[1] * daily_probability_per_phase_best(Eigen::all, 1) +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_best(Eigen::all, Eigen::seq(0, 1)).rowwise().sum());
     Eigen::VectorXf p_positive_test_worst =
         (1. - test_specificity) * daily_probability_per_phase_worst(Eigen::all, 0) +
-        test_sensitivity * daily_probability_per_phase_worst(Eigen::all, 1) +
+        test_sensitivity[1] * daily_probability_per_phase_worst(Eigen::all, 1) +
         (1. - test_specificity) *
             (ones - daily_probability_per_phase_worst(Eigen::all, Eigen::seq(0, 1)).rowwise().sum());
 
     Eigen::MatrixXf efficacy(t_end + 1, 3); // +1 decause of 0-indexed time
-    efficacy.col(0) = (infectious_mean * test_sensitivity).array() / p_positive_test_mean.array();
-    efficacy.col(1) = (infectious_best * test_sensitivity).array() / p_positive_test_best.array();
-    efficacy.col(2) = (infectious_worst * test_sensitivity).array() / p_positive_test_worst.array();
+    efficacy.col(0) = (infectious_mean * test_sensitivity[1]).array() / p_positive_test_mean.array();
+    efficacy.col(1) = (infectious_best * test_sensitivity[1]).array() / p_positive_test_best.array();
+    efficacy.col(2) = (infectious_worst * test_sensitivity[1]).array() / p_positive_test_worst.array();
 
     return efficacy;
 }
@@ -311,7 +394,7 @@ void Simulation::risk_no_intervention() {
     Eigen::VectorXf risk_no_intervention_best;
     Eigen::VectorXf risk_no_intervention_worst;
 
-    int n_eval = t_end + t_test.size() + 1; // +1 decause of 0-indexed time
+    int n_eval = strategy_states_mean.rows();
     Eigen::MatrixXf X0_proxy = initial_states_no_intervention;
     X0_proxy.resize(1, Model::n_compartments);
 
@@ -342,11 +425,14 @@ void Simulation::risk_NPI() {
     Eigen::VectorXf risk_NPI_best;
     Eigen::VectorXf risk_NPI_worst;
 
-    risk_NPI_mean = model_mean_case_no_intervention->integrate(strategy_states_mean) -
+    // the states start at the last evaluation point when only the end of the strategy is calculated
+    int first_row = t_end + t_test.size() + 1 - strategy_states_mean.rows();
+
+    risk_NPI_mean = model_mean_case_no_intervention->integrate(strategy_states_mean, first_row) -
                     strategy_states_mean(Eigen::all, Eigen::last);
-    risk_NPI_best = model_best_case_no_intervention->integrate(strategy_states_best) -
+    risk_NPI_best = model_best_case_no_intervention->integrate(strategy_states_best, first_row) -
                     strategy_states_best(Eigen::all, Eigen::last);
-    risk_NPI_worst = model_worst_case_no_intervention->integrate(strategy_states_worst) -
+    risk_NPI_worst = model_worst_case_no_intervention->integrate(strategy_states_worst, first_row) -
                      strategy_states_worst(Eigen::all, Eigen::last);
 
     Eigen::MatrixXf risk(risk_NPI_mean.size(), 3);
@@ -377,78 +463,332 @@ Eigen::MatrixXf Simulation::fold_risk_reduction() {
            (expected_adherence * risk_matrix_NPI + (1. - expected_adherence) * risk_matrix_no_intervention).array();
 }
 
-Eigen::MatrixXf Simulation::group_by_phase(Eigen::MatrixXf states) {
+// the part of the constructor that end_of_strategy() and evaluate() share, see collect_strategy() and onwards
+void Simulation::prepare(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                         Workspace &workspace) {
+    if (strategy.mode == 2) {
+        throw std::invalid_argument("incoming travelers (mode 2) need prevalence states, which a workspace lacks");
+    }
+    workspace.t_offset = strategy.time_delay;
+    workspace.t_end = strategy.time_delay + strategy.end_of_strategy;
+    workspace.test_moments = strategy.test_moments;
+    workspace.expected_adherence = strategy.expected_adherence;
+    float risk_posing_fraction_symptomatic_phase =
+        strategy.symptomatic_screening ? parameters.fraction_asymptomatic : 1;
+    // PCR, RDT, see deduce_combined_parameters
+    workspace.test_sensitivity = {parameters.pcr_sens,
+                                  float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+    workspace.test_specificity = parameters.test_specificity;
+    if (strategy.test_types.empty()) {
+        workspace.test_types.assign(strategy.test_moments.size(), strategy.test_type);
+    } else {
+        workspace.test_types = strategy.test_types;
+    }
 
-    int n_eval = states.rows();
+    // see set_initial_states
+    Eigen::VectorXf &X0 = workspace.initial_states;
+    X0.setZero(Model::n_compartments);
+    if (strategy.mode == 0) {
+        X0(0) = strategy.p_infectious_t0;
+    } else {
+        X0(Model::sub_compartments[0] + Model::sub_compartments[1]) = strategy.p_infectious_t0;
+    }
 
-    int transpose = false;
-    if (states.cols() == 1) { // states is a column vector
-        states.transposeInPlace();
-        n_eval = 1;
-        transpose = true;
+    // see create_different_scenario_models
+    const std::vector<float> *tau[3] = {&parameters.tau_mean_case, &parameters.tau_best_case,
+                                        &parameters.tau_worst_case};
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        Model &model_no_intervention = workspace.models_no_intervention[scenario];
+        model_no_intervention.set_parameters(*tau[scenario], 1);
+        model_no_intervention.set_strategy(workspace.t_end, {}, {});
+        Model &model_NPI = workspace.models_NPI[scenario];
+        model_NPI.set_parameters(*tau[scenario], risk_posing_fraction_symptomatic_phase);
+        model_NPI.set_test_parameters(workspace.test_sensitivity, workspace.test_specificity);
+        model_NPI.set_strategy(workspace.t_end, workspace.test_moments, workspace.test_types);
     }
+}
 
-    Eigen::MatrixXf grouped(n_eval, 5);
-    int counter = 0;
-    for (int i = 0; i < 5; ++i) {
-        grouped(Eigen::all, i) =
-            states(Eigen::all, Eigen::seq(counter, counter + Model::sub_compartments.at(i) - 1)).rowwise().sum();
-        counter = counter + Model::sub_compartments.at(i);
+// mirrors the constructor with end_of_strategy_outputs, risk_no_intervention(), risk_NPI() and the outputs
+const Simulation::EndOfStrategy &Simulation::end_of_strategy(const DiseaseParameters &parameters,
+                                                             const StrategyParameters &strategy,
+                                                             Workspace &workspace) {
+    prepare(parameters, strategy, workspace);
+    const Eigen::VectorXf &X0 = workspace.initial_states;
+    Eigen::Map<const Eigen::MatrixXf> X0_proxy(X0.data(), 1, Model::n_compartments);
+
+    // the states start at the last evaluation point
+    int first_row = workspace.t_end + workspace.test_moments.size();
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        const Model &model_no_intervention = workspace.models_no_intervention[scenario];
+        Eigen::MatrixXf &strategy_states = workspace.strategy_states[scenario];
+        strategy_states.resize(1, Model::n_compartments);
+        workspace.models_NPI[scenario].run_end_of_strategy(
+            X0, Eigen::Map<Eigen::VectorXf>(strategy_states.data(), Model::n_compartments));
+
+        model_no_intervention.integrate(X0_proxy, 0, workspace.risk_no_intervention.segment(scenario, 1));
+        workspace.risk_no_intervention(scenario) -= X0_proxy(0, Eigen::last);
+        model_no_intervention.integrate(strategy_states, first_row, workspace.risk_NPI.segment(scenario, 1));
+        workspace.risk_NPI(scenario) -= strategy_states(0, Eigen::last);
     }
 
-    if (transpose) { // if states was a column vector, return as column vector
-        grouped.transposeInPlace();
+    // adherence is applied as in risk_NPI() and relative_risk()
+    float adherence = strategy.expected_adherence;
+    Eigen::Array3f risk_no_intervention = workspace.risk_no_intervention;
+    Eigen::Array3f risk_NPI = adherence * workspace.risk_NPI.array() + (1 - adherence) * risk_no_intervention;
+    Eigen::Array3f risk = adherence * risk_NPI + (1 - adherence) * risk_no_intervention;
+
+    EndOfStrategy &outputs = workspace.outputs;
+    outputs.relative_risk = risk / risk_no_intervention;
+    outputs.risk_reduction = 1 - outputs.relative_risk.array();
+    outputs.fold_risk_reduction = risk_no_intervention / risk;
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        // the first three phases, summed per phase as in group_by_phase, see get_p_infectious_tend
+        const float *states = workspace.strategy_states[scenario].data();
+        float p_infectious = 0;
+        int first = 0;
+        for (int phase = 0; phase < 3; ++phase) {
+            int size = Model::sub_compartments[phase];
+            p_infectious += std::accumulate(states + first, states + first + size, float(0));
+            first += size;
+        }
+        outputs.p_infectious_tend(scenario) = p_infectious;
+    }
+    return outputs;
+}
+
+// mirrors the constructor with all_outputs, risk_no_intervention() and risk_NPI()
+void Simulation::evaluate(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                          Workspace &workspace) {
+    prepare(parameters, strategy, workspace);
+    const Eigen::VectorXf &X0 = workspace.initial_states;
+    Eigen::Map<const Eigen::MatrixXf> X0_proxy(X0.data(), 1, Model::n_compartments);
+
+    int n_eval = workspace.models_NPI[0].n_evaluation_points();
+    auto risks_no_intervention = top_rows(workspace.risks_no_intervention, n_eval, 3);
+    auto risks_NPI = top_rows(workspace.risks_NPI, n_eval, 3);
+    float adherence = strategy.expected_adherence;
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        const Model &model_no_intervention = workspace.models_no_intervention[scenario];
+        auto strategy_states = top_rows(workspace.strategy_states[scenario], n_eval, Model::n_compartments);
+        workspace.models_NPI[scenario].run(X0, strategy_states);
+        auto states_no_intervention =
+            top_rows(workspace.states_no_intervention[scenario], workspace.t_end + 1, Model::n_compartments);
+        model_no_intervention.run(X0, states_no_intervention);
+
+        model_no_intervention.integrate(X0_proxy, 0, workspace.risk_no_intervention.segment(scenario, 1));
+        workspace.risk_no_intervention(scenario) -= X0_proxy(0, Eigen::last);
+        auto risk_no_intervention = risks_no_intervention.col(scenario);
+        risk_no_intervention.fill(workspace.risk_no_intervention(scenario));
+        auto risk_NPI = risks_NPI.col(scenario);
+        model_no_intervention.integrate(strategy_states, 0, risk_NPI);
+        risk_NPI -= strategy_states(Eigen::all, Eigen::last);
+        risk_NPI = adherence * risk_NPI + (1 - adherence) * risk_no_intervention;
+    }
+
+    // the outputs at the end of the strategy, see relative_risk(), risk_reduction() and fold_risk_reduction()
+    EndOfStrategy &outputs = workspace.outputs;
+    Eigen::Array3f risk_no_intervention = risks_no_intervention.row(n_eval - 1).transpose();
+    Eigen::Array3f risk =
+        adherence * risks_NPI.row(n_eval - 1).transpose().array() + (1. - adherence) * risk_no_intervention;
+    outputs.relative_risk = risk / risk_no_intervention;
+    outputs.risk_reduction = 1 - outputs.relative_risk.array();
+    outputs.fold_risk_reduction = risk_no_intervention / risk;
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        // see get_p_infectious_tend
+        auto phases = grouped(workspace.phases, n_eval, 5);
+        group_by_phase(workspace.strategy_states[scenario].topRows(n_eval), phases);
+        outputs.p_infectious_tend(scenario) = phases(Eigen::last, Eigen::seq(0, 2)).sum();
+    }
+}
+
+void Simulation::relative_risk(const Workspace &workspace, Output relative_risk) {
+    int n_eval = workspace.models_NPI[0].n_evaluation_points();
+    auto risks_no_intervention = workspace.risks_no_intervention.topRows(n_eval);
+    auto risks_NPI = workspace.risks_NPI.topRows(n_eval);
+    float adherence = workspace.expected_adherence;
+    relative_risk =
+        (adherence * risks_NPI + (1. - adherence) * risks_no_intervention).array() / risks_no_intervention.array();
+}
+
+// see temporal_assay_sensitivity_PCR() and temporal_assay_sensitivity_RDT()
+void Simulation::temporal_assay_sensitivity(Workspace &workspace, int type, Output sensitivity) {
+    int n_days = workspace.t_end + 1;
+    float specificity = workspace.test_specificity;
+    // needed for scaling if initial population (probability) != 1.
+    auto initial_phases = grouped(workspace.phases, 5, 1);
+    group_by_phase(workspace.initial_states, initial_phases);
+    float initial_population = initial_phases.topRows(4).sum();
+
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        auto states = workspace.states_no_intervention[scenario].topRows(n_days);
+        if (type == 0) {
+            auto phases = grouped(workspace.phases, n_days, 5);
+            group_by_phase(states, phases);
+            sensitivity.col(scenario) =
+                ((1 - specificity) * phases(Eigen::all, 0) +
+                 workspace.test_sensitivity[0] * phases(Eigen::all, Eigen::seq(1, 3)).rowwise().sum())
+                    .array() /
+                initial_population;
+        } else {
+            auto phases = grouped(workspace.phases, n_days, 4);
+            group_by_phase_RDT(states, phases);
+            sensitivity.col(scenario) = ((1 - specificity) * phases(Eigen::all, 0) +
+                                         workspace.test_sensitivity[1] * phases(Eigen::all, 1) +
+                                         (1 - specificity) * phases(Eigen::all, 2))
+                                            .array() /
+                                        initial_population;
+        }
     }
-    return grouped;
 }
 
-Eigen::MatrixXf Simulation::group_by_phase_RDT(Eigen::MatrixXf states) {
+// see test_efficacy_PCR() and test_efficacy_RDT()
+void Simulation::test_efficacy(Workspace &workspace, int type, Output efficacy) {
+    int n_days = workspace.t_end + 1;
+    float specificity = workspace.test_specificity;
+    float test_sensitivity = workspace.test_sensitivity[type == 0 ? 0 : 1];
+    auto ones = Eigen::VectorXf::Ones(n_days);
+
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        auto states = workspace.states_no_intervention[scenario].topRows(n_days);
+        if (type == 0) {
+            auto phases = grouped(workspace.phases, n_days, 5);
+            group_by_phase(states, phases);
+            efficacy.col(scenario) =
+                (phases(Eigen::all, Eigen::seq(1, 2)).rowwise().sum() * test_sensitivity).array() /
+                ((1. - specificity) * phases(Eigen::all, 0) +
+                 test_sensitivity * phases(Eigen::all, Eigen::seq(1, 3)).rowwise().sum() +
+                 (1. - specificity) * (ones - phases(Eigen::all, Eigen::seq(0, 3)).rowwise().sum()))
+                    .array();
+        } else {
+            // for RDT, detectable == infectious
+            auto phases = grouped(workspace.phases, n_days, 4);
+            group_by_phase_RDT(states, phases);
+            efficacy.col(scenario) =
+                (phases(Eigen::all, 1) * test_sensitivity).array() /
+                ((1. - specificity) * phases(Eigen::all, 0) + test_sensitivity * phases(Eigen::all, 1) +
+                 (1. - specificity) * (ones - phases(Eigen::all, Eigen::seq(0, 1)).rowwise().sum()))
+                    .array();
+        }
+    }
+}
 
-    int n_eval = states.rows();
+void Simulation::evaluation_points_with_tests(const Workspace &workspace, Eigen::Ref<Eigen::VectorXf> points) {
+    evaluation_points(workspace.t_offset, workspace.t_end, workspace.test_moments, points);
+}
 
-    int transpose = false;
-    if (states.cols() == 1) { // states is a column vector
-        states.transposeInPlace();
-        n_eval = 1;
-        transpose = true;
+Eigen::MatrixXf Simulation::relative_risk_jacobian() {
+    if (restored) {
+        throw std::runtime_error("the Jacobian needs the models, which a restored simulation does not run");
+    }
+    // the initial states of the strategy depend on the fraction asymptomatic through symptomatic screening
+    Eigen::MatrixXd initial_derivatives = Eigen::MatrixXd::Zero(Model::n_compartments, Model::n_parameters);
+    if (initial_states_screened) {
+        int first_symptomatic_compartment = Model::sub_compartments[0] + Model::sub_compartments[1];
+        initial_derivatives.col(Model::risk_posing_fraction).segment(first_symptomatic_compartment,
+                                                                     Model::sub_compartments[2]) =
+            initial_states_no_intervention.segment(first_symptomatic_compartment, Model::sub_compartments[2])
+                .cast<double>();
     }
 
-    Eigen::MatrixXf grouped(n_eval, 4);
+    std::vector<Eigen::MatrixXd> d_states;
+    Eigen::MatrixXd states = model_mean_case_NPI->run_with_derivatives(d_states, initial_derivatives);
 
-    grouped(Eigen::all, 0) = states(Eigen::all, Eigen::seq(0, 3 + 2 - 1)).rowwise().sum();            // pre-detectable
-    grouped(Eigen::all, 1) = states(Eigen::all, Eigen::seq(5, 5 + 1 + (13 - 5) - 1)).rowwise().sum(); // detectable
-    grouped(Eigen::all, 2) = states(Eigen::all, Eigen::seq(14, 14 + 5 + 1 - 1)).rowwise().sum();      // post-detectable
-    grouped(Eigen::all, 3) = states(Eigen::all, 20);                                                  // sink
+    Eigen::MatrixXd d_risk_NPI, d_risk_no_intervention;
+    Eigen::VectorXd risk_NPI =
+        model_mean_case_no_intervention->integrate_with_derivatives(states, d_states, d_risk_NPI) - states.col(20);
+    for (int p = 0; p < Model::n_parameters; ++p) {
+        d_risk_NPI.col(p) -= d_states[p].col(Model::n_compartments - 1);
+    }
+
+    Eigen::MatrixXd X0 = initial_states_no_intervention.transpose().cast<double>();
+    double risk_no_intervention =
+        model_mean_case_no_intervention->integrate_with_derivatives(X0, {}, d_risk_no_intervention)(0) -
+        X0(0, Model::n_compartments - 1);
+
+    // relative risk = a^2 * risk_NPI / risk_no_intervention + 1 - a^2, see risk_NPI() and relative_risk()
+    double a2 = expected_adherence * expected_adherence;
+    Eigen::MatrixXd d_relative_risk =
+        a2 * (d_risk_NPI * risk_no_intervention - risk_NPI * d_risk_no_intervention.row(0)) /
+        (risk_no_intervention * risk_no_intervention);
+
+    // chain rule from the model parameters to the disease parameters
+    Eigen::MatrixXf jacobian(d_relative_risk.rows(), 8);
+    jacobian.leftCols(4) = d_relative_risk.leftCols(4).cast<float>(); // residence times
+    jacobian.col(4) = d_relative_risk.col(Model::risk_posing_fraction).cast<float>() * (symptomatic_screening ? 1 : 0);
+    // RDT: test_sensitivity = 1.3 * rdt_relative_sens * pcr_sens
+    jacobian.col(5) = (d_relative_risk.col(Model::sensitivity_PCR_parameter) +
+                       1.3 * rdt_relative_sens * d_relative_risk.col(Model::sensitivity_RDT_parameter))
+                          .cast<float>();
+    jacobian.col(6) = (1.3 * pcr_sens * d_relative_risk.col(Model::sensitivity_RDT_parameter)).cast<float>();
+    jacobian.col(7) = d_relative_risk.col(Model::specificity_parameter).cast<float>();
+    return jacobian;
+}
 
-    if (transpose) { // if states was a column vector, return as column vector
-        grouped.transposeInPlace();
+Simulation::Results Simulation::results() {
+    require_states_no_intervention(); // the results of a simulation hold all evaluation points
+    Results results;
+    results.risk_no_intervention = risk_matrix_no_intervention;
+    results.risk_NPI = risk_matrix_NPI;
+    for (int type = 0; type < 2; ++type) {
+        results.temporal_assay_sensitivity[type] = temporal_assay_sensitivity(type);
+        results.test_efficacy[type] = test_efficacy(type);
     }
+    results.p_infectious_tend = get_p_infectious_tend();
+    return results;
+}
+
+/* the states are grouped per row, or as a column vector if states is a column vector; a column is summed in sequence,
+ * as a row is, rather than vectorised, such that both give the same result
+ */
+Eigen::MatrixXf Simulation::group_by_phase(const Eigen::Ref<const Eigen::MatrixXf> &states) {
+    bool column = states.cols() == 1;
+    Eigen::MatrixXf grouped(column ? 5 : states.rows(), column ? 1 : 5);
+    group_by_phase(states, grouped);
     return grouped;
 }
 
-Eigen::VectorXf Simulation::evaluation_points_with_tests() {
-    int n_eval_points = t_end + t_test.size() + 1; // +1 decause of 0-indexed time
-    Eigen::VectorXf evaluation_points(n_eval_points);
+Eigen::MatrixXf Simulation::group_by_phase_RDT(const Eigen::Ref<const Eigen::MatrixXf> &states) {
+    bool column = states.cols() == 1;
+    Eigen::MatrixXf grouped(column ? 4 : states.rows(), column ? 1 : 4);
+    group_by_phase_RDT(states, grouped);
+    return grouped;
+}
 
-    int time_counter = -t_offset;
-    int index_counter = 0;
-    int t_diff = 0;
-    for (int i = 0; i < (int)t_test.size(); ++i) {
-        t_diff = (t_test[i] - t_offset) - time_counter;
-        for (int day = 0; day < t_diff + 1; ++day) {
-            evaluation_points(index_counter) = time_counter + day;
-            ++index_counter;
+void Simulation::group_by_phase(const Eigen::Ref<const Eigen::MatrixXf> &states, Eigen::Ref<Eigen::MatrixXf> grouped) {
+    bool column = states.cols() == 1;
+    int counter = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (column) {
+            auto phase = states.col(0).segment(counter, Model::sub_compartments.at(i));
+            grouped(i, 0) = std::accumulate(phase.begin(), phase.end(), float(0));
+        } else {
+            grouped.col(i) = states.middleCols(counter, Model::sub_compartments.at(i)).rowwise().sum();
         }
-        time_counter += t_diff;
+        counter = counter + Model::sub_compartments.at(i);
     }
+}
 
-    t_diff = (t_end - t_offset) - time_counter;
-    for (int day = 0; day < t_diff + 1; ++day) {
-        evaluation_points(index_counter) = time_counter + day;
-        ++index_counter;
+void Simulation::group_by_phase_RDT(const Eigen::Ref<const Eigen::MatrixXf> &states,
+                                    Eigen::Ref<Eigen::MatrixXf> grouped) {
+    // first compartment and number of compartments per group: pre-detectable, detectable, post-detectable and sink
+    const int first[4] = {0, 5, 14, 20};
+    const int size[4] = {3 + 2, 1 + (13 - 5), 5 + 1, 1};
+
+    bool column = states.cols() == 1;
+    for (int i = 0; i < 4; ++i) {
+        if (column) {
+            auto group = states.col(0).segment(first[i], size[i]);
+            grouped(i, 0) = std::accumulate(group.begin(), group.end(), float(0));
+        } else {
+            grouped.col(i) = states.middleCols(first[i], size[i]).rowwise().sum();
+        }
     }
+}
 
-    return evaluation_points;
+Eigen::VectorXf Simulation::evaluation_points_with_tests() {
+    Eigen::VectorXf points(t_end + t_test.size() + 1); // +1 decause of 0-indexed time
+    evaluation_points(t_offset, t_end, t_test, points);
+    return points;
 }
 
 Eigen::VectorXf Simulation::evaluation_points_without_tests() {
@@ -461,8 +801,21 @@ Eigen::VectorXf Simulation::evaluation_points_without_tests() {
     return evaluation_points;
 }
 
+Eigen::MatrixXf Simulation::get_strategy_states(int scenario) {
+    return scenario == 0 ? strategy_states_mean : scenario == 1 ? strategy_states_best : strategy_states_worst;
+}
+
+Eigen::MatrixXf Simulation::get_states_no_intervention(int scenario) {
+    return scenario == 0   ? states_mean_no_intervention
+           : scenario == 1 ? states_best_no_intervention
+                           : states_worst_no_intervention;
+}
+
 // probability to be-, or yet to become infectious
 Eigen::VectorXf Simulation::get_p_infectious_tend() {
+    if (restored) {
+        return restored_results.p_infectious_tend;
+    }
     Eigen::VectorXf v(3);
 
     v(0) = group_by_phase(strategy_states_mean)(Eigen::last, Eigen::seq(0, 2)).sum();
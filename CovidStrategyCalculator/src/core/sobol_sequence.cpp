@@ -0,0 +1,141 @@
+/* sobol_sequence.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the SobolSequence class. Direction numbers are constructed from primitive polynomials and
+ * initial direction numbers as tabulated by Joe & Kuo (2008), the scrambling is the hash-based nested uniform (Owen)
+ * scrambling of Burley (2020).
+ */
+
+#include "include/core/sobol_sequence.h"
+
+#include <stdexcept>
+
+namespace {
+// degree s, coefficients a and initial direction numbers m of the primitive polynomials for dimensions 2, 3, ...
+struct Polynomial {
+    int s;
+    uint32_t a;
+    std::vector<uint32_t> m;
+};
+
+const std::vector<Polynomial> polynomials{
+    {1, 0, {1}},          {2, 1, {1, 3}},          {3, 1, {1, 3, 1}},          {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}}, {4, 4, {1, 3, 5, 13}},   {5, 2, {1, 1, 5, 5, 17}},   {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},                     {5, 11, {1, 1, 5, 1, 1}},   {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},                     {6, 1, {1, 3, 3, 9, 7, 49}}, {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},                {6, 19, {1, 1, 1, 15, 7, 5}}, {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},                 {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}}};
+
+uint32_t reverse_bits(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// Laine-Karras style permutation; a bit only depends on the bits below it, i.e. on the bits above it when reversed
+uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+    x = reverse_bits(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return reverse_bits(x);
+}
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// maps 32 random bits to the center of their interval in (0, 1)
+double to_unit_interval(uint32_t x) { return (x + .5) / 4294967296.; }
+} // namespace
+
+const int SobolSequence::max_dimensions = polynomials.size() + 1;
+
+SobolSequence::SobolSequence(int dimensions, uint32_t seed) : dimensions_(dimensions), seed_(seed) {
+    if (dimensions < 1 || dimensions > max_dimensions) {
+        throw std::invalid_argument("SobolSequence: unsupported number of dimensions");
+    }
+    set_directions();
+}
+
+void SobolSequence::set_directions() {
+    directions_.resize(dimensions_);
+
+    // first dimension: van der Corput sequence in base 2
+    for (int i = 0; i < 32; ++i) {
+        directions_[0][i] = 1u << (31 - i);
+    }
+
+    for (int d = 1; d < dimensions_; ++d) {
+        const Polynomial &p = polynomials[d - 1];
+        std::array<uint32_t, 32> &v = directions_[d];
+        for (int i = 0; i < p.s; ++i) {
+            v[i] = p.m[i] << (31 - i);
+        }
+        for (int i = p.s; i < 32; ++i) {
+            v[i] = v[i - p.s] ^ (v[i - p.s] >> p.s);
+            for (int k = 1; k < p.s; ++k) {
+                v[i] ^= ((p.a >> (p.s - 1 - k)) & 1u) * v[i - k];
+            }
+        }
+    }
+}
+
+Eigen::VectorXd SobolSequence::point(uint32_t index) const {
+    Eigen::VectorXd x(dimensions_);
+    for (int d = 0; d < dimensions_; ++d) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 32 && (index >> i); ++i) {
+            if ((index >> i) & 1u) {
+                bits ^= directions_[d][i];
+            }
+        }
+        if (seed_) {
+            bits = nested_uniform_scramble(bits, splitmix64((uint64_t(seed_) << 32) | d));
+        }
+        x(d) = to_unit_interval(bits);
+    }
+    return x;
+}
+
+Eigen::MatrixXd SobolSequence::points(int first, int n) const {
+    Eigen::MatrixXd x(dimensions_, n);
+    for (int i = 0; i < n; ++i) {
+        x.col(i) = point(first + i);
+    }
+    return x;
+}
+
+Eigen::MatrixXd PseudoRandom::points(int dimensions, int first, int n, uint32_t seed) {
+    Eigen::MatrixXd x(dimensions, n);
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < dimensions; ++d) {
+            uint64_t counter = (uint64_t(first + i) * dimensions + d) ^ (uint64_t(seed) << 40);
+            x(d, i) = to_unit_interval(splitmix64(counter) >> 32);
+        }
+    }
+    return x;
+}
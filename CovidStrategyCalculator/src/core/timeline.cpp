@@ -0,0 +1,218 @@
+/* timeline.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the Timeline class. A jump of n days applies the cached powers of the daily propagator that
+ * make up n, i.e. one matrix-vector product per set bit. The risk node accumulates the risk, so the risk posed between
+ * a release and the next quarantine is the increase of the last state; after the last event it is the residual risk,
+ * computed as in Model::integrate.
+ */
+
+#include "include/core/timeline.h"
+#include "include/core/model.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+const std::array<std::string, Timeline::n_event_types> Timeline::event_names = {
+    "pcr", "rdt", "symptoms", "checks", "no-checks", "release", "quarantine"};
+
+Timeline::Timeline(const DiseaseParameters &parameters, std::vector<Event> events, Eigen::VectorXf initial_states,
+                   float expected_adherence)
+    : events_(events), initial_states_(initial_states.cast<double>()), expected_adherence_(expected_adherence) {
+    if (initial_states.size() != Model::n_compartments) {
+        throw std::invalid_argument("the initial states hold one value per compartment");
+    }
+    for (const Event &event : events_) {
+        if (event.day < 0) {
+            throw std::invalid_argument("the events of a timeline lie on day 0 or later");
+        }
+    }
+    std::stable_sort(events_.begin(), events_.end(), [](const Event &a, const Event &b) { return a.day < b.day; });
+
+    // see Simulation::apply_symptomatic_screening_to_initial_states
+    int first_symptomatic_compartment = Model::sub_compartments[0] + Model::sub_compartments[1];
+    symptom_check_ = Eigen::VectorXd::Ones(Model::n_compartments);
+    symptom_check_.segment(first_symptomatic_compartment, Model::sub_compartments[2]).array() =
+        parameters.fraction_asymptomatic;
+
+    std::vector<float> test_sensitivity{parameters.pcr_sens,
+                                        float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+    Eigen::VectorXf X0 = initial_states;
+    for (const std::vector<float> &tau :
+         {parameters.tau_mean_case, parameters.tau_best_case, parameters.tau_worst_case}) {
+        Model natural(tau, X0, 0); // without tests or symptomatic screening
+        Model screened(tau, parameters.fraction_asymptomatic, X0, 0, {}, {}, test_sensitivity,
+                       parameters.test_specificity);
+
+        std::array<std::array<Operator, n_powers>, 2> powers;
+        std::array<Eigen::Matrix<double, 1, 21>, 2> residual_risk;
+        for (int screening = 0; screening < 2; ++screening) {
+            const Model &model = screening ? screened : natural;
+            powers[screening][0] = model.propagator(1);
+            for (int k = 1; k < n_powers; ++k) {
+                powers[screening][k] = powers[screening][k - 1] * powers[screening][k - 1];
+            }
+            // the risk node at t_inf=100, from the powers 64 + 32 + 4
+            Eigen::Matrix<double, 1, 21> risk_at_t_inf = Eigen::Matrix<double, 1, 21>::Unit(Model::n_compartments - 1);
+            for (int k : {6, 5, 2}) {
+                risk_at_t_inf *= powers[screening][k];
+            }
+            residual_risk[screening] = risk_at_t_inf - Eigen::Matrix<double, 1, 21>::Unit(Model::n_compartments - 1);
+        }
+        powers_.push_back(powers);
+        residual_risk_.push_back(residual_risk);
+        false_ommision_rates_.push_back({screened.false_ommision_rate(0), screened.false_ommision_rate(1)});
+    }
+
+    // see Simulation::relative_risk
+    float adherence_squared = expected_adherence * expected_adherence;
+    relative_risk_.resize(3);
+    for (int s = 0; s < 3; ++s) {
+        double risk_no_intervention = residual_risk_[s][0].dot(initial_states_);
+        relative_risk_(s) = adherence_squared * sweep(s) / risk_no_intervention + 1 - adherence_squared;
+    }
+}
+
+Timeline::Timeline(const DiseaseParameters &parameters, const StrategyParameters &strategy,
+                   Eigen::VectorXf prevalence_states)
+    : Timeline(parameters, events(strategy),
+               strategy.mode == 2 && prevalence_states.size() ? prevalence_states : initial_states(strategy),
+               strategy.expected_adherence) {}
+
+std::vector<Timeline::Event> Timeline::events(const StrategyParameters &strategy) {
+    int end = strategy.time_delay + strategy.end_of_strategy;
+    std::vector<Event> events{};
+    if (strategy.symptomatic_screening) {
+        if (strategy.mode == 2) {
+            events.push_back({0, symptom_check}); // on arrival
+        }
+        events.push_back({0, checks_start});
+    }
+    std::vector<int> types = strategy.types_of_tests();
+    for (int i = 0; i < (int)strategy.test_moments.size(); ++i) {
+        events.push_back({strategy.test_moments[i], EventType(types[i])});
+    }
+    if (strategy.symptomatic_screening) {
+        events.push_back({end, checks_end});
+    }
+    events.push_back({end, release});
+    return events;
+}
+
+Eigen::VectorXf Timeline::initial_states(const StrategyParameters &strategy) {
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    if (strategy.mode == 0) {
+        X0(0) = strategy.p_infectious_t0;
+    } else if (strategy.mode == 1) {
+        X0(Model::sub_compartments[0] + Model::sub_compartments[1]) = strategy.p_infectious_t0;
+    }
+    return X0;
+}
+
+std::vector<Timeline::Event> Timeline::parse(const std::string &text) {
+    std::vector<Event> events{};
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t separator = item.find('@');
+        std::string name = item.substr(0, separator);
+        auto it = std::find(event_names.begin(), event_names.end(), name);
+        if (separator == std::string::npos || it == event_names.end()) {
+            throw std::invalid_argument("unknown event " + item);
+        }
+        events.push_back({std::stoi(item.substr(separator + 1)), EventType(it - event_names.begin())});
+    }
+    return events;
+}
+
+Eigen::MatrixXf Timeline::states(const std::vector<int> &days, int scenario) const {
+    if (!std::is_sorted(days.begin(), days.end())) {
+        throw std::invalid_argument("the days of the states are in ascending order");
+    }
+    Eigen::MatrixXf states(days.size(), Model::n_compartments);
+    sweep(scenario, days, &states);
+    return states;
+}
+
+void Timeline::jump(Eigen::Matrix<double, 21, 1> &x, int days, int scenario, bool screening) const {
+    const std::array<Operator, n_powers> &powers = powers_[scenario][screening];
+    for (int k = n_powers - 1; k >= 0; --k) {
+        for (; days >= (1 << k); days -= 1 << k) {
+            x = powers[k] * x;
+        }
+    }
+}
+
+double Timeline::sweep(int scenario, const std::vector<int> &days, Eigen::MatrixXf *states) const {
+    Eigen::Matrix<double, 21, 1> x = initial_states_;
+    int risk_node = Model::n_compartments - 1;
+    int day = 0;
+    bool screening = false, released = false;
+    double risk = 0, risk_at_release = 0;
+
+    int next = 0; // next requested day
+    auto write_states_until = [&](int last_day) {
+        for (; next < (int)days.size() && days[next] < last_day; ++next) {
+            jump(x, days[next] - day, scenario, screening);
+            day = days[next];
+            states->row(next) = x.transpose().cast<float>();
+        }
+    };
+
+    for (const Event &event : events_) {
+        write_states_until(event.day);
+        jump(x, event.day - day, scenario, screening);
+        day = event.day;
+
+        switch (event.type) {
+        case pcr_test:
+        case rdt_test:
+            x.array() *= false_ommision_rates_[scenario][event.type].array();
+            break;
+        case symptom_check:
+            x.array() *= symptom_check_.array();
+            break;
+        case checks_start:
+        case checks_end:
+            screening = event.type == checks_start;
+            break;
+        case release:
+            if (!released) {
+                released = true;
+                risk_at_release = x(risk_node);
+            }
+            break;
+        case quarantine:
+            if (released) {
+                released = false;
+                risk += x(risk_node) - risk_at_release;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    write_states_until(std::numeric_limits<int>::max());
+
+    if (released) {
+        risk += x(risk_node) - risk_at_release + residual_risk_[scenario][screening].dot(x);
+    }
+    return risk;
+}
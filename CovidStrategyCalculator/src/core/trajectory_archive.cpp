@@ -0,0 +1,428 @@
+/* trajectory_archive.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the TrajectoryArchive class. A compartment is coded as integers: the states divided by the
+ * step and rounded (quantised), or the bits of the floats mapped to integers in the order of the floats (lossless).
+ * The first value is stored as a variable-length integer, the others as residuals of the prediction from the previous
+ * value (order 1) or the linear extrapolation from the previous two (order 2), whichever packs smaller. The residuals
+ * are zigzag-coded and bit-packed in blocks of 16, each block with the number of bits of its largest residual, such
+ * that the jumps at test days only widen their own block.
+ *
+ * A chunk holds the number of rows and columns (4 bytes each) and per column the order of the predictor (1 byte), the
+ * first value and the blocks (1 byte for the width, followed by the packed residuals). Chunks end with 8 bytes of
+ * padding, such that the decoder reads the packed residuals 8 bytes at a time.
+ */
+
+#include "include/core/trajectory_archive.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+// the header, the chunks and their table are written and read in the byte order of the host
+#ifdef __BYTE_ORDER__
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "trajectory archives are little-endian");
+#endif
+
+namespace {
+const char magic[8] = {'C', 'S', 'C', 'T', 'R', 'A', 'J', '\0'};
+const uint32_t version = 1;
+const size_t header_size = 24;
+const size_t footer_size = 24; // number of chunks, offset of their table and the magic
+const int block_size = 16;
+const int padding = 8;
+
+uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+int bit_width(uint64_t value) {
+    int width = 0;
+    while (value) {
+        ++width;
+        value >>= 1;
+    }
+    return width;
+}
+
+// the bits of a float as an integer that is ordered as the floats are
+int64_t ordered(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+float unordered(int64_t key) {
+    uint32_t bits = uint32_t(key);
+    bits = (bits & 0x80000000u) ? (bits ^ 0x80000000u) : ~bits;
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+int64_t prediction(const int64_t *values, int t, int order) {
+    return order == 2 && t >= 2 ? 2 * values[t - 1] - values[t - 2] : values[t - 1];
+}
+
+void append_varint(std::string &bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(char(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(char(value));
+}
+
+// returns false if the integer exceeds the end
+bool read_varint(const unsigned char *&data, const unsigned char *end, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        unsigned char byte = *data++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// packs the residuals of a column in blocks, each prefixed by its width
+void append_blocks(std::string &bytes, const std::vector<uint64_t> &residuals) {
+    for (size_t first = 0; first < residuals.size(); first += block_size) {
+        size_t last = std::min(residuals.size(), first + block_size);
+        uint64_t any = 0;
+        for (size_t t = first; t < last; ++t) {
+            any |= residuals[t];
+        }
+        int width = bit_width(any);
+        bytes.push_back(char(width));
+
+        uint64_t buffer = 0;
+        int n_bits = 0;
+        for (size_t t = first; t < last && width; ++t) {
+            buffer |= residuals[t] << n_bits; // n_bits < 8 and width <= 56
+            n_bits += width;
+            while (n_bits >= 8) {
+                bytes.push_back(char(buffer));
+                buffer >>= 8;
+                n_bits -= 8;
+            }
+        }
+        if (n_bits > 0) {
+            bytes.push_back(char(buffer));
+        }
+    }
+}
+
+size_t packed_size(const std::vector<uint64_t> &residuals) {
+    size_t size = 0;
+    for (size_t first = 0; first < residuals.size(); first += block_size) {
+        size_t last = std::min(residuals.size(), first + block_size);
+        uint64_t any = 0;
+        for (size_t t = first; t < last; ++t) {
+            any |= residuals[t];
+        }
+        size += 1 + (bit_width(any) * (last - first) + 7) / 8;
+    }
+    return size;
+}
+
+/* Decodes the residuals of a column after its first value into the states, converted by to_float. Returns nullptr if
+ * the blocks exceed the end.
+ */
+template <int order, typename Conversion>
+const unsigned char *decode_column(const unsigned char *data, const unsigned char *end, int64_t first_value,
+                                   Conversion to_float, float *states, int n) {
+    int64_t previous = first_value;
+    int64_t slope = 0; // the prediction of order 2 is previous + slope, with slope 0 for the second value
+    states[0] = to_float(first_value);
+    for (int first = 1; first < n; first += block_size) {
+        int last = std::min(n, first + block_size);
+        int width = data < end ? *data++ : 64;
+        if (width > 56 || (width * (last - first) + 7) / 8 > end - data) {
+            return nullptr;
+        }
+        uint64_t mask = (uint64_t(1) << width) - 1;
+        uint64_t bit = 0;
+        for (int t = first; t < last; ++t, bit += width) {
+            uint64_t word; // may extend into the padding
+            std::memcpy(&word, data + (bit >> 3), 8);
+            int64_t value = previous + (order == 2 ? slope : 0) + unzigzag((word >> (bit & 7)) & mask);
+            slope = value - previous;
+            previous = value;
+            states[t] = to_float(value);
+        }
+        data += (bit + 7) / 8;
+    }
+    return data;
+}
+} // namespace
+
+std::string TrajectoryArchive::encode(const Eigen::MatrixXf &trajectory, Coding coding, double step) {
+    const double limit = std::ldexp(1., 52); // keeps the residuals of order 2 within 56 bits
+    int n = trajectory.rows();
+    std::string bytes(8, '\0');
+    uint32_t shape[2] = {uint32_t(trajectory.rows()), uint32_t(trajectory.cols())};
+    std::memcpy(bytes.data(), shape, 8);
+
+    std::vector<int64_t> values(n);
+    std::vector<uint64_t> residuals[2];
+    for (int c = 0; c < trajectory.cols(); ++c) {
+        for (int t = 0; t < n; ++t) {
+            float value = trajectory(t, c);
+            if (coding == lossless) {
+                values[t] = ordered(value);
+                continue;
+            }
+            double quantised = std::round(value / step);
+            if (!(std::abs(quantised) <= limit)) { // also catches NaN
+                throw std::invalid_argument("the states are not finite or too large for the tolerance");
+            }
+            values[t] = int64_t(quantised);
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        for (int order = 1; order <= 2; ++order) {
+            residuals[order - 1].resize(n - 1);
+            for (int t = 1; t < n; ++t) {
+                residuals[order - 1][t - 1] = zigzag(values[t] - prediction(values.data(), t, order));
+            }
+        }
+        int order = packed_size(residuals[1]) < packed_size(residuals[0]) ? 2 : 1;
+        bytes.push_back(char(order));
+        append_varint(bytes, zigzag(values[0]));
+        append_blocks(bytes, residuals[order - 1]);
+    }
+    bytes.append(padding, '\0');
+    return bytes;
+}
+
+void TrajectoryArchive::decode(const char *chunk, size_t size, Coding coding, double step,
+                               Eigen::MatrixXf &trajectory) {
+    uint32_t shape[2];
+    if (size < 8 + padding) {
+        throw std::runtime_error("the trajectory archive is corrupt");
+    }
+    std::memcpy(shape, chunk, 8);
+    // every column takes at least its order, its first value and one byte per block
+    uint64_t blocks = shape[0] > 1 ? (uint64_t(shape[0]) - 1 + block_size - 1) / block_size : 0;
+    if (shape[0] > 0 && uint64_t(shape[1]) * (2 + blocks) > size) {
+        throw std::runtime_error("the trajectory archive is corrupt");
+    }
+    int n = shape[0];
+    trajectory.resize(shape[0], shape[1]);
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(chunk) + 8;
+    const unsigned char *end = reinterpret_cast<const unsigned char *>(chunk) + size - padding;
+    auto lossless_to_float = [](int64_t value) { return unordered(value); };
+    auto quantised_to_float = [step](int64_t value) { return float(value * step); };
+    for (int c = 0; c < int(shape[1]) && n > 0; ++c) {
+        uint64_t first_value;
+        int order = data < end ? *data++ : 0;
+        if ((order != 1 && order != 2) || !read_varint(data, end, first_value)) {
+            throw std::runtime_error("the trajectory archive is corrupt");
+        }
+        float *states = trajectory.col(c).data();
+        int64_t value = unzigzag(first_value);
+        if (coding == lossless) {
+            data = order == 2 ? decode_column<2>(data, end, value, lossless_to_float, states, n)
+                              : decode_column<1>(data, end, value, lossless_to_float, states, n);
+        } else {
+            data = order == 2 ? decode_column<2>(data, end, value, quantised_to_float, states, n)
+                              : decode_column<1>(data, end, value, quantised_to_float, states, n);
+        }
+        if (!data) {
+            throw std::runtime_error("the trajectory archive is corrupt");
+        }
+    }
+}
+
+TrajectoryArchive::Writer::Writer(const std::string &path, Coding coding, double tolerance)
+    : coding_(coding), step_(2 * tolerance) {
+    if (coding_ != lossless && coding_ != quantised) {
+        throw std::invalid_argument("unknown coding");
+    }
+    if (coding_ == quantised && !(tolerance > 0)) {
+        throw std::invalid_argument("quantised coding needs a positive tolerance");
+    }
+    char header[header_size] = {};
+    uint32_t coding_value = coding_;
+    std::memcpy(header, magic, sizeof(magic));
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 12, &coding_value, 4);
+    std::memcpy(header + 16, &step_, 8);
+
+    file_.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    file_.write(header, header_size);
+    if (!file_) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    size_ = header_size;
+}
+
+TrajectoryArchive::Writer::~Writer() {
+    try {
+        close();
+    } catch (const std::exception &) {
+        // an archive that is not closed cannot be read
+    }
+}
+
+int64_t TrajectoryArchive::Writer::append(const Eigen::MatrixXf &trajectory) {
+    return append(std::vector<Eigen::MatrixXf>{trajectory});
+}
+
+int64_t TrajectoryArchive::Writer::append(const std::vector<Eigen::MatrixXf> &trajectories) {
+    std::vector<std::string> chunks{};
+    std::vector<std::pair<uint64_t, uint64_t>> hashes{};
+    for (const Eigen::MatrixXf &trajectory : trajectories) {
+        chunks.push_back(encode(trajectory, coding_, step_));
+        uint64_t fnv = 14695981039346656037ull; // FNV-1a, with std::hash as a second hash against collisions
+        for (unsigned char byte : chunks.back()) {
+            fnv = (fnv ^ byte) * 1099511628211ull;
+        }
+        hashes.push_back({fnv, std::hash<std::string>()(chunks.back())});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        throw std::runtime_error("the trajectory archive is closed");
+    }
+    int64_t first = chunks_.size() / 2;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        auto written = written_.find(hashes[i]);
+        if (written != written_.end() && holds(written->second, chunks[i])) {
+            chunks_.push_back(chunks_[2 * written->second]); // an identical trajectory is stored once
+            chunks_.push_back(chunks[i].size());
+            continue;
+        }
+        file_.write(chunks[i].data(), chunks[i].size());
+        if (!file_) {
+            throw std::runtime_error("cannot write the trajectory archive");
+        }
+        written_[hashes[i]] = chunks_.size() / 2;
+        chunks_.push_back(size_);
+        chunks_.push_back(chunks[i].size());
+        size_ += chunks[i].size();
+    }
+    return first;
+}
+
+bool TrajectoryArchive::Writer::holds(int64_t trajectory, const std::string &bytes) {
+    if (chunks_[2 * trajectory + 1] != bytes.size()) {
+        return false;
+    }
+    std::string stored(bytes.size(), '\0');
+    file_.seekg(chunks_[2 * trajectory]);
+    file_.read(&stored[0], stored.size());
+    file_.seekp(size_); // the chunks are appended at the end
+    if (!file_) {
+        throw std::runtime_error("cannot read the trajectory archive");
+    }
+    return stored == bytes;
+}
+
+void TrajectoryArchive::Writer::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return;
+    }
+    // the table of the chunks is aligned to 8 bytes, such that the reader uses it in place
+    uint64_t table = (size_ + 7) / 8 * 8;
+    file_.write(std::string(table - size_, '\0').data(), table - size_);
+    file_.write(reinterpret_cast<const char *>(chunks_.data()), 8 * chunks_.size());
+
+    uint64_t footer[2] = {chunks_.size() / 2, table};
+    file_.write(reinterpret_cast<const char *>(footer), 16);
+    file_.write(magic, sizeof(magic));
+    bool written = bool(file_.flush());
+    file_.close();
+    if (!written) {
+        throw std::runtime_error("cannot write the trajectory archive");
+    }
+}
+
+TrajectoryArchive::TrajectoryArchive(const std::string &path) : file_(path) {
+    const char *data = file_.data();
+    size_t size = file_.size();
+    if (size < header_size + footer_size || std::memcmp(data, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " is not a trajectory archive");
+    }
+    uint32_t file_version, coding;
+    uint64_t footer[2];
+    std::memcpy(&file_version, data + 8, 4);
+    std::memcpy(&coding, data + 12, 4);
+    std::memcpy(&step_, data + 16, 8);
+    std::memcpy(footer, data + size - footer_size, 16);
+    if (file_version != version || coding > quantised) {
+        throw std::runtime_error(path + " is not a trajectory archive of version " + std::to_string(version));
+    }
+    if (std::memcmp(data + size - sizeof(magic), magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " was not closed");
+    }
+    bool valid = footer[1] % 8 == 0 && footer[1] >= header_size && footer[1] <= size - footer_size &&
+                 footer[0] == (size - footer_size - footer[1]) / 16;
+    if (!valid) {
+        throw std::runtime_error(path + " is corrupt");
+    }
+    coding_ = Coding(coding);
+    n_chunks_ = footer[0];
+    chunks_ = reinterpret_cast<const uint64_t *>(data + footer[1]);
+    for (int64_t i = 0; i < n_chunks_; ++i) {
+        uint64_t offset = chunks_[2 * i], chunk_size = chunks_[2 * i + 1];
+        if (offset < header_size || chunk_size < 8 + padding || chunk_size > footer[1] - offset) {
+            throw std::runtime_error(path + " is corrupt");
+        }
+    }
+}
+
+const char *TrajectoryArchive::chunk(int64_t trajectory) const {
+    if (trajectory < 0 || trajectory >= n_chunks_) {
+        throw std::invalid_argument("trajectory out of range");
+    }
+    return file_.data() + chunks_[2 * trajectory];
+}
+
+uint64_t TrajectoryArchive::chunk_size(int64_t trajectory) const {
+    chunk(trajectory);
+    return chunks_[2 * trajectory + 1];
+}
+
+int TrajectoryArchive::rows(int64_t trajectory) const {
+    uint32_t rows;
+    std::memcpy(&rows, chunk(trajectory), 4);
+    return rows;
+}
+
+int TrajectoryArchive::cols(int64_t trajectory) const {
+    uint32_t cols;
+    std::memcpy(&cols, chunk(trajectory) + 4, 4);
+    return cols;
+}
+
+Eigen::MatrixXf TrajectoryArchive::trajectory(int64_t trajectory) const {
+    Eigen::MatrixXf states;
+    this->trajectory(trajectory, states);
+    return states;
+}
+
+void TrajectoryArchive::trajectory(int64_t trajectory, Eigen::MatrixXf &states) const {
+    decode(chunk(trajectory), chunk_size(trajectory), coding_, step_, states);
+}
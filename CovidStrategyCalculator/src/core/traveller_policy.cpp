@@ -0,0 +1,204 @@
+/* traveller_policy.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file implements the TravellerPolicy class. The states at the end of a plan are a linear function of the initial
+ * states: symptomatic screening on arrival, and the propagators between the tests composed with the false ommision
+ * rates of the tests. The probability to release a (pre-)infectious traveller is therefore a fixed weight vector per
+ * plan and scenario, computed once, such that a region costs one small matrix-vector product.
+ */
+
+#include "include/core/traveller_policy.h"
+#include "include/core/model.h"
+#include "include/core/parallel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+
+namespace {
+const int batch_size = 4096; // regions per stage of the pipeline
+} // namespace
+
+TravellerPolicy::TravellerPolicy(const DiseaseParameters &parameters, float target, int max_duration,
+                                 bool symptomatic_screening, int use_case, bool conservative)
+    : parameters_(parameters), target_(target), use_case_(use_case), conservative_(conservative) {
+    if (max_duration < 0 || use_case < 0 || use_case > 2) {
+        throw std::invalid_argument("the maximal duration is non-negative and the use case is 0, 1 or 2");
+    }
+
+    for (int duration = 0; duration <= max_duration; ++duration) {
+        StrategyParameters plan;
+        plan.mode = 2;
+        plan.end_of_strategy = duration;
+        plan.symptomatic_screening = symptomatic_screening;
+        plans_.push_back(plan); // quarantine only
+        plan.test_moments = {duration};
+        plan.test_types = {1};
+        plans_.push_back(plan); // RDT at the end
+        plan.test_types = {0};
+        plans_.push_back(plan); // PCR at the end
+        if (duration > 0) {
+            plan.test_moments = {0, duration};
+            plan.test_types = {0, 0};
+            plans_.push_back(plan); // PCR on arrival and at the end
+        }
+    }
+
+    float risk_posing_fraction_symptomatic_phase = symptomatic_screening ? parameters.fraction_asymptomatic : 1;
+    std::vector<float> test_sensitivity{parameters.pcr_sens,
+                                        float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+
+    // symptomatic travellers go into isolation on arrival, as Simulation::apply_symptomatic_screening_to_initial_states
+    Eigen::VectorXd screening = Eigen::VectorXd::Ones(Model::n_compartments);
+    int first_symptomatic_compartment = Model::sub_compartments[0] + Model::sub_compartments[1];
+    screening.segment(first_symptomatic_compartment, Model::sub_compartments[2]).setConstant(
+        risk_posing_fraction_symptomatic_phase);
+
+    // (pre-)infectious: the predetection, presymptomatic and symptomatic phase
+    Eigen::VectorXd infectious = Eigen::VectorXd::Zero(Model::n_compartments);
+    infectious.head(first_symptomatic_compartment + Model::sub_compartments[2]).setOnes();
+
+    weights_.resize(3 * plans_.size(), Model::n_compartments);
+    std::vector<std::vector<float>> taus{parameters.tau_mean_case, parameters.tau_best_case, parameters.tau_worst_case};
+    for (int s = 0; s < 3; ++s) {
+        Model model(taus[s], risk_posing_fraction_symptomatic_phase, Eigen::VectorXf::Zero(Model::n_compartments), 0,
+                    {}, {}, test_sensitivity, parameters.test_specificity);
+        for (int p = 0; p < (int)plans_.size(); ++p) {
+            // adjoint of the plan: the weights propagate backward from the end of the plan to the arrival
+            const StrategyParameters &plan = plans_[p];
+            Eigen::VectorXd weights = infectious;
+            int t = plan.end_of_strategy;
+            for (int i = plan.test_moments.size() - 1; i >= 0; --i) {
+                weights = model.propagator(t - plan.test_moments[i]).transpose() * weights;
+                weights = model.false_ommision_rate(plan.test_types[i]).cwiseProduct(weights);
+                t = plan.test_moments[i];
+            }
+            weights = model.propagator(t).transpose() * weights;
+            weights_.row(3 * p + s) = screening.cwiseProduct(weights).cast<float>().transpose();
+        }
+    }
+}
+
+std::string TravellerPolicy::description(const StrategyParameters &plan) {
+    std::string text = std::to_string(plan.end_of_strategy) + (plan.end_of_strategy == 1 ? " day" : " days");
+    std::vector<int> types = plan.types_of_tests();
+    for (int i = 0; i < (int)plan.test_moments.size(); ++i) {
+        if (i == 0 || types[i] != types[i - 1]) {
+            text += std::string(i == 0 ? " with " : " and ") + (types[i] ? "RDT" : "PCR") + " on day ";
+        } else {
+            text += " and ";
+        }
+        text += std::to_string(plan.test_moments[i]);
+    }
+    return text;
+}
+
+Eigen::MatrixXf TravellerPolicy::released(const Eigen::VectorXf &initial_states) const {
+    Eigen::VectorXf released = 1e5 * weights_ * initial_states;
+    return Eigen::Map<Eigen::MatrixXf>(released.data(), 3, plans_.size()).transpose();
+}
+
+TravellerPolicy::Decision TravellerPolicy::decide(const Eigen::VectorXf &initial_states) const {
+    Eigen::MatrixXf released = this->released(initial_states);
+    for (int p = 0; p < (int)plans_.size(); ++p) {
+        float criterion = conservative_ ? released.row(p).maxCoeff() : released(p, 0);
+        if (criterion <= target_) {
+            return {p, released.row(p).transpose()};
+        }
+    }
+    return {-1, released.bottomRows(1).transpose()};
+}
+
+void TravellerPolicy::run(IncidenceFile &file, std::ostream &output) const {
+    struct Result {
+        std::string name;
+        std::string date;
+        float prevalence_infectious;
+        Decision decision;
+    };
+
+    auto read = [&file]() {
+        std::vector<RegionalPrevalence::Region> batch(batch_size);
+        int n = 0;
+        while (n < batch_size && file.next(batch[n])) {
+            ++n;
+        }
+        batch.resize(n);
+        return batch;
+    };
+    auto write = [&output, this](std::vector<Result> results) {
+        char buffer[64];
+        for (const Result &result : results) {
+            output << result.name << "," << result.date;
+            std::snprintf(buffer, sizeof(buffer), ",%g,", result.prevalence_infectious);
+            output << buffer;
+            const Decision &decision = result.decision;
+            if (decision.plan >= 0) {
+                const StrategyParameters &plan = plans_[decision.plan];
+                output << plan.end_of_strategy << "," << description(plan);
+            } else {
+                output << ",none";
+            }
+            std::snprintf(buffer, sizeof(buffer), ",%g,%g,%g\n", decision.released(0),
+                          decision.released.minCoeff(), decision.released.maxCoeff());
+            output << buffer;
+        }
+    };
+
+    output << "region,date,prevalence_infectious,quarantine_days,plan,released_per_100k,released_lower,"
+              "released_upper\n";
+    std::future<std::vector<RegionalPrevalence::Region>> reading = std::async(std::launch::async, read);
+    std::future<void> writing;
+    for (;;) {
+        std::vector<RegionalPrevalence::Region> regions = reading.get();
+        if (regions.empty()) {
+            break;
+        }
+        reading = std::async(std::launch::async, read); // the next batch is read during the evaluation
+
+        int n_days = RegionalPrevalence::n_days(regions);
+        RegionalPrevalence prevalence(parameters_, n_days);
+        std::vector<Result> results(regions.size());
+        int n_blocks = (regions.size() + 255) / 256;
+        Parallel::for_each(n_blocks, [&](int b) {
+            int first = 256 * b;
+            int n = std::min(256, (int)regions.size() - first);
+            Eigen::MatrixXf incidence = Eigen::MatrixXf::Zero(n_days, n);
+            for (int r = 0; r < n; ++r) {
+                const std::vector<float> &daily_incidence = regions[first + r].daily_incidence;
+                incidence.col(r).head(daily_incidence.size()) =
+                    Eigen::Map<const Eigen::VectorXf>(daily_incidence.data(), daily_incidence.size());
+            }
+            Eigen::MatrixXf states = prevalence.compartment_states(incidence, use_case_);
+            Eigen::MatrixXf phases = RegionalPrevalence::phase_probabilities(states);
+            for (int r = 0; r < n; ++r) {
+                results[first + r] = {regions[first + r].name, regions[first + r].date, phases.col(r).head(3).sum(),
+                                      decide(states.col(r))};
+            }
+        });
+
+        if (writing.valid()) {
+            writing.get(); // keeps the order of the batches
+        }
+        writing = std::async(std::launch::async, write, std::move(results)); // written during the next evaluation
+    }
+    if (writing.valid()) {
+        writing.get();
+    }
+}
@@ -87,6 +87,13 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
         update_result_log(simulation);
         update_efficacy_table(simulation);
     });
+    connect(input_container, &InputContainer::output_stored_results,
+            [=](const StrategyParameters &strategy, float fraction_asymptomatic, const Eigen::VectorXf &relative_risk,
+                const Eigen::VectorXf &p_infectious_tend) {
+                chart_view->setChart(new QtCharts::QChart); // the time course is not stored
+                efficacy_table->clearContents();
+                result_log->write_row_result_log(strategy, fraction_asymptomatic, relative_risk, p_infectious_tend);
+            });
 
     QVBoxLayout *main_layout = new QVBoxLayout;
     if (flip_layout) {
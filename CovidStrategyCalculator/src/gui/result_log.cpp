@@ -29,6 +29,7 @@
 #include <QEvent>
 #include <QHeaderView>
 #include <QKeyEvent>
+#include <algorithm>
 
 ResultLog::ResultLog(QWidget *parent) : QTableWidget(0, 11, parent) {
     this->setHorizontalHeaderLabels((QStringList() << "mode"
@@ -49,52 +50,88 @@ ResultLog::ResultLog(QWidget *parent) : QTableWidget(0, 11, parent) {
 }
 
 void ResultLog::write_row_result_log(Simulation *simulation) {
+    StrategyParameters strategy;
+    strategy.mode = simulation->get_mode();
+    strategy.symptomatic_screening = simulation->get_symptomatic_screening();
+    strategy.expected_adherence = simulation->get_adherence();
+    strategy.time_delay = simulation->get_t_offset();
+    strategy.end_of_strategy = simulation->get_last_t();
+    strategy.test_moments = simulation->get_t_test();
+    strategy.test_types = simulation->get_test_types();
+    strategy.p_infectious_t0 = simulation->get_p_infectious_t0();
+
+    Eigen::MatrixXf risk_reduction = Utils::mid_min_max(simulation->risk_reduction())(Eigen::last, Eigen::all);
+    Eigen::MatrixXf fold_risk_reduction =
+        Utils::mid_min_max(simulation->fold_risk_reduction())(Eigen::last, Eigen ::all);
+
+    Eigen::VectorXf relative_risk(3);
+    relative_risk = Utils::mid_min_max((100. / fold_risk_reduction(0, 0)), (100. / fold_risk_reduction(0, 1)),
+                                       (100. / fold_risk_reduction(0, 2)));
+
+    Eigen::VectorXf p_infectious_tend = simulation->get_p_infectious_tend();
+    p_infectious_tend = Utils::mid_min_max(p_infectious_tend(0), p_infectious_tend(1), p_infectious_tend(2));
+
+    write_row(strategy, simulation->get_fraction_asymptomatic(), p_infectious_tend, relative_risk,
+              risk_reduction.row(0).transpose() * 100.f, false);
+}
+
+void ResultLog::write_row_result_log(const StrategyParameters &strategy, float fraction_asymptomatic,
+                                     const Eigen::VectorXf &relative_risk, const Eigen::VectorXf &p_infectious_tend) {
+    Eigen::VectorXf risk_reduction =
+        Utils::mid_min_max(1 - relative_risk(0), 1 - relative_risk(1), 1 - relative_risk(2)) * 100.f;
+    write_row(strategy, fraction_asymptomatic,
+              Utils::mid_min_max(p_infectious_tend(0), p_infectious_tend(1), p_infectious_tend(2)),
+              Utils::mid_min_max(relative_risk(0), relative_risk(1), relative_risk(2)) * 100.f, risk_reduction, true);
+}
+
+void ResultLog::write_row(const StrategyParameters &strategy, float fraction_asymptomatic,
+                          const Eigen::VectorXf &p_infectious_tend, const Eigen::VectorXf &relative_risk,
+                          const Eigen::VectorXf &risk_reduction, bool stored) {
 
     this->insertRow(0);
 
     std::map<int, std::string> mode_map_int{{0, "contact management"}, {1, "isolation"}, {2, "incoming travelers"}};
-    this->setItem(0, 0, new QTableWidgetItem(QString(mode_map_int[simulation->get_mode()].c_str())));
+    QString mode(mode_map_int[strategy.mode].c_str());
+    this->setItem(0, 0, new QTableWidgetItem(stored ? mode + " (stored)" : mode));
 
-    QString boolText = simulation->get_symptomatic_screening() ? "yes" : "no";
-    if (simulation->get_symptomatic_screening()) {
+    QString boolText = strategy.symptomatic_screening ? "yes" : "no";
+    if (strategy.symptomatic_screening) {
         this->setItem(0, 1,
-                      new QTableWidgetItem(boolText + " (" +
-                                           QString::number(simulation->get_fraction_asymptomatic() * 100) + "%)"));
+                      new QTableWidgetItem(boolText + " (" + QString::number(fraction_asymptomatic * 100) + "%)"));
     } else {
         this->setItem(0, 1, new QTableWidgetItem(boolText));
     }
 
-    this->setItem(0, 2, new QTableWidgetItem(QString::number(simulation->get_adherence() * 100.)));
-    this->setItem(0, 3, new QTableWidgetItem(QString::number(simulation->get_t_offset())));
-    this->setItem(0, 4, new QTableWidgetItem(QString::number(simulation->get_last_t())));
+    this->setItem(0, 2, new QTableWidgetItem(QString::number(strategy.expected_adherence * 100.)));
+    this->setItem(0, 3, new QTableWidgetItem(QString::number(strategy.time_delay)));
+    this->setItem(0, 4, new QTableWidgetItem(QString::number(strategy.end_of_strategy)));
 
-    if (simulation->get_t_test().size()) {
+    if (strategy.test_moments.size()) {
         QString days{};
-        for (int day : simulation->get_t_test()) {
-            days += (QString::number(day - simulation->get_t_offset()) + ", ");
+        for (int day : strategy.test_moments) {
+            days += (QString::number(day - strategy.time_delay) + ", ");
         }
         days.chop(2);
         this->setItem(0, 5, new QTableWidgetItem(days));
 
         std::map<int, std::string> test_type_map{{0, "PCR"}, {1, "Antigen"}};
-        this->setItem(0, 6, new QTableWidgetItem(test_type_map[simulation->get_test_type()].c_str()));
+        std::vector<int> test_types = strategy.types_of_tests();
+        if (std::equal(test_types.begin() + 1, test_types.end(), test_types.begin())) {
+            this->setItem(0, 6, new QTableWidgetItem(test_type_map[test_types[0]].c_str()));
+        } else { // mixed schedule, one type per test day
+            QString types{};
+            for (int type : test_types) {
+                types += (QString(test_type_map[type].c_str()) + ", ");
+            }
+            types.chop(2);
+            this->setItem(0, 6, new QTableWidgetItem(types));
+        }
     } else {
         this->setItem(0, 5, new QTableWidgetItem());
         this->setItem(0, 6, new QTableWidgetItem());
     }
 
-    this->setItem(0, 7, new QTableWidgetItem(QString::number(simulation->get_p_infectious_t0(), 'f', 2)));
-
-    Eigen::MatrixXf risk_reduction = Utils::mid_min_max(simulation->risk_reduction())(Eigen::last, Eigen::all);
-    Eigen::MatrixXf fold_risk_reduction =
-        Utils::mid_min_max(simulation->fold_risk_reduction())(Eigen::last, Eigen ::all);
-
-    Eigen::VectorXf relative_risk(3);
-    relative_risk = Utils::mid_min_max((100. / fold_risk_reduction(0, 0)), (100. / fold_risk_reduction(0, 1)),
-                                       (100. / fold_risk_reduction(0, 2)));
-
-    Eigen::VectorXf p_infectious_tend = simulation->get_p_infectious_tend();
-    p_infectious_tend = Utils::mid_min_max(p_infectious_tend(0), p_infectious_tend(1), p_infectious_tend(2));
+    this->setItem(0, 7, new QTableWidgetItem(QString::number(strategy.p_infectious_t0, 'f', 2)));
 
     this->setItem(0, 8,
                   new QTableWidgetItem(Utils::safeguard_probability(p_infectious_tend(0), 2) + " (" +
@@ -107,9 +144,9 @@ void ResultLog::write_row_result_log(Simulation *simulation) {
                                        Utils::safeguard_inf(relative_risk(2), 2) + ")"));
 
     this->setItem(0, 10,
-                  new QTableWidgetItem(Utils::safeguard_probability(risk_reduction(0, 0) * 100., 2) + " (" +
-                                       Utils::safeguard_probability(risk_reduction(0, 1) * 100., 2) + ", " +
-                                       Utils::safeguard_probability(risk_reduction(0, 2) * 100., 2) + ")"));
+                  new QTableWidgetItem(Utils::safeguard_probability(risk_reduction(0), 2) + " (" +
+                                       Utils::safeguard_probability(risk_reduction(1), 2) + ", " +
+                                       Utils::safeguard_probability(risk_reduction(2), 2) + ")"));
 
     for (int i = 0; i < 11; ++i) {
         this->item(0, i)->setFlags(this->item(0, i)->flags() & ~Qt::ItemIsEditable);
@@ -26,6 +26,9 @@
 #include "include/core/prevalence_estimator.h"
 #include "include/gui/utils.h"
 
+#include <QMessageBox>
+#include <QStandardPaths>
+
 InputContainer::InputContainer(QWidget *parent) : QTabWidget(parent) {
 
     strategy_tab = new StrategyTab;
@@ -62,16 +65,80 @@ InputContainer::InputContainer(QWidget *parent) : QTabWidget(parent) {
     connect(prevalence_tab, &PrevalenceTab::run_prevalence_estimator, [=]() { run_prevalence_estimator(); });
 
     connect(strategy_tab, &StrategyTab::run_simulation, [=]() { run_simulation(); });
+
+    try {
+        QString directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+        result_cache = std::make_unique<ResultCache>(directory.toStdString());
+    } catch (const std::exception &) {
+        // without a cache every strategy is simulated
+    }
 }
 
 void InputContainer::run_prevalence_estimator() {
-    PrevalenceEstimator *prevalence_simulation = new PrevalenceEstimator(parameters_tab, prevalence_tab);
+    PrevalenceEstimator *prevalence_simulation =
+        new PrevalenceEstimator(parameters_tab->disease_parameters(), prevalence_tab->incidence());
     prevalence_tab->set_states(prevalence_simulation->compartment_states());
     prevalence_tab->set_probabilities(prevalence_simulation->phase_probabilities());
     prevalence_tab->update_layout();
 }
 
 void InputContainer::run_simulation() {
-    Simulation *simulation = new Simulation(parameters_tab, strategy_tab, prevalence_tab);
+    Eigen::VectorXf prevalence_states{};
+    if (prevalence_tab->use_prevalence_estimation()) {
+        prevalence_states = prevalence_tab->initial_states();
+    } else if (look_up_stored_results()) {
+        return;
+    }
+    DiseaseParameters parameters = parameters_tab->disease_parameters();
+    StrategyParameters strategy = strategy_tab->strategy_parameters();
+    Simulation *simulation = result_cache ? result_cache->simulation(parameters, strategy, prevalence_states).release()
+                                          : new Simulation(parameters, strategy, prevalence_states);
     emit output_results(simulation);
 }
+
+void InputContainer::load_results(const std::string &path) {
+    try {
+        std::unique_ptr<ResultStore> store = std::make_unique<ResultStore>(path);
+        std::unique_ptr<ParameterIndex> index = std::make_unique<ParameterIndex>(ParameterIndex::path(path));
+        if (index->n_store_rows() != store->n_rows()) {
+            throw std::runtime_error("the index is out of date, rebuild it with --store-index");
+        }
+        result_store = std::move(store);
+        parameter_index = std::move(index);
+    } catch (const std::exception &e) {
+        QMessageBox::warning(this, tr("Load results"),
+                             tr("Could not load %1: %2").arg(QString::fromStdString(path), e.what()));
+    }
+}
+
+bool InputContainer::look_up_stored_results() {
+    if (!parameter_index) {
+        return false;
+    }
+    StrategyParameters strategy = strategy_tab->strategy_parameters();
+    Eigen::VectorXf relative_risk(3), p_infectious_tend(3);
+    try {
+        int64_t row = parameter_index->find(ParameterIndex::key(strategy));
+        if (row < 0) {
+            return false;
+        }
+        // the sweep holds the results for its disease parameters only
+        for (const auto &[name, value] : parameters_tab->values()) {
+            if (float(result_store->value(row, result_store->column_index(name))) != value) {
+                return false;
+            }
+        }
+        const std::string scenarios[] = {"_typical", "_best", "_worst"};
+        for (int s = 0; s < 3; ++s) {
+            int relative_risk_column = result_store->column_index("relative_risk" + scenarios[s]);
+            int released_column = result_store->column_index("released" + scenarios[s]);
+            relative_risk(s) = result_store->value(row, relative_risk_column);
+            // stored for an initial probability of infection of 1; the states are linear in it
+            p_infectious_tend(s) = strategy.p_infectious_t0 * result_store->value(row, released_column);
+        }
+    } catch (const std::exception &) { // e.g. tests beyond the days of the index or a store of a different sweep
+        return false;
+    }
+    emit output_stored_results(strategy, parameters_tab->fraction_asymptomatic(), relative_risk, p_infectious_tend);
+    return true;
+}
@@ -25,8 +25,12 @@
 #include "include/gui/user_input/parameters_tab.h"
 #include "include/gui/utils.h"
 
+#include <QFileDialog>
 #include <QGridLayout>
 #include <QLabel>
+#include <QMessageBox>
+#include <fstream>
+#include <stdexcept>
 
 ParametersTab::ParametersTab(QWidget *parent) : QWidget(parent) {
     initialize_member_variables();
@@ -64,6 +68,10 @@ void ParametersTab::initialize_member_variables() {
     reset_button_ = new QPushButton(tr("Reset defaults"));
     reset_button_->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
     connect(reset_button_, &QPushButton::clicked, [=]() { reset_defaults(); });
+
+    load_button_ = new QPushButton(tr("Load parameters"));
+    load_button_->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
+    connect(load_button_, &QPushButton::clicked, [=]() { load_parameters(); });
 }
 
 void ParametersTab::set_layout() {
@@ -133,6 +141,7 @@ void ParametersTab::set_layout() {
     main_layout->addWidget(new QLabel(tr("Percentage of asymptomatic infections [%]:")), 8, 0);
     main_layout->addWidget(percentage_asymptomatic_, 8, 2, Qt::AlignCenter);
 
+    main_layout->addWidget(load_button_, 9, 2, Qt::AlignCenter);
     main_layout->addWidget(reset_button_, 9, 3);
 
     main_layout->setHorizontalSpacing(10);
@@ -141,17 +150,55 @@ void ParametersTab::set_layout() {
     this->setLayout(main_layout);
 }
 
-void ParametersTab::reset_defaults() {
-    incubation_mean_->setValue(default_values["duration_incubation_mean"]);
-    incubation_upper_->setValue(default_values["duration_incubation_upper"]);
-    incubation_lower_->setValue(default_values["duration_incubation_lower"]);
-    percentage_predetection_->setValue(default_values["percentage_of_incubation_predetection"]);
-    symptomatic_mean_->setValue(default_values["duration_symptomatic_mean"]);
-    symptomatic_upper_->setValue(default_values["duration_symptomatic_upper"]);
-    symptomatic_lower_->setValue(default_values["duration_symptomatic_lower"]);
-    percentage_asymptomatic_->setValue(default_values["percentage_asymptomatic"]);
-    postinfectious_->setValue(default_values["duration_postinfectious_mean"]);
-    pcr_sens_->setValue(default_values["PCR_sensitivity"]);
-    pcr_spec_->setValue(default_values["PCR_specificity"]);
-    relative_rdt_sens_->setValue(default_values["relative_RDT_sensitivity"]);
+void ParametersTab::reset_defaults() { set_values(default_values); }
+
+void ParametersTab::load_parameters() {
+    QString file_name = QFileDialog::getOpenFileName(this, tr("Load parameters"), QString(),
+                                                     tr("Parameter files (*.txt *.par);;All files (*)"));
+    if (file_name.isEmpty()) {
+        return;
+    }
+    std::ifstream file(file_name.toStdString());
+    try {
+        set_values(Parameters::read_values(file));
+    } catch (const std::runtime_error &e) {
+        QMessageBox::warning(this, tr("Load parameters"), tr("Could not load %1: %2").arg(file_name, e.what()));
+    }
+}
+
+void ParametersTab::set_values(const std::map<std::string, float> &values) {
+    const std::map<std::string, QDoubleSpinBox *> fields{
+        {"duration_incubation_lower", incubation_lower_},
+        {"duration_incubation_mean", incubation_mean_},
+        {"duration_incubation_upper", incubation_upper_},
+        {"percentage_of_incubation_predetection", percentage_predetection_},
+        {"duration_symptomatic_lower", symptomatic_lower_},
+        {"duration_symptomatic_mean", symptomatic_mean_},
+        {"duration_symptomatic_upper", symptomatic_upper_},
+        {"percentage_asymptomatic", percentage_asymptomatic_},
+        {"duration_postinfectious_mean", postinfectious_},
+        {"PCR_sensitivity", pcr_sens_},
+        {"PCR_specificity", pcr_spec_},
+        {"relative_RDT_sensitivity", relative_rdt_sens_}};
+    for (const auto &[key, value] : values) {
+        auto field = fields.find(key);
+        if (field != fields.end()) {
+            field->second->setValue(value);
+        }
+    }
+}
+
+std::map<std::string, float> ParametersTab::values() const {
+    return {{"duration_incubation_lower", incubation_lower_->value()},
+            {"duration_incubation_mean", incubation_mean_->value()},
+            {"duration_incubation_upper", incubation_upper_->value()},
+            {"percentage_of_incubation_predetection", percentage_predetection_->value()},
+            {"duration_symptomatic_lower", symptomatic_lower_->value()},
+            {"duration_symptomatic_mean", symptomatic_mean_->value()},
+            {"duration_symptomatic_upper", symptomatic_upper_->value()},
+            {"percentage_asymptomatic", percentage_asymptomatic_->value()},
+            {"duration_postinfectious_mean", postinfectious_->value()},
+            {"PCR_sensitivity", pcr_sens_->value()},
+            {"PCR_specificity", pcr_spec_->value()},
+            {"relative_RDT_sensitivity", relative_rdt_sens_->value()}};
 }
@@ -83,6 +83,11 @@ void StrategyTab::initialize_member_variables() {
     connect(time_delay_, QOverload<int>::of(&QSpinBox::valueChanged), [=]() { update_test_days_box(); });
     connect(end_of_strategy_, QOverload<int>::of(&QSpinBox::valueChanged), [=]() { update_test_days_box(); });
     connect(run_button_, &QPushButton::clicked, [=]() { emit run_simulation(); });
+    connect(test_type_, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int index) {
+        for (QComboBox *type : test_days_types) {
+            type->setCurrentIndex(index);
+        }
+    });
 }
 
 void StrategyTab::set_layout() {
@@ -163,21 +168,32 @@ void StrategyTab::set_layout_test_days_box() {
     QHBoxLayout *main_layout = new QHBoxLayout;
     test_days_boxes.clear(); // clean sheet
 
+    test_days_types.clear();
+
     int n = time_delay() + end_of_strategy() + 1;
     for (int day = -time_delay(); day < n - time_delay(); ++day) {
         QCheckBox *box = new QCheckBox;
+        QComboBox *type = new QComboBox;
+        type->addItems(QStringList{"PCR", "Ag"});
+        type->setToolTip(tr("Type of test on this day; PCR or antigen"));
+        type->setCurrentIndex(test_type_->currentIndex());
         if (day < 0) {
             box->setEnabled(false);
         } else {
             if (day < int(test_days_boxes_states.size())) {      // day was also part of previous strategy
                 box->setChecked(test_days_boxes_states.at(day)); // retain previous state
+                type->setCurrentIndex(test_days_types_states.at(day));
             }
         }
+        type->setEnabled(box->isChecked());
+        connect(box, &QCheckBox::toggled, type, &QComboBox::setEnabled);
         test_days_boxes.push_back(box);
+        test_days_types.push_back(type);
 
         QVBoxLayout *vbox = new QVBoxLayout;
         vbox->addWidget(box);
         vbox->addWidget(new QLabel(QString::number(day)));
+        vbox->addWidget(type);
         vbox->setAlignment(Qt::AlignTop);
 
         main_layout->addItem(vbox);
@@ -186,6 +202,7 @@ void StrategyTab::set_layout_test_days_box() {
     main_layout->addStretch();
     test_days_box_->setLayout(main_layout);
     test_days_boxes_states.clear();
+    test_days_types_states.clear();
     this->resize(sizeHint());
 }
 
@@ -194,6 +211,9 @@ void StrategyTab::update_test_days_box() {
     for (auto box : test_days_boxes) {
         test_days_boxes_states.push_back(box->isChecked());
     }
+    for (auto type : test_days_types) {
+        test_days_types_states.push_back(type->currentIndex());
+    }
     // delete existing layout recursively
     QLayout *layout = test_days_box_->layout();
     while (!layout->isEmpty()) {
@@ -251,3 +271,27 @@ std::vector<int> StrategyTab::test_moments() const {
     }
     return v;
 }
+
+std::vector<int> StrategyTab::test_types() const {
+    std::vector<int> v{};
+    for (int i = 0; i < (int)test_days_boxes.size(); ++i) {
+        if (test_days_boxes.at(i)->isChecked()) {
+            v.push_back(test_days_types.at(i)->currentIndex());
+        }
+    }
+    return v;
+}
+
+StrategyParameters StrategyTab::strategy_parameters() const {
+    StrategyParameters strategy;
+    strategy.mode = mode();
+    strategy.time_delay = time_delay();
+    strategy.end_of_strategy = end_of_strategy();
+    strategy.test_moments = test_moments();
+    strategy.test_type = test_type();
+    strategy.test_types = test_types();
+    strategy.expected_adherence = expected_adherence();
+    strategy.p_infectious_t0 = p_infectious_t0();
+    strategy.symptomatic_screening = use_symptomatic_screening();
+    return strategy;
+}
@@ -0,0 +1,95 @@
+/* agent_simulation.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the deterministic model against the agent-based simulation of the process it describes the mean
+ * of. For strategies of both modes, with and without symptomatic screening, with PCR, RDT and mixed test schedules,
+ * the relative risk of the AgentSimulation must lie within five standard errors of that of the Simulation at every
+ * evaluation point, and so must the probability to be, or yet to become infectious at the end of the strategy. The
+ * standard errors include the resolution of a single agent, as the empirical one vanishes where few agents remain.
+ * The random numbers are counter based, so the run is reproducible.
+ */
+
+#include "include/core/agent_simulation.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const int n_agents = 200000;
+    const float max_deviation = 5; // standard errors
+    const float resolution = 1.f / n_agents;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<StrategyParameters> strategies(4);
+    strategies[0].end_of_strategy = 10;
+    strategies[0].test_moments = {5};
+    strategies[1].mode = 1;
+    strategies[1].time_delay = 2;
+    strategies[1].end_of_strategy = 7;
+    strategies[1].test_moments = {4, 9};
+    strategies[1].test_type = 1;
+    strategies[2].time_delay = 3;
+    strategies[2].end_of_strategy = 12;
+    strategies[2].test_moments = {5, 8, 12};
+    strategies[2].test_types = {1, 0, 1};
+    strategies[2].symptomatic_screening = false;
+    strategies[3].end_of_strategy = 14;
+    strategies[3].expected_adherence = .7f;
+
+    float largest_deviation_risk = 0, largest_deviation_released = 0;
+    int deviating_risks = 0, deviating_releases = 0;
+    for (int i = 0; i < (int)strategies.size(); ++i) {
+        Simulation simulation(parameters, strategies[i]);
+        AgentSimulation agents(parameters, strategies[i], n_agents, i + 1);
+
+        Eigen::MatrixXf deviation = (agents.relative_risk() - simulation.relative_risk()).cwiseAbs();
+        Eigen::MatrixXf standard_error =
+            (agents.relative_risk_standard_error().array().square() + resolution * resolution).sqrt();
+        float deviation_risk = (deviation.array() / standard_error.array()).maxCoeff(); // in standard errors
+
+        // the released fraction of n agents is binomial
+        float deviation_released = 0;
+        Eigen::VectorXf released = simulation.get_p_infectious_tend(), released_agents = agents.get_p_infectious_tend();
+        for (int s = 0; s < 3; ++s) {
+            float p = std::clamp(released(s), 0.f, 1.f);
+            float standard_error_released = std::sqrt(p * (1 - p) / n_agents + resolution * resolution);
+            deviation_released =
+                std::max(deviation_released, std::abs(released_agents(s) - released(s)) / standard_error_released);
+        }
+
+        if (!(deviation_risk <= max_deviation && deviation_released <= max_deviation)) {
+            std::printf("strategy %d: deviation of the relative risk %.2f, of the released fraction %.2f standard "
+                        "errors\n",
+                        i, deviation_risk, deviation_released);
+        }
+        deviating_risks += !(deviation_risk <= max_deviation);
+        deviating_releases += !(deviation_released <= max_deviation);
+        largest_deviation_risk = std::max(largest_deviation_risk, deviation_risk);
+        largest_deviation_released = std::max(largest_deviation_released, deviation_released);
+    }
+    check(deviating_risks == 0, "the relative risk of the agents is that of the Simulation");
+    check(deviating_releases == 0, "the released fraction of the agents is that of the Simulation");
+
+    std::printf("%d checks failed; %d strategies, largest deviation from the Simulation %.2f (relative risk), %.2f "
+                "(released fraction) standard errors\n",
+                failures, (int)strategies.size(), largest_deviation_risk, largest_deviation_released);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+# The deterministic model against the agent-based simulation of the same process.
+
+TARGET = agent_simulation
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/agent_simulation.cpp \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/sobol_sequence.cpp \
+        agent_simulation.cpp
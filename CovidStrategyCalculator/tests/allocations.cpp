@@ -0,0 +1,160 @@
+/* allocations.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks that the evaluations in a workspace do not allocate once its buffers have their size:
+ * Ensemble::risks in an Ensemble::Workspace, Simulation::end_of_strategy and Simulation::evaluate with its outputs
+ * in a Simulation::Workspace, and the model
+ * reset with set_parameters, set_test_parameters and set_strategy and evaluated into buffers of the caller. The
+ * allocations of C++ are counted by replacing operator new; Eigen allocates with malloc, which it asserts against
+ * while the evaluations run (EIGEN_RUNTIME_NO_MALLOC, see allocations.pro).
+ */
+
+#ifdef NDEBUG
+#error "the allocations of Eigen are only detected with assertions enabled"
+#endif
+
+#include "include/core/ensemble.h"
+#include "include/core/simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<long> allocations{0};
+
+void *allocate(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// the heap allocations of C++ and Eigen while the function runs
+template <typename Function> long allocations_of(Function function) {
+    long before = allocations;
+    Eigen::internal::set_is_malloc_allowed(false);
+    function();
+    Eigen::internal::set_is_malloc_allowed(true);
+    return allocations - before;
+}
+} // namespace
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+    const int n = 100;
+
+    // parameter sets and strategies, made before the evaluations
+    ParameterSpace space(Parameters::default_values);
+    std::vector<DiseaseParameters> parameters;
+    for (int i = 0; i < n; ++i) {
+        parameters.push_back(space.parameters_at(Eigen::VectorXd::Random(space.dimensions()).array().abs()));
+    }
+    std::vector<StrategyParameters> strategies(n);
+    for (int i = 0; i < n; ++i) {
+        StrategyParameters &strategy = strategies[i];
+        strategy.mode = i % 2; // incoming travelers need prevalence states
+        strategy.time_delay = i % 4;
+        strategy.end_of_strategy = 5 + i % 10;
+        for (int day = 1 + i % 3; day < strategy.end_of_strategy; day += 3) {
+            strategy.test_moments.push_back(strategy.time_delay + day);
+            strategy.test_types.push_back(day % 2);
+        }
+        strategy.expected_adherence = (i % 11) / 10.f;
+        strategy.symptomatic_screening = i % 2;
+    }
+    int failures = 0;
+    auto report = [&failures](const char *evaluation, long count) {
+        std::printf("%s: %ld allocations in %d evaluations\n", evaluation, count, n);
+        failures += count != 0;
+    };
+
+    Ensemble ensemble(space, strategies[n - 1]);
+    for (bool end_of_strategy_only : {false, true}) {
+        Ensemble::Workspace workspace = ensemble.workspace();
+        ensemble.risks(parameters[0], workspace, end_of_strategy_only); // sizes the buffers
+        report(end_of_strategy_only ? "Ensemble::risks, end of strategy" : "Ensemble::risks", allocations_of([&]() {
+                   for (int i = 0; i < n; ++i) {
+                       ensemble.risks(parameters[i], workspace, end_of_strategy_only);
+                   }
+               }));
+    }
+
+    // a first pass sizes the vectors of the workspace for the longest schedule
+    Simulation::Workspace workspace;
+    for (int i = 0; i < n; ++i) {
+        Simulation::end_of_strategy(parameters[i], strategies[i], workspace);
+    }
+    report("Simulation::end_of_strategy", allocations_of([&]() {
+               for (int i = 0; i < n; ++i) {
+                   Simulation::end_of_strategy(parameters[i], strategies[i], workspace);
+               }
+           }));
+
+    // the outputs are written into the top rows of buffers for the longest schedule
+    int max_rows = 0;
+    for (int i = 0; i < n; ++i) {
+        Simulation::evaluate(parameters[i], strategies[i], workspace);
+        max_rows = std::max(max_rows, workspace.models_NPI[0].n_evaluation_points());
+    }
+    Eigen::MatrixXf outputs(max_rows, 3);
+    Eigen::VectorXf points(max_rows);
+    report("Simulation::evaluate", allocations_of([&]() {
+               for (int i = 0; i < n; ++i) {
+                   Simulation::evaluate(parameters[i], strategies[i], workspace);
+                   int n_evaluation_points = workspace.models_NPI[0].n_evaluation_points();
+                   int n_days = workspace.t_end + 1;
+                   Simulation::relative_risk(workspace, outputs.topRows(n_evaluation_points));
+                   Simulation::evaluation_points_with_tests(workspace, points.head(n_evaluation_points));
+                   for (int type = 0; type < 2; ++type) {
+                       Simulation::temporal_assay_sensitivity(workspace, type, outputs.topRows(n_days));
+                       Simulation::test_efficacy(workspace, type, outputs.topRows(n_days));
+                   }
+               }
+           }));
+
+    const StrategyParameters &strategy = strategies[0];
+    int t_end = strategy.time_delay + strategy.end_of_strategy;
+    Eigen::VectorXf initial_states = Eigen::VectorXf::Unit(Model::n_compartments, 0);
+    Model model(parameters[0].tau_mean_case, .8f, initial_states, t_end, strategy.test_moments, strategy.test_types,
+                {.9f, .7f}, .999f);
+    Eigen::MatrixXf states(model.n_evaluation_points(), Model::n_compartments);
+    Eigen::VectorXf end_states(Model::n_compartments), risk(model.n_evaluation_points());
+    std::vector<float> test_sensitivity{.9f, .7f};
+    report("Model", allocations_of([&]() {
+               for (int i = 0; i < n; ++i) {
+                   model.set_parameters(parameters[i].tau_mean_case, parameters[i].fraction_asymptomatic);
+                   model.set_test_parameters(test_sensitivity, parameters[i].test_specificity);
+                   model.set_strategy(t_end, strategy.test_moments, strategy.test_types);
+                   model.run(initial_states, states);
+                   model.run_end_of_strategy(initial_states, end_states);
+                   model.integrate(states, 0, risk);
+                   model.integrate(states.middleRows(3, 4), 3, risk.head(4));
+               }
+           }));
+    return failures ? 1 : 0;
+}
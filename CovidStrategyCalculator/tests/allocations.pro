@@ -0,0 +1,22 @@
+# Heap allocations of the evaluations in a workspace; Eigen asserts on any heap allocation while they run.
+
+TARGET = allocations
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle release
+CONFIG += debug
+DEFINES += EIGEN_RUNTIME_NO_MALLOC
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/ensemble.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameter_space.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/sobol_sequence.cpp \
+        allocations.cpp
@@ -0,0 +1,205 @@
+/* c_interface.c
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the C interface of the covidstrategycalculator library as a C program sees it, through the header
+ * only. Null and out of range arguments must return CSC_INVALID_ARGUMENT, or NULL for the engine, with a message in
+ * csc_last_error; outputs before an evaluation CSC_NOT_EVALUATED; a buffer one value too small CSC_BUFFER_TOO_SMALL,
+ * leaving it untouched. csc_evaluate_batch must give the values of n calls of csc_evaluate at the end of the strategy,
+ * up to the rounding of the jumps from test to test, keep the outputs of the last csc_evaluate, and report the status
+ * of every strategy, with the first failure as its own status and in csc_last_error.
+ */
+
+#include "include/capi/covid_strategy_calculator.h"
+#include "tests/check.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define N_STRATEGIES 6
+
+// largest difference of the three values relative to their magnitude, at least 1e-3
+static float relative_difference(const float *a, const float *b) {
+    float largest = 0;
+    for (int i = 0; i < 3; ++i) {
+        float difference = fabsf(a[i] - b[i]) / fmaxf(fabsf(a[i]), 1e-3f);
+        largest = isnan(difference) ? INFINITY : fmaxf(largest, difference);
+    }
+    return largest;
+}
+
+int main(void) {
+    const float tolerance = 1e-4f;
+
+    check(csc_abi_version() == CSC_ABI_VERSION, "the ABI version of the library is that of the header");
+
+    csc_disease_parameters parameters;
+    csc_default_parameters(&parameters);
+    csc_disease_parameters invalid = parameters;
+    invalid.pcr_sensitivity = 120;
+    check(csc_engine_create(NULL) == NULL, "an engine needs parameters");
+    check(csc_engine_create(&invalid) == NULL, "an engine needs parameters in range");
+
+    csc_engine *engine = csc_engine_create(&parameters);
+    if (!engine) {
+        printf("FAILED: no engine for the default parameters\n");
+        return 1;
+    }
+    check(!strcmp(csc_last_error(engine), ""), "a new engine has no error");
+    check(strlen(csc_last_error(NULL)) > 0, "csc_last_error describes a missing engine");
+    check(csc_engine_set_parameters(engine, &invalid) == CSC_INVALID_ARGUMENT && strlen(csc_last_error(engine)) > 0,
+           "parameters out of range are rejected with a message");
+    check(csc_engine_set_parameters(NULL, &parameters) == CSC_INVALID_ARGUMENT, "setting parameters needs an engine");
+    check(csc_engine_set_parameters(engine, &parameters) == CSC_OK && !strcmp(csc_last_error(engine), ""),
+           "a call that succeeds clears the last error");
+
+    float buffer[3 * 64];
+    check(csc_relative_risk(engine, buffer, sizeof(buffer) / sizeof(float)) == CSC_NOT_EVALUATED &&
+               csc_p_infectious_tend(engine, buffer) == CSC_NOT_EVALUATED,
+           "there are no outputs before an evaluation");
+    check(csc_n_evaluation_points(engine) == 0 && csc_n_days(engine) == 0, "there are no rows before an evaluation");
+
+    // the strategies of the batch, each also evaluated alone
+    const int days[] = {2, 5, 7};
+    const int types[] = {1, 0, 1};
+    const int late_day[] = {12};
+    csc_strategy strategies[N_STRATEGIES];
+    for (int i = 0; i < N_STRATEGIES; ++i) {
+        csc_default_strategy(&strategies[i]);
+    }
+    strategies[1].mode = 1;
+    strategies[1].time_delay = 2;
+    strategies[1].duration = 7;
+    strategies[1].test_days = days;
+    strategies[1].n_tests = 3;
+    strategies[2].test_days = days;
+    strategies[2].test_types = types;
+    strategies[2].n_tests = 3;
+    strategies[2].adherence = .8f;
+    strategies[3].mode = 2; // incoming travelers need prevalence states
+    strategies[4].test_days = late_day; // after the end of the strategy
+    strategies[4].n_tests = 1;
+    strategies[5].test_type = 1;
+    strategies[5].test_days = days + 1;
+    strategies[5].n_tests = 2;
+    strategies[5].symptomatic_screening = 0;
+    const csc_status expected[N_STRATEGIES] = {CSC_OK, CSC_OK, CSC_OK, CSC_INVALID_ARGUMENT, CSC_INVALID_ARGUMENT,
+                                               CSC_OK};
+
+    check(csc_evaluate(NULL, &strategies[0]) == CSC_INVALID_ARGUMENT, "an evaluation needs an engine");
+    check(csc_evaluate(engine, NULL) == CSC_INVALID_ARGUMENT && strlen(csc_last_error(engine)) > 0,
+           "an evaluation needs a strategy");
+    csc_strategy no_days = strategies[0];
+    no_days.n_tests = 2;
+    check(csc_evaluate(engine, &no_days) == CSC_INVALID_ARGUMENT, "tests need their days");
+
+    float risk_alone[N_STRATEGIES][3], p_infectious_alone[N_STRATEGIES][3];
+    for (int i = 0; i < N_STRATEGIES; ++i) {
+        csc_status status = csc_evaluate(engine, &strategies[i]);
+        check(status == expected[i], "csc_evaluate returns the status of the strategy");
+        if (status != CSC_OK) {
+            check(strlen(csc_last_error(engine)) > 0 && csc_n_evaluation_points(engine) == 0,
+                   "a failed evaluation leaves a message and no outputs");
+            continue;
+        }
+
+        size_t n_points = csc_n_evaluation_points(engine), n_days = csc_n_days(engine);
+        check(n_days == (size_t)(strategies[i].time_delay + strategies[i].duration + 1) &&
+                   n_points == n_days + (size_t)strategies[i].n_tests,
+               "the evaluation points are the days and the test days twice");
+        if (3 * n_points > sizeof(buffer) / sizeof(float)) {
+            continue;
+        }
+
+        // a buffer one value too small is left as it is
+        for (size_t k = 0; k < 3 * n_points; ++k) {
+            buffer[k] = -1;
+        }
+        int untouched = csc_relative_risk(engine, buffer, 3 * n_points - 1) == CSC_BUFFER_TOO_SMALL &&
+                        csc_evaluation_points(engine, buffer, n_points - 1) == CSC_BUFFER_TOO_SMALL &&
+                        csc_assay_sensitivity(engine, 0, buffer, 3 * n_days - 1) == CSC_BUFFER_TOO_SMALL &&
+                        csc_test_efficacy(engine, 1, buffer, 3 * n_days - 1) == CSC_BUFFER_TOO_SMALL;
+        for (size_t k = 0; k < 3 * n_points; ++k) {
+            untouched = untouched && buffer[k] == -1;
+        }
+        check(untouched, "a buffer too small is rejected and left untouched");
+        check(csc_relative_risk(engine, NULL, 3 * n_points) == CSC_INVALID_ARGUMENT &&
+                   csc_p_infectious_tend(engine, NULL) == CSC_INVALID_ARGUMENT,
+               "an output needs a buffer");
+        check(csc_assay_sensitivity(engine, 2, buffer, 3 * n_days) == CSC_INVALID_ARGUMENT &&
+                   csc_test_efficacy(engine, -1, buffer, 3 * n_days) == CSC_INVALID_ARGUMENT,
+               "an output needs a known test type");
+        check(csc_assay_sensitivity(engine, 1, buffer, 3 * n_days) == CSC_OK &&
+                   csc_test_efficacy(engine, 0, buffer, 3 * n_days) == CSC_OK &&
+                   csc_evaluation_points(engine, buffer, n_points) == CSC_OK,
+               "outputs fit a buffer of their size");
+        check(buffer[0] == -strategies[i].time_delay && buffer[n_points - 1] == strategies[i].duration,
+               "the evaluation points run from minus the time delay to the duration");
+
+        check(csc_relative_risk(engine, buffer, 3 * n_points) == CSC_OK &&
+                   csc_p_infectious_tend(engine, p_infectious_alone[i]) == CSC_OK,
+               "the outputs of an evaluation are available");
+        memcpy(risk_alone[i], buffer + 3 * (n_points - 1), sizeof(risk_alone[i]));
+    }
+
+    // the last csc_evaluate, of strategy 5, is kept through the batches
+    float p_infectious_before[3], p_infectious_after[3];
+    csc_p_infectious_tend(engine, p_infectious_before);
+
+    float risk[N_STRATEGIES][3], p_infectious[N_STRATEGIES][3];
+    csc_status statuses[N_STRATEGIES];
+    csc_status status = csc_evaluate_batch(engine, strategies, N_STRATEGIES, risk[0], p_infectious[0], statuses);
+    check(status == CSC_INVALID_ARGUMENT, "the batch returns the status of the first failure");
+    check(!strncmp(csc_last_error(engine), "strategy 3: ", 12), "the message names the first failed strategy");
+
+    float largest_difference = 0;
+    for (int i = 0; i < N_STRATEGIES; ++i) {
+        check(statuses[i] == expected[i], "the batch reports the status of every strategy");
+        if (expected[i] != CSC_OK) {
+            check(isnan(risk[i][0]) && isnan(risk[i][2]) && isnan(p_infectious[i][1]),
+                   "the rows of a failed strategy are NaN");
+            continue;
+        }
+        largest_difference = fmaxf(largest_difference, relative_difference(risk[i], risk_alone[i]));
+        largest_difference = fmaxf(largest_difference, relative_difference(p_infectious[i], p_infectious_alone[i]));
+    }
+    check(largest_difference <= tolerance, "the batch gives the values of csc_evaluate at the end of the strategy");
+
+    csc_p_infectious_tend(engine, p_infectious_after);
+    check(!memcmp(p_infectious_before, p_infectious_after, sizeof(p_infectious_after)),
+           "the batch keeps the outputs of csc_evaluate");
+
+    // without the failed strategies, and with the optional buffers left out
+    csc_strategy valid[3] = {strategies[0], strategies[2], strategies[5]};
+    check(csc_evaluate_batch(engine, valid, 3, NULL, p_infectious[0], NULL) == CSC_OK &&
+               !strcmp(csc_last_error(engine), ""),
+           "a batch without failures succeeds and clears the last error");
+    check(relative_difference(p_infectious[0], p_infectious_alone[0]) <= tolerance &&
+               relative_difference(p_infectious[2], p_infectious_alone[5]) <= tolerance,
+           "a batch without relative risk gives the same probabilities");
+    check(csc_evaluate_batch(engine, NULL, 0, NULL, NULL, NULL) == CSC_OK, "an empty batch succeeds");
+    check(csc_evaluate_batch(engine, NULL, 2, NULL, NULL, NULL) == CSC_INVALID_ARGUMENT,
+           "a batch needs its strategies");
+    check(csc_evaluate_batch(NULL, valid, 3, NULL, NULL, NULL) == CSC_INVALID_ARGUMENT, "a batch needs an engine");
+
+    csc_engine_destroy(engine);
+    csc_engine_destroy(NULL);
+    printf("%d checks failed; largest relative difference of the batch to csc_evaluate %.2g\n", failures,
+           largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+# The C interface of the covidstrategycalculator library, called from C through its header.
+
+TARGET = c_interface
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+QMAKE_CFLAGS += -std=c99
+
+INCLUDEPATH += .. ../submodules/eigen
+DEFINES += CSC_BUILD_LIBRARY
+
+SOURCES += \
+        ../src/capi/covid_strategy_calculator.cpp \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        c_interface.c
@@ -0,0 +1,130 @@
+/* calibration.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks a Calibration against the natural course of an infection computed with Model::run_no_test. The
+ * observations are the expected numbers of positive and negative PCR and RDT results, onsets and asymptomatic cases
+ * of a line list drawn from known parameters. The log-likelihood must be that of the probabilities of the natural
+ * course, its gradient must agree with central differences, and the best fit must recover the parameters, which
+ * maximise the likelihood of their expected counts.
+ */
+
+#include "include/core/calibration.h"
+#include "include/core/model.h"
+#include "include/core/parameters.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+// the states of the natural course of an infection at exposure, per day (rows), and the model of its tests
+Eigen::MatrixXd natural_course(const Eigen::VectorXd &parameters, int n_days, Model &model) {
+    double incubation = parameters(Calibration::incubation_mean);
+    double predetection = parameters(Calibration::fraction_predetection);
+    std::vector<float> tau{float(predetection * incubation), float((1 - predetection) * incubation),
+                           float(parameters(Calibration::symptomatic_mean)),
+                           Parameters::default_values.at("duration_postinfectious_mean")};
+    float pcr = parameters(Calibration::pcr_sensitivity);
+    float rdt = 1.3 * parameters(Calibration::rdt_relative_sensitivity) * pcr;
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    X0(0) = 1;
+    model = Model(tau, 1, X0, n_days, {}, {}, {pcr, rdt}, Parameters::default_values.at("PCR_specificity") / 100);
+    return model.run_no_test().cast<double>();
+}
+
+// the probability to enter the symptomatic phase in [day, day + 1)
+double onset_probability(const Eigen::MatrixXd &X, int day) {
+    int n = Model::sub_compartments[0] + Model::sub_compartments[1];
+    return X.row(day).head(n).sum() - X.row(day + 1).head(n).sum();
+}
+} // namespace
+
+int main() {
+    const int n_days = 21;
+    const double tests_per_day[2]{400, 200}; // PCR, RDT
+    const double n_cases = 4000;
+
+    Eigen::VectorXd truth(Calibration::n_fit_parameters);
+    truth << 5.8, .35, 6.5, .85, .8, .3;
+
+    // the expected counts of a line list drawn from the parameters
+    Model model;
+    Eigen::MatrixXd X = natural_course(truth, n_days, model);
+    Calibration::Observations observations;
+    for (int type = 0; type < 2; ++type) {
+        Eigen::VectorXd positive = X.topRows(n_days) * model.positive_test_probability(type);
+        observations.positive[type] = tests_per_day[type] * positive;
+        observations.negative[type] = tests_per_day[type] * (1 - positive.array()).matrix();
+    }
+    observations.onset.resize(n_days);
+    for (int day = 0; day < n_days; ++day) {
+        observations.onset(day) = n_cases * (1 - truth(Calibration::fraction_asymptomatic)) * onset_probability(X, day);
+    }
+    observations.asymptomatic = n_cases * truth(Calibration::fraction_asymptomatic);
+
+    Calibration calibration(observations, Parameters::default_values);
+
+    // the log-likelihood of the probabilities of the natural course, away from the parameters of the counts
+    Eigen::VectorXd parameters(Calibration::n_fit_parameters);
+    parameters << 6.77, .422, 7.5, .8, .85, .2;
+    X = natural_course(parameters, n_days, model);
+    double log_likelihood = observations.asymptomatic * std::log(parameters(Calibration::fraction_asymptomatic));
+    for (int day = 0; day < n_days; ++day) {
+        for (int type = 0; type < 2; ++type) {
+            double p = X.row(day).dot(model.positive_test_probability(type));
+            log_likelihood += observations.positive[type](day) * std::log(p) +
+                              observations.negative[type](day) * std::log(1 - p);
+        }
+        log_likelihood += observations.onset(day) *
+                          std::log((1 - parameters(Calibration::fraction_asymptomatic)) * onset_probability(X, day));
+    }
+    Eigen::VectorXd gradient;
+    double difference = std::abs(calibration.log_likelihood(parameters, &gradient) - log_likelihood);
+    check(difference <= 1e-5 * std::abs(log_likelihood), "the log-likelihood is that of the natural course");
+
+    // the gradient against central differences
+    double largest_difference = 0;
+    for (int k = 0; k < Calibration::n_fit_parameters; ++k) {
+        double step = 1e-3 * parameters(k);
+        Eigen::VectorXd lower = parameters, upper = parameters;
+        lower(k) -= step;
+        upper(k) += step;
+        double central = (calibration.log_likelihood(upper) - calibration.log_likelihood(lower)) / (2 * step);
+        largest_difference =
+            std::max(largest_difference, std::abs(gradient(k) - central) / gradient.cwiseAbs().maxCoeff());
+    }
+    check(largest_difference <= 1e-3, "the gradient agrees with central differences of the log-likelihood");
+
+    // the expected counts are fitted best by the parameters they were drawn from
+    calibration.run();
+    const Calibration::Fit &fit = calibration.best_fit();
+    std::vector<bool> fitted = calibration.fitted();
+    double largest_error = 0;
+    for (int k = 0; k < Calibration::n_fit_parameters; ++k) {
+        largest_error = std::max(largest_error, std::abs(fit.parameters(k) - truth(k)) / truth(k));
+    }
+    check(std::count(fitted.begin(), fitted.end(), true) == Calibration::n_fit_parameters,
+          "all parameters are fitted to data with PCR and RDT results and onsets");
+    check(largest_error <= 1e-2, "the best fit recovers the parameters of the expected counts");
+
+    std::printf("%d checks failed; gradient difference %.2g, largest relative error of the fit %.2g\n", failures,
+                largest_difference, largest_error);
+    return failures ? 1 : 0;
+}
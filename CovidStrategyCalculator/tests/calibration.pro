@@ -0,0 +1,18 @@
+# The likelihood of a calibration against the natural course of the model, and the recovery of its parameters.
+
+TARGET = calibration
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/calibration.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/sobol_sequence.cpp \
+        calibration.cpp
@@ -0,0 +1,36 @@
+/* check.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines check, which the tests made of separate checks call for each of them. It prints the checks that
+ * fail and counts them in failures; the test ends with a summary line and returns failures ? 1 : 0. It is included
+ * from C as well as C++.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int failures = 0;
+
+// prints what and counts a failure unless the check passed
+static void check(int passed, const char *what) {
+    if (!passed) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
@@ -0,0 +1,105 @@
+/* cohort_release.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the distribution of a CohortRelease against the Poisson-binomial distribution computed traveller
+ * by traveller, folding in one Bernoulli variable at a time. For cohorts of a few large origins, of many travellers
+ * with distinct probabilities whose partial distributions are combined by FFT, and with origins that release nobody
+ * or everybody, the probabilities, tail probabilities, mean and quantiles must be those of the direct computation.
+ * Origins with a probability outside [0, 1] must be rejected.
+ */
+
+#include "include/core/cohort_release.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// P(X = k) for k = 0, ..., n, one traveller at a time
+std::vector<double> direct_distribution(const std::vector<CohortRelease::Origin> &origins) {
+    std::vector<double> distribution{1};
+    for (const CohortRelease::Origin &origin : origins) {
+        for (int t = 0; t < origin.travellers; ++t) {
+            distribution.push_back(0);
+            for (int k = distribution.size() - 1; k > 0; --k) {
+                distribution[k] = distribution[k] * (1 - origin.probability) + distribution[k - 1] * origin.probability;
+            }
+            distribution[0] *= 1 - origin.probability;
+        }
+    }
+    return distribution;
+}
+
+bool rejected(const char *text) {
+    std::stringstream stream(text);
+    try {
+        CohortRelease::read_csv(stream);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+int main() {
+    const double tolerance = 1e-12; // of the probabilities, which sum to 1
+
+    std::vector<std::vector<CohortRelease::Origin>> cohorts(3);
+    cohorts[0] = {{.002, 400}, {.03, 250}, {.15, 60}, {.0004, 1000}};
+    for (int t = 0; t < 3000; ++t) {
+        cohorts[1].push_back({.5 * (t * 7919 % 3001) / 3001., 1});
+    }
+    cohorts[2] = {{0, 200}, {1, 17}, {.25, 40}, {.6, 1}};
+
+    double largest_difference = 0;
+    int mismatches = 0;
+    for (const std::vector<CohortRelease::Origin> &origins : cohorts) {
+        CohortRelease release(origins);
+        std::vector<double> distribution = direct_distribution(origins);
+        int n = distribution.size() - 1;
+
+        double mean = 0, tail = 1;
+        for (int k = 0; k <= n; ++k) {
+            largest_difference = std::max({largest_difference, std::abs(release.probability(k) - distribution[k]),
+                                           std::abs(release.tail_probability(k) - tail)});
+            mean += k * distribution[k];
+            tail -= distribution[k];
+        }
+        for (double q : {.025, .5, .975}) {
+            int k = 0;
+            double cumulative = distribution[0];
+            while (cumulative < q) {
+                cumulative += distribution[++k];
+            }
+            mismatches += release.quantile(q) != k;
+        }
+        mismatches += release.n_travellers() != n || std::abs(release.mean() - mean) > 1e-9 * std::max(mean, 1.);
+    }
+    check(largest_difference <= tolerance, "the probabilities are those of the direct computation");
+    check(mismatches == 0, "the mean and quantiles are those of the direct computation");
+
+    check(rejected("origin,travellers,probability\nA,10,1.5\n") && rejected("A,10,-0.1\n") && rejected("A,10,nan\n"),
+          "probabilities outside [0, 1] are rejected");
+
+    std::printf("%d checks failed; largest difference to the direct computation %.2g\n", failures, largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+# The release distribution of a cohort against the Poisson-binomial distribution traveller by traveller.
+
+TARGET = cohort_release
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/cohort_release.cpp \
+        cohort_release.cpp
@@ -0,0 +1,125 @@
+/* end_of_strategy.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the evaluations at the end of the strategy against a full run. For a grid of strategies, the
+ * relative risk, risk reductions and probability to be, or yet to become infectious of a Simulation with
+ * end_of_strategy_outputs must equal the last evaluation point of one with all_outputs, up to the rounding of the
+ * jumps from test to test; Simulation::end_of_strategy in a reused workspace must give exactly the values of the
+ * Simulation with end_of_strategy_outputs; and the outputs that need the states without intervention must throw.
+ */
+
+#include "include/core/simulation.h"
+#include "tests/check.h"
+#include "tests/fixtures.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-4f;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<StrategyParameters> strategies{};
+    for (int mode = 0; mode < 2; ++mode) {
+        for (int delay : {0, 3}) {
+            for (int duration : {0, 1, 6, 14}) {
+                for (int schedule = 0; schedule < 4; ++schedule) {
+                    StrategyParameters strategy;
+                    strategy.mode = mode;
+                    strategy.time_delay = delay;
+                    strategy.end_of_strategy = duration;
+                    strategy.symptomatic_screening = schedule % 2;
+                    strategy.expected_adherence = schedule < 2 ? 1 : .8f;
+                    // none, the last day, the first and last day as RDT, and every other day of mixed types
+                    for (int day = 0; day <= duration; ++day) {
+                        bool test = (schedule == 1 && day == duration) ||
+                                    (schedule == 2 && (day == 0 || day == duration)) || (schedule == 3 && day % 2);
+                        if (test) {
+                            strategy.test_moments.push_back(delay + day);
+                            strategy.test_types.push_back(schedule == 2 ? 1 : day % 4 == 1);
+                        }
+                    }
+                    strategies.push_back(strategy);
+                }
+            }
+        }
+    }
+
+    float largest_difference = 0;
+    int mismatches = 0, workspace_mismatches = 0, unthrown = 0;
+    Simulation::Workspace workspace;
+    for (int i = 0; i < (int)strategies.size(); ++i) {
+        const StrategyParameters &strategy = strategies[i];
+        Simulation full(parameters, strategy);
+        Simulation end(parameters, strategy, Eigen::VectorXf(), Simulation::end_of_strategy_outputs);
+
+        Eigen::MatrixXf relative_risk = end.relative_risk();
+        bool passed = relative_risk.rows() == 1;
+        if (passed) {
+            float difference =
+                std::max({relative_difference(full.relative_risk().bottomRows(1), relative_risk),
+                          relative_difference(full.risk_reduction().bottomRows(1), end.risk_reduction()),
+                          relative_difference(full.fold_risk_reduction().bottomRows(1), end.fold_risk_reduction()),
+                          relative_difference(full.get_p_infectious_tend(), end.get_p_infectious_tend())});
+            largest_difference = std::max(largest_difference, difference);
+            passed = difference <= tolerance;
+        }
+        mismatches += !passed;
+
+        const Simulation::EndOfStrategy &outputs = Simulation::end_of_strategy(parameters, strategy, workspace);
+        bool same = relative_risk.rows() == 1 && outputs.relative_risk == relative_risk.row(0).transpose() &&
+                    outputs.risk_reduction == end.risk_reduction().row(0).transpose() &&
+                    outputs.fold_risk_reduction == end.fold_risk_reduction().row(0).transpose() &&
+                    outputs.p_infectious_tend == end.get_p_infectious_tend();
+        workspace_mismatches += !same;
+
+        int thrown = 0;
+        for (int type = 0; type < 2; ++type) {
+            try {
+                end.temporal_assay_sensitivity(type);
+            } catch (const std::logic_error &) {
+                ++thrown;
+            }
+            try {
+                end.test_efficacy(type);
+            } catch (const std::logic_error &) {
+                ++thrown;
+            }
+        }
+        try {
+            end.results();
+        } catch (const std::logic_error &) {
+            ++thrown;
+        }
+        unthrown += thrown != 5;
+
+        if (!passed || !same || thrown != 5) {
+            std::printf("strategy %d (mode %d, delay %d, duration %d, %d tests) differs\n", i, strategy.mode,
+                        strategy.time_delay, strategy.end_of_strategy, (int)strategy.test_moments.size());
+        }
+    }
+    check(mismatches == 0, "the end of the strategy is the last evaluation point of the full run");
+    check(workspace_mismatches == 0, "end_of_strategy in a reused workspace gives the values of the Simulation");
+    check(unthrown == 0, "the outputs that need the states without intervention throw");
+
+    std::printf("%d checks failed; %d strategies, largest relative difference to the full run %.2g\n", failures,
+                (int)strategies.size(), largest_difference);
+    return failures ? 1 : 0;
+}
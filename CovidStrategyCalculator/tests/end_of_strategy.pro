@@ -0,0 +1,17 @@
+# The evaluations at the end of the strategy against a full run.
+
+TARGET = end_of_strategy
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        end_of_strategy.cpp
@@ -0,0 +1,97 @@
+/* ensemble.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the sampling of an Ensemble against the Simulation of each sampled parameter set. The relative
+ * risk of the ensemble for a parameter set must be the typical case of a Simulation with these parameters, and the
+ * samples of Ensemble::sample_relative_risk those of the points of the sequence, evaluated one by one. The first 2^m
+ * points of the scrambled Sobol sequence must lie in the unit hypercube with one point in each of the 2^m intervals
+ * of every dimension, and the quantile bands must interpolate between the order statistics.
+ */
+
+#include "include/core/ensemble.h"
+#include "include/core/simulation.h"
+#include "include/core/sobol_sequence.h"
+#include "tests/check.h"
+#include "tests/fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-4f;
+    const int n_samples = 32;
+    const uint32_t seed = 7;
+
+    ParameterSpace space(Parameters::default_values);
+    std::vector<StrategyParameters> strategies(3);
+    strategies[1].mode = 1;
+    strategies[1].time_delay = 2;
+    strategies[1].end_of_strategy = 7;
+    strategies[1].test_moments = {5, 9};
+    strategies[2].end_of_strategy = 14;
+    strategies[2].test_moments = {3, 10};
+    strategies[2].test_types = {1, 0};
+    strategies[2].expected_adherence = .7f;
+
+    float largest_difference = 0;
+    for (const StrategyParameters &strategy : strategies) {
+        Ensemble ensemble(space, strategy);
+        Eigen::MatrixXf samples = ensemble.sample_relative_risk(Ensemble::sobol, 5, n_samples, seed);
+        SobolSequence sequence(space.dimensions(), seed);
+        for (int i = 0; i < n_samples; ++i) {
+            DiseaseParameters parameters = space.parameters_at(sequence.point(5 + i));
+            Simulation simulation(parameters, strategy);
+            Eigen::VectorXf relative_risk = ensemble.relative_risk(parameters);
+            largest_difference =
+                std::max({largest_difference, relative_difference(simulation.relative_risk().col(0), relative_risk),
+                          relative_difference(relative_risk, samples.col(i))});
+        }
+    }
+    check(largest_difference <= tolerance, "the ensemble evaluates the typical case of the Simulation of each sample");
+
+    // stratification of the first 2^m points in every dimension
+    for (int m : {4, 8}) {
+        Eigen::MatrixXd points = SobolSequence(space.dimensions(), seed).points(0, 1 << m);
+        bool stratified = points.minCoeff() >= 0 && points.maxCoeff() < 1;
+        for (int d = 0; stratified && d < points.rows(); ++d) {
+            std::vector<int> intervals((1 << m), 0);
+            for (int i = 0; i < points.cols(); ++i) {
+                ++intervals[int(points(d, i) * (1 << m))];
+            }
+            stratified = *std::min_element(intervals.begin(), intervals.end()) == 1;
+        }
+        char what[80];
+        std::snprintf(what, sizeof(what), "the first %d Sobol points have one point in every interval", 1 << m);
+        check(stratified, what);
+    }
+
+    // samples 0, 1, ..., 100 in reverse order
+    Eigen::MatrixXf samples(1, 101);
+    for (int i = 0; i <= 100; ++i) {
+        samples(0, i) = 100 - i;
+    }
+    Eigen::MatrixXf bands = Ensemble::quantile_bands(samples, .95f);
+    check(std::abs(bands(0, 0) - 50) < 1e-4f && std::abs(bands(0, 1) - 2.5f) < 1e-4f &&
+              std::abs(bands(0, 2) - 97.5f) < 1e-4f,
+          "the quantile bands interpolate between the order statistics");
+
+    std::printf("%d checks failed; largest relative difference to the Simulation %.2g\n", failures, largest_difference);
+    return failures ? 1 : 0;
+}
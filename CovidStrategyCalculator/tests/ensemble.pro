@@ -0,0 +1,20 @@
+# The sampling of an ensemble against the simulation of each sampled parameter set.
+
+TARGET = ensemble
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/ensemble.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameter_space.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/sobol_sequence.cpp \
+        ensemble.cpp
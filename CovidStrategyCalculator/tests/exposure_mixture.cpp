@@ -0,0 +1,84 @@
+/* exposure_mixture.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks an ExposureMixture against the weighted average of a Simulation per exposure day. For strategies
+ * with PCR, RDT and mixed tests, with and without symptomatic screening and at lower adherence, the relative risk at
+ * every evaluation point of the strategy and the temporal assay sensitivity on every day of the strategy must be the
+ * average of those of the Simulations whose time delay is the exposure day, weighted by its probability.
+ */
+
+#include "include/core/exposure_mixture.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-5f;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<StrategyParameters> strategies(3);
+    strategies[0].end_of_strategy = 10;
+    strategies[0].test_moments = {5};
+    strategies[1].end_of_strategy = 7;
+    strategies[1].test_moments = {1, 4};
+    strategies[1].test_types = {1, 0};
+    strategies[1].expected_adherence = .8f;
+    strategies[2].end_of_strategy = 14;
+    strategies[2].test_moments = {0, 3, 6};
+    strategies[2].test_type = 1;
+    strategies[2].symptomatic_screening = false;
+    std::vector<float> weights{1, 3, 4, 3, 2, 1, 0, 1};
+
+    float largest_risk_difference = 0, largest_sensitivity_difference = 0;
+    for (const StrategyParameters &strategy : strategies) {
+        ExposureMixture mixture(parameters, strategy, weights);
+        Eigen::MatrixXf relative_risk = mixture.relative_risk();
+        Eigen::MatrixXf sensitivity = mixture.temporal_assay_sensitivity();
+
+        // the Simulation of each exposure day, with the tests on the same days of the strategy
+        Eigen::MatrixXf weighted_risk = Eigen::MatrixXf::Zero(relative_risk.rows(), 3);
+        Eigen::MatrixXf weighted_sensitivity = Eigen::MatrixXf::Zero(strategy.end_of_strategy + 1, 3);
+        for (int d = 0; d < (int)weights.size(); ++d) {
+            StrategyParameters exposed = strategy;
+            exposed.time_delay = d;
+            for (int &t : exposed.test_moments) {
+                t += d;
+            }
+            Simulation simulation(parameters, exposed);
+            float weight = mixture.offset_weights()(d);
+            weighted_risk += weight * simulation.relative_risk().bottomRows(relative_risk.rows());
+            weighted_sensitivity +=
+                weight * simulation.temporal_assay_sensitivity().middleRows(d, strategy.end_of_strategy + 1);
+        }
+        largest_risk_difference =
+            std::max(largest_risk_difference, (relative_risk - weighted_risk).cwiseAbs().maxCoeff());
+        largest_sensitivity_difference =
+            std::max(largest_sensitivity_difference,
+                     (sensitivity.topRows(strategy.end_of_strategy + 1) - weighted_sensitivity).cwiseAbs().maxCoeff());
+    }
+    check(largest_risk_difference <= tolerance, "the relative risk is the weighted average over the exposure days");
+    check(largest_sensitivity_difference <= tolerance,
+          "the assay sensitivity is the weighted average over the exposure days");
+
+    std::printf("%d checks failed; largest difference to the weighted Simulations %.2g (relative risk), %.2g (assay "
+                "sensitivity)\n",
+                failures, largest_risk_difference, largest_sensitivity_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+# Contact management over a distribution of exposure days against the weighted simulations of each exposure day.
+
+TARGET = exposure_mixture
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/exposure_mixture.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        exposure_mixture.cpp
@@ -0,0 +1,53 @@
+/* fixtures.h
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file defines the strategies and comparisons that several of the tests share: strategy, which builds the
+ * StrategyParameters of a schedule, and relative_difference, which compares the results of two paths.
+ */
+
+#pragma once
+
+#include "include/core/parameters.h"
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+/* The strategy of the given mode with tests on the given days, counted from the start of the strategy, i.e. after
+ * the time delay, and of the given types.
+ */
+inline StrategyParameters strategy(int mode, int delay, int duration, const std::vector<int> &days,
+                                   const std::vector<int> &types, float adherence,
+                                   bool symptomatic_screening = true) {
+    StrategyParameters strategy;
+    strategy.mode = mode;
+    strategy.time_delay = delay;
+    strategy.end_of_strategy = duration;
+    strategy.expected_adherence = adherence;
+    strategy.symptomatic_screening = symptomatic_screening;
+    for (int day : days) {
+        strategy.test_moments.push_back(delay + day);
+    }
+    strategy.test_types = types;
+    return strategy;
+}
+
+// largest difference relative to the magnitude of the values of a, at least floor
+inline float relative_difference(const Eigen::MatrixXf &a, const Eigen::MatrixXf &b, float floor = 1e-3f) {
+    return ((a - b).array().abs() / a.array().abs().max(floor)).maxCoeff();
+}
@@ -0,0 +1,140 @@
+/* incidence_file.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the in-place parsing of an IncidenceFile against the values of its text. A file sorted by region,
+ * with reports out of order within a region, days without report, line breaks of both kinds and numbers with
+ * decimals and exponents, must give per region the incidence that the text gives with std::strtod, on the day of
+ * each report; the same as RegionalPrevalence::read_csv reads from a stream. Lines of a region that reappears and
+ * malformed lines must be rejected.
+ */
+
+#include "include/core/incidence_file.h"
+#include "tests/check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string path = "incidence_file_test.csv";
+
+// ISO date of a day since 1970-01-01; civil from days, H. Hinnant
+std::string date(int days) {
+    days += 719468;
+    int era = days / 146097;
+    int day_of_era = days - era * 146097;
+    int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int mp = (5 * day_of_year + 2) / 153;
+    int day = day_of_year - (153 * mp + 2) / 5 + 1;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    char text[16];
+    std::snprintf(text, sizeof(text), "%04d-%02d-%02d", era * 400 + year_of_era + (month <= 2), month, day);
+    return text;
+}
+
+bool same(const RegionalPrevalence::Region &a, const RegionalPrevalence::Region &b) {
+    bool equal = a.name == b.name && a.date == b.date && a.daily_incidence.size() == b.daily_incidence.size();
+    for (size_t i = 0; equal && i < a.daily_incidence.size(); ++i) {
+        equal = std::abs(a.daily_incidence[i] - b.daily_incidence[i]) <= 1e-6f * b.daily_incidence[i];
+    }
+    return equal;
+}
+
+// whether reading the file region by region throws a std::runtime_error
+bool rejected(const std::string &text) {
+    std::ofstream(path, std::ios::binary) << text;
+    try {
+        IncidenceFile file(path);
+        RegionalPrevalence::Region region;
+        while (file.next(region)) {
+        }
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+int main() {
+    const int n_regions = 40;
+    const int last_day = 18961; // 2021-11-30
+
+    // the text of the file, and the incidence of each region from the values of its text
+    std::string text = "region,date,cases,population,detection_rate\n";
+    std::vector<RegionalPrevalence::Region> expected(n_regions);
+    const char *rates[] = {"0.4", "1", "3.5e-1", "0.625", "25E-2"};
+    for (int r = 0; r < n_regions; ++r) {
+        int n_days = 1 + (r * 37) % 90;
+        int first_day = last_day - (r % 5) - n_days + 1;
+        expected[r].name = "R-" + std::to_string(r);
+        expected[r].date = date(first_day + n_days - 1);
+        expected[r].daily_incidence.assign(n_days, 0);
+        for (int i = 0; i < n_days; ++i) {
+            int day = i % 2 ? first_day + n_days - 1 - i / 2 : first_day + i / 2; // from both ends
+            if ((day + r) % 11 == 3 && day != first_day && day != first_day + n_days - 1) {
+                continue; // no report, within the history
+            }
+            std::string cases = std::to_string((day * 13 + r) % 500) + (r % 2 ? ".5" : "");
+            std::string population = std::to_string(10000 + 1000 * r);
+            std::string rate = rates[(day + r) % 5];
+            text += expected[r].name + "," + date(day) + "," + cases + "," + population + "," + rate +
+                    (r % 3 ? "\n" : "\r\n");
+            double value = std::strtod(cases.c_str(), nullptr) /
+                           (std::strtod(population.c_str(), nullptr) * std::strtod(rate.c_str(), nullptr));
+            expected[r].daily_incidence[first_day + n_days - 1 - day] = value;
+        }
+    }
+    std::ofstream(path, std::ios::binary) << text;
+
+    int n_read = 0, mismatches = 0;
+    {
+        IncidenceFile file(path);
+        RegionalPrevalence::Region region;
+        for (; file.next(region); ++n_read) {
+            mismatches += n_read >= n_regions || !same(region, expected[n_read]);
+        }
+    }
+    check(n_read == n_regions && mismatches == 0, "the mapped file gives the incidence of the values of its text");
+
+    std::stringstream stream(text);
+    std::vector<RegionalPrevalence::Region> streamed = RegionalPrevalence::read_csv(stream);
+    mismatches = streamed.size() != expected.size();
+    for (int r = 0; !mismatches && r < n_regions; ++r) {
+        mismatches += !same(streamed[r], expected[r]);
+    }
+    check(mismatches == 0, "the stream reader gives the same regions");
+
+    check(rejected("A,2021-11-29,1,100,1\nB,2021-11-29,1,100,1\nA,2021-11-30,1,100,1\n"),
+          "a region whose lines are not contiguous is rejected");
+    check(rejected("A,2021-11-29,1,100,1\nA,2021-11-30,1,,1\n"), "a line without population is rejected");
+    check(rejected("A,2021-13-01,1,100,1\n") && rejected("A,2021-02-29,1,100,1\n") &&
+              rejected("A,2021-04-31,1,100,1\n") && rejected("A,1900-02-29,1,100,1\n"),
+          "a line with an invalid date is rejected");
+    check(!rejected("A,2020-02-29,1,100,1\n") && !rejected("A,2000-02-29,1,100,1\n"),
+          "the 29th of February of a leap year is accepted");
+    std::remove(path.c_str());
+
+    std::printf("%d checks failed; %d regions, %d bytes\n", failures, n_regions, (int)text.size());
+    return failures ? 1 : 0;
+}
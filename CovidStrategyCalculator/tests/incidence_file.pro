@@ -0,0 +1,21 @@
+# Incidence files parsed in place against the values of their text.
+
+TARGET = incidence_file
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/incidence_file.cpp \
+        ../src/core/mapped_file.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/regional_prevalence.cpp \
+        ../src/core/simulation.cpp \
+        incidence_file.cpp
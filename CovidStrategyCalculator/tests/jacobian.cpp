@@ -0,0 +1,111 @@
+/* jacobian.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the forward-mode derivatives of Simulation::relative_risk_jacobian against central differences of
+ * the relative risk of two Simulations, one on either side of each disease parameter, or one-sided differences where a
+ * probability is too close to 1 for a step above it. For strategies of both modes, with PCR, RDT and mixed tests, with
+ * and without symptomatic screening and at lower adherence, every column must agree at every evaluation point within
+ * the error of the differences.
+ */
+
+#include "include/core/simulation.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+// the disease parameter of a column of the Jacobian
+float &parameter(DiseaseParameters &parameters, int column) {
+    switch (column) {
+    case 4:
+        return parameters.fraction_asymptomatic;
+    case 5:
+        return parameters.pcr_sens;
+    case 6:
+        return parameters.rdt_relative_sens;
+    case 7:
+        return parameters.test_specificity;
+    default:
+        return parameters.tau_mean_case[column];
+    }
+}
+} // namespace
+
+int main() {
+    const float tolerance = 3e-3f; // relative to the largest derivative of the column; the differences are of floats
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<StrategyParameters> strategies(4);
+    strategies[0].test_moments = {5};
+    strategies[1].test_moments = {3, 7};
+    strategies[1].test_types = {1, 0};
+    strategies[1].expected_adherence = .8f;
+    strategies[2].mode = 1;
+    strategies[2].time_delay = 1;
+    strategies[2].end_of_strategy = 6;
+    strategies[2].test_moments = {4};
+    strategies[2].test_type = 1;
+    strategies[3] = strategies[1];
+    strategies[3].symptomatic_screening = false;
+
+    float largest_difference = 0;
+    int mismatches = 0;
+    for (const StrategyParameters &strategy : strategies) {
+        Simulation simulation(parameters, strategy);
+        Eigen::MatrixXf jacobian = simulation.relative_risk_jacobian();
+        for (int column = 0; column < 8; ++column) {
+            /* central differences, or one-sided differences of second order where the step would leave [0, 1]:
+             * the probabilities of columns 4 to 7 and the specificity in particular, which is close to 1
+             */
+            float value = parameter(parameters, column);
+            float step = 1e-2f * value;
+            Eigen::VectorXf difference;
+            if (column < 4 || value + step <= 1) {
+                DiseaseParameters lower = parameters, upper = parameters;
+                parameter(lower, column) -= step;
+                parameter(upper, column) += step;
+                difference = (Simulation(upper, strategy).relative_risk().col(0) -
+                              Simulation(lower, strategy).relative_risk().col(0)) /
+                             (2 * step);
+            } else {
+                DiseaseParameters lower = parameters, lowest = parameters;
+                parameter(lower, column) -= step;
+                parameter(lowest, column) -= 2 * step;
+                difference = (3 * simulation.relative_risk().col(0) -
+                              4 * Simulation(lower, strategy).relative_risk().col(0) +
+                              Simulation(lowest, strategy).relative_risk().col(0)) /
+                             (2 * step);
+            }
+            float scale = std::max(jacobian.col(column).cwiseAbs().maxCoeff(), 1e-3f);
+            float relative_difference = (jacobian.col(column) - difference).cwiseAbs().maxCoeff() / scale;
+            largest_difference = std::max(largest_difference, relative_difference);
+            if (!(relative_difference <= tolerance)) {
+                std::printf("strategy of mode %d with %d tests, column %d: difference %.2g\n", strategy.mode,
+                            (int)strategy.test_moments.size(), column, relative_difference);
+                ++mismatches;
+            }
+        }
+    }
+    check(mismatches == 0, "the Jacobian agrees with central differences of the relative risk");
+
+    std::printf("%d checks failed; largest difference to central differences %.2g\n", failures, largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+/* mixed_schedule.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks schedules that mix test types against models of a single test type. A strategy whose test types
+ * are all the same must give the same states and relative risk as the strategy of that test type, bit for bit. The
+ * states of a Model with a mixed schedule must be those of a chain of single-type models, one per test, each started
+ * from the states after the previous test.
+ */
+
+#include "include/core/simulation.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+// the states of a mixed schedule, run as a chain of models of a single test type
+Eigen::MatrixXf chained_states(const std::vector<float> &tau, float risk_posing_fraction, Eigen::VectorXf x,
+                               int t_end, const std::vector<int> &days, const std::vector<int> &types,
+                               const std::vector<float> &sensitivity, float specificity) {
+    Eigen::MatrixXf states(t_end + days.size() + 1, Model::n_compartments);
+    int row = 0, previous = 0;
+    for (int i = 0; i < (int)days.size(); ++i) {
+        int t = days[i] - previous;
+        Model single(tau, risk_posing_fraction, x, t, {t}, types[i], sensitivity[types[i]], specificity);
+        Eigen::MatrixXf segment = single.run();
+        states.middleRows(row, t + 1) = segment.topRows(t + 1);
+        x = segment.row(t + 1).transpose(); // the states after the test
+        row += t + 1;
+        previous = days[i];
+    }
+    Model tail(tau, risk_posing_fraction, x, t_end - previous, {}, 0, sensitivity[0], specificity);
+    states.bottomRows(t_end - previous + 1) = tail.run();
+    return states;
+}
+} // namespace
+
+int main() {
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    // strategies of one test type, with the type given per test moment or for the whole schedule
+    int mismatches = 0;
+    for (int mode = 0; mode < 2; ++mode) {
+        for (int type = 0; type < 2; ++type) {
+            StrategyParameters strategy;
+            strategy.mode = mode;
+            strategy.time_delay = 2 * mode;
+            strategy.end_of_strategy = 10;
+            strategy.test_moments = {3, 6, 8};
+            strategy.test_type = type;
+            strategy.expected_adherence = .9f;
+            StrategyParameters per_moment = strategy;
+            per_moment.test_type = 1 - type;
+            per_moment.test_types.assign(strategy.test_moments.size(), type);
+
+            Simulation single(parameters, strategy), mixed(parameters, per_moment);
+            bool identical = single.relative_risk() == mixed.relative_risk() &&
+                             single.test_efficacy(type) == mixed.test_efficacy(type);
+            for (int scenario = 0; scenario < 3; ++scenario) {
+                identical = identical && single.get_strategy_states(scenario) == mixed.get_strategy_states(scenario);
+            }
+            mismatches += !identical;
+        }
+    }
+    check(mismatches == 0, "a schedule of one type per moment gives the results of its test type bit for bit");
+
+    // mixed schedules against chains of single-type models
+    std::vector<float> sensitivity{parameters.pcr_sens, 1.3f * parameters.rdt_relative_sens * parameters.pcr_sens};
+    std::vector<std::vector<int>> schedules{{1, 0}, {0, 1, 1}, {1, 0, 1, 0}};
+    std::vector<std::vector<int>> days{{3, 7}, {0, 4, 9}, {2, 3, 5, 11}};
+    float largest_difference = 0;
+    for (float risk_posing_fraction : {1.f, parameters.fraction_asymptomatic}) {
+        for (int s = 0; s < (int)schedules.size(); ++s) {
+            for (int initial : {0, Model::sub_compartments[0] + Model::sub_compartments[1]}) {
+                Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+                X0(initial) = 1;
+                const int t_end = 14;
+                Model mixed(parameters.tau_mean_case, risk_posing_fraction, X0, t_end, days[s], schedules[s],
+                            sensitivity, parameters.test_specificity);
+                Eigen::MatrixXf chained = chained_states(parameters.tau_mean_case, risk_posing_fraction, X0, t_end,
+                                                         days[s], schedules[s], sensitivity,
+                                                         parameters.test_specificity);
+                largest_difference = std::max(largest_difference, (mixed.run() - chained).cwiseAbs().maxCoeff());
+            }
+        }
+    }
+    check(largest_difference <= 1e-6f, "the states of a mixed schedule are those of single-type models in turn");
+
+    std::printf("%d checks failed; largest difference to the chained single-type models %.2g\n", failures,
+                largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/* parameter_index.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the round trip of a ParameterIndex: the keys of a grid of strategies, with PCR, RDT and mixed test
+ * schedules, are written to a ResultStore in an order unlike that of the index, and the index built from the store
+ * must find the row of every strategy, select the rows within a range of keys and find the nearest strategy of one
+ * that is not in the grid. Schedules that mix the test types on the same days must have keys, and rows, of their own.
+ */
+
+#include "include/core/parameter_index.h"
+#include "tests/check.h"
+#include "tests/fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string path = "parameter_index_test.store";
+
+bool operator==(const ParameterIndex::Key &a, const ParameterIndex::Key &b) {
+    return a.mode == b.mode && a.symptomatic_screening == b.symptomatic_screening && a.time_delay == b.time_delay &&
+           a.end_of_strategy == b.end_of_strategy && a.test_days == b.test_days && a.rdt_days == b.rdt_days &&
+           a.test_type == b.test_type && a.adherence == b.adherence;
+}
+} // namespace
+
+int main() {
+    // no tests, one and two tests of either type, and the two schedules that mix them on the same days
+    const std::vector<std::pair<std::vector<int>, std::vector<int>>> schedules{
+        {{}, {}},         {{3}, {0}},       {{3}, {1}},       {{1, 4}, {0, 0}},
+        {{1, 4}, {1, 1}}, {{1, 4}, {0, 1}}, {{1, 4}, {1, 0}}};
+    std::vector<StrategyParameters> strategies{};
+    for (int mode = 0; mode < 2; ++mode) {
+        for (int delay : {0, 2}) {
+            for (int duration : {5, 10}) {
+                for (const auto &[days, types] : schedules) {
+                    for (float adherence : {1.f, .9f, .8f}) {
+                        strategies.push_back(strategy(mode, delay, duration, days, types, adherence));
+                    }
+                }
+            }
+        }
+    }
+    const int64_t n = strategies.size();
+
+    {
+        // row r holds strategy n - 1 - r, and its number as an output
+        std::vector<ResultStore::Column> columns{};
+        for (const std::string &name : ParameterIndex::columns) {
+            ResultStore::Type type = name == "test_days" || name == "rdt_days" ? ResultStore::int64
+                                     : name == "adherence" ? ResultStore::float32
+                                                           : ResultStore::int32;
+            columns.push_back({name, type, ResultStore::parameter});
+        }
+        columns.push_back({"strategy", ResultStore::int32, ResultStore::output});
+        ResultStore::Writer writer(path, columns, n);
+        Eigen::MatrixXd rows(n, columns.size());
+        for (int64_t i = 0; i < n; ++i) {
+            ParameterIndex::Key key = ParameterIndex::key(strategies[i]);
+            rows.row(n - 1 - i) << key.mode, key.symptomatic_screening, key.time_delay, key.end_of_strategy,
+                double(key.test_days), double(key.rdt_days), key.test_type, key.adherence, double(i);
+        }
+        writer.write(0, rows);
+    }
+    ResultStore store(path);
+    ParameterIndex::build(store, ParameterIndex::path(path));
+    ParameterIndex index(ParameterIndex::path(path));
+    check(index.size() == n && index.n_store_rows() == n, "the index holds every row of the store");
+
+    int column = store.column_index("strategy");
+    int64_t missing = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        int64_t row = index.find(ParameterIndex::key(strategies[i]));
+        missing += row < 0 || store.value(row, column) != i;
+    }
+    check(missing == 0, "every strategy is found in its row");
+
+    ParameterIndex::Key pcr_rdt = ParameterIndex::key(strategy(0, 0, 5, {1, 4}, {0, 1}, 1));
+    ParameterIndex::Key rdt_pcr = ParameterIndex::key(strategy(0, 0, 5, {1, 4}, {1, 0}, 1));
+    check(pcr_rdt.test_days == rdt_pcr.test_days && pcr_rdt.test_type == -1 && rdt_pcr.test_type == -1 &&
+              !(pcr_rdt == rdt_pcr) && index.find(pcr_rdt) != index.find(rdt_pcr),
+          "mixed schedules on the same days have keys and rows of their own");
+    check(index.find(ParameterIndex::key(strategy(0, 0, 7, {3}, {0}, 1))) == -1,
+          "a strategy that is not in the grid is not found");
+
+    // mode 1 with screening, delay 2, any duration and adherence, tests on days 1 and 4 of any type, then RDTs only
+    ParameterIndex::Key lower{1, 1, 2, 0, 0b10010, 0, -1, 0};
+    ParameterIndex::Key upper{1, 1, 2, 100, 0b10010, ~uint64_t(0), 1, 1};
+    std::vector<int64_t> rows = index.range(lower, upper);
+    int64_t outside = 0;
+    for (int64_t row : rows) {
+        const StrategyParameters &s = strategies[int64_t(store.value(row, column))];
+        outside += s.mode != 1 || s.time_delay != 2 || s.test_moments != std::vector<int>{3, 6};
+    }
+    check(rows.size() == 4 * 2 * 3 && outside == 0, "a range selects the rows within its bounds");
+    lower.rdt_days = upper.rdt_days = 0b10010;
+    rows = index.range(lower, upper);
+    outside = 0;
+    for (int64_t row : rows) {
+        const StrategyParameters &s = strategies[int64_t(store.value(row, column))];
+        outside += s.test_moments != std::vector<int>{3, 6} || s.test_types != std::vector<int>{1, 1};
+    }
+    check(rows.size() == 2 * 3 && outside == 0, "equal bounds on the RDT days select one schedule");
+
+    float distance;
+    int64_t row = index.nearest(ParameterIndex::key(strategy(1, 2, 10, {1, 4}, {0, 1}, .85f)), &distance);
+    const StrategyParameters &nearest = strategies[int64_t(store.value(row, column))];
+    check(std::abs(distance - .5f) < 1e-4f && nearest.end_of_strategy == 10 && nearest.test_types[0] == 0 &&
+              nearest.test_types[1] == 1,
+          "the nearest strategy differs in adherence only");
+    row = index.nearest(ParameterIndex::key(strategy(0, 0, 6, {1, 4}, {1, 0}, 1)), &distance);
+    check(row >= 0 && distance == 1 && strategies[int64_t(store.value(row, column))].test_types[0] == 1,
+          "the nearest strategy keeps the schedule of mixed tests");
+
+    std::remove(ParameterIndex::path(path).c_str());
+    std::remove(path.c_str());
+    std::printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+# The round trip of a parameter index built from a result store, with mixed test schedules.
+
+TARGET = parameter_index
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/mapped_file.cpp \
+        ../src/core/parameter_index.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/result_store.cpp \
+        parameter_index.cpp
@@ -0,0 +1,119 @@
+/* prevalence_estimator.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the convolution of the PrevalenceEstimator against running the model for the reports. For five
+ * weeks of weekly incidence, the states of every scenario must be those of the estimator before the convolution,
+ * which ran one model per week and summed the states of its last seven days. For daily incidence of any length,
+ * they must be the sum of the states of one model run per reported day; also when the cached impulse response is
+ * extended by a longer history.
+ */
+
+#include "include/core/prevalence_estimator.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+namespace {
+// infections reported on one day, distributed over the phases by the typical residence times
+Eigen::VectorXf reported_states(const DiseaseParameters &parameters, float incidence) {
+    const std::vector<float> &tau = parameters.tau_mean_case;
+    float total_tau = std::accumulate(tau.begin(), tau.end(), 0);
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    int counter = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < Model::sub_compartments[i]; ++j) {
+            X0(counter++) = tau[i] / total_tau * incidence / Model::sub_compartments[i];
+        }
+    }
+    return X0;
+}
+
+// the residence times of the typical (0), best (1) or worst (2) case
+const std::vector<float> &residence_times(const DiseaseParameters &parameters, int scenario) {
+    switch (scenario) {
+    case 1:
+        return parameters.tau_best_case;
+    case 2:
+        return parameters.tau_worst_case;
+    default:
+        return parameters.tau_mean_case;
+    }
+}
+
+// the estimate before the convolution: a model per week, whose states of the last seven days are summed
+Eigen::MatrixXf weekly_models(const DiseaseParameters &parameters, const std::vector<float> &weekly_incidence) {
+    Eigen::MatrixXf states = Eigen::MatrixXf::Zero(Model::n_compartments, 3);
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        for (int week = 0; week < 5; ++week) {
+            Eigen::VectorXf X0 = reported_states(parameters, weekly_incidence[week] / 7);
+            Model model(residence_times(parameters, scenario), X0, (week + 1) * 7 - 1);
+            states.col(scenario) += model.run_no_test().bottomRows(7).colwise().sum().transpose();
+        }
+    }
+    return states;
+}
+
+// one model per reported day, run from the day of the report until today
+Eigen::MatrixXf daily_models(const DiseaseParameters &parameters, const std::vector<float> &daily_incidence) {
+    Eigen::MatrixXf states = Eigen::MatrixXf::Zero(Model::n_compartments, 3);
+    for (int scenario = 0; scenario < 3; ++scenario) {
+        for (int day = 0; day < (int)daily_incidence.size(); ++day) {
+            Model model(residence_times(parameters, scenario), reported_states(parameters, daily_incidence[day]), day);
+            states.col(scenario) += model.run_no_test().bottomRows(1).transpose();
+        }
+    }
+    return states;
+}
+
+// largest difference relative to the total probability of a scenario
+float relative_difference(const Eigen::MatrixXf &a, const Eigen::MatrixXf &b) {
+    return ((a - b).cwiseAbs().colwise().maxCoeff().array() / a.colwise().sum().array()).maxCoeff();
+}
+} // namespace
+
+int main() {
+    const float tolerance = 1e-5f;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    std::vector<float> weekly_incidence{.0031f, .0024f, .0018f, .0022f, .0009f};
+    PrevalenceEstimator weekly(parameters, weekly_incidence);
+    float weekly_difference =
+        relative_difference(weekly_models(parameters, weekly_incidence), weekly.compartment_states());
+    check(weekly_difference <= tolerance, "five weeks of incidence give the states of a model per week");
+
+    // a short history first, such that the longer ones extend the cached responses
+    float daily_difference = 0;
+    for (int n_days : {10, 45, 120}) {
+        std::vector<float> daily_incidence(n_days);
+        for (int day = 0; day < n_days; ++day) {
+            daily_incidence[day] = 1e-4f * (1 + (day * 7919) % 13);
+        }
+        PrevalenceEstimator daily(parameters, daily_incidence, PrevalenceEstimator::daily);
+        daily_difference = std::max(daily_difference, relative_difference(daily_models(parameters, daily_incidence),
+                                                                           daily.compartment_states()));
+    }
+    check(daily_difference <= tolerance, "daily incidence gives the states of a model per reported day");
+
+    std::printf("%d checks failed; largest relative difference to the models per week %.2g and per day %.2g\n",
+                failures, weekly_difference, daily_difference);
+    return failures ? 1 : 0;
+}
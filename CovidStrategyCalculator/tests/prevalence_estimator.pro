@@ -0,0 +1,18 @@
+# The convolution of the prevalence estimator against a model run per reported day.
+
+TARGET = prevalence_estimator
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/simulation.cpp \
+        prevalence_estimator.cpp
@@ -0,0 +1,143 @@
+/* query_service.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the QueryService as a server uses it. A query submitted as a line must be answered with its id and
+ * the values of QueryService::evaluate, as formatted by QueryService::format; malformed lines and incoming travelers
+ * (mode 2) with an error that carries the id; a strategy whose fold risk reduction is infinite with an error rather
+ * than a number JSON cannot hold. A callback that throws must neither keep the other waiters of its evaluation from
+ * their answer nor stop the service. Queries identical to one in flight, apart from their id, must be evaluated once
+ * and each answered with its own id.
+ */
+
+#include "include/core/query_service.h"
+#include "tests/check.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// the answers of the service by the id of their query, as a connection of the QueryServer would receive them
+class Answers {
+    std::mutex mutex_{};
+    std::condition_variable arrived_{};
+    std::map<std::string, std::string> answers_{};
+
+  public:
+    QueryService::Respond respond(const std::string &id) {
+        return [this, id](const std::string &answer) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            answers_[id] = answer;
+            arrived_.notify_all();
+        };
+    }
+
+    // the answer to the query with the id, or "" if none arrives within a few seconds
+    std::string wait(const std::string &id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        arrived_.wait_for(lock, std::chrono::seconds(10), [&]() { return answers_.count(id) > 0; });
+        return answers_.count(id) ? answers_[id] : "";
+    }
+};
+
+// the answer that the service should give to the request
+std::string expected_answer(const std::string &request) {
+    QueryService::Query query;
+    QueryService::parse(request, query);
+    return QueryService::format(query.id, QueryService::evaluate(query));
+}
+
+bool is_error(const std::string &answer, const std::string &id) {
+    return answer.rfind("{\"id\": " + id + ", \"error\": ", 0) == 0;
+}
+} // namespace
+
+int main() {
+    const int n_identical = 16;
+
+    Answers answers;
+    {
+        QueryService service(std::chrono::microseconds(2000), 64);
+
+        const std::string request =
+            R"({"id": 7, "mode": 0, "delay": 2, "duration": 10, "tests": [5], "test_type": "rdt", "adherence": 90})";
+        service.submit(request, answers.respond("7"));
+        check(answers.wait("7") == expected_answer(request), "a query is answered with the values of evaluate");
+
+        service.submit(R"({"id": "line 2", "mode": 0, "duration": )", answers.respond("line 2"));
+        service.submit(R"({"id": 3, "mode": 0, "colour": "red"})", answers.respond("3"));
+        check(is_error(answers.wait("line 2"), "\"line 2\"") && is_error(answers.wait("3"), "3"),
+               "malformed lines are answered with an error and their id");
+
+        service.submit(R"({"id": 4, "mode": 2, "duration": 10})", answers.respond("4"));
+        check(is_error(answers.wait("4"), "4"), "incoming travelers are answered with an error");
+
+        QueryService::Answer infinite{Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(),
+                                      Eigen::Vector3f::Zero()};
+        infinite.fold_risk_reduction(1) = std::numeric_limits<float>::infinity();
+        check(QueryService::format("5", infinite) == R"({"id": 5, "error": "fold_risk_reduction is not finite"})",
+               "a value that is not finite is formatted as an error");
+        service.submit(R"({"id": 5, "mode": 1, "duration": 30})", answers.respond("5"));
+        check(answers.wait("5") == R"({"id": 5, "error": "fold_risk_reduction is not finite"})",
+               "a strategy without residual risk is answered with an error");
+
+        // the first waiter of the evaluation throws from its callback, the second waits for the same evaluation
+        const std::string quarantine = R"({"mode": 0, "delay": 1, "duration": 8, "tests": [6], "id": )";
+        service.submit(quarantine + "10}", [](const std::string &) { throw std::runtime_error("connection closed"); });
+        service.submit(quarantine + "11}", answers.respond("11"));
+        check(answers.wait("11") == expected_answer(quarantine + "11}"),
+               "a callback that throws does not keep the other waiters from their answer");
+        service.submit(quarantine + "12}", answers.respond("12"));
+        check(answers.wait("12") == expected_answer(quarantine + "12}"),
+               "the service answers after a callback has thrown");
+
+        QueryService::Statistics statistics = service.statistics();
+        check(statistics.queries == 8 && statistics.errors == 4, "the queries and errors are counted");
+    }
+
+    // identical queries, apart from their id, submitted while the first one waits for the window of its batch
+    {
+        QueryService service(std::chrono::microseconds(200000), 64);
+        const std::string strategy =
+            R"("mode": 0, "delay": 1, "duration": 7, "tests": [3, 7], "test_types": ["pcr", "rdt"])";
+        for (int i = 0; i < n_identical; ++i) {
+            std::string id = std::to_string(100 + i);
+            service.submit("{\"id\": " + id + ", " + strategy + "}", answers.respond(id));
+        }
+        bool same = true;
+        for (int i = 0; i < n_identical; ++i) {
+            std::string id = std::to_string(100 + i);
+            same = same && answers.wait(id) == expected_answer("{\"id\": " + id + ", " + strategy + "}");
+        }
+        check(same, "every identical query is answered with the same values and its own id");
+
+        QueryService::Statistics statistics = service.statistics();
+        check(statistics.evaluations == 1 && statistics.coalesced == n_identical - 1,
+               "identical queries in flight are evaluated once");
+        std::printf("%d identical queries: %llu evaluation, %llu coalesced\n", n_identical,
+                    (unsigned long long)statistics.evaluations, (unsigned long long)statistics.coalesced);
+    }
+
+    std::printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
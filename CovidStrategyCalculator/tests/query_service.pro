@@ -0,0 +1,19 @@
+# The answers of the query service: round trip, errors, callbacks that throw and identical queries in flight.
+
+TARGET = query_service
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/query_service.cpp \
+        ../src/core/result_cache.cpp \
+        ../src/core/simulation.cpp \
+        query_service.cpp
@@ -0,0 +1,124 @@
+/* regional_prevalence.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the batch estimation of RegionalPrevalence against a PrevalenceEstimator per region. The states
+ * and phase probabilities of regions with histories of different lengths must be those of the estimator of each
+ * region in every scenario, also in the rows that write_csv streams in the order of the regions. A time series read
+ * with read_csv must give the incidence per individual, corrected for detection, on the day of each report.
+ */
+
+#include "include/core/prevalence_estimator.h"
+#include "include/core/regional_prevalence.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-5f; // relative to the total probability of a scenario
+    const int n_regions = 300;     // several blocks of regions
+    const int n_days = 60;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    std::vector<RegionalPrevalence::Region> regions(n_regions);
+    for (int r = 0; r < n_regions; ++r) {
+        regions[r].name = "R" + std::to_string(r);
+        regions[r].date = "2021-11-30";
+        regions[r].daily_incidence.resize(r % 7 == 0 ? n_days : 1 + (r * 37) % n_days);
+        for (int day = 0; day < (int)regions[r].daily_incidence.size(); ++day) {
+            regions[r].daily_incidence[day] = 1e-5f * (1 + (r * 31 + day * 7) % 23);
+        }
+    }
+    RegionalPrevalence regional(parameters, RegionalPrevalence::n_days(regions));
+
+    // the estimator of each region against the batch, per scenario
+    Eigen::MatrixXf incidence = Eigen::MatrixXf::Zero(n_days, n_regions);
+    std::vector<Eigen::MatrixXf> expected_states(n_regions), expected_phases(n_regions); // per region, as estimated
+    for (int r = 0; r < n_regions; ++r) {
+        const std::vector<float> &daily_incidence = regions[r].daily_incidence;
+        incidence.col(r).head(daily_incidence.size()) =
+            Eigen::Map<const Eigen::VectorXf>(daily_incidence.data(), daily_incidence.size());
+        PrevalenceEstimator estimator(parameters, daily_incidence, PrevalenceEstimator::daily);
+        expected_states[r] = estimator.compartment_states();
+        expected_phases[r] = estimator.phase_probabilities();
+    }
+    float largest_difference = 0;
+    for (int s = 0; s < 3; ++s) {
+        Eigen::MatrixXf states = regional.compartment_states(incidence, s);
+        Eigen::MatrixXf phases = RegionalPrevalence::phase_probabilities(states);
+        for (int r = 0; r < n_regions; ++r) {
+            float total = expected_states[r].col(s).sum();
+            largest_difference = std::max({largest_difference,
+                                           (states.col(r) - expected_states[r].col(s)).cwiseAbs().maxCoeff() / total,
+                                           (phases.col(r) - expected_phases[r].col(s)).cwiseAbs().maxCoeff() / total});
+        }
+    }
+    check(largest_difference <= tolerance, "the batch gives the states of the prevalence estimator of each region");
+
+    // the streamed rows, in the order of the regions and scenarios
+    std::stringstream output;
+    regional.write_csv(regions, output);
+    std::string line;
+    std::getline(output, line); // header
+    int rows = 0, mismatches = 0;
+    for (; std::getline(output, line); ++rows) {
+        int r = rows / 3, s = rows % 3;
+        std::stringstream fields(line);
+        std::string name, date, scenario, field;
+        std::getline(fields, name, ',');
+        std::getline(fields, date, ',');
+        std::getline(fields, scenario, ',');
+        bool matches = r < n_regions && name == regions[r].name && date == regions[r].date;
+        for (int phase = 0; matches && phase < 4 && std::getline(fields, field, ','); ++phase) {
+            float expected = expected_phases[r](phase, s);
+            matches = std::abs(std::stof(field) - expected) <= 1e-5f * std::abs(expected) + 1e-12f;
+        }
+        mismatches += !matches;
+    }
+    check(rows == 3 * n_regions && mismatches == 0, "write_csv streams the estimates in the order of the regions");
+
+    // two regions, with a day without report and a report out of order
+    std::stringstream csv("region,date,cases,population,detection_rate\n"
+                          "A,2021-11-28,10,1000,0.5\n"
+                          "A,2021-11-30,30,1000,0.5\n"
+                          "B,2021-11-30,7,7000,1\n"
+                          "A,2021-11-27,4,1000,0.5\n"
+                          "B,2021-11-29,14,7000,1\n");
+    std::vector<RegionalPrevalence::Region> read = RegionalPrevalence::read_csv(csv);
+    std::vector<float> expected_A{.06f, 0, .02f, .008f}, expected_B{.001f, .002f};
+    auto same = [](const std::vector<float> &a, const std::vector<float> &b) {
+        bool equal = a.size() == b.size();
+        for (int i = 0; equal && i < (int)a.size(); ++i) {
+            equal = std::abs(a[i] - b[i]) <= 1e-6f * b[i];
+        }
+        return equal;
+    };
+    check(read.size() == 2 && read[0].name == "A" && read[0].date == "2021-11-30" &&
+              same(read[0].daily_incidence, expected_A) && read[1].name == "B" &&
+              same(read[1].daily_incidence, expected_B),
+          "read_csv gives the corrected incidence per day, most recent first");
+
+    std::printf("%d checks failed; %d regions, largest relative difference to the prevalence estimator %.2g\n",
+                failures, n_regions, largest_difference);
+    return failures ? 1 : 0;
+}
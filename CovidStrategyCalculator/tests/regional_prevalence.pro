@@ -0,0 +1,21 @@
+# The prevalence of many regions at once against the prevalence estimator of each region.
+
+TARGET = regional_prevalence
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/incidence_file.cpp \
+        ../src/core/mapped_file.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/regional_prevalence.cpp \
+        ../src/core/simulation.cpp \
+        regional_prevalence.cpp
@@ -0,0 +1,124 @@
+/* result_cache.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the round trip of a ResultCache: the results of a simulation must be restored exactly, by a lookup
+ * and by a Simulation restored from the cache, also by a cache opened on the same directory later; strategies that
+ * differ only in the order of their test types or in adherence must not share an entry, while the same schedule
+ * given by one test type or per test day must; the inputs must be little-endian; and the least recently used entries
+ * must be evicted once the cache grows beyond its size.
+ */
+
+#include "include/core/result_cache.h"
+#include "tests/check.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace {
+const std::string directory = "result_cache_test";
+
+bool equal(const Simulation::Results &a, const Simulation::Results &b) {
+    bool equal = a.risk_no_intervention == b.risk_no_intervention && a.risk_NPI == b.risk_NPI &&
+                 a.p_infectious_tend == b.p_infectious_tend;
+    for (int type = 0; type < 2; ++type) {
+        equal = equal && a.temporal_assay_sensitivity[type] == b.temporal_assay_sensitivity[type] &&
+                a.test_efficacy[type] == b.test_efficacy[type];
+    }
+    return equal;
+}
+} // namespace
+
+int main() {
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    StrategyParameters strategy;
+    strategy.end_of_strategy = 12;
+    strategy.test_moments = {4, 9};
+    strategy.test_types = {1, 0};
+    strategy.expected_adherence = .8f;
+    std::string inputs = ResultCache::inputs(parameters, strategy);
+
+    ResultCache(directory, 0); // removes the entries of an earlier run
+    {
+        ResultCache cache(directory);
+        std::unique_ptr<Simulation> simulated = cache.simulation(parameters, strategy);
+        Simulation::Results results;
+        check(cache.find(inputs, results) && equal(results, simulated->results()), "the results are stored");
+
+        std::unique_ptr<Simulation> restored = cache.simulation(parameters, strategy);
+        bool same = restored->relative_risk() == simulated->relative_risk() &&
+                    restored->risk_reduction() == simulated->risk_reduction() &&
+                    restored->fold_risk_reduction() == simulated->fold_risk_reduction() &&
+                    restored->get_p_infectious_tend() == simulated->get_p_infectious_tend() &&
+                    restored->evaluation_points_with_tests() == simulated->evaluation_points_with_tests();
+        for (int type = 0; type < 2; ++type) {
+            same = same && restored->temporal_assay_sensitivity(type) == simulated->temporal_assay_sensitivity(type) &&
+                   restored->test_efficacy(type) == simulated->test_efficacy(type);
+        }
+        check(same, "a restored simulation has the outputs of the simulated one");
+
+        StrategyParameters swapped = strategy, adherence = strategy;
+        swapped.test_types = {0, 1};
+        adherence.expected_adherence = .9f;
+        check(!cache.find(ResultCache::inputs(parameters, swapped), results) &&
+                  !cache.find(ResultCache::inputs(parameters, adherence), results),
+              "strategies that differ in the order of test types or in adherence have entries of their own");
+
+        StrategyParameters by_type = strategy, by_day = strategy;
+        by_type.test_type = 1;
+        by_type.test_types.clear();
+        by_day.test_types = {1, 1};
+        check(ResultCache::inputs(parameters, by_type) == ResultCache::inputs(parameters, by_day),
+              "a schedule of one test type shares its entry with the same schedule given per test day");
+        check(inputs.compare(0, 4, std::string("\x02\0\0\0", 4)) == 0, "the inputs are little-endian");
+
+        ResultCache reopened(directory);
+        check(reopened.size() == cache.size() && reopened.size() > 0 && reopened.find(inputs, results) &&
+                  equal(results, simulated->results()),
+              "the entries are found by a cache opened later");
+    }
+
+    {
+        // room for three entries: the first of ten strategies is evicted, the last is kept
+        Simulation::Results results = Simulation(parameters, strategy).results();
+        ResultCache(directory, 0);
+        uint64_t entry_size;
+        {
+            ResultCache cache(directory);
+            cache.insert(inputs, results);
+            entry_size = cache.size();
+        }
+        ResultCache(directory, 0);
+        ResultCache cache(directory, 3 * entry_size);
+        std::string first, last;
+        for (int delay = 0; delay < 10; ++delay) {
+            strategy.time_delay = delay;
+            last = ResultCache::inputs(parameters, strategy);
+            first = delay ? first : last;
+            cache.insert(last, results);
+        }
+        Simulation::Results found;
+        check(cache.size() <= cache.max_size() && !cache.find(first, found) && cache.find(last, found),
+              "the least recently used entries are evicted");
+    }
+
+    ResultCache(directory, 0);
+    std::remove(directory.c_str());
+    std::printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
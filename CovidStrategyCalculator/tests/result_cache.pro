@@ -0,0 +1,18 @@
+# The round trip of simulation results through the result cache, and its eviction.
+
+TARGET = result_cache
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/result_cache.cpp \
+        ../src/core/simulation.cpp \
+        result_cache.cpp
@@ -0,0 +1,149 @@
+/* result_store.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the round trip of a ResultStore: columns of every type and role are written in batches out of
+ * order and appended from several threads, and the store read back must hold the rows written, converted to the type
+ * of their column. While it is written, the number of rows a reader sees must end at the first row not written yet;
+ * after the writer is closed it must end at the last row written, with the rows never written reading as zero.
+ */
+
+#include "include/core/result_store.h"
+#include "tests/check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+const std::string path = "result_store_test.store";
+const int n_columns = 4;
+
+double value(int64_t row, int column) { return row * n_columns + column + .25; }
+
+Eigen::MatrixXd rows(int64_t first_row, int n_rows) {
+    Eigen::MatrixXd rows(n_rows, n_columns);
+    for (int i = 0; i < n_rows; ++i) {
+        for (int c = 0; c < n_columns; ++c) {
+            rows(i, c) = value(first_row + i, c);
+        }
+    }
+    return rows;
+}
+
+// the value in the store, converted to the type of the column
+double expected(int64_t row, int column, ResultStore::Type type) {
+    double v = value(row, column);
+    switch (type) {
+    case ResultStore::int32:
+    case ResultStore::int64:
+        return double(std::llround(v));
+    case ResultStore::float32:
+        return double(float(v));
+    default:
+        return v;
+    }
+}
+
+int64_t published_rows() { return ResultStore(path).n_rows(); }
+} // namespace
+
+int main() {
+    const std::vector<ResultStore::Column> columns{{"mode", ResultStore::int32, ResultStore::parameter},
+                                                   {"test_days", ResultStore::int64, ResultStore::parameter},
+                                                   {"relative_risk", ResultStore::float32, ResultStore::output},
+                                                   {"p_infectious", ResultStore::float64, ResultStore::output}};
+    const int64_t capacity = 1000;
+    const int n_threads = 4, n_appends = 25, batch = 5; // the appends fill rows 100 to 600
+
+    {
+        ResultStore::Writer writer(path, columns, capacity);
+        writer.write(50, rows(50, 50));
+        check(published_rows() == 0, "rows after a gap are not published");
+        writer.write(0, rows(0, 20));
+        check(published_rows() == 20, "the rows up to the gap are published");
+        writer.write(20, rows(20, 30));
+        check(published_rows() == 100, "filling the gap publishes the rows after it");
+
+        std::vector<std::thread> threads{};
+        for (int t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&writer]() {
+                for (int i = 0; i < n_appends; ++i) {
+                    // the rows are only known once they are reserved, so each batch is written where it lands
+                    Eigen::MatrixXd placeholder = Eigen::MatrixXd::Zero(batch, n_columns);
+                    int64_t first_row = writer.append(placeholder);
+                    writer.write(first_row, rows(first_row, batch));
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        check(published_rows() == 100 + n_threads * n_appends * batch, "appended rows follow the rows written");
+
+        writer.write(700, rows(700, 10));
+        check(published_rows() == 600, "a write after a gap leaves the published rows");
+
+        bool thrown = false;
+        try {
+            writer.write(995, rows(995, 10));
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        check(thrown, "rows beyond the capacity are rejected");
+    }
+
+    ResultStore store(path);
+    check(store.n_rows() == 710 && store.capacity() == capacity, "closing publishes the rows up to the last written");
+
+    bool same = store.columns().size() == columns.size();
+    for (int c = 0; same && c < n_columns; ++c) {
+        same = store.columns()[c].name == columns[c].name && store.columns()[c].type == columns[c].type &&
+               store.columns()[c].role == columns[c].role && store.column_index(columns[c].name) == c;
+    }
+    check(same, "the columns are read back");
+
+    int64_t mismatches = 0;
+    for (int64_t row = 0; row < store.n_rows(); ++row) {
+        for (int c = 0; c < n_columns; ++c) {
+            double read = store.value(row, c);
+            mismatches += row < 600 || row >= 700 ? read != expected(row, c, columns[c].type) : read != 0;
+        }
+    }
+    for (int64_t row = 0; row < store.n_rows(); ++row) {
+        mismatches += store.data<int32_t>(0)[row] != store.value(row, 0) ||
+                      store.data<int64_t>(1)[row] != store.value(row, 1) ||
+                      store.data<float>(2)[row] != store.value(row, 2) ||
+                      store.data<double>(3)[row] != store.value(row, 3);
+    }
+    check(mismatches == 0, "the values are read back, converted to their column type");
+
+    bool thrown = false;
+    try {
+        store.data<double>(0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    check(thrown, "a column is not read as another type");
+
+    std::remove(path.c_str());
+    std::printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+# The round trip of a result store written out of order.
+
+TARGET = result_store
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/mapped_file.cpp \
+        ../src/core/result_store.cpp \
+        result_store.cpp
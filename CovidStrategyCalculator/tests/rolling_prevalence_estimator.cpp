@@ -0,0 +1,80 @@
+/* rolling_prevalence_estimator.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the RollingPrevalenceEstimator against the PrevalenceEstimator of the same reports. Starting from
+ * a history, the days are reported incompletely and corrected while they lie in the correction window; every day,
+ * the states of every scenario after advance and correct must be those of a PrevalenceEstimator of the daily
+ * incidence as reported so far. Corrections outside the window must be rejected.
+ */
+
+#include "include/core/prevalence_estimator.h"
+#include "include/core/rolling_prevalence_estimator.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-4f; // relative to the total probability of a scenario; the rolling states accumulate
+    const int window = 7;
+    const int n_days = 150;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    // the final reports; each day is first reported at half, and completed over the days of the window
+    std::vector<float> final_reports(n_days);
+    for (int day = 0; day < n_days; ++day) {
+        final_reports[day] = 1e-4f * (3 + (day * 7919) % 17);
+    }
+    const int n_history = 30;
+    std::vector<float> reported(final_reports.rbegin() + (n_days - n_history), final_reports.rend()); // [day 0, ...]
+    RollingPrevalenceEstimator rolling(parameters, reported, window);
+
+    float largest_difference = 0;
+    for (int day = n_history; day < n_days; ++day) {
+        reported.insert(reported.begin(), final_reports[day] / 2);
+        rolling.advance(reported[0]);
+        for (int days_ago = 1; days_ago < window && days_ago < (int)reported.size(); ++days_ago) {
+            if ((day + days_ago) % 3 == 0 || days_ago == window - 1) {
+                reported[days_ago] = final_reports[day - days_ago] * (days_ago == window - 1 ? 1 : .8f);
+                rolling.correct(days_ago, reported[days_ago]);
+            }
+        }
+        PrevalenceEstimator full(parameters, reported, PrevalenceEstimator::daily);
+        Eigen::MatrixXf states = full.compartment_states();
+        float difference = ((rolling.compartment_states() - states).cwiseAbs().colwise().maxCoeff().array() /
+                            states.colwise().sum().array())
+                               .maxCoeff();
+        largest_difference = std::max(largest_difference, difference);
+    }
+    check(largest_difference <= tolerance, "every day, the states are those of the prevalence estimator");
+
+    bool rejected = false;
+    try {
+        rolling.correct(window, 1e-3f);
+    } catch (const std::out_of_range &) {
+        rejected = true;
+    }
+    check(rejected, "a correction outside the window is rejected");
+
+    std::printf("%d checks failed; %d days, largest relative difference to the prevalence estimator %.2g\n", failures,
+                n_days - n_history, largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+# The rolling prevalence estimator, with late corrections, against the prevalence estimator of the same reports.
+
+TARGET = rolling_prevalence_estimator
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/rolling_prevalence_estimator.cpp \
+        ../src/core/simulation.cpp \
+        rolling_prevalence_estimator.cpp
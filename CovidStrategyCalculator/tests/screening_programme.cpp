@@ -0,0 +1,143 @@
+/* screening_programme.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the periodic screening of a ScreeningProgramme against stepping through the programme day by day.
+ * ScreeningProgramme::power must equal the repeated product of the period operator; the relative risk of programmes
+ * of both modes, with PCR, RDT and mixed schedules, durations that do and do not end with a full period, and lower
+ * adherence must equal that of the states stepped day by day, each test followed by one day of disease progression;
+ * and the steady state must be the relative risk of one infection on each day of the period, followed until its risk
+ * has passed.
+ */
+
+#include "include/core/model.h"
+#include "include/core/screening_programme.h"
+#include "tests/check.h"
+#include "tests/fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+typedef Eigen::Matrix<double, 21, 1> State;
+
+// the residual risk of the typical case stepped day by day, with the tests of the period or without intervention
+double stepped_risk(const DiseaseParameters &parameters, const StrategyParameters &strategy, int period,
+                    bool intervention) {
+    std::vector<float> sensitivity{parameters.pcr_sens,
+                                   float(1.3 * parameters.rdt_relative_sens * parameters.pcr_sens)};
+    float risk_posing_fraction = strategy.symptomatic_screening ? parameters.fraction_asymptomatic : 1;
+    Eigen::VectorXf X0 = Eigen::VectorXf::Zero(Model::n_compartments);
+    X0(strategy.mode == 1 ? Model::sub_compartments[0] + Model::sub_compartments[1] : 0) = strategy.p_infectious_t0;
+    Model screened(parameters.tau_mean_case, risk_posing_fraction, X0, 0, {}, {}, sensitivity,
+                   parameters.test_specificity);
+    Model natural(parameters.tau_mean_case, X0, 0);
+
+    ScreeningProgramme::Operator P0 = natural.propagator(1);
+    ScreeningProgramme::Operator P = intervention ? screened.propagator(1) : P0;
+    std::vector<int> types = strategy.types_of_tests();
+    State x = X0.cast<double>();
+    for (int day = 0; day < strategy.time_delay; ++day) {
+        x = P0 * x;
+    }
+    double start = x(Model::n_compartments - 1);
+    for (int day = 0; day < strategy.end_of_strategy; ++day) {
+        for (int i = 0; intervention && i < (int)strategy.test_moments.size(); ++i) {
+            if (strategy.test_moments[i] - strategy.time_delay == day % period) {
+                x = x.cwiseProduct(screened.false_ommision_rate(types[i]));
+            }
+        }
+        x = P * x;
+    }
+    return x(Model::n_compartments - 1) - start;
+}
+} // namespace
+
+int main() {
+    const float tolerance = 1e-4f;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    // the power by repeated squaring against the repeated product, for the operators of two periods
+    double largest_power_difference = 0;
+    for (int period : {3, 7}) {
+        ScreeningProgramme programme(parameters, strategy(0, 0, 28, {0}, {1}, 1), period);
+        for (int scenario = 0; scenario < 3; ++scenario) {
+            const ScreeningProgramme::Operator &M = programme.period_operator(scenario);
+            ScreeningProgramme::Operator product = ScreeningProgramme::Operator::Identity();
+            for (int n = 0; n <= 40; ++n) {
+                double difference = (ScreeningProgramme::power(M, n) - product).cwiseAbs().maxCoeff();
+                largest_power_difference = std::max(largest_power_difference, difference);
+                product = M * product;
+            }
+        }
+    }
+    check(largest_power_difference < 1e-12, "the power of the period operator is its repeated product");
+
+    // programmes of both modes against the states stepped day by day
+    std::vector<std::pair<StrategyParameters, int>> programmes{};
+    for (int mode = 0; mode < 2; ++mode) {
+        for (int duration : {21, 26, 180}) {
+            programmes.push_back({strategy(mode, 0, duration, {0, 2, 4}, {}, 1), 7});
+            programmes.push_back({strategy(mode, 2, duration, {1, 4}, {1, 0}, .8f), 7});
+            programmes.push_back({strategy(mode, 1, duration, {0}, {1}, 1), 3});
+        }
+    }
+    programmes[1].first.symptomatic_screening = false;
+    float largest_difference = 0;
+    int mismatches = 0;
+    for (const auto &[strategy, period] : programmes) {
+        ScreeningProgramme programme(parameters, strategy, period);
+        float adherence_squared = strategy.expected_adherence * strategy.expected_adherence;
+        double relative_risk = adherence_squared * stepped_risk(parameters, strategy, period, true) /
+                                   stepped_risk(parameters, strategy, period, false) +
+                               1 - adherence_squared;
+        float difference = std::abs(programme.relative_risk()(0) - relative_risk) / std::max(relative_risk, 1e-3);
+        largest_difference = std::max(largest_difference, difference);
+        mismatches += !(difference <= tolerance);
+    }
+    check(mismatches == 0, "the relative risk of a programme is that of the states stepped day by day");
+
+    // the steady state is the risk per period of an infection on every day of a long programme
+    {
+        const int period = 7;
+        StrategyParameters screened = strategy(0, 0, 7, {0, 2, 4}, {}, 1);
+        ScreeningProgramme programme(parameters, screened, period);
+        double risk = 0, risk_no_intervention = 0;
+        for (int day = 0; day < period; ++day) {
+            // one infection on this day of the period, followed until its risk has passed
+            StrategyParameters late = screened;
+            late.end_of_strategy = 364;
+            late.test_moments.clear();
+            for (int test_day : screened.test_moments) {
+                late.test_moments.push_back((test_day - day + period) % period);
+            }
+            std::sort(late.test_moments.begin(), late.test_moments.end());
+            late.test_types.assign(late.test_moments.size(), 0);
+            risk += stepped_risk(parameters, late, period, true);
+            risk_no_intervention += stepped_risk(parameters, late, period, false);
+        }
+        float difference = std::abs(programme.steady_state_relative_risk()(0) - risk / risk_no_intervention);
+        check(difference <= tolerance, "the steady state is the relative risk of an infection on any day");
+    }
+
+    std::printf("%d checks failed; %d programmes, largest relative difference to stepping day by day %.2g\n", failures,
+                (int)programmes.size(), largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+# The periodic screening of a screening programme against stepping through it day by day.
+
+TARGET = screening_programme
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/screening_programme.cpp \
+        screening_programme.cpp
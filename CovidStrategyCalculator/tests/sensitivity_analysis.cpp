@@ -0,0 +1,106 @@
+/* sensitivity_analysis.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the Sobol indices of a SensitivityAnalysis against the same estimators evaluated with one Simulation
+ * per point of every design matrix, including the matrix that only differs in adherence, whose model evaluations the
+ * analysis takes from the base matrix. The mean, variance, first order and total indices of every input must agree,
+ * and the analysis must evaluate the model for n (k + 2) parameter sets per strategy.
+ */
+
+#include "include/core/sensitivity_analysis.h"
+#include "include/core/simulation.h"
+#include "include/core/sobol_sequence.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const int n = 64;
+    const uint32_t seed = 3;
+    const float adherence_spread = .2f;
+    const float tolerance = 1e-3f; // of the indices, which are ratios of means of n products
+
+    ParameterSpace space(Parameters::default_values);
+    std::vector<StrategyParameters> strategies(2);
+    strategies[0].test_moments = {5};
+    strategies[0].expected_adherence = .8f;
+    strategies[1].mode = 1;
+    strategies[1].end_of_strategy = 7;
+    strategies[1].test_moments = {4, 6};
+    strategies[1].test_types = {1, 1};
+    strategies[1].expected_adherence = .9f;
+
+    SensitivityAnalysis analysis(space, strategies, adherence_spread);
+    analysis.run(n, seed);
+    const int k = space.dimensions();
+    check(analysis.n_evaluations() == 2 * n * (k + 2) && (int)analysis.inputs().size() == k + 1 &&
+              analysis.inputs().back() == "expected_adherence",
+          "the analysis evaluates the model for n (k + 2) parameter sets per strategy");
+
+    Eigen::MatrixXd points = SobolSequence(2 * (k + 1), seed).points(0, n);
+    Eigen::MatrixXd A = points.topRows(k + 1), B = points.bottomRows(k + 1);
+    float largest_difference = 0;
+    for (int s = 0; s < 2; ++s) {
+        float adherence = strategies[s].expected_adherence;
+        float lower = std::max(0.f, (1 - adherence_spread) * adherence);
+        float upper = std::min(1.f, (1 + adherence_spread) * adherence);
+        // the relative risk at the end of the strategy at a point of a design matrix
+        auto relative_risk = [&](const Eigen::VectorXd &x) {
+            StrategyParameters strategy = strategies[s];
+            strategy.expected_adherence = lower + x(k) * (upper - lower);
+            Simulation simulation(space.parameters_at(x.head(k)), strategy, Eigen::VectorXf(),
+                                  Simulation::end_of_strategy_outputs);
+            return double(simulation.relative_risk()(0, 0));
+        };
+
+        Eigen::ArrayXd y_A(n), y_B(n);
+        for (int j = 0; j < n; ++j) {
+            y_A(j) = relative_risk(A.col(j));
+            y_B(j) = relative_risk(B.col(j));
+        }
+        Eigen::ArrayXd y_A_B(2 * n);
+        y_A_B << y_A, y_B;
+        double mean = y_A_B.mean();
+        double variance = (y_A_B - mean).square().mean();
+
+        const SensitivityAnalysis::Indices &indices = analysis.indices()[s];
+        float difference = std::max(std::abs(indices.mean_relative_risk - mean) / mean,
+                                    std::abs(indices.variance - variance) / variance);
+        for (int i = 0; i < k + 1; ++i) {
+            Eigen::ArrayXd y_AB_i(n);
+            for (int j = 0; j < n; ++j) {
+                Eigen::VectorXd x = A.col(j);
+                x(i) = B(i, j);
+                y_AB_i(j) = relative_risk(x);
+            }
+            double first_order = (y_B * (y_AB_i - y_A)).mean() / variance;
+            double total = .5 * (y_A - y_AB_i).square().mean() / variance;
+            difference = std::max({difference, float(std::abs(indices.first_order(i) - first_order)),
+                                   float(std::abs(indices.total(i) - total))});
+        }
+        largest_difference = std::max(largest_difference, difference);
+    }
+    check(largest_difference <= tolerance, "the indices are those of one Simulation per point of the design matrices");
+
+    std::printf("%d checks failed; largest difference to the indices of one Simulation per point %.2g\n", failures,
+                largest_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+# The Sobol indices of a sensitivity analysis against one simulation per point of its design matrices.
+
+TARGET = sensitivity_analysis
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/ensemble.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameter_space.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/sensitivity_analysis.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/sobol_sequence.cpp \
+        sensitivity_analysis.cpp
@@ -0,0 +1,81 @@
+/* shared_model.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks that one Model, with its cached propagators, can be shared by several threads. The threads evaluate
+ * run, run_end_of_strategy and integrate from different initial states on the shared model; the results must equal
+ * those of private copies without the cache, evaluated one after the other, and the shared model must be unchanged.
+ * Built with ThreadSanitizer (see shared_model.pro), a data race fails the run as well.
+ */
+
+#include "include/core/model.h"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main() {
+    const int n_threads = 8;
+    const int n_states = 256;
+
+    std::vector<float> tau{2.6f, 2.3f, 7.f, 2.f};
+    Eigen::VectorXf X0 = Eigen::VectorXf::Unit(Model::n_compartments, 0);
+    Model shared(tau, .8f, X0, 20, {3, 7, 12}, {0, 1, 0}, {.9f, .7f}, .999f);
+    Model uncached = shared;
+    shared.cache_propagators(100);
+
+    std::vector<Eigen::VectorXf> initial_states(n_states);
+    for (int i = 0; i < n_states; ++i) {
+        int compartment = i % (Model::n_compartments - 1);
+        initial_states[i] = Eigen::VectorXf::Unit(Model::n_compartments, compartment) * (1 + i * 1e-3f);
+    }
+
+    // more threads than cores on small machines as well, such that the evaluations overlap
+    std::vector<Eigen::MatrixXf> states(n_states), end_states(n_states);
+    std::vector<Eigen::VectorXf> risks(n_states);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = t; i < n_states; i += n_threads) {
+                states[i] = shared.run(initial_states[i]);
+                end_states[i] = shared.run_end_of_strategy(initial_states[i]);
+                risks[i] = shared.integrate(states[i]);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    int failures = 0;
+    for (int i = 0; i < n_states; ++i) {
+        Model own = uncached;
+        own.X0 = initial_states[i];
+        Eigen::MatrixXf own_states = own.run();
+        if (own_states != states[i] || own.run_end_of_strategy() != end_states[i] ||
+            own.integrate(own_states) != risks[i]) {
+            std::printf("initial states %d: the shared model differs from a private copy\n", i);
+            ++failures;
+        }
+    }
+    if (shared.X0 != X0) {
+        std::printf("the evaluations changed the initial states of the shared model\n");
+        ++failures;
+    }
+    std::printf("%d of %d initial states differ\n", failures, n_states);
+    return failures ? 1 : 0;
+}
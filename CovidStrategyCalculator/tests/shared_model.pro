@@ -0,0 +1,15 @@
+# One Model shared by several threads, built with ThreadSanitizer.
+
+TARGET = shared_model
+TEMPLATE = app
+
+CONFIG += c++17 thread console sanitizer sanitize_thread
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        shared_model.cpp
@@ -0,0 +1,29 @@
+# Checks of the model that are built and run apart from the application; each exits with 0 when it passes.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        agent_simulation.pro \
+        allocations.pro \
+        c_interface.pro \
+        calibration.pro \
+        cohort_release.pro \
+        end_of_strategy.pro \
+        ensemble.pro \
+        exposure_mixture.pro \
+        incidence_file.pro \
+        jacobian.pro \
+        mixed_schedule.pro \
+        parameter_index.pro \
+        prevalence_estimator.pro \
+        query_service.pro \
+        regional_prevalence.pro \
+        result_cache.pro \
+        result_store.pro \
+        rolling_prevalence_estimator.pro \
+        screening_programme.pro \
+        sensitivity_analysis.pro \
+        shared_model.pro \
+        timeline.pro \
+        trajectory_archive.pro \
+        traveller_policy.pro
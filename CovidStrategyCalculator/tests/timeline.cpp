@@ -0,0 +1,105 @@
+/* timeline.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the Timeline of a strategy against the Simulation of the strategy, which runs the model day by day.
+ * For strategies of all modes, with PCR, RDT and mixed tests, with and without symptomatic screening, at lower
+ * adherence and with gaps between the events that need several powers of the propagator, and for incoming travellers
+ * from the prevalence of rising incidence, the relative risk of the timeline must be that of the Simulation at the end
+ * of the strategy in every scenario, and the states on the days of the strategy those of the Simulation after the tests
+ * of the day. Both must be finite.
+ */
+
+#include "include/core/prevalence_estimator.h"
+#include "include/core/simulation.h"
+#include "include/core/timeline.h"
+#include "tests/check.h"
+#include "tests/fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-5f;
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<StrategyParameters> strategies{};
+    for (int mode = 0; mode < 3; ++mode) {
+        for (bool screening : {true, false}) {
+            int delay = mode == 0 ? 2 : 0;
+            strategies.push_back(strategy(mode, delay, 10, {5}, {0}, 1, screening));
+            strategies.push_back(strategy(mode, delay, 14, {1, 6}, {1, 0}, .8f, screening));
+            strategies.push_back(strategy(mode, delay, 37, {0, 37}, {1, 1}, 1, screening));
+        }
+    }
+
+    // incoming travellers start from the prevalence of rising incidence
+    std::vector<float> history{};
+    for (int day = 0; day < 28; ++day) {
+        history.push_back(1e-4f * std::exp(-.05f * day));
+    }
+    Eigen::VectorXf prevalence_states =
+        PrevalenceEstimator(parameters, history, PrevalenceEstimator::daily).compartment_states().col(0);
+
+    float largest_risk_difference = 0, largest_state_difference = 0;
+    int non_finite = 0;
+    for (const StrategyParameters &strategy : strategies) {
+        Eigen::VectorXf initial_states = strategy.mode == 2 ? prevalence_states : Eigen::VectorXf();
+        Simulation simulation(parameters, strategy, initial_states);
+        Timeline timeline(parameters, strategy, initial_states);
+        Eigen::VectorXf relative_risk = simulation.relative_risk().bottomRows(1).transpose();
+        non_finite += !relative_risk.allFinite() || !timeline.relative_risk().allFinite();
+        largest_risk_difference =
+            std::max(largest_risk_difference, (timeline.relative_risk() - relative_risk).cwiseAbs().maxCoeff());
+
+        /* the states of the Simulation after the tests of each day: the last evaluation point of the day; the points
+         * count from the start of the strategy, the days of the timeline from the start of the model
+         */
+        Eigen::VectorXf points = simulation.evaluation_points_with_tests().array() + simulation.get_t_offset();
+        std::vector<int> days{};
+        std::vector<int> rows{};
+        for (int i = 0; i < points.size(); ++i) {
+            if (i + 1 == points.size() || points(i + 1) != points(i)) {
+                days.push_back(points(i));
+                rows.push_back(i);
+            }
+        }
+        for (int scenario = 0; scenario < 3; ++scenario) {
+            Eigen::MatrixXf states = timeline.states(days, scenario);
+            Eigen::MatrixXf simulated = simulation.get_strategy_states(scenario);
+            non_finite += !states.allFinite() || !simulated.allFinite();
+            /* relative to the magnitude of the states, at least the initial probability of infection; the risk node
+             * accumulates to about 15 times that
+             */
+            float floor = strategy.mode == 2 ? prevalence_states.sum() : 1;
+            for (int i = 0; i < (int)days.size(); ++i) {
+                largest_state_difference = std::max(largest_state_difference,
+                                                    relative_difference(simulated.row(rows[i]), states.row(i), floor));
+            }
+        }
+    }
+    check(non_finite == 0, "the relative risk and the states are finite");
+    check(largest_risk_difference <= tolerance, "the relative risk is that of the Simulation of the strategy");
+    check(largest_state_difference <= tolerance, "the states are those of the Simulation after the tests of the day");
+
+    std::printf("%d checks failed; %d strategies, largest difference to the Simulation %.2g (relative risk), %.2g "
+                "(states)\n",
+                failures, (int)strategies.size(), largest_risk_difference, largest_state_difference);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+# Strategies as event timelines against the simulation of the strategy.
+
+TARGET = timeline
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/timeline.cpp \
+        timeline.cpp
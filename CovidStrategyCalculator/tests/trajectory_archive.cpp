@@ -0,0 +1,167 @@
+/* trajectory_archive.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the round trip of a TrajectoryArchive: the compartment states of a set of strategies, with and
+ * without intervention, and a few matrices at the edges of the coding (empty compartments, a single time point,
+ * negative zero, subnormal and non-finite values) are appended from several threads. Lossless coding must restore the
+ * bits of every float, quantised coding every state within its tolerance; identical trajectories must share their
+ * chunk, and quantised coding must reject states that are not finite.
+ */
+
+#include "include/core/simulation.h"
+#include "include/core/trajectory_archive.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+const std::string path = "trajectory_archive_test.traj";
+
+bool identical(const Eigen::MatrixXf &a, const Eigen::MatrixXf &b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() &&
+           std::memcmp(a.data(), b.data(), sizeof(float) * a.size()) == 0;
+}
+
+// writes the trajectories from several threads, returns the index of each
+std::vector<int64_t> write(const std::vector<Eigen::MatrixXf> &trajectories, TrajectoryArchive::Coding coding,
+                           double tolerance) {
+    const int n_threads = 4;
+    std::vector<int64_t> indices(trajectories.size());
+    TrajectoryArchive::Writer writer(path, coding, tolerance);
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = t; i < trajectories.size(); i += n_threads) {
+                indices[i] = writer.append(trajectories[i]);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    return indices;
+}
+} // namespace
+
+int main() {
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+    std::vector<Eigen::MatrixXf> trajectories{};
+    for (int mode = 0; mode < 2; ++mode) {
+        for (int duration : {5, 10}) {
+            StrategyParameters strategy;
+            strategy.mode = mode;
+            strategy.end_of_strategy = duration;
+            strategy.test_moments = {duration - 1};
+            Simulation simulation(parameters, strategy);
+            for (int scenario = 0; scenario < 3; ++scenario) {
+                trajectories.push_back(simulation.get_strategy_states(scenario));
+                trajectories.push_back(simulation.get_states_no_intervention(scenario));
+            }
+        }
+    }
+    const int n_simulated = trajectories.size();
+    Eigen::MatrixXf edges(20, 4);
+    edges.col(0).setZero();
+    edges.col(1).setLinSpaced(-1, 1);
+    edges.col(2).setConstant(std::numeric_limits<float>::denorm_min());
+    edges.col(3).setConstant(1e6f);
+    edges(3, 0) = -0.f;
+    trajectories.push_back(edges);
+    trajectories.push_back(Eigen::MatrixXf::Constant(1, 7, .5f));
+    Eigen::MatrixXf non_finite = edges;
+    non_finite(5, 1) = std::numeric_limits<float>::quiet_NaN();
+    non_finite(6, 1) = std::numeric_limits<float>::infinity();
+
+    {
+        std::vector<Eigen::MatrixXf> lossless = trajectories;
+        lossless.push_back(non_finite);
+        std::vector<int64_t> indices = write(lossless, TrajectoryArchive::lossless, 0);
+        TrajectoryArchive archive(path);
+        bool same = archive.n_trajectories() == (int64_t)lossless.size() &&
+                    archive.coding() == TrajectoryArchive::lossless;
+        Eigen::MatrixXf states;
+        for (size_t i = 0; same && i < lossless.size(); ++i) {
+            archive.trajectory(indices[i], states);
+            same = identical(states, lossless[i]) && archive.rows(indices[i]) == lossless[i].rows() &&
+                   archive.cols(indices[i]) == lossless[i].cols();
+        }
+        check(same, "lossless coding restores the bits of every float");
+    }
+
+    for (double tolerance : {1e-4, 1e-7}) {
+        std::vector<int64_t> indices = write(trajectories, TrajectoryArchive::quantised, tolerance);
+        TrajectoryArchive archive(path);
+        bool same = archive.n_trajectories() == (int64_t)trajectories.size() && archive.tolerance() == tolerance;
+        float largest_error = 0;
+        for (size_t i = 0; same && i < trajectories.size(); ++i) {
+            Eigen::MatrixXf states = archive.trajectory(indices[i]);
+            same = states.rows() == trajectories[i].rows() && states.cols() == trajectories[i].cols();
+            if (same) {
+                // the tolerance, plus the rounding of the decoded state to float
+                Eigen::ArrayXXf error = (states - trajectories[i]).array().abs();
+                Eigen::ArrayXXf bound =
+                    tolerance + trajectories[i].array().abs() * std::numeric_limits<float>::epsilon();
+                same = (error <= bound).all();
+                largest_error = std::max(largest_error, error.maxCoeff());
+            }
+        }
+        char what[96];
+        std::snprintf(what, sizeof(what), "quantised coding within the tolerance %g (largest error %.2g)", tolerance,
+                      largest_error);
+        check(same, what);
+    }
+
+    {
+        // every trajectory once, then again: the second copies only add their entries to the table
+        size_t once, twice;
+        write(std::vector<Eigen::MatrixXf>(trajectories.begin(), trajectories.begin() + n_simulated),
+              TrajectoryArchive::quantised, 1e-6);
+        once = TrajectoryArchive(path).size();
+        std::vector<Eigen::MatrixXf> repeated(trajectories.begin(), trajectories.begin() + n_simulated);
+        repeated.insert(repeated.end(), trajectories.begin(), trajectories.begin() + n_simulated);
+        std::vector<int64_t> indices = write(repeated, TrajectoryArchive::quantised, 1e-6);
+        TrajectoryArchive archive(path);
+        twice = archive.size();
+        bool same = twice == once + 2 * sizeof(uint64_t) * n_simulated;
+        for (int i = 0; same && i < n_simulated; ++i) {
+            same = identical(archive.trajectory(indices[i]), archive.trajectory(indices[n_simulated + i]));
+        }
+        check(same, "identical trajectories share their chunk");
+    }
+
+    bool thrown = false;
+    try {
+        TrajectoryArchive::Writer writer(path, TrajectoryArchive::quantised, 1e-6);
+        writer.append(non_finite);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    check(thrown, "quantised coding rejects states that are not finite");
+
+    std::remove(path.c_str());
+    std::printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+# The round trip of trajectories through the trajectory archive, lossless and quantised.
+
+TARGET = trajectory_archive
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/mapped_file.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/trajectory_archive.cpp \
+        trajectory_archive.cpp
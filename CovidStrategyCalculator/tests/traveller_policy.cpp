@@ -0,0 +1,89 @@
+/* traveller_policy.cpp
+ *
+ * This file is part of COVIDStrategycalculator.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ * This file checks the plans of a TravellerPolicy against a Simulation of each plan in incoming travelers mode. For
+ * the prevalence of regions with rising, falling and constant incidence, in every use case and with and without
+ * symptomatic screening, the travellers released by every plan must be those of get_p_infectious_tend of the
+ * Simulation with the prevalence as initial states. The decision must be the first plan whose simulated release
+ * meets the target, in the typical case or, for a conservative policy, in all scenarios.
+ */
+
+#include "include/core/prevalence_estimator.h"
+#include "include/core/traveller_policy.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main() {
+    const float tolerance = 1e-5f; // relative to the largest release of a scenario
+
+    DiseaseParameters parameters = DiseaseParameters::from_values(Parameters::default_values);
+
+    std::vector<std::vector<float>> histories{std::vector<float>(28, 2e-4f), {}, {}}; // [day 0, day -1, ...]
+    for (int day = 0; day < 28; ++day) {
+        histories[1].push_back(1e-4f * std::exp(-.05f * day)); // rising
+        histories[2].push_back(1e-4f * std::exp(.05f * day));  // falling
+    }
+
+    float largest_difference = 0;
+    int wrong_decisions = 0, n_decisions = 0;
+    for (bool symptomatic_screening : {true, false}) {
+        for (int use_case = 0; use_case < 3; ++use_case) {
+            TravellerPolicy policy(parameters, 10, 10, symptomatic_screening, use_case);
+            for (const std::vector<float> &history : histories) {
+                PrevalenceEstimator prevalence(parameters, history, PrevalenceEstimator::daily);
+                Eigen::VectorXf states = prevalence.compartment_states().col(use_case);
+
+                // the release of every plan, simulated one by one
+                Eigen::MatrixXf released = policy.released(states);
+                Eigen::MatrixXf simulated(policy.plans().size(), 3);
+                for (int p = 0; p < (int)policy.plans().size(); ++p) {
+                    Simulation simulation(parameters, policy.plans()[p], states);
+                    simulated.row(p) = 1e5 * simulation.get_p_infectious_tend().transpose();
+                }
+                Eigen::ArrayXXf difference = (released - simulated).cwiseAbs().array().rowwise() /
+                                             simulated.colwise().maxCoeff().array();
+                largest_difference = std::max(largest_difference, difference.maxCoeff());
+
+                // decisions for targets between the releases of the plans
+                for (bool conservative : {false, true}) {
+                    for (float percentage : {.5f, 2.f, 8.f, 30.f}) { // of the release without quarantine
+                        float target = percentage / 100 * simulated(0, 0);
+                        TravellerPolicy judge(parameters, target, 10, symptomatic_screening, use_case, conservative);
+                        int expected = -1;
+                        for (int p = 0; expected < 0 && p < simulated.rows(); ++p) {
+                            float criterion = conservative ? simulated.row(p).maxCoeff() : simulated(p, 0);
+                            expected = criterion <= target ? p : -1;
+                        }
+                        wrong_decisions += judge.decide(states).plan != expected;
+                        ++n_decisions;
+                    }
+                }
+            }
+        }
+    }
+    check(largest_difference <= tolerance, "every plan releases the travellers of its Simulation");
+    check(wrong_decisions == 0, "the decision is the first plan whose Simulation meets the target");
+
+    std::printf("%d checks failed; %d decisions, largest relative difference to the Simulation %.2g\n", failures,
+                n_decisions, largest_difference);
+    return failures ? 1 : 0;
+}
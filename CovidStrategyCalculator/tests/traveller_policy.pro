@@ -0,0 +1,22 @@
+# The plans of the traveller policy against the simulation of each plan in incoming travelers mode.
+
+TARGET = traveller_policy
+TEMPLATE = app
+
+CONFIG += c++17 thread console
+CONFIG -= qt app_bundle
+QMAKE_CXXFLAGS += "-Wno-deprecated-copy"
+
+INCLUDEPATH += .. ../submodules/eigen
+
+SOURCES += \
+        ../src/core/base_model.cpp \
+        ../src/core/incidence_file.cpp \
+        ../src/core/mapped_file.cpp \
+        ../src/core/model.cpp \
+        ../src/core/parameters.cpp \
+        ../src/core/prevalence_estimator.cpp \
+        ../src/core/regional_prevalence.cpp \
+        ../src/core/simulation.cpp \
+        ../src/core/traveller_policy.cpp \
+        traveller_policy.cpp